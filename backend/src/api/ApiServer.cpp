@@ -1,9 +1,26 @@
 // ============================================================================
 // File: backend/src/api/ApiServer.cpp
-// Version: 4.2.4
+// Version: 4.2.7
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.2.7:
+//   - flushProgress() keeps, per client and player, the latest update a
+//     client's rate held back, and schedules a trailing flush for when
+//     the interval expires: the final position after stop/pause/seek
+//     always reaches slow clients
+//
+// Changes v4.2.6:
+//   - playback:progress no longer serialized on the publishing (MIDI)
+//     thread: latest update per player is kept and flushed on the server
+//     thread, serialized once, sent according to each client's rate
+//   - client.setProgressRate: per-connection progress rate
+//   - FIXED: Subscriptions kept in eventSubscriptions_ (a discarded
+//     Subscription unsubscribes its handler immediately)
+//
+// Changes v4.2.5:
+//   - playback:state and playback:progress carry player_id
+//
 // Changes v4.2.4:
 //   - FIXED: Removed eventSubscriptions_ storage (EventBus manages subscriptions)
 //
@@ -28,6 +45,7 @@ ApiServer::ApiServer(std::shared_ptr<EventBus> eventBus)
     : running_(false)
     , port_(8080)
     , eventBus_(eventBus)
+    , progressFlushScheduled_(false)
 {
     Logger::info("ApiServer", "Creating WebSocket server...");
     
@@ -116,8 +134,11 @@ void ApiServer::setupEventSubscriptions() {
     
     Logger::info("ApiServer", "Setting up event subscriptions...");
     
+    // Handlers stay registered as long as their Subscription is alive
+    eventSubscriptions_.clear();
+    
     // 1. MIDI Message Received
-    eventBus_->subscribe<events::MidiMessageReceivedEvent>(
+    eventSubscriptions_.push_back(eventBus_->subscribe<events::MidiMessageReceivedEvent>(
         [this](const auto& event) {
             json data = {
                 {"device_id", event.deviceId},
@@ -132,10 +153,10 @@ void ApiServer::setupEventSubscriptions() {
             auto envelope = MessageEnvelope::createEvent("midi:message:received", data);
             broadcast(envelope);
         }
-    );
+    ));
     
     // 2. Device Connected
-    eventBus_->subscribe<events::DeviceConnectedEvent>(
+    eventSubscriptions_.push_back(eventBus_->subscribe<events::DeviceConnectedEvent>(
         [this](const auto& event) {
             json data = {
                 {"device_id", event.deviceId},
@@ -146,10 +167,10 @@ void ApiServer::setupEventSubscriptions() {
             auto envelope = MessageEnvelope::createEvent("device:connected", data);
             broadcast(envelope);
         }
-    );
+    ));
     
     // 3. Device Disconnected
-    eventBus_->subscribe<events::DeviceDisconnectedEvent>(
+    eventSubscriptions_.push_back(eventBus_->subscribe<events::DeviceDisconnectedEvent>(
         [this](const auto& event) {
             json data = {
                 {"device_id", event.deviceId},
@@ -160,10 +181,10 @@ void ApiServer::setupEventSubscriptions() {
             auto envelope = MessageEnvelope::createEvent("device:disconnected", data);
             broadcast(envelope);
         }
-    );
+    ));
     
     // 4. Playback State Changed
-    eventBus_->subscribe<events::PlaybackStateChangedEvent>(
+    eventSubscriptions_.push_back(eventBus_->subscribe<events::PlaybackStateChangedEvent>(
         [this](const auto& event) {
             std::string stateStr;
             switch (event.state) {
@@ -183,29 +204,40 @@ void ApiServer::setupEventSubscriptions() {
                 {"state", stateStr},
                 {"filepath", event.filepath},
                 {"position", event.position},
-                {"timestamp", event.timestamp}
+                {"timestamp", event.timestamp},
+                {"player_id", event.playerId}
             };
             auto envelope = MessageEnvelope::createEvent("playback:state", data);
             broadcast(envelope);
         }
-    );
+    ));
     
-    // 5. Playback Progress
-    eventBus_->subscribe<events::PlaybackProgressEvent>(
+    // 5. Playback Progress (published on the player thread: only store it,
+    //    newer updates overwrite older ones until the server thread flushes)
+    eventSubscriptions_.push_back(eventBus_->subscribe<events::PlaybackProgressEvent>(
         [this](const auto& event) {
-            json data = {
-                {"position", event.position},
-                {"duration", event.duration},
-                {"percentage", event.percentage},
-                {"timestamp", event.timestamp}
-            };
-            auto envelope = MessageEnvelope::createEvent("playback:progress", data);
-            broadcast(envelope);
+            if (!running_.load()) {
+                return;
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(progressMutex_);
+                pendingProgress_[event.playerId] = ProgressUpdate{
+                    event.position, event.duration, event.percentage, event.timestamp
+                };
+                
+                if (progressFlushScheduled_) {
+                    return;
+                }
+                progressFlushScheduled_ = true;
+            }
+            
+            server_.get_io_service().post([this]() { flushProgress(); });
         }
-    );
+    ));
     
     // 6. Route Added
-    eventBus_->subscribe<events::RouteAddedEvent>(
+    eventSubscriptions_.push_back(eventBus_->subscribe<events::RouteAddedEvent>(
         [this](const auto& event) {
             json data = {
                 {"source", event.source},
@@ -215,10 +247,10 @@ void ApiServer::setupEventSubscriptions() {
             auto envelope = MessageEnvelope::createEvent("route:added", data);
             broadcast(envelope);
         }
-    );
+    ));
     
     // 7. Route Removed
-    eventBus_->subscribe<events::RouteRemovedEvent>(
+    eventSubscriptions_.push_back(eventBus_->subscribe<events::RouteRemovedEvent>(
         [this](const auto& event) {
             json data = {
                 {"source", event.source},
@@ -228,7 +260,7 @@ void ApiServer::setupEventSubscriptions() {
             auto envelope = MessageEnvelope::createEvent("route:removed", data);
             broadcast(envelope);
         }
-    );
+    ));
     
     Logger::info("ApiServer", "✓ Event subscriptions configured");
 }
@@ -245,6 +277,13 @@ bool ApiServer::start(uint16_t port) {
     
     port_ = port;
     
+    {
+        std::lock_guard<std::mutex> lock(progressMutex_);
+        pendingProgress_.clear();
+        progressFlushScheduled_ = false;
+    }
+    progressTimer_.reset();
+    
     try {
         serverThread_ = std::thread(&ApiServer::serverThread, this);
         running_.store(true);
@@ -352,7 +391,7 @@ void ApiServer::broadcast(const MessageEnvelope& message) {
     
     std::string payload = message.toString();
     
-    for (auto& hdl : connections_) {
+    for (auto& [hdl, client] : connections_) {
         try {
             server_.send(hdl, payload, websocketpp::frame::opcode::text);
             
@@ -386,7 +425,7 @@ void ApiServer::broadcastEvent(const std::string& name,
 
 void ApiServer::onOpen(connection_hdl hdl) {
     std::lock_guard<std::mutex> lock(connectionsMutex_);
-    connections_.insert(hdl);
+    connections_.emplace(hdl, ClientState{});
     
     {
         std::lock_guard<std::mutex> statsLock(statsMutex_);
@@ -516,6 +555,12 @@ void ApiServer::processRequest(connection_hdl hdl, const MessageEnvelope& messag
     try {
         const auto& request = message.getRequest();
         
+        if (request.command == SET_PROGRESS_RATE_COMMAND) {
+            sendTo(hdl, MessageEnvelope::createSuccessResponse(
+                message.getId(), setClientProgressRate(hdl, request.params)));
+            return;
+        }
+        
         // Build complete command JSON with both command and params
         json commandJson = {
             {"command", request.command},
@@ -542,8 +587,146 @@ void ApiServer::processRequest(connection_hdl hdl, const MessageEnvelope& messag
     }
 }
 
+// ============================================================================
+// PROGRESS EVENTS
+// ============================================================================
+
+void ApiServer::flushProgress() {
+    std::map<std::string, ProgressUpdate> updates;
+    
+    {
+        std::lock_guard<std::mutex> lock(progressMutex_);
+        updates.swap(pendingProgress_);
+        progressFlushScheduled_ = false;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    auto nextDue = std::chrono::steady_clock::time_point::max();
+    
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    
+    // New updates replace what each client still holds for the player
+    for (const auto& [playerId, update] : updates) {
+        std::shared_ptr<const std::string> payload;   // Serialized once, if wanted
+        
+        for (auto& [hdl, client] : connections_) {
+            if (!client.progressEnabled) {
+                continue;
+            }
+            
+            if (!payload) {
+                json data = {
+                    {"position", update.position},
+                    {"duration", update.duration},
+                    {"percentage", update.percentage},
+                    {"timestamp", update.timestamp},
+                    {"player_id", playerId}
+                };
+                payload = std::make_shared<const std::string>(
+                    MessageEnvelope::createEvent("playback:progress", data).toString());
+            }
+            
+            client.progress[playerId].pending = payload;
+        }
+    }
+    
+    // Send what each client's rate allows; the rest waits for a trailing
+    // flush (the player publishes nothing once the position stops moving)
+    for (auto& [hdl, client] : connections_) {
+        for (auto& [playerId, progress] : client.progress) {
+            if (!progress.pending) {
+                continue;
+            }
+            
+            if (!client.progressEnabled) {
+                progress.pending.reset();
+                continue;
+            }
+            
+            auto due = progress.lastSent + client.progressInterval;
+            if (now < due) {
+                nextDue = std::min(nextDue, due);
+                continue;
+            }
+            
+            try {
+                server_.send(hdl, *progress.pending, websocketpp::frame::opcode::text);
+                progress.lastSent = now;
+                
+                std::lock_guard<std::mutex> statsLock(statsMutex_);
+                stats_.messagesSent++;
+                
+            } catch (const std::exception& e) {
+                Logger::warning("ApiServer", 
+                              "Failed to send progress to client: " + std::string(e.what()));
+                
+                std::lock_guard<std::mutex> statsLock(statsMutex_);
+                stats_.errorCount++;
+            }
+            
+            progress.pending.reset();
+        }
+    }
+    
+    if (nextDue != std::chrono::steady_clock::time_point::max()) {
+        scheduleProgressFlush(nextDue);
+    }
+}
+
+void ApiServer::scheduleProgressFlush(std::chrono::steady_clock::time_point due) {
+    auto now = std::chrono::steady_clock::now();
+    
+    if (progressTimer_ && progressTimerDue_ > now && progressTimerDue_ <= due) {
+        return;     // An earlier flush will handle it
+    }
+    
+    if (progressTimer_) {
+        progressTimer_->cancel();
+    }
+    
+    // Rounded up: firing early would only reschedule
+    auto delayUs = std::chrono::duration_cast<std::chrono::microseconds>(due - now).count();
+    long delayMs = static_cast<long>(std::max<int64_t>(0, (delayUs + 999) / 1000));
+    
+    progressTimerDue_ = due;
+    progressTimer_ = server_.set_timer(delayMs, [this](const websocketpp::lib::error_code& ec) {
+        if (ec) {
+            return;     // Cancelled (rescheduled or server stopping)
+        }
+        progressTimer_.reset();
+        flushProgress();
+    });
+}
+
+json ApiServer::setClientProgressRate(connection_hdl hdl, const json& params) {
+    if (!params.contains("rate_hz") || !params["rate_hz"].is_number()) {
+        throw std::runtime_error("Missing rate_hz parameter");
+    }
+    
+    double rate = params["rate_hz"].get<double>();
+    if (rate < 0.0) {
+        throw std::runtime_error("rate_hz must be >= 0");
+    }
+    
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    
+    auto it = connections_.find(hdl);
+    if (it == connections_.end()) {
+        throw std::runtime_error("Unknown connection");
+    }
+    
+    it->second.progressEnabled = rate > 0.0;
+    it->second.progressInterval = rate > 0.0 ?
+        std::chrono::microseconds(static_cast<int64_t>(1e6 / rate)) :
+        std::chrono::microseconds(0);
+    
+    Logger::debug("ApiServer", "Client progress rate: " + std::to_string(rate) + " Hz");
+    
+    return json{{"rate_hz", rate}};
+}
+
 } // namespace midiMind
 
 // ============================================================================
-// END OF FILE ApiServer.cpp v4.2.4
+// END OF FILE ApiServer.cpp v4.2.7
 // ============================================================================
\ No newline at end of file
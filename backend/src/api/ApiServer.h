@@ -1,9 +1,17 @@
 // ============================================================================
 // File: backend/src/api/ApiServer.h
-// Version: 4.2.8
+// Version: 4.2.10
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.2.10:
+//   - A progress update held back by a client's rate is kept and sent
+//     by a trailing flush when the client's interval expires
+//
+// Changes v4.2.9:
+//   - playback:progress coalesced per player and sent from the server
+//     thread; per-client rate limit (client.setProgressRate)
+//
 // Changes v4.2.8:
 //   - FIXED: Removed inline definitions causing redefinition errors
 //   - isRunning() and setCommandCallback() now declared only (defined in .cpp)
@@ -21,7 +29,8 @@
 #include "../core/EventBus.h"
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/server.hpp>
-#include <set>
+#include <map>
+#include <string>
 #include <thread>
 #include <mutex>
 #include <functional>
@@ -38,6 +47,9 @@ public:
     using message_ptr = server_t::message_ptr;
     using CommandCallback = std::function<json(const json&)>;
     
+    /// Connection-scoped command handled by the server itself
+    static constexpr const char* SET_PROGRESS_RATE_COMMAND = "client.setProgressRate";
+    
     struct Stats {
         std::chrono::steady_clock::time_point startTime;
         size_t activeConnections;
@@ -91,8 +103,45 @@ private:
     void processRequest(connection_hdl hdl, const MessageEnvelope& message);
     void setupEventSubscriptions();
     
+    /**
+     * @brief Send the latest progress of each player (server thread)
+     */
+    void flushProgress();
+    
+    /**
+     * @brief Run flushProgress() again at `due` unless an earlier flush
+     *        is already scheduled (server thread)
+     */
+    void scheduleProgressFlush(std::chrono::steady_clock::time_point due);
+    
+    /**
+     * @brief client.setProgressRate {rate_hz}: 0 = no progress events
+     */
+    json setClientProgressRate(connection_hdl hdl, const json& params);
+    
+    /// Progress of one player as seen by one client
+    struct ClientProgress {
+        std::chrono::steady_clock::time_point lastSent;
+        std::shared_ptr<const std::string> pending;       // Held back by the rate
+    };
+    
+    /// Per-connection state
+    struct ClientState {
+        std::chrono::microseconds progressInterval{0};   // 0 = every update
+        bool progressEnabled = true;
+        std::map<std::string, ClientProgress> progress;   // By player ID
+    };
+    
+    /// Latest progress of a player, waiting for flushProgress()
+    struct ProgressUpdate {
+        double position;
+        double duration;
+        double percentage;
+        uint64_t timestamp;
+    };
+    
     server_t server_;
-    std::set<connection_hdl, std::owner_less<connection_hdl>> connections_;
+    std::map<connection_hdl, ClientState, std::owner_less<connection_hdl>> connections_;
     std::thread serverThread_;
     std::atomic<bool> running_;
     int port_;
@@ -101,6 +150,12 @@ private:
     std::shared_ptr<EventBus> eventBus_;
     std::vector<Subscription> eventSubscriptions_;
     
+    std::mutex progressMutex_;
+    std::map<std::string, ProgressUpdate> pendingProgress_;   // By player ID
+    bool progressFlushScheduled_;
+    server_t::timer_ptr progressTimer_;                       // Trailing flush (server thread)
+    std::chrono::steady_clock::time_point progressTimerDue_;
+    
     mutable std::mutex connectionsMutex_;
     mutable std::mutex statsMutex_;
     Stats stats_;
@@ -109,5 +164,5 @@ private:
 } // namespace midiMind
 
 // ============================================================================
-// END OF FILE ApiServer.h v4.2.8
+// END OF FILE ApiServer.h v4.2.10
 // ============================================================================
\ No newline at end of file
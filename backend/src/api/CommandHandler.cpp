@@ -1,10 +1,56 @@
 // ============================================================================
 // File: backend/src/api/CommandHandler.cpp
-// Version: 4.2.3
+// Version: 4.2.15
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 
 
+// Changes v4.2.15:
+//   - FIXED: routing.addRoute took coalesce_window_ms unchecked (a negative
+//     value wrapped to ~49 days); same 0..1000 range as setCoalescing
+//
+// Changes v4.2.14:
+//   - FIXED: playback.render wrote to any path the client gave; output is
+//     now a bare file name inside the MIDI files directory
+//
+// Changes v4.2.13:
+//   - Added devices.setJitterBuffer (input re-timing depth of BLE devices)
+//
+// Changes v4.2.12:
+//   - Added devices.setQueuePolicy (device queue overflow policy)
+//
+// Changes v4.2.11:
+//   - devices.getHotPlugStatus reports event_driven (ALSA announcements)
+//
+// Changes v4.2.10:
+//   - Added devices.setBackend (ALSA sequencer / raw MIDI for USB devices)
+//
+// Changes v4.2.9:
+//   - Added devices.setOutputMode (direct / ALSA-queued output),
+//     latency.setLookahead and playback.setLookahead
+//
+// Changes v4.2.8:
+//   - Added routing.setCoalescing (controller/pitch bend thinning window);
+//     routing.addRoute accepts an optional coalesce_window_ms
+//
+// Changes v4.2.7:
+//   - routing.listRoutes includes each route's statistics (latency and
+//     compensation percentiles)
+//   - Added routing.getStats (routes, devices, timed delivery)
+//
+// Changes v4.2.6:
+//   - Added latency.getDeliveryStats (timed delivery queue and lateness)
+//   - latency.getCompensation also returns the applied alignment delay
+//
+// Changes v4.2.5:
+//   - Added playback.render (offline render to a MIDI file)
+//   - Added playback.setProgressRate (progress event rate of a player)
+//
+// Changes v4.2.4:
+//   - Playback commands take an optional player_id (default "main")
+//   - Added playback.listPlayers, playback.createPlayer,
+//     playback.removePlayer, playback.playTogether
+//
 // Changes v4.2.3:
 //   - FIXED: Removed double wrapping - commands return raw data
 //   - ApiServer now handles response envelope creation
@@ -16,6 +62,8 @@
 #include "../storage/InstrumentDatabase.h"
 #include "../storage/PresetManager.h"
 #include "../storage/MidiDatabase.h"
+#include "../storage/PathManager.h"
+#include "../midi/player/OfflineRenderer.h"
 #include <chrono>
 #include <sys/utsname.h>
 #include <sys/statvfs.h>
@@ -36,7 +84,7 @@ namespace midiMind {
 CommandHandler::CommandHandler(
     std::shared_ptr<MidiDeviceManager> deviceManager,
     std::shared_ptr<MidiRouter> router,
-    std::shared_ptr<MidiPlayer> player,
+    std::shared_ptr<PlayerEngine> playerEngine,
     std::shared_ptr<FileManager> fileManager,
     std::shared_ptr<LatencyCompensator> compensator,
     std::shared_ptr<InstrumentDatabase> instrumentDb,
@@ -46,7 +94,7 @@ CommandHandler::CommandHandler(
     std::shared_ptr<PlaylistManager> playlistManager)
     : deviceManager_(deviceManager)
     , router_(router)
-    , player_(player)
+    , playerEngine_(playerEngine)
     , fileManager_(fileManager)
     , compensator_(compensator)
     , instrumentDb_(instrumentDb)
@@ -196,7 +244,7 @@ void CommandHandler::registerAllCommands() {
 }
 
 // ============================================================================
-// DEVICE COMMANDS (12 commands)
+// DEVICE COMMANDS (22 commands)
 // ============================================================================
 
 void CommandHandler::registerDeviceCommands() {
@@ -346,7 +394,144 @@ void CommandHandler::registerDeviceCommands() {
         bool active = deviceManager_->isHotPlugMonitoringActive();
         
         return json{
-            {"active", active}
+            {"active", active},
+            {"event_driven", deviceManager_->isHotPlugEventDriven()}
+        };
+    });
+    
+    // devices.setOutputMode
+    registerCommand("devices.setOutputMode", [this](const json& params) {
+        if (!params.contains("device_id") || !params.contains("mode")) {
+            throw std::runtime_error("Missing device_id or mode parameter");
+        }
+        
+        std::string deviceId = params["device_id"];
+        std::string modeStr = params["mode"];
+        
+        OutputMode mode;
+        if (modeStr == "DIRECT" || modeStr == "direct") {
+            mode = OutputMode::DIRECT;
+        } else if (modeStr == "QUEUED" || modeStr == "queued") {
+            mode = OutputMode::QUEUED;
+        } else {
+            throw std::runtime_error("Invalid output mode: " + modeStr);
+        }
+        
+        auto device = deviceManager_->getDevice(deviceId);
+        if (!device) {
+            throw std::runtime_error("Device not found: " + deviceId);
+        }
+        
+        if (!device->setOutputMode(mode)) {
+            throw std::runtime_error("Output mode not supported by device: " + modeStr);
+        }
+        
+        return json{
+            {"device_id", deviceId},
+            {"mode", MidiDevice::outputModeToString(device->getOutputMode())},
+            {"timed", device->supportsTimedOutput()}
+        };
+    });
+    
+    // devices.setQueuePolicy
+    registerCommand("devices.setQueuePolicy", [this](const json& params) {
+        if (!params.contains("device_id") || !params.contains("policy")) {
+            throw std::runtime_error("Missing device_id or policy parameter");
+        }
+        
+        std::string deviceId = params["device_id"];
+        std::string policyStr = params["policy"];
+        
+        OverflowPolicy policy;
+        if (policyStr == "DROP_OLDEST" || policyStr == "drop_oldest") {
+            policy = OverflowPolicy::DROP_OLDEST;
+        } else if (policyStr == "DROP_NEWEST" || policyStr == "drop_newest") {
+            policy = OverflowPolicy::DROP_NEWEST;
+        } else if (policyStr == "BLOCK" || policyStr == "block") {
+            policy = OverflowPolicy::BLOCK;
+        } else {
+            throw std::runtime_error("Invalid queue policy: " + policyStr);
+        }
+        
+        auto device = deviceManager_->getDevice(deviceId);
+        if (!device) {
+            throw std::runtime_error("Device not found: " + deviceId);
+        }
+        
+        if (!device->setOverflowPolicy(policy)) {
+            throw std::runtime_error("Queue policy not supported by device: " + policyStr);
+        }
+        
+        return json{
+            {"device_id", deviceId},
+            {"policy", overflowPolicyToString(policy)}
+        };
+    });
+    
+    // devices.setJitterBuffer
+    registerCommand("devices.setJitterBuffer", [this](const json& params) {
+        if (!params.contains("device_id") || !params.contains("max_depth_ms")) {
+            throw std::runtime_error("Missing device_id or max_depth_ms parameter");
+        }
+        
+        std::string deviceId = params["device_id"];
+        double maxDepthMs = params["max_depth_ms"];
+        bool adaptive = params.value("adaptive", true);
+        
+        if (maxDepthMs < 0 || maxDepthMs > 100) {
+            throw std::runtime_error("max_depth_ms must be between 0 and 100");
+        }
+        
+        auto device = deviceManager_->getDevice(deviceId);
+        if (!device) {
+            throw std::runtime_error("Device not found: " + deviceId);
+        }
+        
+        auto maxDepth = std::chrono::microseconds(static_cast<int64_t>(maxDepthMs * 1000));
+        if (!device->setJitterBuffer(maxDepth, adaptive)) {
+            throw std::runtime_error("Jitter buffer not supported by device: " + deviceId);
+        }
+        
+        return json{
+            {"device_id", deviceId},
+            {"max_depth_ms", maxDepthMs},
+            {"adaptive", adaptive}
+        };
+    });
+    
+    // devices.setBackend
+    registerCommand("devices.setBackend", [this](const json& params) {
+        if (!params.contains("device_id") || !params.contains("backend")) {
+            throw std::runtime_error("Missing device_id or backend parameter");
+        }
+        
+        std::string deviceId = params["device_id"];
+        std::string backendStr = params["backend"];
+        
+        DeviceBackend backend;
+        if (backendStr == "SEQUENCER" || backendStr == "sequencer") {
+            backend = DeviceBackend::SEQUENCER;
+        } else if (backendStr == "RAWMIDI" || backendStr == "rawmidi") {
+            backend = DeviceBackend::RAWMIDI;
+        } else {
+            throw std::runtime_error("Invalid backend: " + backendStr);
+        }
+        
+        if (!deviceManager_->setDeviceBackend(deviceId, backend)) {
+            throw std::runtime_error("Backend not available for device: " + backendStr);
+        }
+        
+        // A connected device is reopened through its new backend
+        bool reconnected = false;
+        if (deviceManager_->isConnected(deviceId)) {
+            deviceManager_->disconnect(deviceId);
+            reconnected = deviceManager_->connect(deviceId);
+        }
+        
+        return json{
+            {"device_id", deviceId},
+            {"backend", MidiDeviceManager::deviceBackendToString(backend)},
+            {"reconnected", reconnected}
         };
     });
     
@@ -483,11 +668,11 @@ void CommandHandler::registerDeviceCommands() {
         };
     });
     
-    Logger::debug("CommandHandler", "Ã¢Å“â€œ Device commands registered (18 commands)");  
+    Logger::debug("CommandHandler", "Ã¢Å“â€œ Device commands registered (22 commands)");  
 }
 
 // ============================================================================
-// ROUTING COMMANDS (6 commands)
+// ROUTING COMMANDS (8 commands)
 // ============================================================================
 
 void CommandHandler::registerRoutingCommands() {
@@ -506,8 +691,18 @@ void CommandHandler::registerRoutingCommands() {
         std::string sourceId = params["source_id"];
         std::string destId = params["destination_id"];
         
+        // Checked before the route exists, so a bad window adds nothing
+        int windowMs = params.value("coalesce_window_ms", 0);
+        if (windowMs < 0 || windowMs > 1000) {
+            throw std::runtime_error("coalesce_window_ms must be between 0 and 1000");
+        }
+        
         bool success = router_->addRoute(sourceId, destId);
         
+        if (success && windowMs > 0) {
+            router_->setRouteCoalescing(sourceId, destId, static_cast<uint32_t>(windowMs));
+        }
+        
         return json{
             {"added", success},
             {"source_id", sourceId},
@@ -546,9 +741,12 @@ void CommandHandler::registerRoutingCommands() {
         json routesJson = json::array();
         for (const auto& route : routes) {
             json routeObj = {
+                {"id", route->id},
                 {"source_id", route->sourceDeviceId},
                 {"destination_id", route->destinationDeviceId},
-                {"enabled", route->enabled}
+                {"enabled", route->enabled},
+                {"coalesce_window_ms", route->coalesceWindowMs},
+                {"stats", router_->getRouteStatistics(route->id).toJson()}
             };
             routesJson.push_back(routeObj);
         }
@@ -595,17 +793,59 @@ void CommandHandler::registerRoutingCommands() {
         };
     });
     
-    Logger::debug("CommandHandler", "Ã¢Å“â€œ Routing commands registered (6 commands)");
+    // routing.setCoalescing
+    registerCommand("routing.setCoalescing", [this](const json& params) {
+        if (!params.contains("source_id") || !params.contains("destination_id") ||
+            !params.contains("window_ms")) {
+            throw std::runtime_error("Missing source_id, destination_id or window_ms");
+        }
+        
+        std::string sourceId = params["source_id"];
+        std::string destId = params["destination_id"];
+        int windowMs = params["window_ms"];
+        
+        if (windowMs < 0 || windowMs > 1000) {
+            throw std::runtime_error("window_ms must be between 0 and 1000");
+        }
+        
+        bool success = router_->setRouteCoalescing(sourceId, destId,
+                                                   static_cast<uint32_t>(windowMs));
+        
+        return json{
+            {"updated", success},
+            {"source_id", sourceId},
+            {"destination_id", destId},
+            {"window_ms", windowMs}
+        };
+    });
+    
+    // routing.getStats
+    registerCommand("routing.getStats", [this](const json& params) {
+        return router_->getStatistics();
+    });
+    
+    Logger::debug("CommandHandler", "Ã¢Å“â€œ Routing commands registered (8 commands)");
 }
 
 // ============================================================================
-// PLAYBACK COMMANDS (10 commands)
+// PLAYBACK COMMANDS (17 commands)
 // ============================================================================
 
+std::shared_ptr<MidiPlayer> CommandHandler::resolvePlayer(const json& params) const {
+    std::string playerId = params.value("player_id", PlayerEngine::DEFAULT_PLAYER_ID);
+    
+    auto player = playerEngine_->getPlayer(playerId);
+    if (!player) {
+        throw std::runtime_error("Unknown player: " + playerId);
+    }
+    
+    return player;
+}
+
 void CommandHandler::registerPlaybackCommands() {
-    if (!player_) {
+    if (!playerEngine_) {
         Logger::warning("CommandHandler", 
-                    "Player not available, skipping playback commands");
+                    "Player engine not available, skipping playback commands");
         return;
     }
     
@@ -615,10 +855,12 @@ void CommandHandler::registerPlaybackCommands() {
             throw std::runtime_error("Missing filename parameter");
         }
         
+        auto player = resolvePlayer(params);
         std::string filename = params["filename"];
-        bool success = player_->load(filename);
+        bool success = player->load(filename);
         
         return json{
+            {"player_id", player->getId()},
             {"loaded", success},
             {"filename", filename}
         };
@@ -626,41 +868,50 @@ void CommandHandler::registerPlaybackCommands() {
     
     // playback.play
     registerCommand("playback.play", [this](const json& params) {
-        bool success = player_->play();
+        auto player = resolvePlayer(params);
+        bool success = player->play();
         
         return json{
+            {"player_id", player->getId()},
             {"playing", success}
         };
     });
     
     // playback.pause
     registerCommand("playback.pause", [this](const json& params) {
-        player_->pause();
+        auto player = resolvePlayer(params);
+        player->pause();
         
         return json{
+            {"player_id", player->getId()},
             {"paused", true}
         };
     });
     
     // playback.stop
     registerCommand("playback.stop", [this](const json& params) {
-        player_->stop();
+        auto player = resolvePlayer(params);
+        player->stop();
         
         return json{
+            {"player_id", player->getId()},
             {"stopped", true}
         };
     });
     
     // playback.getStatus
     registerCommand("playback.getStatus", [this](const json& params) {
-        auto state = player_->getState();
+        auto player = resolvePlayer(params);
+        auto state = player->getState();
         
         return json{
+            {"player_id", player->getId()},
             {"state", static_cast<int>(state)},
-            {"current_time", player_->getCurrentPosition()},
-            {"duration", player_->getDuration()},
-            {"tempo", player_->getTempo()},
-            {"filename", player_->getCurrentFile()}
+            {"current_time", player->getCurrentPosition()},
+            {"duration", player->getDuration()},
+            {"tempo", player->getTempo()},
+            {"filename", player->getCurrentFile()},
+            {"timing", player->getTimingStatistics()}
         };
     });
     
@@ -670,10 +921,12 @@ void CommandHandler::registerPlaybackCommands() {
             throw std::runtime_error("Missing position parameter");
         }
         
+        auto player = resolvePlayer(params);
         double position = params["position"];
-        player_->seek(position);
+        player->seek(position);
         
         return json{
+            {"player_id", player->getId()},
             {"seeked", true},
             {"position", position}
         };
@@ -685,10 +938,12 @@ void CommandHandler::registerPlaybackCommands() {
             throw std::runtime_error("Missing tempo parameter");
         }
         
+        auto player = resolvePlayer(params);
         double tempo = params["tempo"];
-        player_->setTempo(tempo);
+        player->setTempo(tempo);
         
         return json{
+            {"player_id", player->getId()},
             {"tempo", tempo}
         };
     });
@@ -699,26 +954,154 @@ void CommandHandler::registerPlaybackCommands() {
             throw std::runtime_error("Missing enabled parameter");
         }
         
+        auto player = resolvePlayer(params);
         bool enabled = params["enabled"];
-        player_->setLoop(enabled);
+        player->setLoop(enabled);
         
         return json{
+            {"player_id", player->getId()},
             {"loop_enabled", enabled}
         };
     });
     
     // playback.getInfo
     registerCommand("playback.getInfo", [this](const json& params) {
-        json metadata = player_->getMetadata();
+        auto player = resolvePlayer(params);
+        json metadata = player->getMetadata();
         
         return json{
-            {"filename", player_->getCurrentFile()},
-            {"duration", player_->getDuration()},
-            {"tempo", player_->getTempo()},
+            {"player_id", player->getId()},
+            {"filename", player->getCurrentFile()},
+            {"duration", player->getDuration()},
+            {"tempo", player->getTempo()},
             {"metadata", metadata}
         };
     });
     
+    // playback.listPlayers
+    registerCommand("playback.listPlayers", [this](const json& params) {
+        json players = playerEngine_->getStatus();
+        
+        return json{
+            {"players", players},
+            {"count", players.size()}
+        };
+    });
+    
+    // playback.createPlayer
+    registerCommand("playback.createPlayer", [this](const json& params) {
+        std::string playerId = params.value("player_id", "");
+        
+        auto player = playerEngine_->createPlayer(playerId);
+        if (!player) {
+            throw std::runtime_error("Cannot create player: " +
+                (playerId.empty() ? std::string("limit reached") : playerId));
+        }
+        
+        return json{
+            {"player_id", player->getId()},
+            {"created", true}
+        };
+    });
+    
+    // playback.removePlayer
+    registerCommand("playback.removePlayer", [this](const json& params) {
+        if (!params.contains("player_id")) {
+            throw std::runtime_error("Missing player_id parameter");
+        }
+        
+        std::string playerId = params["player_id"];
+        
+        return json{
+            {"player_id", playerId},
+            {"removed", playerEngine_->removePlayer(playerId)}
+        };
+    });
+    
+    // playback.playTogether
+    registerCommand("playback.playTogether", [this](const json& params) {
+        if (!params.contains("player_ids") || !params["player_ids"].is_array()) {
+            throw std::runtime_error("Missing player_ids parameter");
+        }
+        
+        auto playerIds = params["player_ids"].get<std::vector<std::string>>();
+        size_t started = playerEngine_->playTogether(playerIds);
+        
+        return json{
+            {"player_ids", playerIds},
+            {"started", started}
+        };
+    });
+    
+    // playback.render
+    registerCommand("playback.render", [this](const json& params) {
+        auto player = resolvePlayer(params);
+        
+        if (!player->hasFile()) {
+            throw std::runtime_error("No file loaded");
+        }
+        
+        // Default: <file>_render.mid. A bare file name only: the render
+        // always lands in the MIDI files directory
+        std::string filename = params.value("output",
+            std::filesystem::path(player->getCurrentFile()).stem().string() + "_render.mid");
+        std::filesystem::path name(filename);
+        if (filename.empty() || name.has_parent_path() || name.is_absolute() ||
+            filename == "." || filename == "..") {
+            throw std::runtime_error("Invalid output file name: " + filename);
+        }
+        
+        // Resolved (symlinks included) it must still be in that directory
+        std::filesystem::path directory = std::filesystem::weakly_canonical(
+            PathManager::instance().getMidiFilesPath());
+        std::filesystem::path output = std::filesystem::weakly_canonical(directory / name);
+        if (output.parent_path() != directory) {
+            throw std::runtime_error("Output outside the MIDI files directory: " + filename);
+        }
+        
+        OfflineRenderer renderer(router_);
+        json result = renderer.render(*player, output.string(),
+                                      params.value("apply_routing", true));
+        result["player_id"] = player->getId();
+        
+        return result;
+    });
+    
+    // playback.setProgressRate
+    registerCommand("playback.setProgressRate", [this](const json& params) {
+        if (!params.contains("rate_hz")) {
+            throw std::runtime_error("Missing rate_hz parameter");
+        }
+        
+        auto player = resolvePlayer(params);
+        player->setProgressRate(params["rate_hz"].get<double>());
+        
+        return json{
+            {"player_id", player->getId()},
+            {"rate_hz", player->getProgressRate()}
+        };
+    });
+    
+    // playback.setLookahead
+    registerCommand("playback.setLookahead", [this](const json& params) {
+        if (!params.contains("lookahead_ms")) {
+            throw std::runtime_error("Missing lookahead_ms parameter");
+        }
+        
+        double lookaheadMs = params["lookahead_ms"];
+        if (lookaheadMs < 0) {
+            throw std::runtime_error("lookahead_ms must be >= 0");
+        }
+        
+        auto player = resolvePlayer(params);
+        player->setLookahead(std::chrono::microseconds(static_cast<int64_t>(lookaheadMs * 1000.0)));
+        
+        return json{
+            {"player_id", player->getId()},
+            {"lookahead_ms", player->getLookahead().count() / 1000.0}
+        };
+    });
+    
     // playback.listFiles
     registerCommand("playback.listFiles", [this](const json& params) {
         auto fileInfos = fileManager_->listFiles();  // List all files
@@ -734,7 +1117,7 @@ void CommandHandler::registerPlaybackCommands() {
         };
     });
     
-    Logger::debug("CommandHandler", "Ã¢Å“â€œ Playback commands registered (10 commands)");
+    Logger::debug("CommandHandler", "Ã¢Å“â€œ Playback commands registered (17 commands)");
 }
 
 // ============================================================================
@@ -1152,7 +1535,7 @@ void CommandHandler::registerLoggerCommands() {
 }
 
 // ============================================================================
-// LATENCY COMMANDS (7 commands)
+// LATENCY COMMANDS (9 commands)
 // ============================================================================
 
 void CommandHandler::registerLatencyCommands() {
@@ -1194,7 +1577,8 @@ void CommandHandler::registerLatencyCommands() {
         return json{
             {"instrument_id", instrumentId},
             {"offset_ms", offsetMs},
-            {"offset_us", offsetUs}
+            {"offset_us", offsetUs},
+            {"alignment_delay_us", compensator_->getAlignmentDelay(instrumentId)}
         };
     });
     
@@ -1257,7 +1641,39 @@ void CommandHandler::registerLatencyCommands() {
         };
     });
     
-    Logger::debug("CommandHandler", "Ã¢Å“â€œ Latency commands registered (7 commands)");
+    // latency.getDeliveryStats
+    registerCommand("latency.getDeliveryStats", [this](const json& params) {
+        if (!router_) {
+            throw std::runtime_error("Router not available");
+        }
+        
+        return router_->getDeliveryStatistics();
+    });
+    
+    // latency.setLookahead
+    registerCommand("latency.setLookahead", [this](const json& params) {
+        if (!router_) {
+            throw std::runtime_error("Router not available");
+        }
+        
+        if (!params.contains("lookahead_ms")) {
+            throw std::runtime_error("Missing lookahead_ms parameter");
+        }
+        
+        double lookaheadMs = params["lookahead_ms"];
+        if (lookaheadMs < 0 || lookaheadMs > 100) {
+            throw std::runtime_error("lookahead_ms must be between 0 and 100");
+        }
+        
+        router_->setOutputLookahead(
+            std::chrono::microseconds(static_cast<int64_t>(lookaheadMs * 1000.0)));
+        
+        return json{
+            {"lookahead_ms", router_->getOutputLookahead().count() / 1000.0}
+        };
+    });
+    
+    Logger::debug("CommandHandler", "Ã¢Å“â€œ Latency commands registered (9 commands)");
 }
 
 // ============================================================================
@@ -1,9 +1,12 @@
 // ============================================================================
 // File: backend/src/api/CommandHandler.h
-// Version: 4.2.8
+// Version: 4.2.9
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.2.9:
+//   - Playback commands address PlayerEngine players by player_id
+//
 // Changes v4.2.8:
 //   - REMOVED: createSuccessResponse(), createErrorResponse(), validateCommand()
 //     (already removed from .cpp in v4.2.3, now removed from header)
@@ -14,7 +17,7 @@
 
 #include "../midi/devices/MidiDeviceManager.h"
 #include "../midi/MidiRouter.h"
-#include "../midi/player/MidiPlayer.h"
+#include "../midi/player/PlayerEngine.h"
 #include "../storage/FileManager.h"
 #include "../timing/LatencyCompensator.h"
 #include "../storage/InstrumentDatabase.h"
@@ -41,7 +44,7 @@ public:
     CommandHandler(
         std::shared_ptr<MidiDeviceManager> deviceManager,
         std::shared_ptr<MidiRouter> router,
-        std::shared_ptr<MidiPlayer> player,
+        std::shared_ptr<PlayerEngine> playerEngine,
         std::shared_ptr<FileManager> fileManager,
         std::shared_ptr<LatencyCompensator> compensator,
         std::shared_ptr<InstrumentDatabase> instrumentDb,
@@ -82,13 +85,14 @@ private:
     void registerPresetCommands();
     
     std::vector<uint8_t> base64Decode(const std::string& encoded) const;
+    std::shared_ptr<MidiPlayer> resolvePlayer(const json& params) const;
     
     std::unordered_map<std::string, CommandFunction> commands_;
     mutable std::mutex commandsMutex_;
     
     std::shared_ptr<MidiDeviceManager> deviceManager_;
     std::shared_ptr<MidiRouter> router_;
-    std::shared_ptr<MidiPlayer> player_;
+    std::shared_ptr<PlayerEngine> playerEngine_;
     std::shared_ptr<FileManager> fileManager_;
     std::shared_ptr<LatencyCompensator> compensator_;
     std::shared_ptr<InstrumentDatabase> instrumentDb_;
@@ -1,9 +1,33 @@
 // ============================================================================
 // File: backend/src/core/Application.cpp
-// Version: 4.2.5
+// Version: 4.2.11
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.2.11:
+//   - A device's input latency goes to recordDeviceInputLatency(): it no
+//     longer moves the device's output alignment delay
+//
+// Changes v4.2.10:
+//   - Device input is routed with the device's router handle
+//
+// Changes v4.2.9:
+//   - Input latency measured by a device (BLE jitter buffer) is recorded
+//     in the LatencyCompensator
+//
+// Changes v4.2.8:
+//   - Messages a device receives together are routed as one burst
+//
+// Changes v4.2.7:
+//   - Connected devices are registered with the MidiRouter, and input
+//     devices route what they receive straight from their receive thread
+//     (live thru path)
+//   - TimestampManager started (arrival stamps, latency statistics)
+//
+// Changes v4.2.6:
+//   - Single MidiPlayer replaced by a PlayerEngine hosting N players on
+//     one scheduler thread (default player "main")
+//
 // Changes v4.2.5:
 //   - ADDED: Command handler callback configuration in initializeApi()
 //
@@ -27,9 +51,10 @@
 #include "../storage/MidiDatabase.h"
 #include "../storage/PlaylistManager.h"
 #include "../timing/LatencyCompensator.h"
+#include "../timing/TimestampManager.h"
 #include "../midi/devices/MidiDeviceManager.h"
 #include "../midi/MidiRouter.h"
-#include "../midi/player/MidiPlayer.h"
+#include "../midi/player/PlayerEngine.h"
 #include "../api/ApiServer.h"
 #include "../api/CommandHandler.h"
 #include "../api/MessageEnvelope.h"
@@ -105,7 +130,7 @@ Application::~Application() {
     eventBus_.reset();
     commandHandler_.reset();
     apiServer_.reset();
-    player_.reset();
+    playerEngine_.reset();
     router_.reset();
     deviceManager_.reset();
     latencyCompensator_.reset();
@@ -121,6 +146,10 @@ Application::~Application() {
     Logger::info("Application", "Application destroyed successfully");
 }
 
+std::shared_ptr<MidiPlayer> Application::getPlayer() const {
+    return playerEngine_ ? playerEngine_->getDefaultPlayer() : nullptr;
+}
+
 bool Application::isInitialized() const {
     return initialized_.load();
 }
@@ -147,7 +176,7 @@ json Application::getStatus() const {
         {"latency_compensator", latencyCompensator_ != nullptr},
         {"device_manager", deviceManager_ != nullptr},
         {"router", router_ != nullptr},
-        {"player", player_ != nullptr},
+        {"player", playerEngine_ != nullptr},
         {"api_server", apiServer_ != nullptr},
         {"event_bus", eventBus_ != nullptr}
     };
@@ -326,6 +355,8 @@ bool Application::initializeTiming() {
     Logger::info("Application", "");
     
     try {
+        TimestampManager::instance().start();
+        
         Logger::info("Application", "  Creating LatencyCompensator...");
         latencyCompensator_ = std::make_shared<LatencyCompensator>(*instrumentDatabase_);
         Logger::info("Application", "  [OK] LatencyCompensator initialized");
@@ -352,9 +383,62 @@ bool Application::initializeMidi() {
         router_ = std::make_shared<MidiRouter>(latencyCompensator_.get(), eventBus_);
         Logger::info("Application", "  [OK] MidiRouter initialized");
         
-        Logger::info("Application", "  Creating MidiPlayer...");
-        player_ = std::make_shared<MidiPlayer>(router_, eventBus_);
-        Logger::info("Application", "  [OK] MidiPlayer initialized");
+        Logger::info("Application", "  Connecting devices to MidiRouter...");
+        std::weak_ptr<MidiRouter> weakRouter = router_;
+        std::weak_ptr<MidiDeviceManager> weakManager = deviceManager_;
+        std::weak_ptr<LatencyCompensator> weakCompensator = latencyCompensator_;
+        
+        deviceManager_->setHotPlugCallbacks(
+            [weakRouter, weakManager, weakCompensator](const std::string& deviceId) {
+                auto router = weakRouter.lock();
+                auto manager = weakManager.lock();
+                auto device = manager ? manager->getDevice(deviceId) : nullptr;
+                if (!router || !device) {
+                    return;
+                }
+                
+                if (device->getDirection() != DeviceDirection::INPUT) {
+                    router->registerDevice(device);
+                }
+                
+                if (device->getDirection() != DeviceDirection::OUTPUT) {
+                    // Thru path: routed on the device's receive thread, by handle
+                    DeviceHandle source = router->registerSource(deviceId);
+                    device->setMessageCallback([weakRouter, source](const MidiMessage& message) {
+                        if (auto router = weakRouter.lock()) {
+                            router->route(message, source);
+                        }
+                    });
+                    device->setBatchCallback([weakRouter, source](const MidiMessage* messages,
+                                                                  size_t count) {
+                        if (auto router = weakRouter.lock()) {
+                            router->route(messages, count, source);
+                        }
+                    });
+                    
+                    auto compensator = weakCompensator.lock();
+                    if (compensator) {
+                        if (!compensator->isDeviceRegistered(deviceId)) {
+                            compensator->registerDevice(deviceId);
+                        }
+                        device->setLatencyCallback([weakCompensator, deviceId](uint64_t latencyUs) {
+                            if (auto compensator = weakCompensator.lock()) {
+                                compensator->recordDeviceInputLatency(deviceId, latencyUs);
+                            }
+                        });
+                    }
+                }
+            },
+            [weakRouter](const std::string& deviceId) {
+                if (auto router = weakRouter.lock()) {
+                    router->unregisterDevice(deviceId);
+                }
+            });
+        Logger::info("Application", "  [OK] Devices connected to MidiRouter");
+        
+        Logger::info("Application", "  Creating PlayerEngine...");
+        playerEngine_ = std::make_shared<PlayerEngine>(router_, eventBus_);
+        Logger::info("Application", "  [OK] PlayerEngine initialized");
         
         Logger::info("Application", "");
         return true;
@@ -374,7 +458,7 @@ bool Application::initializeApi() {
         commandHandler_ = std::make_shared<CommandHandler>(
             deviceManager_,
             router_,
-            player_,
+            playerEngine_,
             fileManager_,
             latencyCompensator_,
             instrumentDatabase_,
@@ -501,6 +585,12 @@ void Application::stop() {
         }
         Logger::info("Application", "[OK] API server stopped");
         
+        Logger::info("Application", "Stopping players...");
+        if (playerEngine_) {
+            playerEngine_->stopAll();
+        }
+        Logger::info("Application", "[OK] Players stopped");
+        
         running_ = false;
         
         Logger::info("Application", "");
@@ -1,6 +1,6 @@
 // ============================================================================
 // File: backend/src/core/Application.h
-// Version: 4.2.5 - Add PlaylistManager support
+// Version: 4.2.6 - PlayerEngine (multiple players)
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 
@@ -32,6 +32,7 @@ class LatencyCompensator;
 class MidiDeviceManager;
 class MidiRouter;
 class MidiPlayer;
+class PlayerEngine;
 class ApiServer;
 class CommandHandler;
 class EventBus;
@@ -80,7 +81,8 @@ public:
     const std::shared_ptr<LatencyCompensator>& getLatencyCompensator() const { return latencyCompensator_; }
     const std::shared_ptr<MidiDeviceManager>& getDeviceManager() const { return deviceManager_; }
     const std::shared_ptr<MidiRouter>& getRouter() const { return router_; }
-    const std::shared_ptr<MidiPlayer>& getPlayer() const { return player_; }
+    const std::shared_ptr<PlayerEngine>& getPlayerEngine() const { return playerEngine_; }
+    std::shared_ptr<MidiPlayer> getPlayer() const;   // Default ("main") player
     const std::shared_ptr<ApiServer>& getApiServer() const { return apiServer_; }
     const std::shared_ptr<EventBus>& getEventBus() const { return eventBus_; }
     
@@ -139,7 +141,7 @@ private:
     // MIDI components
     std::shared_ptr<MidiDeviceManager> deviceManager_;
     std::shared_ptr<MidiRouter> router_;
-    std::shared_ptr<MidiPlayer> player_;
+    std::shared_ptr<PlayerEngine> playerEngine_;
     
     // API components
     std::shared_ptr<ApiServer> apiServer_;
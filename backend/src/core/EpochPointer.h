@@ -0,0 +1,248 @@
+// ============================================================================
+// File: backend/src/core/EpochPointer.h
+// Version: 4.2.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Read-mostly pointer with epoch-based reclamation. Readers enter a read
+//   section by stamping their own slot with the current epoch (one store,
+//   no shared read-modify-write, no reference count); a writer swaps the
+//   pointer, advances the epoch and frees a replaced object only once no
+//   reader slot shows an epoch from before the swap.
+//
+// Reader slots:
+//   - One per thread, taken on its first read and returned when it exits
+//   - Shared by every EpochPointer (a slot stamps the process-wide epoch)
+//   - Past MAX_SLOTS threads, readers fall back to a shared counter that
+//     holds back all reclamation while non-zero
+//
+// ============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace midiMind {
+
+/**
+ * @class ReaderEpochs
+ * @brief Process-wide reader slots and epoch counter behind EpochPointer
+ *
+ * All operations are sequentially consistent: a reader's slot store is
+ * ordered before its pointer load, and a writer's pointer swap before its
+ * epoch advance and slot scan. A reader that stamped an epoch after the
+ * advance therefore sees the new pointer.
+ */
+class ReaderEpochs {
+public:
+    /// Threads reading at once with their own slot
+    static constexpr size_t MAX_SLOTS = 64;
+
+    /**
+     * @brief Start a read section (nests: only the outermost one stamps)
+     */
+    static void enter() {
+        ThreadSlot& thread = threadSlot();
+        if (thread.depth++ > 0) {
+            return;
+        }
+
+        if (thread.slot) {
+            thread.slot->epoch.store(epoch_.load());
+        } else {
+            overflowReaders_.fetch_add(1);
+        }
+    }
+
+    /**
+     * @brief End a read section
+     */
+    static void leave() {
+        ThreadSlot& thread = threadSlot();
+        if (--thread.depth > 0) {
+            return;
+        }
+
+        if (thread.slot) {
+            thread.slot->epoch.store(0);
+        } else {
+            overflowReaders_.fetch_sub(1);
+        }
+    }
+
+    /**
+     * @brief Advance the epoch (writer, after swapping the pointer)
+     * @return Epoch of the objects replaced by that swap
+     */
+    static uint64_t advance() {
+        return epoch_.fetch_add(1);
+    }
+
+    /**
+     * @brief True if no reader can still hold an object retired at `retired`
+     */
+    static bool quiescent(uint64_t retired) {
+        if (overflowReaders_.load() != 0) {
+            return false;
+        }
+
+        for (const Slot& slot : slots_) {
+            uint64_t epoch = slot.epoch.load();
+            if (epoch != 0 && epoch <= retired) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct alignas(64) Slot {
+        /// Epoch stamped by the reading thread (0 = not reading)
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> taken{false};
+    };
+
+    struct ThreadSlot {
+        Slot* slot = nullptr;
+        unsigned depth = 0;
+
+        ThreadSlot() {
+            for (Slot& candidate : slots_) {
+                bool expected = false;
+                if (candidate.taken.compare_exchange_strong(expected, true)) {
+                    slot = &candidate;
+                    break;
+                }
+            }
+        }
+
+        ~ThreadSlot() {
+            if (slot) {
+                slot->epoch.store(0);
+                slot->taken.store(false);
+            }
+        }
+    };
+
+    static ThreadSlot& threadSlot() {
+        thread_local ThreadSlot thread;
+        return thread;
+    }
+
+    static Slot slots_[MAX_SLOTS];
+    static std::atomic<uint64_t> epoch_;
+    static std::atomic<uint64_t> overflowReaders_;
+};
+
+inline ReaderEpochs::Slot ReaderEpochs::slots_[ReaderEpochs::MAX_SLOTS];
+inline std::atomic<uint64_t> ReaderEpochs::epoch_{1};
+inline std::atomic<uint64_t> ReaderEpochs::overflowReaders_{0};
+
+/**
+ * @class EpochPointer
+ * @brief Pointer to an immutable object, replaced by a writer and read
+ *        without locks or reference counting
+ * @tparam T Object type (read as const T)
+ *
+ * Thread Safety: Reader from any thread; publish() and reclaim() from one
+ * thread at a time (the caller serializes writers). Destroy only once no
+ * reader remains.
+ *
+ * Example:
+ * ```cpp
+ * EpochPointer<RoutingTable> table;
+ * table.publish(RoutingTable::compile(...));   // Writer, under its lock
+ *
+ * EpochPointer<RoutingTable>::Reader current(table);
+ * current->lookup(source, status);              // Valid until `current` ends
+ * ```
+ */
+template <typename T>
+class EpochPointer {
+public:
+    /**
+     * @class Reader
+     * @brief Read section: the object read stays alive while it exists
+     */
+    class Reader {
+    public:
+        explicit Reader(const EpochPointer& pointer) {
+            ReaderEpochs::enter();
+            object_ = pointer.current_.load();
+        }
+
+        ~Reader() {
+            ReaderEpochs::leave();
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const T* get() const { return object_; }
+        const T& operator*() const { return *object_; }
+        const T* operator->() const { return object_; }
+
+    private:
+        const T* object_;
+    };
+
+    EpochPointer() : current_(nullptr) {}
+
+    ~EpochPointer() {
+        delete current_.load();
+        for (const Retired& retired : retired_) {
+            delete retired.object;
+        }
+    }
+
+    EpochPointer(const EpochPointer&) = delete;
+    EpochPointer& operator=(const EpochPointer&) = delete;
+
+    /**
+     * @brief Replace the object; the previous one is freed once no reader
+     *        can hold it (here or at a later publish()/reclaim())
+     * @return size_t Replaced objects still waiting for readers
+     */
+    size_t publish(std::unique_ptr<const T> object) {
+        const T* previous = current_.exchange(object.release());
+        uint64_t epoch = ReaderEpochs::advance();
+
+        if (previous) {
+            retired_.push_back(Retired{previous, epoch});
+        }
+        return reclaim();
+    }
+
+    /**
+     * @brief Free the replaced objects no reader can hold any more
+     * @return size_t Replaced objects still waiting for readers
+     */
+    size_t reclaim() {
+        size_t kept = 0;
+        for (const Retired& retired : retired_) {
+            if (ReaderEpochs::quiescent(retired.epoch)) {
+                delete retired.object;
+            } else {
+                retired_[kept++] = retired;
+            }
+        }
+        retired_.resize(kept);
+        return kept;
+    }
+
+private:
+    struct Retired {
+        const T* object;
+        uint64_t epoch;
+    };
+
+    std::atomic<const T*> current_;
+    std::vector<Retired> retired_;      ///< Writer side only
+};
+
+} // namespace midiMind
@@ -1,6 +1,6 @@
 // ============================================================================
 // File: backend/src/events/Events.h
-// Version: 4.2.1
+// Version: 4.2.2
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
@@ -157,15 +157,18 @@ struct PlaybackStateChangedEvent {
     std::string filepath;
     double position;
     uint64_t timestamp;
+    std::string playerId;
     
     PlaybackStateChangedEvent(State s, 
                              const std::string& f,
                              double p,
-                             uint64_t ts)
+                             uint64_t ts,
+                             const std::string& id = "main")
         : state(s)
         , filepath(f)
         , position(p)
         , timestamp(ts)
+        , playerId(id)
     {}
 };
 
@@ -178,12 +181,15 @@ struct PlaybackProgressEvent {
     double duration;      // Total duration in milliseconds
     double percentage;    // Progress percentage (0-100)
     uint64_t timestamp;
+    std::string playerId;  // Player that published the event
     
-    PlaybackProgressEvent(double pos, double dur, double pct, uint64_t ts)
+    PlaybackProgressEvent(double pos, double dur, double pct, uint64_t ts,
+                          const std::string& id = "main")
         : position(pos)
         , duration(dur)
         , percentage(pct)
         , timestamp(ts)
+        , playerId(id)
     {}
 };
 
@@ -532,7 +532,7 @@ JsonMidi JsonMidiConverter::fromMidiFile(const std::string& filepath) {
         jsonMidi.tracks.push_back(jsonTrack);
     }
     
-    jsonMidi.timeline = convertMidiEventsToTimeline(midiFile, midiFile.header.division);
+    jsonMidi.timeline = convertMidiEventsToTimeline(midiFile);
     
     std::sort(jsonMidi.timeline.begin(), jsonMidi.timeline.end(),
         [](const JsonMidiEvent& a, const JsonMidiEvent& b) {
@@ -650,6 +650,15 @@ uint32_t JsonMidiConverter::msToTicks(uint32_t ms, uint16_t ticksPerBeat, uint32
     return static_cast<uint32_t>(ms / millisecondsPerTick);
 }
 
+uint32_t JsonMidiConverter::ticksToMs(uint64_t ticks, const TempoMap& tempoMap) {
+    uint64_t ms = tempoMap.ticksToMs(ticks);
+    return ms > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(ms);
+}
+
+uint64_t JsonMidiConverter::msToTicks(uint32_t ms, const TempoMap& tempoMap) {
+    return tempoMap.msToTicks(ms);
+}
+
 JsonMidiMetadata JsonMidiConverter::extractMetadata(const std::vector<MidiMessage>& messages) {
     JsonMidiMetadata metadata;
     metadata.tempo = defaultTempo_;
@@ -704,29 +713,15 @@ JsonMidiTrack JsonMidiConverter::convertMidiTrackToJsonTrack(
 }
 
 std::vector<JsonMidiEvent> JsonMidiConverter::convertMidiEventsToTimeline(
-    const MidiFile& midiFile, 
-    uint16_t ticksPerBeat) {
+    const MidiFile& midiFile) {
     
     std::vector<JsonMidiEvent> timeline;
-    uint32_t currentTempo = 500000;
     
     for (size_t trackIdx = 0; trackIdx < midiFile.tracks.size(); ++trackIdx) {
         const auto& track = midiFile.tracks[trackIdx];
         
         for (const auto& event : track.events) {
-            if (event.type == MidiEventType::META && event.metaType == 0x51) {
-                if (event.data.size() >= 3) {
-                    currentTempo = (event.data[0] << 16) | 
-                                  (event.data[1] << 8) | 
-                                   event.data[2];
-                }
-            }
-            
-            uint32_t timeMs = ticksToMilliseconds(
-                event.absoluteTime, 
-                ticksPerBeat, 
-                currentTempo
-            );
+            uint32_t timeMs = ticksToMs(event.absoluteTime, midiFile.tempoMap);
             
             JsonMidiEvent jsonEvent = convertMidiEventToJsonEvent(
                 event, 
@@ -826,15 +821,6 @@ JsonMidiEvent JsonMidiConverter::convertMidiEventToJsonEvent(
     return jsonEvent;
 }
 
-uint32_t JsonMidiConverter::ticksToMilliseconds(
-    uint32_t ticks, 
-    uint16_t ticksPerBeat, 
-    uint32_t tempo) const {
-    
-    uint64_t microseconds = (static_cast<uint64_t>(ticks) * tempo) / ticksPerBeat;
-    return static_cast<uint32_t>(microseconds / 1000);
-}
-
 uint32_t JsonMidiConverter::extractTempoFromMidiFile(const MidiFile& midiFile) const {
     for (const auto& track : midiFile.tracks) {
         for (const auto& event : track.events) {
@@ -1,6 +1,6 @@
 // ============================================================================
 // File: backend/src/midi/JsonMidiConverter.h
-// Version: 4.2.1
+// Version: 4.2.2
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
@@ -19,6 +19,10 @@
 // Author: MidiMind Team
 // Date: 2025-10-31
 //
+// Changes v4.2.2:
+//   - Timeline times computed from MidiFile::tempoMap (all tempo changes)
+//   - Added ticksToMs()/msToTicks() overloads taking a TempoMap
+//
 // Changes v4.2.1:
 //   - Added fromMidiFile() implementation support
 //   - Added helper methods for MIDI file conversion
@@ -346,6 +350,22 @@ public:
      */
     static uint32_t msToTicks(uint32_t ms, uint16_t ticksPerBeat, uint32_t tempo);
     
+    /**
+     * @brief Convert ticks to milliseconds across tempo changes
+     * @param ticks Absolute tick
+     * @param tempoMap Tempo map of the file
+     * @return uint32_t Milliseconds
+     */
+    static uint32_t ticksToMs(uint64_t ticks, const TempoMap& tempoMap);
+    
+    /**
+     * @brief Convert milliseconds to ticks across tempo changes
+     * @param ms Milliseconds
+     * @param tempoMap Tempo map of the file
+     * @return uint64_t Absolute tick
+     */
+    static uint64_t msToTicks(uint32_t ms, const TempoMap& tempoMap);
+    
 private:
     // ========================================================================
     // PRIVATE METHODS
@@ -400,13 +420,10 @@ private:
     /**
      * @brief Convert all MIDI events to unified timeline
      * @param midiFile Source MIDI file
-     * @param ticksPerBeat Ticks per quarter note
      * @return Vector of JsonMidiEvents in chronological order
+     * @note Event times follow midiFile.tempoMap
      */
-    std::vector<JsonMidiEvent> convertMidiEventsToTimeline(
-        const MidiFile& midiFile, 
-        uint16_t ticksPerBeat
-    );
+    std::vector<JsonMidiEvent> convertMidiEventsToTimeline(const MidiFile& midiFile);
     
     /**
      * @brief Convert single MidiEvent to JsonMidiEvent
@@ -421,15 +438,6 @@ private:
         uint8_t trackChannel
     );
     
-    /**
-     * @brief Convert ticks to milliseconds using tempo
-     * @param ticks Tick value
-     * @param ticksPerBeat Ticks per quarter note
-     * @param tempo Tempo in microseconds per quarter note
-     * @return Milliseconds
-     */
-    uint32_t ticksToMilliseconds(uint32_t ticks, uint16_t ticksPerBeat, uint32_t tempo) const;
-    
     /**
      * @brief Extract tempo (BPM) from MIDI file Meta events
      * @param midiFile MIDI file to extract tempo from
@@ -0,0 +1,136 @@
+// ============================================================================
+// File: backend/src/midi/MessageCoalescer.cpp
+// Version: 4.2.7
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "MessageCoalescer.h"
+#include <algorithm>
+
+namespace midiMind {
+
+// Key offsets after the 128 controllers of a channel
+static constexpr int PITCH_BEND_KEY = 128;
+static constexpr int CHANNEL_PRESSURE_KEY = 129;
+static constexpr int KEYS_PER_CHANNEL = 130;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+MessageCoalescer::MessageCoalescer(std::chrono::microseconds window)
+    : window_(window)
+{
+}
+
+// ============================================================================
+// KEYS
+// ============================================================================
+
+int MessageCoalescer::keyOf(const MidiMessage& message) {
+    if (message.getSize() < 2) {
+        return -1;
+    }
+
+    uint8_t status = message.getStatus();
+    int channel = status & 0x0F;
+
+    switch (status & 0xF0) {
+        case 0xB0: {
+            uint8_t controller = message.getData1();
+
+            // Paired or sequenced controllers: every value matters
+            if (controller == 0 || controller == 32 ||          // Bank select
+                controller == 6 || controller == 38 ||          // Data entry
+                (controller >= 96 && controller <= 101) ||      // Increment, (N)RPN
+                controller >= 120) {                            // Channel mode
+                return -1;
+            }
+            return channel * KEYS_PER_CHANNEL + controller;
+        }
+
+        case 0xE0:
+            return channel * KEYS_PER_CHANNEL + PITCH_BEND_KEY;
+
+        case 0xD0:
+            return channel * KEYS_PER_CHANNEL + CHANNEL_PRESSURE_KEY;
+
+        default:
+            return -1;
+    }
+}
+
+// ============================================================================
+// PRIVATE METHODS
+// ============================================================================
+
+void MessageCoalescer::process(const MidiMessage& message, Clock::time_point now,
+                               Outcome& outcome) {
+    int key = keyOf(message);
+
+    if (key < 0) {
+        // Real-time messages may interleave with anything
+        if (!message.isRealTimeMessage()) {
+            takeHeld(now, true);
+        }
+        ready_.push_back(message);
+        return;
+    }
+
+    Slot& slot = slotFor(key);
+
+    if (slot.pending) {
+        slot.held = message;
+        outcome.coalesced++;
+    } else if (now - slot.lastSent >= window_) {
+        slot.lastSent = now;
+        ready_.push_back(message);
+    } else {
+        slot.held = message;
+        slot.pending = true;
+        heldKeys_.push_back(key);
+    }
+}
+
+void MessageCoalescer::takeHeld(Clock::time_point now, bool all) {
+    size_t kept = 0;
+
+    for (int key : heldKeys_) {
+        Slot& slot = slots_[slotIndex_[key] - 1];
+
+        if (all || now - slot.lastSent >= window_) {
+            slot.lastSent = now;
+            slot.pending = false;
+            ready_.push_back(std::move(slot.held));
+        } else {
+            heldKeys_[kept++] = key;
+        }
+    }
+
+    heldKeys_.resize(kept);
+}
+
+void MessageCoalescer::armTimer(Outcome& outcome) {
+    if (heldKeys_.empty() || timerArmed_) {
+        return;
+    }
+
+    auto earliest = Clock::time_point::max();
+    for (int key : heldKeys_) {
+        earliest = std::min(earliest, slots_[slotIndex_[key] - 1].lastSent);
+    }
+
+    timerArmed_ = true;
+    outcome.armTimer = true;
+    outcome.flushAt = earliest + window_;
+}
+
+MessageCoalescer::Slot& MessageCoalescer::slotFor(int key) {
+    if (slotIndex_[key] == 0) {
+        slots_.emplace_back();
+        slotIndex_[key] = static_cast<uint16_t>(slots_.size());
+    }
+    return slots_[slotIndex_[key] - 1];
+}
+
+} // namespace midiMind
@@ -0,0 +1,174 @@
+// ============================================================================
+// File: backend/src/midi/MessageCoalescer.h
+// Version: 4.2.7
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Thinning of continuous controller floods for one route.
+//   Expression pedals, mod wheels and pitch wheels can send thousands of
+//   values per second; a slow destination (BLE, DIN) only needs the latest
+//   one. Within the window, each (channel, controller) sends its first
+//   value at once and holds back the rest, keeping only the latest, which
+//   goes out when the window ends.
+//
+// Features:
+//   - Coalesced: control change, pitch bend, channel pressure
+//   - Never coalesced: notes and every other message; bank select, data
+//     entry, (N)RPN and channel mode controllers (their order carries
+//     meaning)
+//   - Held values are sent ahead of any non-coalesced message, so nothing
+//     is reordered relative to notes
+//   - Real-time messages (clock, start/stop) pass without flushing
+//
+// ============================================================================
+
+#pragma once
+
+#include "MidiMessage.h"
+#include <array>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+namespace midiMind {
+
+/**
+ * @class MessageCoalescer
+ * @brief Keeps the latest controller value per channel within a time window
+ *
+ * The caller delivers what submit()/flushDue() hand it (under the
+ * coalescer's lock, so deliveries keep their order), and calls flushDue()
+ * once the time returned in Outcome::flushAt is reached.
+ *
+ * Thread Safety: All public methods are thread-safe.
+ *
+ * Example:
+ * ```cpp
+ * MessageCoalescer coalescer(std::chrono::milliseconds(10));
+ * auto outcome = coalescer.submit(&bend, 1, now, [&](const MidiMessage* m, size_t n) {
+ *     scheduler.send(output, m, n, now);
+ * });
+ * if (outcome.armTimer) { ... call flushDue() at outcome.flushAt ... }
+ * ```
+ */
+class MessageCoalescer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// 128 controllers + pitch bend + channel pressure, per channel
+    static constexpr size_t KEY_COUNT = 16 * 130;
+
+    /**
+     * @struct Outcome
+     * @brief What a submit()/flushDue() call did
+     */
+    struct Outcome {
+        uint64_t coalesced = 0;         ///< Held values replaced by a newer one
+        bool armTimer = false;          ///< Values are held: call flushDue() at flushAt
+        Clock::time_point flushAt;
+    };
+
+    /**
+     * @brief Constructor
+     * @param window Minimum interval between two values of one controller
+     */
+    explicit MessageCoalescer(std::chrono::microseconds window);
+
+    std::chrono::microseconds getWindow() const { return window_; }
+
+    /**
+     * @brief Coalescing key of a message
+     * @return int Key (< KEY_COUNT) or -1 if the message is never coalesced
+     */
+    static int keyOf(const MidiMessage& message);
+
+    /**
+     * @brief Pass messages through the coalescer
+     * @param messages Messages in order
+     * @param count Number of messages
+     * @param now Current time
+     * @param deliver Called once with the messages to deliver now (in
+     *        order), if any: void(const MidiMessage*, size_t)
+     */
+    template<typename Deliver>
+    Outcome submit(const MidiMessage* messages, size_t count,
+                   Clock::time_point now, Deliver&& deliver) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Outcome outcome;
+
+        ready_.clear();
+        for (size_t i = 0; i < count; ++i) {
+            process(messages[i], now, outcome);
+        }
+
+        armTimer(outcome);
+
+        if (!ready_.empty()) {
+            deliver(ready_.data(), ready_.size());
+        }
+        return outcome;
+    }
+
+    /**
+     * @brief Release held values whose window has ended
+     * @param now Current time
+     * @param deliver As for submit()
+     */
+    template<typename Deliver>
+    Outcome flushDue(Clock::time_point now, Deliver&& deliver) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Outcome outcome;
+
+        timerArmed_ = false;
+        ready_.clear();
+        takeHeld(now, false);
+
+        armTimer(outcome);
+
+        if (!ready_.empty()) {
+            deliver(ready_.data(), ready_.size());
+        }
+        return outcome;
+    }
+
+private:
+    struct Slot {
+        Clock::time_point lastSent;     ///< Last value of this key that went out
+        MidiMessage held;               ///< Latest value waiting for the window to end
+        bool pending = false;
+    };
+
+    /// Route one message into ready_ or a held slot (mutex_ held)
+    void process(const MidiMessage& message, Clock::time_point now, Outcome& outcome);
+
+    /**
+     * @brief Move held values to ready_, in the order they were held back
+     * @param all true: every held value, false: only those whose window ended
+     */
+    void takeHeld(Clock::time_point now, bool all);
+
+    /// Ask for a flushDue() call if values are held and none is pending
+    void armTimer(Outcome& outcome);
+
+    Slot& slotFor(int key);
+
+    const std::chrono::microseconds window_;
+
+    std::mutex mutex_;
+
+    /// Slot index + 1 per key (0 = no slot yet): slots only for keys in use
+    std::array<uint16_t, KEY_COUNT> slotIndex_{};
+    std::vector<Slot> slots_;
+
+    /// Keys with a held value, in the order they were held back
+    std::vector<int> heldKeys_;
+
+    /// Output of the current call (reused)
+    std::vector<MidiMessage> ready_;
+
+    bool timerArmed_ = false;
+};
+
+} // namespace midiMind
@@ -1,6 +1,6 @@
 // ============================================================================
 // File: backend/src/midi/MidiMessage.h
-// Version: 4.1.0
+// Version: 4.1.1
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
@@ -18,6 +18,9 @@
 // Author: MidiMind Team
 // Date: 2025-10-16
 //
+// Changes v4.1.1:
+//   - setRawData() to refill a message without reallocating
+//
 // Changes v4.1.0:
 //   - Enhanced type safety
 //   - Better validation
@@ -373,6 +376,13 @@ public:
      */
     const std::vector<uint8_t>& getRawData() const { return data_; }
     
+    /**
+     * @brief Replace raw data (reuses the existing buffer capacity)
+     * @param data Raw MIDI bytes
+     * @param size Number of bytes
+     */
+    void setRawData(const uint8_t* data, size_t size) { data_.assign(data, data + size); }
+    
     /**
      * @brief Get data size
      * @return size_t Number of bytes
@@ -1,9 +1,77 @@
 // ============================================================================
 // File: backend/src/midi/MidiRouter.cpp
-// Version: 4.2.0 - EventBus Integration
+// Version: 4.2.14
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.2.14:
+//   - The table is an EpochPointer: route() stamps its thread's reader
+//     slot instead of std::atomic_load of a shared_ptr (a lock from
+//     libstdc++'s mutex pool and two refcount updates per call); replaced
+//     tables are freed once no reader slot predates the swap
+//
+// Changes v4.2.13:
+//   - Alignment delays come from LatencyCompensator::getAlignmentDelays()
+//     in one call, device compensation (BLE input latency) included
+//
+// Changes v4.2.12:
+//   - route() takes the compiled alignment delay of the route instead of
+//     calling LatencyCompensator::getAlignmentDelay() (mutex + scan of
+//     every instrument) per message; the compensator's change callback
+//     recompiles the table when a delay moves
+//   - Source routing keyed by DeviceHandle (no string hash per message);
+//     handles are no longer recycled
+//
+// Changes v4.2.11:
+//   - FIXED: replaced routing tables were freed 10 s after the swap,
+//     whether or not a route() call still used them; the table is now a
+//     shared_ptr (std::atomic_load/atomic_store) and the last reader
+//     frees it
+//   - FIXED: a route to an unregistered device logged a warning per
+//     message; it is counted (messagesUndeliverable) and warned once
+//
+// Changes v4.2.10:
+//   - Burst routing takes a source device (routeBurst()); end-to-end
+//     statistics for device bursts use the earliest arrival
+//
+// Changes v4.2.9:
+//   - route(messages, count, due): the burst's delivery time is given by
+//     the caller instead of being the time of the call
+//
+// Changes v4.2.8:
+//   - Messages from a device record their end-to-end latency (arrival
+//     stamp -> hand-over) per route
+//
+// Changes v4.2.7:
+//   - Routes with a coalescing window deliver through their
+//     MessageCoalescer; held values are flushed by a scheduler task
+//
+// Changes v4.2.6:
+//   - Route latency/compensation histograms recorded into the compiled
+//     statistics slot; one TimestampManager::now() per route() call
+//
+// Changes v4.2.5:
+//   - route(messages, count): burst grouped per destination, one scheduler
+//     send (and one device flush) per destination
+//
+// Changes v4.2.4:
+//   - Delivery goes straight to the route's OutputEndpoint; sendToDevice()
+//     (device map lookup + callback copy under a mutex) is gone
+//
+// Changes v4.2.3:
+//   - route() hands messages to the OutputScheduler with their alignment
+//     delay instead of only stamping a timestamp nobody read
+//   - Statistics record the delay actually applied
+//
+// Changes v4.2.2:
+//   - Route changes compile a RoutingTable published by atomic pointer
+//     swap; route() does no locking, copying or filter vector scans
+//   - Statistics slots resolved at compile time (no map lookup per message)
+//   - FIXED: removeRoute(source, destination) used the erased iterator
+//
+// Changes v4.2.1:
+//   - ADDED: resolveRoutes() (same matching/transforms as route(), no delivery)
+//
 // Changes v4.2.0:
 //   🔧 ADDED: EventBus support for routing events
 //   ✅ Publishes RouteAddedEvent and RouteRemovedEvent
@@ -28,19 +96,38 @@ namespace midiMind {
 
 MidiRouter::MidiRouter(LatencyCompensator* compensator,
                        std::shared_ptr<EventBus> eventBus)
-    : compensator_(compensator)
+    : nextHandle_(0)
+    , compensator_(compensator)
     , instrumentCompensationEnabled_(true)
     , eventBus_(eventBus)
+    , scheduler_(std::make_unique<OutputScheduler>())
 {
-    Logger::info("MidiRouter", "MidiRouter v4.2.0 created");
+    Logger::info("MidiRouter", "MidiRouter v4.2.14 created");
     
     // Initialize global stats
     globalStats_.totalMessages = 0;
     globalStats_.routedMessages = 0;
     globalStats_.droppedMessages = 0;
+    
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        publishRoutingTable();
+    }
+    
+    if (compensator) {
+        compensator->setChangeCallback([this]() { refreshCompensation(); });
+    }
 }
 
 MidiRouter::~MidiRouter() {
+    // Waits for a recompile in progress
+    if (LatencyCompensator* comp = compensator_.load()) {
+        comp->setChangeCallback(nullptr);
+    }
+    
+    // Deliver what is still waiting before anything else goes away
+    scheduler_.reset();
+    
     Logger::info("MidiRouter", "MidiRouter destroyed");
 }
 
@@ -49,77 +136,321 @@ MidiRouter::~MidiRouter() {
 // ============================================================================
 
 void MidiRouter::route(const MidiMessage& message) {
+    route(message, INVALID_DEVICE_HANDLE);
+}
+
+void MidiRouter::route(const MidiMessage& message, DeviceHandle source) {
     // Update global stats (atomic, no lock needed)
     globalStats_.totalMessages++;
     
-    // Copy routes for processing (avoid holding lock during routing)
-    std::vector<std::shared_ptr<MidiRoute>> routesCopy;
-    {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        routesCopy = routes_;
-    }
-    
-    // Find matching routes
-    std::vector<std::shared_ptr<MidiRoute>> matchingRoutes;
-    
-    for (const auto& route : routesCopy) {
-        if (route->enabled && matchesRoute(message, *route)) {
-            matchingRoutes.push_back(route);
-        }
+    if (message.getSize() == 0) {
+        globalStats_.droppedMessages++;
+        return;
     }
     
-    // Sort by priority (highest first)
-    std::sort(matchingRoutes.begin(), matchingRoutes.end(),
-             [](const auto& a, const auto& b) {
-                 return a->priority > b->priority;
-             });
+    // Matching routes, already filtered and in priority order
+    RoutingTableReader table(table_);
+    auto matchingRoutes = table->lookup(source, message.getStatus());
     
-    // Route to all matching destinations
     if (matchingRoutes.empty()) {
         globalStats_.droppedMessages++;
         Logger::debug("MidiRouter", "No matching routes for message");
         return;
     }
     
-    for (const auto& route : matchingRoutes) {
-        // Apply transformations
-        MidiMessage transformedMessage = applyTransformations(message, *route);
-        
-        // Get compensation
-        int64_t compensation = getCompensationForRoute(*route);
+    auto now = OutputScheduler::Clock::now();
+    uint64_t timestamp = TimestampManager::instance().now();
+    
+    // Time since the input device received it (thru path)
+    uint64_t arrival = message.getTimestamp();
+    bool fromDevice = source != INVALID_DEVICE_HANDLE && arrival != 0 && arrival <= timestamp;
+    
+    for (const CompiledRoute* compiled : matchingRoutes) {
+        const MidiRoute& route = *compiled->route;
+        int64_t delay = 0;
+        auto handedOver = now;
         
-        // Apply compensation if needed
-        if (compensation != 0) {
-            uint64_t currentTime = TimestampManager::instance().now();
-            uint64_t scheduledTime = currentTime + static_cast<uint64_t>(std::abs(compensation));
-            transformedMessage.setTimestamp(scheduledTime);
+        if (!compiled->output) {
+            recordUndeliverable(*compiled);
+        } else {
+            // Delay that lines this destination up with the slowest instrument
+            delay = compiled->delay;
+            
+            // Delivered as is unless there is something to change
+            const MidiMessage* outgoing = &message;
+            MidiMessage transformedMessage;
             
-            Logger::debug("MidiRouter", 
-                         "Applied compensation: " + std::to_string(compensation) + "µs");
+            if (compiled->hasTransform || delay != 0) {
+                // Apply transformations
+                transformedMessage = compiled->hasTransform ?
+                    applyTransformations(message, route) : message;
+                
+                if (delay != 0) {
+                    transformedMessage.setTimestamp(timestamp + static_cast<uint64_t>(delay));
+                }
+                outgoing = &transformedMessage;
+            }
+            
+            if (compiled->coalescer) {
+                sendCoalesced(*compiled, outgoing, 1, now, delay);
+                handedOver = OutputScheduler::Clock::now();
+            } else {
+                handedOver = scheduler_->send(compiled->output, *outgoing,
+                                              now + std::chrono::microseconds(delay));
+            }
         }
         
-        // Send to destination
-        sendToDevice(route->destinationDeviceId, transformedMessage);
-        
         // Update statistics
-        updateRouteStatistics(route->id, compensation);
+        if (compiled->stats) {
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                handedOver - now).count() + delay;
+            updateRouteStatistics(*compiled->stats, timestamp, latency, delay);
+            
+            if (fromDevice) {
+                compiled->stats->endToEnd.record(timestamp - arrival + latency);
+            }
+        }
         
         globalStats_.routedMessages++;
     }
 }
 
+void MidiRouter::route(const MidiMessage* messages, size_t count) {
+    if (count == 1) {
+        route(messages[0]);
+        return;
+    }
+    
+    route(messages, count, OutputScheduler::Clock::time_point());
+}
+
+void MidiRouter::route(const MidiMessage* messages, size_t count,
+                       OutputScheduler::Clock::time_point due) {
+    routeBurst(messages, count, due, INVALID_DEVICE_HANDLE);
+}
+
+void MidiRouter::route(const MidiMessage* messages, size_t count, DeviceHandle source) {
+    if (count == 1) {
+        route(messages[0], source);
+        return;
+    }
+    
+    routeBurst(messages, count, OutputScheduler::Clock::time_point(), source);
+}
+
+void MidiRouter::routeBurst(const MidiMessage* messages, size_t count,
+                            OutputScheduler::Clock::time_point due,
+                            DeviceHandle source) {
+    if (count == 0) {
+        return;
+    }
+    
+    // Share of the burst for one destination (and coalescer, if the
+    // route has one)
+    struct OutputBurst {
+        const std::shared_ptr<const OutputEndpoint>* output;
+        const CompiledRoute* coalescing;        // Route whose coalescer filters it
+        int64_t delay;
+        std::vector<MidiMessage> messages;      // Slots reused across bursts
+        size_t size;
+    };
+    
+    // Routes used by the burst, for one statistics update each
+    struct RouteBurst {
+        const CompiledRoute* compiled;
+        int64_t delay;
+        uint64_t count;
+    };
+    
+    // Scratch kept per calling thread (player scheduler, device threads);
+    // taken out while in use so a nested route() from a delivery callback
+    // gets its own
+    thread_local std::vector<OutputBurst> spareOutputs;
+    thread_local std::vector<RouteBurst> spareRoutes;
+    std::vector<OutputBurst> outputs;
+    std::vector<RouteBurst> routesUsed;
+    outputs.swap(spareOutputs);
+    routesUsed.swap(spareRoutes);
+    routesUsed.clear();
+    size_t outputCount = 0;
+    
+    RoutingTableReader table(table_);
+    auto start = OutputScheduler::Clock::now();
+    uint64_t timestamp = TimestampManager::instance().now();
+    uint64_t dropped = 0;
+    uint64_t routed = 0;
+    
+    // Earliest arrival at the input device (thru path)
+    uint64_t arrival = 0;
+    
+    for (size_t i = 0; i < count; ++i) {
+        const MidiMessage& message = messages[i];
+        
+        if (message.getSize() == 0) {
+            dropped++;
+            continue;
+        }
+        
+        if (source != INVALID_DEVICE_HANDLE) {
+            uint64_t arrived = message.getTimestamp();
+            if (arrived != 0 && arrived <= timestamp && (arrival == 0 || arrived < arrival)) {
+                arrival = arrived;
+            }
+        }
+        
+        auto matchingRoutes = table->lookup(source, message.getStatus());
+        if (matchingRoutes.empty()) {
+            dropped++;
+            continue;
+        }
+        
+        for (const CompiledRoute* compiled : matchingRoutes) {
+            const MidiRoute& route = *compiled->route;
+            routed++;
+            
+            int64_t delay = 0;
+            
+            if (!compiled->output) {
+                recordUndeliverable(*compiled);
+            } else {
+                OutputBurst* burst = nullptr;
+                const CompiledRoute* coalescing = compiled->coalescer ? compiled : nullptr;
+                
+                for (size_t j = 0; j < outputCount; ++j) {
+                    if (outputs[j].output->get() == compiled->output.get() &&
+                        outputs[j].coalescing == coalescing) {
+                        burst = &outputs[j];
+                        break;
+                    }
+                }
+                
+                if (!burst) {
+                    if (outputCount == outputs.size()) {
+                        outputs.emplace_back();
+                    }
+                    burst = &outputs[outputCount++];
+                    burst->output = &compiled->output;
+                    burst->coalescing = coalescing;
+                    burst->delay = compiled->delay;
+                    burst->size = 0;
+                }
+                
+                delay = burst->delay;
+                
+                if (burst->size == burst->messages.size()) {
+                    burst->messages.emplace_back();
+                }
+                MidiMessage& slot = burst->messages[burst->size++];
+                slot = compiled->hasTransform ? applyTransformations(message, route) : message;
+                
+                if (delay != 0) {
+                    slot.setTimestamp(timestamp + static_cast<uint64_t>(delay));
+                }
+            }
+            
+            auto used = std::find_if(routesUsed.begin(), routesUsed.end(),
+                                     [compiled](const RouteBurst& r) {
+                                         return r.compiled == compiled;
+                                     });
+            if (used != routesUsed.end()) {
+                used->count++;
+            } else {
+                routesUsed.push_back(RouteBurst{compiled, delay, 1});
+            }
+        }
+    }
+    
+    // Time the burst is meant for (later than now if the caller works ahead)
+    auto now = std::max(OutputScheduler::Clock::now(), due);
+    
+    for (size_t j = 0; j < outputCount; ++j) {
+        const OutputBurst& burst = outputs[j];
+        if (burst.coalescing) {
+            sendCoalesced(*burst.coalescing, burst.messages.data(), burst.size,
+                          now, burst.delay);
+        } else {
+            scheduler_->send(*burst.output, burst.messages.data(), burst.size,
+                             now + std::chrono::microseconds(burst.delay));
+        }
+    }
+    
+    auto handedOver = std::chrono::duration_cast<std::chrono::microseconds>(
+        OutputScheduler::Clock::now() - start).count();
+    
+    for (const auto& used : routesUsed) {
+        if (used.compiled->stats) {
+            updateRouteStatistics(*used.compiled->stats, timestamp,
+                                  handedOver + used.delay, used.delay, used.count);
+            
+            if (arrival != 0) {
+                used.compiled->stats->endToEnd.record(
+                    timestamp - arrival + handedOver + used.delay);
+            }
+        }
+    }
+    
+    globalStats_.totalMessages += count;
+    globalStats_.routedMessages += routed;
+    globalStats_.droppedMessages += dropped;
+    
+    spareOutputs.swap(outputs);
+    spareRoutes.swap(routesUsed);
+}
+
 void MidiRouter::routeTo(const MidiMessage& message, const std::string& deviceId) {
     Logger::debug("MidiRouter", "Direct routing to device: " + deviceId);
     
-    sendToDevice(deviceId, message);
+    std::shared_ptr<const OutputEndpoint> output;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = outputs_.find(deviceId);
+        if (it != outputs_.end()) {
+            output = it->second;
+        }
+    }
+    
+    if (output) {
+        scheduler_->send(output, message, OutputScheduler::Clock::now());
+    } else {
+        Logger::warning("MidiRouter", "Device not found: " + deviceId);
+    }
     
     globalStats_.totalMessages++;
     globalStats_.routedMessages++;
 }
 
+std::vector<std::pair<std::string, MidiMessage>> MidiRouter::resolveRoutes(
+    const MidiMessage& message) const
+{
+    std::vector<std::pair<std::string, MidiMessage>> resolved;
+    
+    if (message.getSize() == 0) {
+        return resolved;
+    }
+    
+    RoutingTableReader table(table_);
+    
+    auto matchingRoutes = table->lookup(INVALID_DEVICE_HANDLE, message.getStatus());
+    
+    for (const CompiledRoute* compiled : matchingRoutes) {
+        resolved.emplace_back(compiled->route->destinationDeviceId,
+                              compiled->hasTransform ?
+                                  applyTransformations(message, *compiled->route) : message);
+    }
+    
+    return resolved;
+}
+
 void MidiRouter::setMessageCallback(MessageCallback callback) {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     messageCallback_ = callback;
+    
+    // Endpoints are immutable: rebuild them around the new callback
+    for (auto& [id, output] : outputs_) {
+        output = makeEndpoint(output->handle, output->device, output->stats);
+    }
+    publishRoutingTable();
+    
     Logger::info("MidiRouter", "Message callback set");
 }
 
@@ -147,10 +478,12 @@ void MidiRouter::addRoute(std::shared_ptr<MidiRoute> route) {
     routes_.push_back(route);
     
     // Initialize statistics
-    RouteStatistics stats;
-    stats.routeId = route->id;
-    stats.routeName = route->name;
-    routeStats_[route->id] = std::move(stats);
+    auto stats = std::make_shared<RouteStatistics>();
+    stats->routeId = route->id;
+    stats->routeName = route->name;
+    routeStats_[route->id] = stats;
+    
+    publishRoutingTable();
     
     Logger::info("MidiRouter", "Route added: " + route->name + " (ID: " + route->id + ")");
     
@@ -218,6 +551,7 @@ bool MidiRouter::removeRoute(const std::string& id) {
             Logger::info("MidiRouter", "Route removed: " + (*it)->name);
             routes_.erase(it);
             routeStats_.erase(id);
+            publishRoutingTable();
             found = true;
         }
     }
@@ -258,8 +592,9 @@ bool MidiRouter::removeRoute(const std::string& sourceDeviceId,
             sourceId = (*it)->sourceDeviceId;
             destId = (*it)->destinationDeviceId;
             Logger::info("MidiRouter", "Route removed: " + (*it)->name);
-            routes_.erase(it);
             routeStats_.erase((*it)->id);
+            routes_.erase(it);
+            publishRoutingTable();
             found = true;
         }
     }
@@ -308,6 +643,7 @@ void MidiRouter::setRouteEnabled(const std::string& id, bool enabled) {
     
     if (it != routes_.end()) {
         (*it)->enabled = enabled;
+        publishRoutingTable();
         Logger::info("MidiRouter", 
                     "Route " + id + " " + (enabled ? "enabled" : "disabled"));
     }
@@ -325,6 +661,7 @@ bool MidiRouter::enableRoute(const std::string& sourceDeviceId,
     
     if (it != routes_.end()) {
         (*it)->enabled = true;
+        publishRoutingTable();
         Logger::info("MidiRouter", "Route enabled: " + (*it)->name);
         return true;
     }
@@ -344,6 +681,7 @@ bool MidiRouter::disableRoute(const std::string& sourceDeviceId,
     
     if (it != routes_.end()) {
         (*it)->enabled = false;
+        publishRoutingTable();
         Logger::info("MidiRouter", "Route disabled: " + (*it)->name);
         return true;
     }
@@ -351,36 +689,82 @@ bool MidiRouter::disableRoute(const std::string& sourceDeviceId,
     return false;
 }
 
+bool MidiRouter::setRouteCoalescing(const std::string& sourceDeviceId,
+                                    const std::string& destinationDeviceId,
+                                    uint32_t windowMs) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    
+    auto it = std::find_if(routes_.begin(), routes_.end(),
+                          [&](const auto& r) {
+                              return (sourceDeviceId.empty() || r->sourceDeviceId == sourceDeviceId) &&
+                                     r->destinationDeviceId == destinationDeviceId;
+                          });
+    
+    if (it != routes_.end()) {
+        (*it)->coalesceWindowMs = windowMs;
+        publishRoutingTable();
+        Logger::info("MidiRouter", "Route " + (*it)->name + " coalescing window: " +
+                    std::to_string(windowMs) + " ms");
+        return true;
+    }
+    
+    return false;
+}
+
 void MidiRouter::clearRoutes() {
     std::unique_lock<std::shared_mutex> lock(mutex_);
     
     Logger::info("MidiRouter", "Clearing all routes");
     routes_.clear();
     routeStats_.clear();
+    publishRoutingTable();
 }
 
 // ============================================================================
 // DEVICE MANAGEMENT
 // ============================================================================
 
-void MidiRouter::registerDevice(std::shared_ptr<MidiDevice> device) {
+DeviceHandle MidiRouter::registerDevice(std::shared_ptr<MidiDevice> device) {
     if (!device) {
         Logger::error("MidiRouter", "Cannot register null device");
-        return;
+        return INVALID_DEVICE_HANDLE;
     }
     
     std::unique_lock<std::shared_mutex> lock(mutex_);
     
-    devices_[device->getId()] = device;
-    Logger::info("MidiRouter", "Device registered: " + device->getId());
+    std::string deviceId = device->getId();
+    DeviceHandle handle = acquireHandle(deviceId);
+    std::shared_ptr<DeliveryStatistics> stats;
+    
+    auto it = outputs_.find(deviceId);
+    if (it != outputs_.end()) {
+        stats = it->second->stats;
+    }
+    
+    outputs_[deviceId] = makeEndpoint(handle, device, stats);
+    publishRoutingTable();
+    
+    Logger::info("MidiRouter", "Device registered: " + deviceId +
+                 " (handle " + std::to_string(handle) + ")");
+    
+    return handle;
+}
+
+DeviceHandle MidiRouter::registerSource(const std::string& deviceId) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    
+    // Route sources got their handle when the table was compiled, so a new
+    // handle never changes what the table matches
+    return acquireHandle(deviceId);
 }
 
 void MidiRouter::unregisterDevice(const std::string& deviceId) {
     std::unique_lock<std::shared_mutex> lock(mutex_);
     
-    auto it = devices_.find(deviceId);
-    if (it != devices_.end()) {
-        devices_.erase(it);
+    auto it = outputs_.find(deviceId);
+    if (it != outputs_.end()) {
+        outputs_.erase(it);
+        publishRoutingTable();
         Logger::info("MidiRouter", "Device unregistered: " + deviceId);
     }
 }
@@ -388,25 +772,58 @@ void MidiRouter::unregisterDevice(const std::string& deviceId) {
 std::shared_ptr<MidiDevice> MidiRouter::getDevice(const std::string& deviceId) const {
     std::shared_lock<std::shared_mutex> lock(mutex_);
     
-    auto it = devices_.find(deviceId);
-    if (it != devices_.end()) {
-        return it->second;
+    auto it = outputs_.find(deviceId);
+    if (it != outputs_.end()) {
+        return it->second->device;
     }
     
     return nullptr;
 }
 
+DeviceHandle MidiRouter::getDeviceHandle(const std::string& deviceId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    auto it = handles_.find(deviceId);
+    if (it != handles_.end()) {
+        return it->second;
+    }
+    
+    return INVALID_DEVICE_HANDLE;
+}
+
 // ============================================================================
 // LATENCY COMPENSATION
 // ============================================================================
 
 void MidiRouter::setLatencyCompensator(LatencyCompensator* compensator) {
-    compensator_.store(compensator);
+    LatencyCompensator* previous = compensator_.exchange(compensator);
+    if (previous == compensator) {
+        return;
+    }
+    
+    // Not under mutex_: the callback takes it
+    if (previous) {
+        previous->setChangeCallback(nullptr);
+    }
+    if (compensator) {
+        compensator->setChangeCallback([this]() { refreshCompensation(); });
+    }
+    
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        publishRoutingTable();
+    }
+    
     Logger::info("MidiRouter", "Latency compensator set");
 }
 
 void MidiRouter::setInstrumentCompensationEnabled(bool enabled) {
-    instrumentCompensationEnabled_.store(enabled);
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        instrumentCompensationEnabled_.store(enabled);
+        publishRoutingTable();
+    }
+    
     Logger::info("MidiRouter", 
                 "Instrument compensation " + std::string(enabled ? "enabled" : "disabled"));
 }
@@ -415,6 +832,14 @@ bool MidiRouter::isInstrumentCompensationEnabled() const {
     return instrumentCompensationEnabled_.load();
 }
 
+void MidiRouter::setOutputLookahead(std::chrono::microseconds lookahead) {
+    scheduler_->setLookahead(lookahead);
+}
+
+std::chrono::microseconds MidiRouter::getOutputLookahead() const {
+    return scheduler_->getLookahead();
+}
+
 // ============================================================================
 // STATISTICS
 // ============================================================================
@@ -424,7 +849,7 @@ RouteStatistics MidiRouter::getRouteStatistics(const std::string& routeId) const
     
     auto it = routeStats_.find(routeId);
     if (it != routeStats_.end()) {
-        return RouteStatistics(it->second);
+        return RouteStatistics(*it->second);
     }
     
     // Return empty stats if not found
@@ -434,6 +859,8 @@ RouteStatistics MidiRouter::getRouteStatistics(const std::string& routeId) const
 }
 
 json MidiRouter::getStatistics() const {
+    json devices = getDeviceStatistics();
+    
     std::shared_lock<std::shared_mutex> lock(mutex_);
     
     json stats = {
@@ -441,27 +868,53 @@ json MidiRouter::getStatistics() const {
         {"routed_messages", globalStats_.routedMessages.load()},
         {"dropped_messages", globalStats_.droppedMessages.load()},
         {"total_routes", routes_.size()},
-        {"routes", json::array()}
+        {"delivery", scheduler_->getStatistics()},
+        {"routes", json::array()},
+        {"devices", devices}
     };
     
     for (const auto& [id, routeStat] : routeStats_) {
-        stats["routes"].push_back(routeStat.toJson());
+        stats["routes"].push_back(routeStat->toJson());
     }
     
     return stats;
 }
 
+json MidiRouter::getDeviceStatistics() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    json devices = json::array();
+    
+    for (const auto& [id, output] : outputs_) {
+        json device = output->stats->toJson();
+        device["device_id"] = id;
+        device["handle"] = output->handle;
+        devices.push_back(std::move(device));
+    }
+    
+    return devices;
+}
+
+json MidiRouter::getDeliveryStatistics() const {
+    return scheduler_->getStatistics();
+}
+
 void MidiRouter::resetStatistics() {
     Logger::info("MidiRouter", "Resetting statistics");
     
+    scheduler_->resetStatistics();
+    
     globalStats_.totalMessages = 0;
     globalStats_.routedMessages = 0;
     globalStats_.droppedMessages = 0;
     
     std::shared_lock<std::shared_mutex> lock(mutex_);
     for (auto& [id, stats] : routeStats_) {
-        stats.messagesRouted = 0;
-        stats.avgCompensation = 0;
+        stats->reset();
+    }
+    
+    for (auto& [id, output] : outputs_) {
+        output->stats->reset();
     }
 }
 
@@ -478,39 +931,104 @@ void MidiRouter::setEventBus(std::shared_ptr<EventBus> eventBus) {
 // PRIVATE METHODS
 // ============================================================================
 
-bool MidiRouter::matchesRoute(const MidiMessage& message, const MidiRoute& route) const {
-    // Check channel filter
-    if (!route.channelFilter.empty()) {
-        int channel = message.getChannel();
-        if (channel < 0) return false;
-        
-        bool channelMatch = false;
-        for (uint8_t allowedChannel : route.channelFilter) {
-            if (channel == allowedChannel) {
-                channelMatch = true;
-                break;
-            }
+void MidiRouter::publishRoutingTable() {
+    // Caller holds the unique lock: table changes are serialized
+    
+    // One coalescer per route with a window; a new window gets a new one
+    // (the old one still flushes what it holds)
+    std::unordered_map<std::string, std::shared_ptr<MessageCoalescer>> coalescers;
+    for (const auto& route : routes_) {
+        if (route->coalesceWindowMs == 0) {
+            continue;
         }
         
-        if (!channelMatch) return false;
+        std::chrono::microseconds window(std::chrono::milliseconds(route->coalesceWindowMs));
+        auto it = coalescers_.find(route->id);
+        if (it != coalescers_.end() && it->second->getWindow() == window) {
+            coalescers[route->id] = it->second;
+        } else {
+            coalescers[route->id] = std::make_shared<MessageCoalescer>(window);
+        }
     }
+    coalescers_.swap(coalescers);
     
-    // Check message type filter
-    if (!route.messageTypeFilter.empty()) {
-        uint8_t status = message.getStatus();
-        
-        bool typeMatch = false;
-        for (uint8_t allowedType : route.messageTypeFilter) {
-            if (status == allowedType) {
-                typeMatch = true;
-                break;
-            }
+    // Every source gets a handle, so route sources index the table by handle
+    for (const auto& route : routes_) {
+        if (!route->sourceDeviceId.empty()) {
+            acquireHandle(route->sourceDeviceId);
         }
+    }
+    
+    alignmentDelays_ = computeAlignmentDelays();
+    
+    std::unique_ptr<const RoutingTable> table = RoutingTable::compile(
+        routes_, routeStats_, coalescers_, outputs_, handles_, alignmentDelays_);
+    size_t routeCount = table->getRouteCount();
+    
+    // A route() call still reading the old table delays its release
+    if (table_.publish(std::move(table)) > 0) {
+        scheduleTableReclaim();
+    }
+    
+    Logger::debug("MidiRouter", "Routing table compiled (" +
+                  std::to_string(routeCount) + " active routes)");
+}
+
+void MidiRouter::scheduleTableReclaim() {
+    // Caller holds the unique lock
+    if (tableReclaimPending_) {
+        return;
+    }
+    tableReclaimPending_ = true;
+    
+    // The scheduler is destroyed first, so the task never outlives the router
+    scheduler_->schedule(OutputScheduler::Clock::now() + TABLE_RECLAIM_RETRY, [this]() {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        tableReclaimPending_ = false;
         
-        if (!typeMatch) return false;
+        // Replaced tables hold their endpoints (and devices) alive
+        if (table_.reclaim() > 0) {
+            scheduleTableReclaim();
+        }
+    });
+}
+
+void MidiRouter::sendCoalesced(const CompiledRoute& compiled, const MidiMessage* messages,
+                               size_t count, OutputScheduler::Clock::time_point now,
+                               int64_t delay) {
+    auto due = now + std::chrono::microseconds(delay);
+    
+    auto outcome = compiled.coalescer->submit(messages, count, now,
+        [&](const MidiMessage* ready, size_t readyCount) {
+            scheduler_->send(compiled.output, ready, readyCount, due);
+        });
+    
+    if (outcome.coalesced != 0 && compiled.stats) {
+        compiled.stats->messagesCoalesced.fetch_add(outcome.coalesced, std::memory_order_relaxed);
     }
     
-    return true;
+    if (outcome.armTimer) {
+        scheduleCoalescerFlush(compiled.coalescer, compiled.output, delay, outcome.flushAt);
+    }
+}
+
+void MidiRouter::scheduleCoalescerFlush(std::shared_ptr<MessageCoalescer> coalescer,
+                                        std::shared_ptr<const OutputEndpoint> output,
+                                        int64_t delay, OutputScheduler::Clock::time_point at) {
+    // The scheduler is destroyed first, so the task never outlives the router
+    scheduler_->schedule(at, [this, coalescer, output, delay]() {
+        auto now = OutputScheduler::Clock::now();
+        
+        auto outcome = coalescer->flushDue(now,
+            [&](const MidiMessage* ready, size_t readyCount) {
+                scheduler_->send(output, ready, readyCount,
+                                 now + std::chrono::microseconds(delay));
+            });
+        
+        if (outcome.armTimer) {
+            scheduleCoalescerFlush(coalescer, output, delay, outcome.flushAt);
+        }
+    });
 }
 
 MidiMessage MidiRouter::applyTransformations(const MidiMessage& message, 
@@ -585,64 +1103,78 @@ MidiMessage MidiRouter::applyTransformations(const MidiMessage& message,
     return transformed;
 }
 
-int64_t MidiRouter::getCompensationForRoute(const MidiRoute& route) const {
-    if (!instrumentCompensationEnabled_.load()) {
-        return 0;
+std::unordered_map<std::string, int64_t> MidiRouter::computeAlignmentDelays() const {
+    LatencyCompensator* comp = compensator_.load();
+    if (!comp || !instrumentCompensationEnabled_.load()) {
+        return {};
     }
     
-    LatencyCompensator* comp = compensator_.load();
-    if (comp) {
-        std::string instrumentId = route.destinationDeviceId;
-        int64_t compensation = comp->getInstrumentCompensation(instrumentId);
-        
-        Logger::debug("MidiRouter", 
-                     "Compensation for " + instrumentId + ": " + 
-                     std::to_string(compensation) + "µs");
-        
-        return compensation;
+    std::vector<std::string> destinations;
+    for (const auto& route : routes_) {
+        const std::string& destination = route->destinationDeviceId;
+        if (std::find(destinations.begin(), destinations.end(), destination) ==
+            destinations.end()) {
+            destinations.push_back(destination);
+        }
     }
     
-    return 0;
+    // One pass: device compensation counts among the destinations only
+    return comp->getAlignmentDelays(destinations);
 }
 
-void MidiRouter::sendToDevice(const std::string& deviceId, const MidiMessage& message) {
-    // Get device
-    auto device = getDevice(deviceId);
+void MidiRouter::refreshCompensation() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     
-    if (!device) {
-        Logger::warning("MidiRouter", "Device not found: " + deviceId);
-        return;
+    if (computeAlignmentDelays() != alignmentDelays_) {
+        publishRoutingTable();
     }
-    
-    // Copy callback with lock
-    MessageCallback callback;
-    {
-        std::lock_guard<std::mutex> lock(callbackMutex_);
-        callback = messageCallback_;
+}
+
+DeviceHandle MidiRouter::acquireHandle(const std::string& deviceId) {
+    auto it = handles_.find(deviceId);
+    if (it != handles_.end()) {
+        return it->second;
     }
     
-    if (callback) {
-        callback(message, deviceId);
+    DeviceHandle handle = nextHandle_++;
+    handles_.emplace(deviceId, handle);
+    return handle;
+}
+
+std::shared_ptr<const OutputEndpoint> MidiRouter::makeEndpoint(
+    DeviceHandle handle, std::shared_ptr<MidiDevice> device,
+    std::shared_ptr<DeliveryStatistics> stats) const
+{
+    auto output = std::make_shared<OutputEndpoint>();
+    output->handle = handle;
+    output->deviceId = device->getId();
+    output->device = std::move(device);
+    output->send = messageCallback_;
+    output->stats = stats ? std::move(stats) : std::make_shared<DeliveryStatistics>();
+    return output;
+}
+
+void MidiRouter::recordUndeliverable(const CompiledRoute& compiled, uint64_t count) {
+    if (!compiled.stats) {
+        return;
     }
     
-    Logger::debug("MidiRouter", 
-                 "Message sent to " + deviceId + ": " + message.getTypeName());
+    if (compiled.stats->messagesUndeliverable.fetch_add(count, std::memory_order_relaxed) == 0) {
+        Logger::warning("MidiRouter", "Device not found: " +
+                        compiled.route->destinationDeviceId + " (route " +
+                        compiled.route->id + ", further messages counted only)");
+    }
 }
 
-void MidiRouter::updateRouteStatistics(const std::string& routeId, int64_t compensation) {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
-    
-    auto it = routeStats_.find(routeId);
-    if (it != routeStats_.end()) {
-        auto& stats = it->second;
-        
-        uint64_t routed = stats.messagesRouted.fetch_add(1) + 1;
-        stats.lastMessageTime.store(TimestampManager::instance().now());
-        
-        // Update average compensation (simple moving average)
-        int64_t oldAvg = stats.avgCompensation.load();
-        int64_t newAvg = (oldAvg * (routed - 1) + compensation) / routed;
-        stats.avgCompensation.store(newAvg);
+void MidiRouter::updateRouteStatistics(RouteStatistics& stats, uint64_t timestamp,
+                                       uint64_t latencyUs, int64_t compensation,
+                                       uint64_t count) {
+    stats.messagesRouted.fetch_add(count, std::memory_order_relaxed);
+    stats.lastMessageTime.store(timestamp, std::memory_order_relaxed);
+    stats.latency.record(latencyUs, count);
+    
+    if (compensation != 0) {
+        stats.compensation.record(static_cast<uint64_t>(compensation), count);
     }
 }
 
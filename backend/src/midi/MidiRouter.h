@@ -1,13 +1,94 @@
 // ============================================================================
 // File: backend/src/midi/MidiRouter.h
-// Version: 4.2.0 - EventBus Integration
+// Version: 4.2.14
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v4.2.14:
+//   - table_ is an EpochPointer: route() reads it with one store to its
+//     thread's reader slot, no lock and no reference count
+//
+// Changes v4.2.13:
+//   - Alignment delays come from LatencyCompensator::getAlignmentDelays()
+//     in one call, device compensation (BLE input latency) included
+//
+// Changes v4.2.12:
+//   - Device input is routed by DeviceHandle: route(message, source) and
+//     route(messages, count, source); ADDED: registerSource()
+//   - A device ID keeps its handle for the router's lifetime
+//   - Alignment delays are compiled into the routing table and recompiled
+//     when the LatencyCompensator reports a change (route() no longer asks
+//     the compensator per message)
+//
+// Changes v4.2.11:
+//   - The compiled table is a shared_ptr published with atomic_store;
+//     route() holds a reference for the call, so a replaced table lives
+//     exactly as long as its last reader (no timed reclamation)
+//   - RouteStatistics::messagesUndeliverable: messages for a destination
+//     that is not registered (warned once per route, not per message)
+//
+// Changes v4.2.10:
+//   - ADDED: route(messages, count, sourceDeviceId) for devices that
+//     receive several messages at once (BLE packets)
+//
+// Changes v4.2.9:
+//   - ADDED: route(messages, count, due) for senders that work ahead of
+//     time (player lookahead); setOutputLookahead() for timed
+//     (OutputMode::QUEUED) destinations
+//
+// Changes v4.2.8:
+//   - RouteStatistics::endToEnd: device input arrival -> handed to the
+//     output, for messages routed from a device (thru path)
+//
+// Changes v4.2.7:
+//   - MidiRoute::coalesceWindowMs: optional thinning of controller, pitch
+//     bend and channel pressure floods (latest value per channel and
+//     controller within the window; notes are never held or reordered)
+//   - RouteStatistics::messagesCoalesced; ADDED: setRouteCoalescing()
+//
+// Changes v4.2.6:
+//   - RouteStatistics: latency and compensation histograms replace the
+//     racy integer average of compensation
+//   - Per-device delivery statistics (lateness, send time); ADDED:
+//     getDeviceStatistics()
+//
+// Changes v4.2.5:
+//   - ADDED: route(messages, count) for bursts (chords, drum hits): one
+//     delivery per destination, statistics updated once per burst
+//   - Routed messages are sent to the registered device
+//
+// Changes v4.2.4:
+//   - Registered devices get a dense DeviceHandle and an OutputEndpoint;
+//     compiled routes point at their endpoint, so delivery does no device
+//     lookup, shared_ptr copy or callback locking per message
+//   - registerDevice() returns the handle; ADDED: getDeviceHandle()
+//
+// Changes v4.2.3:
+//   - Latency compensation is applied: routed messages go through an
+//     OutputScheduler that holds them back by the instrument's alignment
+//     delay (faster instruments wait for the slowest)
+//   - ADDED: getDeliveryStatistics() (queue depth, delay, lateness)
+//
+// Changes v4.2.2:
+//   - route() reads a compiled RoutingTable published by atomic pointer
+//     swap (no lock, no route list copy per message)
+//   - route(message, sourceDeviceId): honors MidiRoute::sourceDeviceId
+//
+// Changes v4.2.1:
+//   - resolveRoutes(): routing without delivery (offline render)
+//
+// ============================================================================
 
 #pragma once
 
 #include "MidiMessage.h"
+#include "RoutingTable.h"
+#include "../core/EpochPointer.h"
+#include "OutputEndpoint.h"
+#include "OutputScheduler.h"
+#include "MessageCoalescer.h"
 #include "../timing/LatencyCompensator.h"
+#include "../timing/LatencyHistogram.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -16,6 +97,7 @@
 #include <shared_mutex>
 #include <mutex>
 #include <functional>
+#include <chrono>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -51,25 +133,36 @@ struct MidiRoute {
     int8_t velocityTransform;          // Velocity offset (-127 to +127, 0 = no change)
     int8_t transposeTransform;         // Transpose semitones (-127 to +127, 0 = no change)
     
+    // Rate limiting
+    uint32_t coalesceWindowMs;         // Controller/bend/pressure thinning window (0 = off)
+    
     MidiRoute()
         : priority(50)
         , enabled(true)
         , channelTransform(0)
         , velocityTransform(0)
         , transposeTransform(0)
+        , coalesceWindowMs(0)
     {}
 };
 
 /**
  * @struct RouteStatistics
  * @brief Statistics for a specific route
+ *
+ * Resolved into the compiled routing table, so route() records into it
+ * directly with relaxed atomics (no lock, no lookup).
  */
 struct RouteStatistics {
     std::string routeId;
     std::string routeName;
     std::atomic<uint64_t> messagesRouted{0};
+    std::atomic<uint64_t> messagesCoalesced{0};  ///< Held values replaced by a newer one (never sent)
+    std::atomic<uint64_t> messagesUndeliverable{0}; ///< Destination not registered (not sent)
     std::atomic<uint64_t> lastMessageTime{0};
-    std::atomic<int64_t> avgCompensation{0};
+    LatencyHistogram latency;           ///< route() call -> handed to the device, plus delay (µs)
+    LatencyHistogram compensation;      ///< Delay applied, compensated messages only (µs)
+    LatencyHistogram endToEnd;          ///< Thru: arrival at the input device -> handed to the output, plus delay (µs)
     
     // Default constructor
     RouteStatistics() = default;
@@ -79,8 +172,12 @@ struct RouteStatistics {
         : routeId(other.routeId)
         , routeName(other.routeName)
         , messagesRouted(other.messagesRouted.load())
+        , messagesCoalesced(other.messagesCoalesced.load())
+        , messagesUndeliverable(other.messagesUndeliverable.load())
         , lastMessageTime(other.lastMessageTime.load())
-        , avgCompensation(other.avgCompensation.load())
+        , latency(other.latency)
+        , compensation(other.compensation)
+        , endToEnd(other.endToEnd)
     {}
     
     // Copy assignment operator
@@ -89,31 +186,23 @@ struct RouteStatistics {
             routeId = other.routeId;
             routeName = other.routeName;
             messagesRouted.store(other.messagesRouted.load());
+            messagesCoalesced.store(other.messagesCoalesced.load());
+            messagesUndeliverable.store(other.messagesUndeliverable.load());
             lastMessageTime.store(other.lastMessageTime.load());
-            avgCompensation.store(other.avgCompensation.load());
+            latency = other.latency;
+            compensation = other.compensation;
+            endToEnd = other.endToEnd;
         }
         return *this;
     }
     
-    // Move constructor
-    RouteStatistics(RouteStatistics&& other) noexcept
-        : routeId(std::move(other.routeId))
-        , routeName(std::move(other.routeName))
-        , messagesRouted(other.messagesRouted.load())
-        , lastMessageTime(other.lastMessageTime.load())
-        , avgCompensation(other.avgCompensation.load())
-    {}
-    
-    // Move assignment operator
-    RouteStatistics& operator=(RouteStatistics&& other) noexcept {
-        if (this != &other) {
-            routeId = std::move(other.routeId);
-            routeName = std::move(other.routeName);
-            messagesRouted.store(other.messagesRouted.load());
-            lastMessageTime.store(other.lastMessageTime.load());
-            avgCompensation.store(other.avgCompensation.load());
-        }
-        return *this;
+    void reset() {
+        messagesRouted = 0;
+        messagesCoalesced = 0;
+        messagesUndeliverable = 0;
+        latency.reset();
+        compensation.reset();
+        endToEnd.reset();
     }
     
     json toJson() const {
@@ -121,8 +210,14 @@ struct RouteStatistics {
             {"route_id", routeId},
             {"route_name", routeName},
             {"messages_routed", messagesRouted.load()},
+            {"messages_coalesced", messagesCoalesced.load()},
+            {"messages_undeliverable", messagesUndeliverable.load()},
             {"last_message_time", lastMessageTime.load()},
-            {"avg_compensation_us", avgCompensation.load()}
+            {"avg_compensation_us", messagesRouted.load() ? static_cast<int64_t>(
+                compensation.getMean() * compensation.getCount() / messagesRouted.load()) : 0},
+            {"latency", latency.toJson()},
+            {"compensation", compensation.toJson()},
+            {"end_to_end", endToEnd.toJson()}
         };
     }
 };
@@ -145,13 +240,16 @@ struct GlobalRoutingStatistics {
  * @class MidiRouter
  * @brief Routes MIDI messages with filtering, transformation, and latency compensation
  * 
- * Thread Safety: All methods are thread-safe using shared_mutex for read/write locks.
+ * Thread Safety: All methods are thread-safe. Route management is serialized
+ * by a shared_mutex and republishes a compiled RoutingTable; route() reads
+ * the current table inside an epoch read section (read-copy-update, a
+ * replaced table is freed once no reader predates the swap).
  * 
  * EventBus Integration: Publishes RouteAddedEvent and RouteRemovedEvent.
  */
 class MidiRouter {
 public:
-    using MessageCallback = std::function<void(const MidiMessage&, const std::string& deviceId)>;
+    using MessageCallback = OutputEndpoint::SendCallback;
     
     // ========================================================================
     // CONSTRUCTOR / DESTRUCTOR
@@ -180,10 +278,47 @@ public:
     
     /**
      * @brief Route a MIDI message through configured routes
-     * @param message MIDI message to route
+     * @param message MIDI message to route (source unknown: every route applies)
      */
     void route(const MidiMessage& message);
     
+    /**
+     * @brief Route a MIDI message received from a device
+     * @param message MIDI message to route (timestamp = arrival time, as
+     *        stamped by MidiDevice, for the end-to-end statistics)
+     * @param source Source device (registerSource()); routes with another
+     *        source are skipped
+     */
+    void route(const MidiMessage& message, DeviceHandle source);
+    
+    /**
+     * @brief Route a burst of simultaneous messages (source unknown)
+     * @param messages First message
+     * @param count Number of messages
+     * @note Each destination receives its share of the burst in one
+     *       sendMessages() call, in the original order
+     */
+    void route(const MidiMessage* messages, size_t count);
+    
+    /**
+     * @brief Route a burst of simultaneous messages meant for a given time
+     * @param messages First message
+     * @param count Number of messages
+     * @param due When they should be heard (now or earlier = now); each
+     *        route's compensation delay is added to it
+     */
+    void route(const MidiMessage* messages, size_t count,
+               OutputScheduler::Clock::time_point due);
+    
+    /**
+     * @brief Route a burst of messages received together from a device
+     * @param messages First message (timestamps = arrival times)
+     * @param count Number of messages
+     * @param source Source device (registerSource()); routes with another
+     *        source are skipped
+     */
+    void route(const MidiMessage* messages, size_t count, DeviceHandle source);
+    
     /**
      * @brief Route directly to a specific device (bypass routing table)
      * @param message MIDI message to send
@@ -191,6 +326,15 @@ public:
      */
     void routeTo(const MidiMessage& message, const std::string& deviceId);
     
+    /**
+     * @brief Resolve a message through the routing table without sending it
+     * @param message MIDI message to route
+     * @return (destination device ID, transformed message) for each matching
+     *         enabled route, highest priority first
+     * @note Does not touch statistics or latency compensation
+     */
+    std::vector<std::pair<std::string, MidiMessage>> resolveRoutes(const MidiMessage& message) const;
+    
     /**
      * @brief Set callback for routed messages
      * @param callback Function to call when message is routed
@@ -270,6 +414,19 @@ public:
     bool disableRoute(const std::string& sourceDeviceId,
                       const std::string& destinationDeviceId);
     
+    /**
+     * @brief Thin controller floods on a route
+     * @param sourceDeviceId Source device ID
+     * @param destinationDeviceId Destination device ID
+     * @param windowMs Send at most one value per channel and controller
+     *        (pitch bend, channel pressure) in this window, the latest
+     *        one (0 = off)
+     * @return bool true if the route was found
+     */
+    bool setRouteCoalescing(const std::string& sourceDeviceId,
+                            const std::string& destinationDeviceId,
+                            uint32_t windowMs);
+    
     /**
      * @brief Clear all routes
      */
@@ -281,9 +438,20 @@ public:
     
     /**
      * @brief Register a MIDI device
-     * @param device Device to register
+     * @param device Device to register (replaces a device with the same ID)
+     * @return DeviceHandle Handle of the device (INVALID_DEVICE_HANDLE if null)
+     */
+    DeviceHandle registerDevice(std::shared_ptr<MidiDevice> device);
+    
+    /**
+     * @brief Get the handle a device's input is routed with
+     * @param deviceId Source device ID (input devices need not be registered)
+     * @return DeviceHandle Handle for route(message, source)
+     * @note Same handle as registerDevice() for the same ID; a device ID
+     *       keeps its handle for the router's lifetime, so late messages of
+     *       a disconnected device can never be taken for another device's
      */
-    void registerDevice(std::shared_ptr<MidiDevice> device);
+    DeviceHandle registerSource(const std::string& deviceId);
     
     /**
      * @brief Unregister a MIDI device
@@ -298,6 +466,13 @@ public:
      */
     std::shared_ptr<MidiDevice> getDevice(const std::string& deviceId) const;
     
+    /**
+     * @brief Get the handle of a device
+     * @param deviceId Device ID
+     * @return DeviceHandle Handle or INVALID_DEVICE_HANDLE (never seen)
+     */
+    DeviceHandle getDeviceHandle(const std::string& deviceId) const;
+    
     // ========================================================================
     // LATENCY COMPENSATION
     // ========================================================================
@@ -320,6 +495,13 @@ public:
      */
     bool isInstrumentCompensationEnabled() const;
     
+    /**
+     * @brief How far ahead of their due time timed destinations receive
+     *        delayed messages (OutputScheduler lookahead)
+     */
+    void setOutputLookahead(std::chrono::microseconds lookahead);
+    std::chrono::microseconds getOutputLookahead() const;
+    
     // ========================================================================
     // STATISTICS
     // ========================================================================
@@ -337,6 +519,19 @@ public:
      */
     json getStatistics() const;
     
+    /**
+     * @brief Get delivery statistics of every registered device
+     * @return json Array of {device_id, handle, messages_sent, bursts,
+     *         lateness, send_time}
+     */
+    json getDeviceStatistics() const;
+    
+    /**
+     * @brief Get timed delivery statistics
+     * @return json OutputScheduler statistics (queue depth, delay, lateness)
+     */
+    json getDeliveryStatistics() const;
+    
     /**
      * @brief Reset statistics
      */
@@ -358,9 +553,41 @@ private:
     // ========================================================================
     
     /**
-     * @brief Check if message matches route filters
+     * @brief Compile routes_ and publish the table (caller holds unique lock)
+     */
+    void publishRoutingTable();
+    
+    /**
+     * @brief Retry freeing replaced tables a reader still held at publish
+     *        time, after TABLE_RECLAIM_RETRY (caller holds unique lock)
+     */
+    void scheduleTableReclaim();
+    
+    /**
+     * @brief Route a burst: each destination gets its share in one send
+     * @param due When the burst is meant for (epoch: now)
+     * @param source Source device (INVALID_DEVICE_HANDLE = unknown, every
+     *        route applies)
      */
-    bool matchesRoute(const MidiMessage& message, const MidiRoute& route) const;
+    void routeBurst(const MidiMessage* messages, size_t count,
+                    OutputScheduler::Clock::time_point due,
+                    DeviceHandle source);
+    
+    /**
+     * @brief Deliver a route's messages through its coalescer
+     * @param delay Compensation delay of the destination (µs)
+     */
+    void sendCoalesced(const CompiledRoute& compiled, const MidiMessage* messages,
+                           size_t count, OutputScheduler::Clock::time_point now,
+                           int64_t delay);
+    
+    /**
+     * @brief Release a coalescer's held values at the end of their window
+     *        (runs on the scheduler thread)
+     */
+    void scheduleCoalescerFlush(std::shared_ptr<MessageCoalescer> coalescer,
+                                std::shared_ptr<const OutputEndpoint> output,
+                                int64_t delay, OutputScheduler::Clock::time_point at);
     
     /**
      * @brief Apply transformations to message
@@ -369,19 +596,44 @@ private:
                                     const MidiRoute& route) const;
     
     /**
-     * @brief Get compensation for route
+     * @brief Alignment delay of every route destination, device
+     *        compensation included (µs, >= 0; caller holds the lock)
+     */
+    std::unordered_map<std::string, int64_t> computeAlignmentDelays() const;
+    
+    /**
+     * @brief Recompile the table if an alignment delay changed
+     *        (LatencyCompensator change callback)
+     */
+    void refreshCompensation();
+    
+    /**
+     * @brief Handle of a device ID, assigned on first use (caller holds
+     *        unique lock)
+     */
+    DeviceHandle acquireHandle(const std::string& deviceId);
+    
+    /**
+     * @brief Build the endpoint of a device (caller holds unique lock)
+     * @param stats Statistics to carry over from the endpoint being
+     *        replaced (nullptr = new device)
      */
-    int64_t getCompensationForRoute(const MidiRoute& route) const;
+    std::shared_ptr<const OutputEndpoint> makeEndpoint(
+        DeviceHandle handle, std::shared_ptr<MidiDevice> device,
+        std::shared_ptr<DeliveryStatistics> stats) const;
     
     /**
-     * @brief Send message to device
+     * @brief Count a message whose destination is not registered
+     *        (warns on the first one of the route)
      */
-    void sendToDevice(const std::string& deviceId, const MidiMessage& message);
+    static void recordUndeliverable(const CompiledRoute& compiled, uint64_t count = 1);
     
     /**
      * @brief Update route statistics
      */
-    void updateRouteStatistics(const std::string& routeId, int64_t compensation);
+    static void updateRouteStatistics(RouteStatistics& stats, uint64_t timestamp,
+                                      uint64_t latencyUs, int64_t compensation,
+                                      uint64_t count = 1);
     
     // ========================================================================
     // MEMBER VARIABLES
@@ -390,11 +642,36 @@ private:
     /// Routes
     std::vector<std::shared_ptr<MidiRoute>> routes_;
     
-    /// Registered devices
-    std::unordered_map<std::string, std::shared_ptr<MidiDevice>> devices_;
+    /// Registered devices, as delivery endpoints
+    std::unordered_map<std::string, std::shared_ptr<const OutputEndpoint>> outputs_;
+
+    
+    /// Handles by device ID (inputs, outputs and route sources)
+    std::unordered_map<std::string, DeviceHandle> handles_;
+    DeviceHandle nextHandle_;
+    
+    /// Alignment delays the current table was compiled with (µs)
+    std::unordered_map<std::string, int64_t> alignmentDelays_;
+    
+    /// Route statistics (shared with the compiled tables)
+    std::unordered_map<std::string, std::shared_ptr<RouteStatistics>> routeStats_;
+    
+    /// Coalescers of the routes with a coalescing window (shared with the
+    /// compiled tables and pending flushes)
+    std::unordered_map<std::string, std::shared_ptr<MessageCoalescer>> coalescers_;
     
-    /// Route statistics
-    std::unordered_map<std::string, RouteStatistics> routeStats_;
+    /// Read section on table_: the table stays valid while it exists
+    using RoutingTableReader = EpochPointer<RoutingTable>::Reader;
+    
+    /// Compiled routes read by route() (RoutingTableReader; published
+    /// under the unique lock)
+    EpochPointer<RoutingTable> table_;
+    
+    /// Delay before retrying to free tables still read at publish time
+    static constexpr std::chrono::milliseconds TABLE_RECLAIM_RETRY{50};
+    
+    /// A scheduleTableReclaim() task is waiting (unique lock)
+    bool tableReclaimPending_ = false;
     
     /// Global statistics
     GlobalRoutingStatistics globalStats_;
@@ -405,15 +682,17 @@ private:
     /// Instrument compensation enabled
     std::atomic<bool> instrumentCompensationEnabled_;
     
-    /// Message callback
+    /// Message callback (copied into every endpoint)
     MessageCallback messageCallback_;
-    std::mutex callbackMutex_;
     
     /// Thread safety
     mutable std::shared_mutex mutex_;
     
     /// EventBus for publishing events
     std::shared_ptr<EventBus> eventBus_;
+    
+    /// Timed delivery (last member: stopped first)
+    std::unique_ptr<OutputScheduler> scheduler_;
 };
 
 } // namespace midiMind
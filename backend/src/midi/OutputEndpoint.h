@@ -0,0 +1,130 @@
+// ============================================================================
+// File: backend/src/midi/OutputEndpoint.h
+// Version: 4.2.8
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Changes v4.2.8:
+//   - deliverAt()/timed(): destinations in OutputMode::QUEUED get delayed
+//     messages ahead of time, stamped with their due time
+//
+// Changes v4.2.6:
+//   - DeliveryStatistics per device: messages, lateness, send time
+//     (recorded by OutputScheduler)
+//
+// Changes v4.2.5:
+//   - Messages are sent to the device (burst-aware), then reported to the
+//     send callback
+//
+// Description:
+//   Destination of routed messages, resolved once when a device is
+//   registered with MidiRouter. Compiled routes and queued messages point
+//   at an endpoint directly instead of looking the device up by name.
+//
+// ============================================================================
+
+#pragma once
+
+#include "MidiMessage.h"
+#include "devices/MidiDevice.h"
+#include "../timing/LatencyHistogram.h"
+#include <string>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace midiMind {
+
+/// Dense index of a device known to MidiRouter (output or input)
+using DeviceHandle = uint32_t;
+
+/// No device
+static constexpr DeviceHandle INVALID_DEVICE_HANDLE = UINT32_MAX;
+
+/**
+ * @struct DeliveryStatistics
+ * @brief What a destination was sent and how punctually (lock-free)
+ */
+struct DeliveryStatistics {
+    std::atomic<uint64_t> messagesSent{0};
+    LatencyHistogram lateness;                  ///< Delayed messages: handed over - due time (µs)
+    LatencyHistogram sendTime;                  ///< Per burst: time to hand it to the device (µs)
+
+    void reset() {
+        messagesSent = 0;
+        lateness.reset();
+        sendTime.reset();
+    }
+
+    json toJson() const {
+        return json{
+            {"messages_sent", messagesSent.load()},
+            {"bursts", sendTime.getCount()},
+            {"lateness", lateness.toJson()},
+            {"send_time", sendTime.toJson()}
+        };
+    }
+};
+
+/**
+ * @struct OutputEndpoint
+ * @brief Registered device plus the callback told about what it was sent
+ *
+ * Immutable once published; a registration or callback change builds a new
+ * endpoint (sharing the statistics of the old one), while routing tables and
+ * queued messages keep the old one alive (shared_ptr) until they are done
+ * with it.
+ */
+struct OutputEndpoint {
+    using SendCallback = std::function<void(const MidiMessage&, const std::string& deviceId)>;
+
+    DeviceHandle handle = INVALID_DEVICE_HANDLE;
+    std::string deviceId;
+    std::shared_ptr<MidiDevice> device;
+    SendCallback send;
+    std::shared_ptr<DeliveryStatistics> stats;
+
+    /**
+     * @brief Whether the device delivers at a given time (deliverAt())
+     */
+    bool timed() const {
+        return device && device->supportsTimedOutput();
+    }
+
+    void deliver(const MidiMessage& message) const {
+        deliver(&message, 1);
+    }
+
+    void deliver(const MidiMessage* messages, size_t count) const {
+        if (device) {
+            device->sendMessages(messages, count);
+        }
+
+        if (send) {
+            for (size_t i = 0; i < count; ++i) {
+                send(messages[i], deviceId);
+            }
+        }
+    }
+
+    /**
+     * @brief Hand messages to a timed device ahead of their due time
+     * @note The send callback is told now, not at due
+     */
+    void deliverAt(const MidiMessage* messages, size_t count,
+                   std::chrono::steady_clock::time_point due) const {
+        if (device) {
+            device->sendMessagesAt(messages, count, due);
+        }
+
+        if (send) {
+            for (size_t i = 0; i < count; ++i) {
+                send(messages[i], deviceId);
+            }
+        }
+    }
+};
+
+} // namespace midiMind
@@ -0,0 +1,361 @@
+// ============================================================================
+// File: backend/src/midi/OutputScheduler.cpp
+// Version: 4.2.8
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "OutputScheduler.h"
+#include "../core/Logger.h"
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+
+namespace midiMind {
+
+// ============================================================================
+// CONSTRUCTOR / DESTRUCTOR
+// ============================================================================
+
+OutputScheduler::OutputScheduler()
+    : nextSequence_(0)
+    , running_(true)
+    , lookaheadUs_(DEFAULT_LOOKAHEAD.count())
+    , queueDepth_(0)
+    , immediateCount_(0)
+    , delayedCount_(0)
+    , handedAheadCount_(0)
+    , maxQueueDepth_(0)
+{
+    schedulerThread_ = std::thread(&OutputScheduler::schedulerLoop, this);
+
+    // Delayed notes must leave on time even when the API or file I/O is busy
+    sched_param param{};
+    param.sched_priority = THREAD_PRIORITY;
+    int result = pthread_setschedparam(schedulerThread_.native_handle(), SCHED_FIFO, &param);
+    if (result != 0) {
+        Logger::debug("OutputScheduler",
+            "Real-time priority not available (error " + std::to_string(result) + ")");
+    }
+
+    Logger::info("OutputScheduler", "OutputScheduler started");
+}
+
+OutputScheduler::~OutputScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wakeCv_.notify_all();
+
+    if (schedulerThread_.joinable()) {
+        schedulerThread_.join();
+    }
+
+    Logger::info("OutputScheduler", "OutputScheduler stopped");
+}
+
+// ============================================================================
+// DELIVERY
+// ============================================================================
+
+OutputScheduler::Clock::time_point OutputScheduler::send(
+    const std::shared_ptr<const OutputEndpoint>& output,
+    const MidiMessage* messages, size_t count, Clock::time_point due)
+{
+    auto now = Clock::now();
+
+    if (count == 0) {
+        return now;
+    }
+
+    bool timed = output->timed();
+
+    // Fast path: due now and nothing queued anywhere
+    if (!timed && due <= now && queueDepth_.load(std::memory_order_acquire) == 0) {
+        immediateCount_.fetch_add(count, std::memory_order_relaxed);
+        output->deliver(messages, count);
+        return recordSent(*output, count, now);
+    }
+
+    auto lookahead = timed ? getLookahead() : std::chrono::microseconds(0);
+    bool newEarliest;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        DeviceQueue& queue = deviceQueues_[output->handle];
+
+        // The device plays what it holds in time order: never hand it
+        // anything due before what it already has
+        if (timed && due < queue.handedDue) {
+            due = queue.handedDue;
+        }
+
+        if (queue.count == 0 && due <= now + lookahead) {
+            if (timed) {
+                queue.handedDue = due;
+            }
+            lock.unlock();
+
+            if (!timed) {
+                immediateCount_.fetch_add(count, std::memory_order_relaxed);
+                output->deliver(messages, count);
+                return recordSent(*output, count, now);
+            }
+
+            if (due > now) {
+                handedAheadCount_.fetch_add(count, std::memory_order_relaxed);
+            } else {
+                immediateCount_.fetch_add(count, std::memory_order_relaxed);
+            }
+            output->deliverAt(messages, count, due);
+            return recordSent(*output, count, now);
+        }
+
+        // Never overtake what is already waiting for this destination
+        auto wake = due - lookahead;
+        if (queue.count > 0) {
+            due = std::max(due, queue.lastDue);
+            wake = std::max(wake, queue.lastWake);
+        }
+        queue.count += count;
+        queue.lastDue = due;
+        queue.lastWake = wake;
+
+        newEarliest = heap_.empty() || wake < heap_.front().wake;
+
+        for (size_t i = 0; i < count; ++i) {
+            heap_.push_back(Pending{due, wake, nextSequence_++, output, timed, messages[i]});
+            std::push_heap(heap_.begin(), heap_.end(), later);
+        }
+
+        size_t depth = queueDepth_.fetch_add(count, std::memory_order_release) + count;
+        size_t maxDepth = maxQueueDepth_.load(std::memory_order_relaxed);
+        while (depth > maxDepth &&
+               !maxQueueDepth_.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {}
+    }
+
+    delayedCount_.fetch_add(count, std::memory_order_relaxed);
+    uint64_t delayUs = due > now ?
+        std::chrono::duration_cast<std::chrono::microseconds>(due - now).count() : 0;
+    delayHistogram_.record(delayUs, count);
+
+    // Otherwise the scheduler already wakes up earlier than this
+    if (newEarliest) {
+        wakeCv_.notify_one();
+    }
+
+    return now;
+}
+
+void OutputScheduler::schedule(Clock::time_point due, Task task) {
+    bool newEarliest;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        newEarliest = (timers_.empty() || due < timers_.front().due) &&
+                      (heap_.empty() || due < heap_.front().wake);
+
+        timers_.push_back(Timer{due, nextSequence_++, std::move(task)});
+        std::push_heap(timers_.begin(), timers_.end(), laterTimer);
+    }
+
+    if (newEarliest) {
+        wakeCv_.notify_one();
+    }
+}
+
+void OutputScheduler::setLookahead(std::chrono::microseconds lookahead) {
+    lookaheadUs_.store(std::max<int64_t>(0, lookahead.count()), std::memory_order_relaxed);
+    Logger::info("OutputScheduler",
+        "Timed output lookahead: " + std::to_string(getLookahead().count()) + " us");
+}
+
+void OutputScheduler::flush() {
+    std::vector<Pending> pending;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending.swap(heap_);
+    }
+
+    deliverSorted(pending);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+json OutputScheduler::getStatistics() const {
+    return json{
+        {"queue_depth", getQueueDepth()},
+        {"max_queue_depth", maxQueueDepth_.load(std::memory_order_relaxed)},
+        {"immediate", immediateCount_.load(std::memory_order_relaxed)},
+        {"delayed", delayedCount_.load(std::memory_order_relaxed)},
+        {"handed_ahead", handedAheadCount_.load(std::memory_order_relaxed)},
+        {"lookahead_us", getLookahead().count()},
+        {"delay", delayHistogram_.toJson()},
+        {"lateness", latenessHistogram_.toJson()}
+    };
+}
+
+void OutputScheduler::resetStatistics() {
+    immediateCount_.store(0, std::memory_order_relaxed);
+    delayedCount_.store(0, std::memory_order_relaxed);
+    handedAheadCount_.store(0, std::memory_order_relaxed);
+    maxQueueDepth_.store(getQueueDepth(), std::memory_order_relaxed);
+    delayHistogram_.reset();
+    latenessHistogram_.reset();
+}
+
+// ============================================================================
+// PRIVATE METHODS
+// ============================================================================
+
+void OutputScheduler::schedulerLoop() {
+    Logger::info("OutputScheduler", "Scheduler thread started");
+
+    std::vector<Pending> run;
+    std::vector<MidiMessage> burst;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (running_) {
+        if (heap_.empty() && timers_.empty()) {
+            wakeCv_.wait(lock);
+            continue;
+        }
+
+        bool timerFirst = !timers_.empty() &&
+                          (heap_.empty() || timers_.front().due <= heap_.front().wake);
+
+        auto due = timerFirst ? timers_.front().due : heap_.front().wake;
+        if (Clock::now() < due) {
+            wakeCv_.wait_until(lock, due);
+            continue;       // Re-check: an earlier message may have arrived
+        }
+
+        if (timerFirst) {
+            std::pop_heap(timers_.begin(), timers_.end(), laterTimer);
+            Task task = std::move(timers_.back().task);
+            timers_.pop_back();
+
+            lock.unlock();
+            try {
+                task();
+            } catch (const std::exception& e) {
+                Logger::error("OutputScheduler", "Scheduled task failed: " + std::string(e.what()));
+            }
+            lock.lock();
+            continue;
+        }
+
+        // The due message plus the rest of its burst (same destination,
+        // same due time: queued together, so adjacent in heap order)
+        do {
+            std::pop_heap(heap_.begin(), heap_.end(), later);
+            run.push_back(std::move(heap_.back()));
+            heap_.pop_back();
+        } while (!heap_.empty() && heap_.front().wake == due &&
+                 heap_.front().due == run.front().due &&
+                 heap_.front().output == run.front().output &&
+                 heap_.front().timed == run.front().timed);
+
+        lock.unlock();
+        deliverRun(run, burst);
+        lock.lock();
+    }
+
+    std::vector<Pending> pending;
+    std::vector<Timer> dropped;
+    pending.swap(heap_);
+    dropped.swap(timers_);
+    lock.unlock();
+
+    // Shutdown: send what is left rather than leaving notes hanging
+    deliverSorted(pending);
+
+    Logger::info("OutputScheduler", "Scheduler thread stopped");
+}
+
+void OutputScheduler::deliverRun(std::vector<Pending>& run, std::vector<MidiMessage>& burst) {
+    auto now = Clock::now();
+    auto output = run.front().output;
+    auto due = run.front().due;
+    bool timed = run.front().timed;
+
+    for (auto& pending : run) {
+        uint64_t latenessUs = now > pending.due ?
+            std::chrono::duration_cast<std::chrono::microseconds>(now - pending.due).count() : 0;
+        latenessHistogram_.record(latenessUs);
+        output->stats->lateness.record(latenessUs);
+        burst.push_back(std::move(pending.message));
+    }
+
+    if (timed) {
+        // The device holds them until due
+        if (due > now) {
+            handedAheadCount_.fetch_add(burst.size(), std::memory_order_relaxed);
+        }
+        output->deliverAt(burst.data(), burst.size(), due);
+    } else {
+        output->deliver(burst.data(), burst.size());
+    }
+    recordSent(*output, burst.size(), now);
+
+    size_t delivered = run.size();
+    run.clear();
+    burst.clear();
+
+    // Released only after delivery so an inline send cannot overtake it
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = deviceQueues_.find(output->handle);
+    if (it != deviceQueues_.end()) {
+        DeviceQueue& queue = it->second;
+        queue.count -= std::min(queue.count, delivered);
+        if (timed) {
+            queue.handedDue = std::max(queue.handedDue, due);
+        }
+        // Kept while the device holds messages not yet due
+        if (queue.count == 0 && queue.handedDue <= now) {
+            deviceQueues_.erase(it);
+        }
+    }
+
+    queueDepth_.fetch_sub(delivered, std::memory_order_release);
+}
+
+OutputScheduler::Clock::time_point OutputScheduler::recordSent(
+    const OutputEndpoint& output, size_t count, Clock::time_point start)
+{
+    auto end = Clock::now();
+    output.stats->messagesSent.fetch_add(count, std::memory_order_relaxed);
+    output.stats->sendTime.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    return end;
+}
+
+void OutputScheduler::deliverSorted(std::vector<Pending>& pending) {
+    std::sort(pending.begin(), pending.end(),
+              [](const Pending& a, const Pending& b) { return later(b, a); });
+
+    std::vector<Pending> run;
+    std::vector<MidiMessage> burst;
+
+    for (auto& message : pending) {
+        if (!run.empty() && (message.due != run.front().due ||
+                             message.output != run.front().output ||
+                             message.timed != run.front().timed)) {
+            deliverRun(run, burst);
+        }
+        run.push_back(std::move(message));
+    }
+
+    if (!run.empty()) {
+        deliverRun(run, burst);
+    }
+}
+
+} // namespace midiMind
@@ -0,0 +1,242 @@
+// ============================================================================
+// File: backend/src/midi/OutputScheduler.h
+// Version: 4.2.8
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Changes v4.2.8:
+//   - Timed destinations (OutputMode::QUEUED): delayed messages are handed
+//     over up to the lookahead ahead of their due time, stamped with it,
+//     so the driver rather than our wake-up decides when they play
+//
+// Changes v4.2.7:
+//   - ADDED: schedule() runs a task on the scheduler thread at a given
+//     time (route coalescing flushes)
+//
+// Changes v4.2.6:
+//   - Per-destination statistics (OutputEndpoint): messages sent, send
+//     time per burst, lateness of delayed messages
+//
+// Changes v4.2.5:
+//   - send() of a burst (one lock, one wake-up); queued messages for the
+//     same destination and due time are delivered as one burst
+//
+// Changes v4.2.4:
+//   - Messages are addressed to an OutputEndpoint (delivered directly,
+//     destinations keyed by DeviceHandle) instead of a device ID string
+//
+// Description:
+//   Timed delivery of routed messages.
+//   Messages due now are delivered inline on the caller's thread; messages
+//   with a delay (latency compensation) wait in a min-heap serviced by a
+//   dedicated high-priority thread that sleeps until the earliest due time.
+//
+// Features:
+//   - Per-destination order is preserved: a destination with queued
+//     messages never has a newer message overtake them
+//   - Pending messages are delivered (not dropped) on shutdown, so no
+//     note-off is lost
+//   - Queue depth, delay and lateness statistics
+//   - Timed destinations keep their order too: nothing is handed over
+//     with a due time earlier than what the device already holds
+//
+// ============================================================================
+
+#pragma once
+
+#include "MidiMessage.h"
+#include "OutputEndpoint.h"
+#include "../timing/LatencyHistogram.h"
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace midiMind {
+
+/**
+ * @class OutputScheduler
+ * @brief Holds messages until their scheduled time, then delivers them
+ *
+ * Thread Safety: All public methods are thread-safe. Endpoints are
+ * delivered to from the sender's thread (due messages) or from the scheduler
+ * thread (delayed messages), never concurrently for the same destination
+ * while it has queued messages.
+ *
+ * Example:
+ * ```cpp
+ * OutputScheduler scheduler;
+ * scheduler.send(synthEndpoint, noteOn, OutputScheduler::Clock::now() + 12ms);
+ * ```
+ */
+class OutputScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+
+    /// SCHED_FIFO priority requested for the scheduler thread
+    static constexpr int THREAD_PRIORITY = 80;
+
+    /// How early timed destinations get their messages by default
+    static constexpr std::chrono::microseconds DEFAULT_LOOKAHEAD{5000};
+
+    /**
+     * @brief Constructor (starts the scheduler thread)
+     */
+    OutputScheduler();
+
+    /**
+     * @brief Destructor (delivers pending messages, stops the thread)
+     */
+    ~OutputScheduler();
+
+    OutputScheduler(const OutputScheduler&) = delete;
+    OutputScheduler& operator=(const OutputScheduler&) = delete;
+
+    /**
+     * @brief Deliver a message at a given time
+     * @param output Destination (referenced only if the message has to wait)
+     * @param message Message (copied only if it has to wait)
+     * @param due Delivery time (now or earlier = immediately)
+     * @return Clock::time_point When the message was delivered or queued
+     */
+    Clock::time_point send(const std::shared_ptr<const OutputEndpoint>& output,
+                           const MidiMessage& message, Clock::time_point due) {
+        return send(output, &message, 1, due);
+    }
+    
+    /**
+     * @brief Deliver a burst of messages to one destination at a given time
+     * @param output Destination
+     * @param messages First message
+     * @param count Number of messages (delivered in order, together)
+     * @param due Delivery time (now or earlier = immediately)
+     * @return Clock::time_point When the messages were delivered or queued
+     */
+    Clock::time_point send(const std::shared_ptr<const OutputEndpoint>& output,
+                           const MidiMessage* messages, size_t count, Clock::time_point due);
+
+    /**
+     * @brief Run a task on the scheduler thread at a given time
+     * @param due When to run it (tasks still waiting at shutdown are dropped)
+     * @param task Task; may send() and schedule() again
+     */
+    void schedule(Clock::time_point due, Task task);
+
+    /**
+     * @brief Deliver every queued message now
+     */
+    void flush();
+
+    /**
+     * @brief How far ahead of their due time timed destinations receive
+     *        messages (0 = at their due time, like other destinations)
+     */
+    void setLookahead(std::chrono::microseconds lookahead);
+
+    std::chrono::microseconds getLookahead() const {
+        return std::chrono::microseconds(lookaheadUs_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Number of messages waiting
+     */
+    size_t getQueueDepth() const { return queueDepth_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Statistics
+     * @return json {queue_depth, max_queue_depth, immediate, delayed,
+     *         handed_ahead, lookahead_us, delay: histogram,
+     *         lateness: histogram}
+     */
+    json getStatistics() const;
+
+    void resetStatistics();
+
+private:
+    struct Pending {
+        Clock::time_point due;
+        Clock::time_point wake;     ///< Hand-over time: due, or due - lookahead if timed
+        uint64_t sequence;          ///< Tie-break: same hand-over time keeps send order
+        std::shared_ptr<const OutputEndpoint> output;
+        bool timed;                 ///< Handed over with deliverAt()
+        MidiMessage message;
+    };
+
+    /// Heap order: earliest hand-over first
+    static bool later(const Pending& a, const Pending& b) {
+        return a.wake != b.wake ? a.wake > b.wake : a.sequence > b.sequence;
+    }
+
+    struct Timer {
+        Clock::time_point due;
+        uint64_t sequence;
+        Task task;
+    };
+
+    static bool laterTimer(const Timer& a, const Timer& b) {
+        return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+    }
+
+    /// Queued messages of one destination
+    struct DeviceQueue {
+        size_t count = 0;           ///< Queued or being delivered
+        Clock::time_point lastDue;  ///< Due time of the newest queued message
+        Clock::time_point lastWake; ///< Hand-over time of the newest queued message
+        Clock::time_point handedDue;///< Latest due time handed to a timed device
+    };
+
+    void schedulerLoop();
+
+    /**
+     * @brief Deliver popped messages of one destination as a burst
+     *        (called without mutex_ held)
+     * @param run Messages in due order
+     * @param burst Scratch buffer
+     */
+    void deliverRun(std::vector<Pending>& run, std::vector<MidiMessage>& burst);
+    
+    /**
+     * @brief Record a delivery in the destination's statistics
+     * @param start Clock reading taken before the delivery
+     * @return Clock::time_point Clock reading taken after it
+     */
+    static Clock::time_point recordSent(const OutputEndpoint& output, size_t count,
+                                        Clock::time_point start);
+    
+    /**
+     * @brief Deliver sorted messages, grouping each destination's
+     *        consecutive messages with the same due time
+     */
+    void deliverSorted(std::vector<Pending>& pending);
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeCv_;
+    std::vector<Pending> heap_;
+    std::vector<Timer> timers_;                 ///< Min-heap of scheduled tasks
+    std::unordered_map<DeviceHandle, DeviceQueue> deviceQueues_;
+    uint64_t nextSequence_;
+    bool running_;
+    std::atomic<int64_t> lookaheadUs_;
+
+    std::atomic<size_t> queueDepth_;
+    std::thread schedulerThread_;
+
+    // Statistics
+    std::atomic<uint64_t> immediateCount_;
+    std::atomic<uint64_t> delayedCount_;
+    std::atomic<uint64_t> handedAheadCount_;    ///< Handed to timed devices before due
+    std::atomic<size_t> maxQueueDepth_;
+    LatencyHistogram delayHistogram_;       ///< Requested delay (µs)
+    LatencyHistogram latenessHistogram_;    ///< Delivery time - due time (µs)
+};
+
+} // namespace midiMind
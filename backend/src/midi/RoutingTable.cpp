@@ -0,0 +1,176 @@
+// ============================================================================
+// File: backend/src/midi/RoutingTable.cpp
+// Version: 4.2.8
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "RoutingTable.h"
+#include "MidiRouter.h"
+#include "../core/Logger.h"
+#include <algorithm>
+
+namespace midiMind {
+
+// ============================================================================
+// COMPILE
+// ============================================================================
+
+std::unique_ptr<RoutingTable> RoutingTable::compile(
+    const std::vector<std::shared_ptr<MidiRoute>>& routes,
+    const std::unordered_map<std::string, std::shared_ptr<RouteStatistics>>& stats,
+    const std::unordered_map<std::string, std::shared_ptr<MessageCoalescer>>& coalescers,
+    const std::unordered_map<std::string, std::shared_ptr<const OutputEndpoint>>& outputs,
+    const std::unordered_map<std::string, DeviceHandle>& handles,
+    const std::unordered_map<std::string, int64_t>& delays)
+{
+    auto table = std::unique_ptr<RoutingTable>(new RoutingTable());
+
+    std::vector<std::shared_ptr<MidiRoute>> enabled;
+    for (const auto& route : routes) {
+        if (route->enabled) {
+            enabled.push_back(route);
+        }
+    }
+
+    if (enabled.size() > MAX_ROUTES) {
+        Logger::warning("RoutingTable", "Too many routes, extra routes ignored");
+        enabled.resize(MAX_ROUTES);
+    }
+
+    std::stable_sort(enabled.begin(), enabled.end(),
+                     [](const auto& a, const auto& b) {
+                         return a->priority > b->priority;
+                     });
+
+    table->routes_.reserve(enabled.size());
+
+    for (const auto& route : enabled) {
+        CompiledRoute compiled;
+        compiled.route = route;
+
+        auto it = stats.find(route->id);
+        if (it != stats.end()) {
+            compiled.stats = it->second;
+        }
+
+        auto coalescer = coalescers.find(route->id);
+        if (coalescer != coalescers.end()) {
+            compiled.coalescer = coalescer->second;
+        }
+
+        auto output = outputs.find(route->destinationDeviceId);
+        if (output != outputs.end()) {
+            compiled.output = output->second;
+        }
+
+        auto delay = delays.find(route->destinationDeviceId);
+        if (delay != delays.end()) {
+            compiled.delay = delay->second;
+        }
+
+        compiled.hasTransform = route->channelTransform != 0 ||
+                                route->transposeTransform != 0 ||
+                                route->velocityTransform != 0;
+
+        // Same rules as the filter vectors: channel messages only when a
+        // channel filter is set, exact status byte for the type filter
+        for (int status = 0; status < 256; ++status) {
+            bool pass = true;
+
+            if (!route->channelFilter.empty()) {
+                pass = status < 0xF0 &&
+                       std::find(route->channelFilter.begin(), route->channelFilter.end(),
+                                 status & 0x0F) != route->channelFilter.end();
+            }
+
+            if (pass && !route->messageTypeFilter.empty()) {
+                pass = std::find(route->messageTypeFilter.begin(), route->messageTypeFilter.end(),
+                                 status) != route->messageTypeFilter.end();
+            }
+
+            if (pass) {
+                compiled.statusMask[status >> 6] |= uint64_t(1) << (status & 63);
+            }
+        }
+
+        table->routes_.push_back(std::move(compiled));
+    }
+
+    table->allSources_ = table->buildIndex([](const MidiRoute&) { return true; });
+    table->anySource_ = table->buildIndex([](const MidiRoute& route) {
+        return route.sourceDeviceId.empty();
+    });
+
+    for (const auto& compiled : table->routes_) {
+        const std::string& source = compiled.route->sourceDeviceId;
+        if (source.empty()) {
+            continue;
+        }
+
+        auto handle = handles.find(source);
+        if (handle == handles.end()) {
+            continue;
+        }
+
+        if (handle->second >= table->bySource_.size()) {
+            table->bySource_.resize(handle->second + 1, NO_INDEX);
+        }
+
+        if (table->bySource_[handle->second] == NO_INDEX) {
+            table->bySource_[handle->second] = static_cast<uint32_t>(table->sourceIndexes_.size());
+            table->sourceIndexes_.push_back(table->buildIndex([&source](const MidiRoute& route) {
+                return route.sourceDeviceId.empty() || route.sourceDeviceId == source;
+            }));
+        }
+    }
+
+    return table;
+}
+
+// ============================================================================
+// LOOKUP
+// ============================================================================
+
+RoutingTable::RouteRange RoutingTable::lookup(DeviceHandle source, uint8_t status) const {
+    if (source == INVALID_DEVICE_HANDLE) {
+        return range(allSources_, status);
+    }
+
+    if (source < bySource_.size() && bySource_[source] != NO_INDEX) {
+        return range(sourceIndexes_[bySource_[source]], status);
+    }
+
+    return range(anySource_, status);
+}
+
+// ============================================================================
+// PRIVATE METHODS
+// ============================================================================
+
+template<typename Predicate>
+RoutingTable::Index RoutingTable::buildIndex(Predicate accept) const {
+    Index index;
+
+    for (int status = 0; status < 256; ++status) {
+        index.offsets[status] = static_cast<uint32_t>(index.entries.size());
+
+        for (size_t i = 0; i < routes_.size(); ++i) {
+            if (routes_[i].matchesStatus(static_cast<uint8_t>(status)) &&
+                accept(*routes_[i].route)) {
+                index.entries.push_back(static_cast<uint16_t>(i));
+            }
+        }
+    }
+
+    index.offsets[256] = static_cast<uint32_t>(index.entries.size());
+    index.entries.shrink_to_fit();
+
+    return index;
+}
+
+RoutingTable::RouteRange RoutingTable::range(const Index& index, uint8_t status) const {
+    const uint16_t* base = index.entries.data();
+    return RouteRange(this, base + index.offsets[status], base + index.offsets[status + 1]);
+}
+
+} // namespace midiMind
@@ -0,0 +1,179 @@
+// ============================================================================
+// File: backend/src/midi/RoutingTable.h
+// Version: 4.2.8
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Changes v4.2.8:
+//   - Compiled routes carry the alignment delay of their destination
+//   - Sources are looked up by DeviceHandle (array index, no string hash)
+//
+// Changes v4.2.7:
+//   - Compiled routes carry their MessageCoalescer (controller thinning)
+//
+// Changes v4.2.4:
+//   - Compiled routes carry their destination OutputEndpoint
+//
+// Description:
+//   Immutable, precompiled form of the MidiRouter route list.
+//   Channel and message type filters are evaluated once per status byte at
+//   compile time, so matching a message is a single array lookup that
+//   yields the matching routes already in priority order.
+//
+// Features:
+//   - Channel and type filters compiled to one 256-bit status mask
+//   - Per-status route lists, one set per source device handle
+//   - Disabled routes are left out of the table
+//
+// ============================================================================
+
+#pragma once
+
+#include "MidiMessage.h"
+#include "OutputEndpoint.h"
+#include "MessageCoalescer.h"
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+namespace midiMind {
+
+struct MidiRoute;
+struct RouteStatistics;
+
+/**
+ * @struct CompiledRoute
+ * @brief Route plus everything route() needs, resolved at compile time
+ */
+struct CompiledRoute {
+    std::shared_ptr<MidiRoute> route;           ///< Definition (kept alive by the table)
+    std::shared_ptr<RouteStatistics> stats;     ///< Statistics slot of the route
+    std::shared_ptr<const OutputEndpoint> output; ///< Destination (nullptr: not registered)
+    std::shared_ptr<MessageCoalescer> coalescer; ///< Controller thinning (nullptr: off)
+    std::array<uint64_t, 4> statusMask{};       ///< Bit s = status byte s passes both filters
+    int64_t delay = 0;                          ///< Alignment delay of the destination (µs, >= 0)
+    bool hasTransform = false;                  ///< Any channel/transpose/velocity transform
+
+    bool matchesStatus(uint8_t status) const {
+        return (statusMask[status >> 6] >> (status & 63)) & 1;
+    }
+};
+
+/**
+ * @class RoutingTable
+ * @brief Routes indexed by source device and status byte
+ *
+ * Thread Safety: Immutable after compile(); safe to read from any thread.
+ *
+ * Example:
+ * ```cpp
+ * auto table = RoutingTable::compile(routes, stats, coalescers, outputs, handles, delays);
+ * for (const CompiledRoute* r : table->lookup(sourceHandle, msg.getStatus())) {
+ *     scheduler.send(r->output, msg, now + std::chrono::microseconds(r->delay));
+ * }
+ * ```
+ */
+class RoutingTable {
+public:
+    /**
+     * @brief Contiguous run of matching routes (priority order)
+     */
+    class RouteRange {
+    public:
+        RouteRange(const RoutingTable* table, const uint16_t* first, const uint16_t* last)
+            : table_(table), first_(first), last_(last) {}
+
+        class iterator {
+        public:
+            iterator(const RoutingTable* table, const uint16_t* pos)
+                : table_(table), pos_(pos) {}
+            const CompiledRoute* operator*() const { return &table_->routes_[*pos_]; }
+            iterator& operator++() { ++pos_; return *this; }
+            bool operator!=(const iterator& other) const { return pos_ != other.pos_; }
+        private:
+            const RoutingTable* table_;
+            const uint16_t* pos_;
+        };
+
+        iterator begin() const { return iterator(table_, first_); }
+        iterator end() const { return iterator(table_, last_); }
+        bool empty() const { return first_ == last_; }
+        size_t size() const { return static_cast<size_t>(last_ - first_); }
+
+    private:
+        const RoutingTable* table_;
+        const uint16_t* first_;
+        const uint16_t* last_;
+    };
+
+    /// Routes beyond this count are ignored (index width)
+    static constexpr size_t MAX_ROUTES = 65535;
+
+    /**
+     * @brief Compile a route list
+     * @param routes Routes in insertion order (equal priorities keep this order)
+     * @param stats Statistics slots by route ID
+     * @param coalescers Coalescers of the routes that thin controllers, by route ID
+     * @param outputs Registered destinations by device ID
+     * @param handles Device handles by device ID (every route source must
+     *        have one, or its routes never match a device)
+     * @param delays Alignment delays by destination device ID (µs; absent = 0)
+     */
+    static std::unique_ptr<RoutingTable> compile(
+        const std::vector<std::shared_ptr<MidiRoute>>& routes,
+        const std::unordered_map<std::string, std::shared_ptr<RouteStatistics>>& stats,
+        const std::unordered_map<std::string, std::shared_ptr<MessageCoalescer>>& coalescers,
+        const std::unordered_map<std::string, std::shared_ptr<const OutputEndpoint>>& outputs,
+        const std::unordered_map<std::string, DeviceHandle>& handles,
+        const std::unordered_map<std::string, int64_t>& delays);
+
+    /**
+     * @brief Routes matching a message
+     * @param source Source device (INVALID_DEVICE_HANDLE = unknown: every
+     *        route, whatever its source, as MidiRouter has always done for
+     *        local messages)
+     * @param status Status byte of the message
+     */
+    RouteRange lookup(DeviceHandle source, uint8_t status) const;
+
+    size_t getRouteCount() const { return routes_.size(); }
+
+private:
+    /**
+     * @struct Index
+     * @brief Route indices for each of the 256 status bytes (flattened)
+     */
+    struct Index {
+        std::array<uint32_t, 257> offsets{};
+        std::vector<uint16_t> entries;
+    };
+
+    /**
+     * @brief Build an index over the routes accepted by a source predicate
+     */
+    template<typename Predicate>
+    Index buildIndex(Predicate accept) const;
+
+    RouteRange range(const Index& index, uint8_t status) const;
+
+    /// Enabled routes, highest priority first
+    std::vector<CompiledRoute> routes_;
+
+    /// Every route (source unknown)
+    Index allSources_;
+
+    /// Routes without a source filter (source with no dedicated route)
+    Index anySource_;
+
+    /// Routes for a given source plus the routes without a source filter
+    std::vector<Index> sourceIndexes_;
+
+    /// Position in sourceIndexes_ by source handle (NO_INDEX: anySource_)
+    static constexpr uint32_t NO_INDEX = UINT32_MAX;
+    std::vector<uint32_t> bySource_;
+};
+
+} // namespace midiMind
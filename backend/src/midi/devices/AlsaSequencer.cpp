@@ -0,0 +1,507 @@
+// ============================================================================
+// File: backend/src/midi/devices/AlsaSequencer.cpp
+// Version: 4.2.6
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "AlsaSequencer.h"
+#include "../../core/Logger.h"
+#include <vector>
+#include <cerrno>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace midiMind {
+
+// ============================================================================
+// SHARED INSTANCE
+// ============================================================================
+
+std::shared_ptr<AlsaSequencer> AlsaSequencer::acquire() {
+    static std::mutex instanceMutex;
+    static std::weak_ptr<AlsaSequencer> instance;
+
+    std::lock_guard<std::mutex> lock(instanceMutex);
+
+    auto sequencer = instance.lock();
+    if (sequencer) {
+        return sequencer;
+    }
+
+    snd_seq_t* seq = nullptr;
+    int result = snd_seq_open(&seq, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK);
+    if (result < 0) {
+        Logger::error("AlsaSequencer",
+            "Failed to open ALSA sequencer: " + std::string(snd_strerror(result)));
+        return nullptr;
+    }
+
+    sequencer.reset(new AlsaSequencer(seq), &AlsaSequencer::release);
+    instance = sequencer;
+    return sequencer;
+}
+
+void AlsaSequencer::release(AlsaSequencer* sequencer) {
+    // The last device may be released from one of its own handlers: the
+    // reactor is still inside dispatch() and cannot join itself, so the
+    // client is destroyed once it has returned, from another thread
+    if (sequencer->reactorThread_.get_id() == std::this_thread::get_id()) {
+        std::thread([sequencer]() { delete sequencer; }).detach();
+        return;
+    }
+
+    delete sequencer;
+}
+
+// ============================================================================
+// CONSTRUCTOR / DESTRUCTOR
+// ============================================================================
+
+AlsaSequencer::AlsaSequencer(snd_seq_t* seq)
+    : seq_(seq)
+    , clientId_(snd_seq_client_id(seq))
+    , stopFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , running_(true)
+    , dispatching_(-1)
+    , queueId_(-1)
+    , probePort_(-1)
+    , wakeups_(0)
+    , eventsReceived_(0)
+    , eventsSent_(0)
+    , unrouted_(0)
+    , errors_(0)
+    , eventsQueued_(0)
+{
+    snd_seq_set_client_name(seq_, "MidiMind");
+
+    startQueue();
+
+    reactorThread_ = std::thread(&AlsaSequencer::reactorLoop, this);
+
+    // Input is on the thru path: keep it ahead of API and file work
+    sched_param param{};
+    param.sched_priority = THREAD_PRIORITY;
+    int result = pthread_setschedparam(reactorThread_.native_handle(), SCHED_FIFO, &param);
+    if (result != 0) {
+        Logger::debug("AlsaSequencer",
+            "Real-time priority not available (error " + std::to_string(result) + ")");
+    }
+
+    Logger::info("AlsaSequencer", "Sequencer client " + std::to_string(clientId_) + " opened");
+}
+
+AlsaSequencer::~AlsaSequencer() {
+    running_ = false;
+
+    if (stopFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(stopFd_, &one, sizeof(one));
+        (void)written;
+    }
+
+    // Not the reactor thread (release()): it finishes its dispatch first
+    if (reactorThread_.joinable()) {
+        reactorThread_.join();
+    }
+
+    if (stopFd_ >= 0) {
+        close(stopFd_);
+    }
+
+    if (queueId_ >= 0) {
+        snd_seq_stop_queue(seq_, queueId_, nullptr);
+        snd_seq_drain_output(seq_);
+        snd_seq_free_queue(seq_, queueId_);
+    }
+
+    snd_seq_close(seq_);
+
+    Logger::info("AlsaSequencer", "Sequencer client closed");
+}
+
+// ============================================================================
+// PORTS
+// ============================================================================
+
+int AlsaSequencer::createPort(const std::string& name, unsigned int caps,
+                              unsigned int type, EventHandler handler) {
+    int port = snd_seq_create_simple_port(seq_, name.c_str(), caps, type);
+    if (port < 0) {
+        errors_++;
+        return port;
+    }
+
+    std::lock_guard<std::mutex> lock(handlersMutex_);
+    handlers_[port] = std::make_shared<const EventHandler>(std::move(handler));
+
+    Logger::debug("AlsaSequencer", "Created port " + std::to_string(port) + ": " + name);
+    return port;
+}
+
+void AlsaSequencer::deletePort(int port) {
+    {
+        std::unique_lock<std::mutex> lock(handlersMutex_);
+        handlers_.erase(port);
+
+        if (reactorThread_.get_id() != std::this_thread::get_id()) {
+            dispatchDone_.wait(lock, [this, port] { return dispatching_ != port; });
+        }
+    }
+
+    snd_seq_delete_simple_port(seq_, port);
+
+    Logger::debug("AlsaSequencer", "Deleted port " + std::to_string(port));
+}
+
+bool AlsaSequencer::getPortCapability(int port, unsigned int& caps) const {
+    snd_seq_port_info_t* pinfo;
+    snd_seq_port_info_alloca(&pinfo);
+
+    if (snd_seq_get_port_info(seq_, port, pinfo) < 0) {
+        return false;
+    }
+
+    caps = snd_seq_port_info_get_capability(pinfo);
+    return true;
+}
+
+int AlsaSequencer::connectTo(int port, int client, int remotePort) {
+    return snd_seq_connect_to(seq_, port, client, remotePort);
+}
+
+int AlsaSequencer::connectFrom(int port, int client, int remotePort) {
+    return snd_seq_connect_from(seq_, port, client, remotePort);
+}
+
+void AlsaSequencer::disconnectTo(int port, int client, int remotePort) {
+    snd_seq_disconnect_to(seq_, port, client, remotePort);
+}
+
+void AlsaSequencer::disconnectFrom(int port, int client, int remotePort) {
+    snd_seq_disconnect_from(seq_, port, client, remotePort);
+}
+
+// ============================================================================
+// OTHER CLIENTS
+// ============================================================================
+
+bool AlsaSequencer::getClientInfo(int client, ClientInfo& info) const {
+    return queryClientInfo(seq_, client, info);
+}
+
+std::vector<AlsaSequencer::PortInfo> AlsaSequencer::getClientPorts(int client) const {
+    return queryClientPorts(seq_, client);
+}
+
+bool AlsaSequencer::queryClientInfo(snd_seq_t* seq, int client, ClientInfo& info) {
+    snd_seq_client_info_t* cinfo;
+    snd_seq_client_info_alloca(&cinfo);
+
+    if (snd_seq_get_any_client_info(seq, client, cinfo) < 0) {
+        return false;
+    }
+
+    const char* name = snd_seq_client_info_get_name(cinfo);
+    info.client = client;
+    info.name = name ? name : "";
+    info.card = snd_seq_client_info_get_card(cinfo);
+    return true;
+}
+
+std::vector<AlsaSequencer::PortInfo> AlsaSequencer::queryClientPorts(snd_seq_t* seq, int client) {
+    std::vector<PortInfo> ports;
+
+    snd_seq_port_info_t* pinfo;
+    snd_seq_port_info_alloca(&pinfo);
+
+    snd_seq_port_info_set_client(pinfo, client);
+    snd_seq_port_info_set_port(pinfo, -1);
+
+    while (snd_seq_query_next_port(seq, pinfo) >= 0) {
+        const char* name = snd_seq_port_info_get_name(pinfo);
+
+        PortInfo port;
+        port.port = snd_seq_port_info_get_port(pinfo);
+        port.name = name ? name : "";
+        port.caps = snd_seq_port_info_get_capability(pinfo);
+        ports.push_back(std::move(port));
+    }
+
+    return ports;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+size_t AlsaSequencer::output(snd_seq_event_t* events, size_t count) {
+    size_t sent = 0;
+
+    std::lock_guard<std::mutex> lock(outputMutex_);
+
+    for (size_t i = 0; i < count; ++i) {
+        int result = snd_seq_event_output(seq_, &events[i]);
+        if (result < 0) {
+            Logger::error("AlsaSequencer", "Failed to send event: " +
+                         std::string(snd_strerror(result)));
+            errors_++;
+            continue;
+        }
+        sent++;
+    }
+
+    // One kernel flush for the whole burst
+    snd_seq_drain_output(seq_);
+
+    eventsSent_ += sent;
+    return sent;
+}
+
+size_t AlsaSequencer::outputAt(snd_seq_event_t* events, size_t count, Clock::time_point due) {
+    if (queueId_ < 0) {
+        return output(events, count);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        scheduleAt(&events[i], due);
+    }
+
+    size_t sent = 0;
+
+    std::lock_guard<std::mutex> lock(outputMutex_);
+
+    for (size_t i = 0; i < count; ++i) {
+        int result = snd_seq_event_output(seq_, &events[i]);
+        if (result < 0) {
+            Logger::error("AlsaSequencer", "Failed to queue event: " +
+                         std::string(snd_strerror(result)));
+            errors_++;
+            continue;
+        }
+        sent++;
+    }
+
+    // Echo to ourselves at the same time: measures the queue's punctuality
+    if (probePort_ >= 0 && sent > 0) {
+        snd_seq_event_t probe;
+        snd_seq_ev_clear(&probe);
+        probe.type = SND_SEQ_EVENT_ECHO;
+        snd_seq_ev_set_source(&probe, probePort_);
+        snd_seq_ev_set_dest(&probe, clientId_, probePort_);
+        scheduleAt(&probe, due);
+        snd_seq_event_output(seq_, &probe);
+    }
+
+    snd_seq_drain_output(seq_);
+
+    eventsSent_ += sent;
+    eventsQueued_ += sent;
+    return sent;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+json AlsaSequencer::getStatistics() const {
+    size_t ports;
+    {
+        std::lock_guard<std::mutex> lock(handlersMutex_);
+        ports = handlers_.size();
+    }
+
+    return json{
+        {"client", clientId_},
+        {"ports", ports},
+        {"wakeups", wakeups_.load()},
+        {"events_received", eventsReceived_.load()},
+        {"events_sent", eventsSent_.load()},
+        {"unrouted", unrouted_.load()},
+        {"errors", errors_.load()},
+        {"queue", queueId_},
+        {"events_queued", eventsQueued_.load()},
+        {"queue_lateness", queueLateness_.toJson()}
+    };
+}
+
+// ============================================================================
+// PRIVATE METHODS - QUEUE
+// ============================================================================
+
+void AlsaSequencer::startQueue() {
+    int queue = snd_seq_alloc_named_queue(seq_, "MidiMind");
+    if (queue < 0) {
+        Logger::warning("AlsaSequencer",
+            "No output queue (direct output only): " + std::string(snd_strerror(queue)));
+        return;
+    }
+
+    int result = snd_seq_start_queue(seq_, queue, nullptr);
+    if (result >= 0) {
+        result = snd_seq_drain_output(seq_);
+    }
+    if (result < 0) {
+        Logger::warning("AlsaSequencer",
+            "Failed to start output queue: " + std::string(snd_strerror(result)));
+        snd_seq_free_queue(seq_, queue);
+        return;
+    }
+
+    // Read the queue clock between two readings of ours: queue time 0 is
+    // then known to within half that interval
+    snd_seq_queue_status_t* status;
+    snd_seq_queue_status_alloca(&status);
+
+    auto before = Clock::now();
+    result = snd_seq_get_queue_status(seq_, queue, status);
+    auto after = Clock::now();
+
+    if (result < 0) {
+        Logger::warning("AlsaSequencer",
+            "Failed to read queue time: " + std::string(snd_strerror(result)));
+        snd_seq_free_queue(seq_, queue);
+        return;
+    }
+
+    const snd_seq_real_time_t* queueTime = snd_seq_queue_status_get_real_time(status);
+    auto elapsed = std::chrono::seconds(queueTime->tv_sec) +
+                   std::chrono::nanoseconds(queueTime->tv_nsec);
+
+    queueEpoch_ = before + (after - before) / 2 -
+                  std::chrono::duration_cast<Clock::duration>(elapsed);
+    queueId_ = queue;
+
+    int probe = createPort("Timing probe",
+                           SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_NO_EXPORT,
+                           SND_SEQ_PORT_TYPE_APPLICATION,
+                           [this](const snd_seq_event_t* ev) { handleProbe(ev); });
+    probePort_ = probe >= 0 ? probe : -1;
+
+    Logger::info("AlsaSequencer", "Output queue " + std::to_string(queue) + " started");
+}
+
+void AlsaSequencer::scheduleAt(snd_seq_event_t* ev, Clock::time_point due) const {
+    int64_t ns = due > queueEpoch_ ?
+        std::chrono::duration_cast<std::chrono::nanoseconds>(due - queueEpoch_).count() : 0;
+
+    snd_seq_real_time_t time;
+    time.tv_sec = static_cast<unsigned int>(ns / 1000000000);
+    time.tv_nsec = static_cast<unsigned int>(ns % 1000000000);
+
+    snd_seq_ev_schedule_real(ev, queueId_, 0, &time);
+}
+
+void AlsaSequencer::handleProbe(const snd_seq_event_t* ev) {
+    if (ev->type != SND_SEQ_EVENT_ECHO) {
+        return;
+    }
+
+    auto now = Clock::now();
+    auto due = queueEpoch_ + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::seconds(ev->time.time.tv_sec) +
+        std::chrono::nanoseconds(ev->time.time.tv_nsec));
+
+    queueLateness_.record(now > due ?
+        std::chrono::duration_cast<std::chrono::microseconds>(now - due).count() : 0);
+}
+
+// ============================================================================
+// PRIVATE METHODS - REACTOR
+// ============================================================================
+
+void AlsaSequencer::reactorLoop() {
+    Logger::debug("AlsaSequencer", "Reactor thread started");
+
+    int count = snd_seq_poll_descriptors_count(seq_, POLLIN);
+    std::vector<struct pollfd> fds(static_cast<size_t>(count > 0 ? count : 0) + 1);
+
+    fds[0].fd = stopFd_;
+    fds[0].events = POLLIN;
+    snd_seq_poll_descriptors(seq_, fds.data() + 1, static_cast<unsigned int>(fds.size() - 1), POLLIN);
+
+    while (running_) {
+        int result = poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::error("AlsaSequencer", "poll() failed: " + std::to_string(errno));
+            errors_++;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            break;      // Shutdown
+        }
+
+        wakeups_++;
+        drainInput();
+    }
+
+    Logger::debug("AlsaSequencer", "Reactor thread stopped");
+}
+
+void AlsaSequencer::drainInput() {
+    while (running_) {
+        snd_seq_event_t* ev = nullptr;
+        int result = snd_seq_event_input(seq_, &ev);
+
+        if (result == -EAGAIN) {
+            return;     // Everything pending has been handled
+        }
+
+        if (result < 0) {
+            // -ENOSPC: the kernel queue overflowed and events were lost;
+            // carry on with what is left
+            Logger::warning("AlsaSequencer",
+                "Error receiving event: " + std::string(snd_strerror(result)));
+            errors_++;
+            if (result != -ENOSPC) {
+                return;
+            }
+            continue;
+        }
+
+        // ev points into ALSA's input buffer (valid until the next input call)
+        if (ev) {
+            eventsReceived_++;
+            dispatch(ev);
+        }
+    }
+}
+
+void AlsaSequencer::dispatch(const snd_seq_event_t* ev) {
+    int port = ev->dest.port;
+    std::shared_ptr<const EventHandler> handler;
+
+    {
+        std::lock_guard<std::mutex> lock(handlersMutex_);
+
+        auto it = handlers_.find(port);
+        if (it == handlers_.end()) {
+            unrouted_++;
+            return;
+        }
+
+        handler = it->second;
+        dispatching_ = port;
+    }
+
+    try {
+        (*handler)(ev);
+    } catch (const std::exception& e) {
+        Logger::error("AlsaSequencer", "Event handler failed: " + std::string(e.what()));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(handlersMutex_);
+        dispatching_ = -1;
+    }
+    dispatchDone_.notify_all();
+}
+
+} // namespace midiMind
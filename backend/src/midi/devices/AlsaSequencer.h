@@ -0,0 +1,281 @@
+// ============================================================================
+// File: backend/src/midi/devices/AlsaSequencer.h
+// Version: 4.2.6
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Changes v4.2.6:
+//   - ADDED: getClientInfo() / getClientPorts(): other clients are queried
+//     through this client (hot-plug no longer opens one per announcement)
+//
+// Changes v4.2.5:
+//   - FIXED: releasing the last reference from an event handler destroyed
+//     the client on its own reactor thread (thread detached, object freed
+//     under the running dispatch); that release is now handed to another
+//     thread, which joins the reactor before destroying it
+//
+// Changes v4.2.4:
+//   - Output queue: outputAt() schedules events on an ALSA queue with
+//     real-time stamps, so the kernel delivers them at their time
+//   - Queue timing probe: an echo event per scheduled burst measures how
+//     punctually the queue delivers
+//
+// Description:
+//   The process's single ALSA sequencer client ("MidiMind").
+//   Every USB and virtual device gets one port on this client instead of
+//   opening a client and a receive thread of its own. One reactor thread
+//   sleeps in poll() on the sequencer's descriptors, drains every pending
+//   event when woken and hands each one to the device owning its
+//   destination port.
+//
+// Features:
+//   - Shared: acquire() returns the running client, opened on first use
+//     and closed when the last device releases it
+//   - Input: one thread for all devices, woken only by input
+//   - Output: events of a burst are queued and drained once
+//   - Port removal waits for a dispatch in progress, so a device never
+//     receives an event after deletePort() returns
+//
+// ============================================================================
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "../../timing/LatencyHistogram.h"
+
+#ifdef __linux__
+#include <alsa/asoundlib.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace midiMind {
+
+/**
+ * @class AlsaSequencer
+ * @brief Shared sequencer client with a poll()-driven input reactor
+ *
+ * Thread Safety: All public methods are thread-safe. Event handlers run
+ * on the reactor thread, one event at a time.
+ *
+ * Example:
+ * ```cpp
+ * auto sequencer = AlsaSequencer::acquire();
+ * int port = sequencer->createPort("Synth", caps, type,
+ *     [this](const snd_seq_event_t* ev) { processAlsaEvent(ev); });
+ * sequencer->connectTo(port, 20, 0);
+ * ...
+ * sequencer->deletePort(port);
+ * ```
+ */
+class AlsaSequencer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Receives the events addressed to one port (reactor thread)
+    using EventHandler = std::function<void(const snd_seq_event_t*)>;
+
+    /// SCHED_FIFO priority requested for the reactor thread
+    static constexpr int THREAD_PRIORITY = 80;
+
+    /// Another client of the sequencer
+    struct ClientInfo {
+        int client = -1;
+        std::string name;
+        int card = -1;                      ///< -1 if not a sound card's client
+    };
+
+    /// A port of another client
+    struct PortInfo {
+        int port = -1;
+        std::string name;
+        unsigned int caps = 0;              ///< SND_SEQ_PORT_CAP_* flags
+    };
+
+    /**
+     * @brief Shared client, opened if no device holds it yet
+     * @return std::shared_ptr<AlsaSequencer> Client, or nullptr if the
+     *         sequencer cannot be opened
+     */
+    static std::shared_ptr<AlsaSequencer> acquire();
+
+    /**
+     * @brief Destructor (stops and joins the reactor, closes the client)
+     * @note Never runs on the reactor thread: acquire()'s deleter moves a
+     *       release made there to another thread
+     */
+    ~AlsaSequencer();
+
+    AlsaSequencer(const AlsaSequencer&) = delete;
+    AlsaSequencer& operator=(const AlsaSequencer&) = delete;
+
+    int getClientId() const { return clientId_; }
+
+    // ========================================================================
+    // PORTS
+    // ========================================================================
+
+    /**
+     * @brief Create a port and route its input to a handler
+     * @param name Port name
+     * @param caps SND_SEQ_PORT_CAP_* flags
+     * @param type SND_SEQ_PORT_TYPE_* flags
+     * @param handler Called for each event addressed to the port
+     * @return int Port number, or a negative ALSA error code
+     */
+    int createPort(const std::string& name, unsigned int caps, unsigned int type,
+                   EventHandler handler);
+
+    /**
+     * @brief Delete a port; its handler is not called after this returns
+     *        (unless called from that handler)
+     */
+    void deletePort(int port);
+
+    /**
+     * @brief Capabilities of one of our ports
+     * @return bool false if the port does not exist
+     */
+    bool getPortCapability(int port, unsigned int& caps) const;
+
+    /// Subscribe a remote port to our port's output (0 or ALSA error code)
+    int connectTo(int port, int client, int remotePort);
+
+    /// Subscribe our port to a remote port's output (0 or ALSA error code)
+    int connectFrom(int port, int client, int remotePort);
+
+    void disconnectTo(int port, int client, int remotePort);
+    void disconnectFrom(int port, int client, int remotePort);
+
+    // ========================================================================
+    // OTHER CLIENTS
+    // ========================================================================
+
+    /**
+     * @brief Describe another client
+     * @return bool false if the client does not exist
+     */
+    bool getClientInfo(int client, ClientInfo& info) const;
+
+    /**
+     * @brief Ports of another client, in port order
+     */
+    std::vector<PortInfo> getClientPorts(int client) const;
+
+    /**
+     * @brief Same queries on a handle of one's own (full scans)
+     */
+    static bool queryClientInfo(snd_seq_t* seq, int client, ClientInfo& info);
+    static std::vector<PortInfo> queryClientPorts(snd_seq_t* seq, int client);
+
+    // ========================================================================
+    // OUTPUT
+    // ========================================================================
+
+    /**
+     * @brief Send prepared events (source, destination and timing set)
+     * @param events Events in order
+     * @param count Number of events (drained to the kernel together)
+     * @return size_t Number of events accepted
+     */
+    size_t output(snd_seq_event_t* events, size_t count);
+
+    /**
+     * @brief Whether the output queue is running (outputAt() available)
+     */
+    bool hasQueue() const { return queueId_ >= 0; }
+
+    /**
+     * @brief Send prepared events (source and destination set), delivered
+     *        by the kernel at a given time
+     * @param events Events in order (their timing fields are overwritten)
+     * @param count Number of events
+     * @param due Delivery time (now or earlier = as soon as possible); the
+     *        kernel orders queued events by time, so a caller that needs
+     *        send order kept must not go back in time
+     * @return size_t Number of events accepted
+     */
+    size_t outputAt(snd_seq_event_t* events, size_t count, Clock::time_point due);
+
+    // ========================================================================
+    // STATISTICS
+    // ========================================================================
+
+    /**
+     * @brief Statistics
+     * @return json {client, ports, wakeups, events_received, events_sent,
+     *         unrouted, errors, queue, events_queued,
+     *         queue_lateness: histogram of probe delivery - due time (µs,
+     *         includes the reactor's wake-up)}
+     */
+    json getStatistics() const;
+
+private:
+    explicit AlsaSequencer(snd_seq_t* seq);
+
+    /// Deleter of the shared instance
+    static void release(AlsaSequencer* sequencer);
+
+    /**
+     * @brief Allocate and start the output queue, create the probe port
+     *        (constructor; on failure only direct output is available)
+     */
+    void startQueue();
+
+    /// Stamp an event for delivery on the queue at a given time
+    void scheduleAt(snd_seq_event_t* ev, Clock::time_point due) const;
+
+    /// Probe port handler: punctuality of the queue (reactor thread)
+    void handleProbe(const snd_seq_event_t* ev);
+
+    void reactorLoop();
+
+    /// Drain every pending event (reactor thread)
+    void drainInput();
+
+    void dispatch(const snd_seq_event_t* ev);
+
+    snd_seq_t* seq_;
+
+    int clientId_;
+
+    /// Wakes the reactor for shutdown
+    int stopFd_;
+
+    std::thread reactorThread_;
+    std::atomic<bool> running_;
+
+    /// Handlers by port (shared: a running handler outlives its removal)
+    std::unordered_map<int, std::shared_ptr<const EventHandler>> handlers_;
+    mutable std::mutex handlersMutex_;
+    std::condition_variable dispatchDone_;
+    int dispatching_;                       ///< Port being dispatched, -1 if none
+
+    /// Serializes the client's output buffer
+    std::mutex outputMutex_;
+
+    int queueId_;                           ///< -1 if no queue
+    Clock::time_point queueEpoch_;          ///< Our clock at queue time 0
+    int probePort_;                         ///< -1 if no probe
+
+    // Statistics
+    std::atomic<uint64_t> wakeups_;
+    std::atomic<uint64_t> eventsReceived_;
+    std::atomic<uint64_t> eventsSent_;
+    std::atomic<uint64_t> unrouted_;
+    std::atomic<uint64_t> errors_;
+    std::atomic<uint64_t> eventsQueued_;
+    LatencyHistogram queueLateness_;        ///< Probe received - due time (µs)
+};
+
+} // namespace midiMind
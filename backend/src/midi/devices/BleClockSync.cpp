@@ -0,0 +1,242 @@
+// ============================================================================
+// File: backend/src/midi/devices/BleClockSync.cpp
+// Version: 2.0.5
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "BleClockSync.h"
+#include <algorithm>
+#include <cmath>
+
+namespace midiMind {
+
+// Sender timestamps count milliseconds modulo 8192
+static constexpr int64_t TIMESTAMP_PERIOD_MS = 8192;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+BleClockSync::BleClockSync()
+    : synchronized_(false)
+    , senderMs_(0)
+    , lastArrivalUs_(0)
+    , current_(0)
+    , origin_(0)
+    , offset_(0)
+    , drift_(0)
+    , jitterMean_(0)
+    , jitterDeviation_(0)
+    , offsetUs_(0)
+    , driftPpm_(0)
+    , jitterMeanUs_(0)
+    , jitterDeviationUs_(0)
+    , maxJitterUs_(0)
+    , packets_(0)
+    , resyncs_(0)
+{
+}
+
+void BleClockSync::reset() {
+    synchronized_ = false;
+    windows_.fill(Window());
+    current_ = 0;
+    drift_ = 0;
+    jitterMean_ = 0;
+    jitterDeviation_ = 0;
+    maxJitterUs_ = 0;
+}
+
+json BleClockSync::getStatistics() const {
+    return json{
+        {"synchronized", synchronized_.load()},
+        {"offset_us", offsetUs_.load()},
+        {"drift_ppm", driftPpm_.load()},
+        {"jitter_mean_us", jitterMeanUs_.load()},
+        {"jitter_deviation_us", jitterDeviationUs_.load()},
+        {"jitter_max_us", maxJitterUs_.load()},
+        {"packets", packets_.load()},
+        {"resyncs", resyncs_.load()}
+    };
+}
+
+// ============================================================================
+// ESTIMATION
+// ============================================================================
+
+int64_t BleClockSync::observe(uint16_t senderMs, uint64_t arrivalUs) {
+    packets_++;
+
+    if (!synchronized_) {
+        senderMs_ = senderMs;
+        lastArrivalUs_ = arrivalUs;
+        restart(senderMs * 1000.0, arrivalUs);
+        synchronized_ = true;
+        return 0;
+    }
+
+    // Unwrap: the sender clock advanced about as much as ours
+    int64_t elapsedMs = arrivalUs > lastArrivalUs_ ?
+        static_cast<int64_t>((arrivalUs - lastArrivalUs_) / 1000) : 0;
+    int64_t expected = senderMs_ + elapsedMs;
+    int64_t distance = expected - senderMs + TIMESTAMP_PERIOD_MS / 2;
+    int64_t periods = distance >= 0 ? distance / TIMESTAMP_PERIOD_MS :
+        -((-distance + TIMESTAMP_PERIOD_MS - 1) / TIMESTAMP_PERIOD_MS);
+
+    senderMs_ = senderMs + periods * TIMESTAMP_PERIOD_MS;
+    lastArrivalUs_ = arrivalUs;
+
+    double senderUs = senderMs_ * 1000.0;
+    double delay = static_cast<double>(arrivalUs) - senderUs;
+
+    if (std::fabs(delay - floorAt(senderUs)) > RESYNC_THRESHOLD_US) {
+        resyncs_++;
+        restart(senderUs, arrivalUs);
+        return 0;
+    }
+
+    Window* window = &windows_[current_];
+
+    if (arrivalUs - window->startUs >= WINDOW_US) {
+        current_ = (current_ + 1) % WINDOW_COUNT;
+        window = &windows_[current_];
+        *window = Window();
+        window->startUs = arrivalUs;
+        window->senderUs = senderUs;
+        window->minDelayUs = delay;
+        window->used = true;
+        fit();
+    } else if (delay < window->minDelayUs) {
+        window->minDelayUs = delay;
+        window->senderUs = senderUs;
+
+        // A new floor applies at once; the slope waits for the window
+        double below = floorAt(senderUs) - delay;
+        if (below > 0) {
+            offset_ -= below;
+            offsetUs_ = std::llround(offset_);
+        }
+    }
+
+    int64_t jitter = std::max<int64_t>(0, std::llround(delay - floorAt(senderUs)));
+    window->maxJitterUs = std::max(window->maxJitterUs, jitter);
+
+    double diff = jitter - jitterMean_;
+    jitterMean_ += diff / 16.0;
+    jitterDeviation_ += (std::fabs(diff) - jitterDeviation_) / 16.0;
+
+    int64_t maxJitter = 0;
+    for (const Window& w : windows_) {
+        if (w.used) {
+            maxJitter = std::max(maxJitter, w.maxJitterUs);
+        }
+    }
+
+    maxJitterUs_ = maxJitter;
+    jitterMeanUs_ = std::llround(jitterMean_);
+    jitterDeviationUs_ = std::llround(jitterDeviation_);
+
+    return jitter;
+}
+
+uint64_t BleClockSync::toHost(uint16_t senderMs) const {
+    if (!synchronized_) {
+        return 0;
+    }
+
+    int64_t age = (senderMs_ - senderMs) & (TIMESTAMP_PERIOD_MS - 1);
+    double senderUs = (senderMs_ - age) * 1000.0;
+    double host = senderUs + floorAt(senderUs);
+
+    return host > 0 ? static_cast<uint64_t>(host) : 0;
+}
+
+double BleClockSync::floorAt(double senderUs) const {
+    return offset_ + drift_ * (senderUs - origin_);
+}
+
+void BleClockSync::fit() {
+    // The window just opened has too few packets for a true minimum: it
+    // only enters the fit while it is the sole window
+    size_t previous = (current_ + WINDOW_COUNT - 1) % WINDOW_COUNT;
+    bool alone = !windows_[previous].used;
+
+    auto fitted = [this, alone](size_t index) {
+        return windows_[index].used && (index != current_ || alone);
+    };
+
+    size_t count = 0;
+    double meanX = 0;
+    double meanY = 0;
+
+    for (size_t i = 0; i < WINDOW_COUNT; ++i) {
+        if (fitted(i)) {
+            meanX += windows_[i].senderUs;
+            meanY += windows_[i].minDelayUs;
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    meanX /= count;
+    meanY /= count;
+
+    // Least-squares slope of the window minima; too short a span says
+    // nothing about drift
+    double sxx = 0;
+    double sxy = 0;
+    for (size_t i = 0; i < WINDOW_COUNT; ++i) {
+        if (fitted(i)) {
+            const Window& w = windows_[i];
+            sxx += (w.senderUs - meanX) * (w.senderUs - meanX);
+            sxy += (w.senderUs - meanX) * (w.minDelayUs - meanY);
+        }
+    }
+
+    double drift = 0;
+    if (count >= 3 && sxx > 0) {
+        drift = std::clamp(sxy / sxx, -MAX_DRIFT_PPM * 1e-6, MAX_DRIFT_PPM * 1e-6);
+    }
+
+    origin_ = meanX;
+    drift_ = drift;
+    offset_ = meanY;
+
+    // Lower the line under every minimum: it is a floor, not an average
+    double excess = 0;
+    for (const Window& w : windows_) {
+        if (w.used) {
+            excess = std::max(excess, floorAt(w.senderUs) - w.minDelayUs);
+        }
+    }
+    offset_ -= excess;
+
+    offsetUs_ = std::llround(offset_);
+    driftPpm_ = drift_ * 1e6;
+}
+
+void BleClockSync::restart(double senderUs, uint64_t arrivalUs) {
+    windows_.fill(Window());
+    current_ = 0;
+
+    Window& window = windows_[0];
+    window.startUs = arrivalUs;
+    window.senderUs = senderUs;
+    window.minDelayUs = static_cast<double>(arrivalUs) - senderUs;
+    window.used = true;
+
+    origin_ = senderUs;
+    offset_ = window.minDelayUs;
+    drift_ = 0;
+    jitterMean_ = 0;
+    jitterDeviation_ = 0;
+
+    offsetUs_ = std::llround(offset_);
+    driftPpm_ = 0;
+    maxJitterUs_ = 0;
+}
+
+} // namespace midiMind
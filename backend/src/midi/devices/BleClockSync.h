@@ -0,0 +1,145 @@
+// ============================================================================
+// File: backend/src/midi/devices/BleClockSync.h
+// Version: 2.0.5
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Maps the 13-bit millisecond clock of a BLE-MIDI sender onto
+//   TimestampManager time. Packets wait a variable time for their
+//   connection event (7.5-30 ms steps), but the fastest ones show the
+//   true offset between the clocks: the estimate follows the floor of
+//   (arrival - sender time), and its slope over several seconds gives
+//   the drift between the two oscillators.
+//
+// Features:
+//   - Sender timestamps unwrapped (8192 ms period) using arrival times
+//   - Offset: minimum per 2 s window; drift: least-squares slope of the
+//     minima of the last completed windows (up to 14 s)
+//   - Jitter: each packet's delay above the floor (mean, deviation, max)
+//   - Re-sync when the sender clock jumps (reconnection, reset)
+//
+// ============================================================================
+
+#pragma once
+
+#include "../MidiMessage.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace midiMind {
+
+/**
+ * @class BleClockSync
+ * @brief Offset and drift estimate between a BLE-MIDI sender and the host
+ *
+ * Thread Safety: Not thread-safe (one receive thread), except
+ * getStatistics().
+ *
+ * Example:
+ * ```cpp
+ * BleClockSync clock;
+ * clock.observe(newestTimestamp, TimestampManager::instance().now());
+ * uint64_t sentAt = clock.toHost(timestamps[i]);  // host µs, floor delay
+ * ```
+ */
+class BleClockSync {
+public:
+    /// Length of one minimum window (µs)
+    static constexpr uint64_t WINDOW_US = 2000000;
+
+    /// Windows kept for the drift fit
+    static constexpr size_t WINDOW_COUNT = 8;
+
+    /// A delay this far from the floor means the sender clock jumped (µs)
+    static constexpr int64_t RESYNC_THRESHOLD_US = 500000;
+
+    /// Drift beyond this is not a clock, it is an error in the fit (ppm)
+    static constexpr double MAX_DRIFT_PPM = 1000.0;
+
+    BleClockSync();
+
+    /**
+     * @brief Feed a packet
+     * @param senderMs Timestamp of the packet's newest message (13 bits)
+     * @param arrivalUs Arrival time (TimestampManager µs)
+     * @return int64_t Delay of this packet above the floor (µs, >= 0)
+     */
+    int64_t observe(uint16_t senderMs, uint64_t arrivalUs);
+
+    /**
+     * @brief Host time at which a message would have arrived with the
+     *        smallest delay seen
+     * @param senderMs Sender timestamp of a message of the last observed
+     *        packet (at most 8 s older than its newest message)
+     * @return uint64_t TimestampManager µs (0 before the first observe())
+     */
+    uint64_t toHost(uint16_t senderMs) const;
+
+    bool isSynchronized() const { return synchronized_.load(); }
+
+    /**
+     * @brief Largest jitter over the windows kept (µs)
+     */
+    int64_t getMaxJitter() const { return maxJitterUs_.load(); }
+
+    /**
+     * @brief Forget everything (new connection)
+     */
+    void reset();
+
+    /**
+     * @brief Statistics
+     * @return json {synchronized, offset_us, drift_ppm, jitter_mean_us,
+     *         jitter_deviation_us, jitter_max_us, packets, resyncs}
+     */
+    json getStatistics() const;
+
+private:
+    struct Window {
+        uint64_t startUs = 0;       ///< Arrival time of the first packet
+        double senderUs = 0;        ///< Sender time of the minimum (µs, unwrapped)
+        double minDelayUs = 0;      ///< Minimum of arrival - sender time
+        int64_t maxJitterUs = 0;
+        bool used = false;
+    };
+
+    /// Floor delay (arrival - sender time) predicted at a sender time
+    double floorAt(double senderUs) const;
+
+    /// Refit offset and drift from the window minima
+    void fit();
+
+    void restart(double senderUs, uint64_t arrivalUs);
+
+    std::atomic<bool> synchronized_;
+
+    // Unwrapped sender clock
+    int64_t senderMs_;                      ///< Newest timestamp, unwrapped
+    uint64_t lastArrivalUs_;
+
+    std::array<Window, WINDOW_COUNT> windows_;
+    size_t current_;
+
+    // Model: floor(x) = offset_ + drift_ * (x - origin_)
+    double origin_;
+    double offset_;
+    double drift_;
+
+    // Jitter (EWMA)
+    double jitterMean_;
+    double jitterDeviation_;
+
+    // Statistics (read from other threads)
+    std::atomic<int64_t> offsetUs_;
+    std::atomic<double> driftPpm_;
+    std::atomic<int64_t> jitterMeanUs_;
+    std::atomic<int64_t> jitterDeviationUs_;
+    std::atomic<int64_t> maxJitterUs_;
+    std::atomic<uint64_t> packets_;
+    std::atomic<uint64_t> resyncs_;
+};
+
+} // namespace midiMind
@@ -0,0 +1,214 @@
+// ============================================================================
+// File: backend/src/midi/devices/BleMidiDecoder.cpp
+// Version: 2.0.4
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "BleMidiDecoder.h"
+
+namespace midiMind {
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+BleMidiDecoder::BleMidiDecoder()
+    : runningStatus_(0)
+    , inSysEx_(false)
+    , lastTimestamp_(0)
+    , count_(0)
+    , packets_(0)
+    , messagesDecoded_(0)
+    , sysexDecoded_(0)
+    , malformedPackets_(0)
+    , droppedBytes_(0)
+    , sysexDropped_(0)
+{
+    sysex_.reserve(256);
+}
+
+void BleMidiDecoder::reset() {
+    runningStatus_ = 0;
+    inSysEx_ = false;
+    sysex_.clear();
+    lastTimestamp_ = 0;
+}
+
+json BleMidiDecoder::getStatistics() const {
+    return json{
+        {"packets", packets_.load()},
+        {"messages", messagesDecoded_.load()},
+        {"sysex", sysexDecoded_.load()},
+        {"malformed_packets", malformedPackets_.load()},
+        {"dropped_bytes", droppedBytes_.load()},
+        {"sysex_dropped", sysexDropped_.load()}
+    };
+}
+
+// ============================================================================
+// DECODING
+// ============================================================================
+
+void BleMidiDecoder::parse(const uint8_t* packet, size_t size) {
+    packets_++;
+
+    // Header: 1 0 t12..t7
+    if (size < 2 || (packet[0] & 0xC0) != 0x80) {
+        malformedPackets_++;
+        return;
+    }
+
+    uint16_t high = packet[0] & 0x3F;
+    int lastLow = -1;
+
+    // Data right after the header (SysEx continuation, running status)
+    // carries the previous timestamp's low bits
+    uint16_t timestamp = static_cast<uint16_t>((high << 7) | (lastTimestamp_ & 0x7F));
+
+    size_t i = 1;
+    while (i < size) {
+        uint8_t byte = packet[i];
+
+        if (byte & 0x80) {
+            // Timestamp byte; a smaller low part than the previous one
+            // means the low 7 bits wrapped
+            uint8_t low = byte & 0x7F;
+            if (lastLow >= 0 && low < lastLow) {
+                high = (high + 1) & 0x3F;
+            }
+            lastLow = low;
+            timestamp = static_cast<uint16_t>((high << 7) | low);
+            lastTimestamp_ = timestamp;
+
+            if (++i >= size) {
+                break;
+            }
+
+            byte = packet[i];
+            if (byte & 0x80) {
+                ++i;
+                handleStatus(byte, packet, size, i, timestamp);
+                continue;
+            }
+            // Data after a timestamp: running status, new time
+        }
+
+        if (inSysEx_) {
+            if (sysex_.size() >= MAX_SYSEX_SIZE) {
+                abortSysEx();
+                droppedBytes_++;
+            } else {
+                sysex_.push_back(byte);
+            }
+            ++i;
+            continue;
+        }
+
+        if (runningStatus_ == 0) {
+            droppedBytes_++;
+            ++i;
+            continue;
+        }
+
+        readMessage(runningStatus_, packet, size, i, timestamp);
+    }
+}
+
+void BleMidiDecoder::handleStatus(uint8_t status, const uint8_t* packet, size_t size,
+                                  size_t& i, uint16_t timestamp) {
+    if (status >= 0xF8) {
+        // Real-time: may appear anywhere, even inside SysEx
+        emit(&status, 1, timestamp);
+        return;
+    }
+
+    if (status == 0xF7) {
+        if (!inSysEx_) {
+            droppedBytes_++;
+            return;
+        }
+
+        sysex_.push_back(0xF7);
+        emit(sysex_.data(), sysex_.size(), timestamp);
+        sysexDecoded_++;
+        inSysEx_ = false;
+        sysex_.clear();
+        return;
+    }
+
+    if (inSysEx_) {
+        // Any other status ends an unterminated SysEx
+        abortSysEx();
+    }
+
+    if (status == 0xF0) {
+        inSysEx_ = true;
+        sysex_.clear();
+        sysex_.push_back(0xF0);
+        runningStatus_ = 0;
+        return;
+    }
+
+    // System common cancels running status; channel status sets it
+    runningStatus_ = status < 0xF0 ? status : 0;
+
+    readMessage(status, packet, size, i, timestamp);
+}
+
+void BleMidiDecoder::readMessage(uint8_t status, const uint8_t* packet, size_t size,
+                                 size_t& i, uint16_t timestamp) {
+    size_t length = dataLength(status);
+
+    uint8_t bytes[3] = {status, 0, 0};
+    for (size_t n = 0; n < length; ++n) {
+        if (i >= size || (packet[i] & 0x80)) {
+            // Truncated: what was read is lost, the next byte is parsed anew
+            droppedBytes_ += n;
+            return;
+        }
+        bytes[1 + n] = packet[i++];
+    }
+
+    emit(bytes, 1 + length, timestamp);
+}
+
+void BleMidiDecoder::abortSysEx() {
+    inSysEx_ = false;
+    sysex_.clear();
+    sysexDropped_++;
+}
+
+void BleMidiDecoder::emit(const uint8_t* bytes, size_t size, uint16_t timestamp) {
+    if (count_ == messages_.size()) {
+        messages_.emplace_back();
+        timestamps_.emplace_back();
+    }
+
+    messages_[count_] = MidiMessage(std::vector<uint8_t>(bytes, bytes + size));
+    timestamps_[count_] = timestamp & TIMESTAMP_MASK;
+    count_++;
+
+    messagesDecoded_++;
+}
+
+size_t BleMidiDecoder::dataLength(uint8_t status) {
+    switch (status & 0xF0) {
+        case 0xC0:
+        case 0xD0:
+            return 1;
+        case 0xF0:
+            switch (status) {
+                case 0xF1:
+                case 0xF3:
+                    return 1;
+                case 0xF2:
+                    return 2;
+                default:
+                    return 0;
+            }
+        default:
+            return 2;
+    }
+}
+
+} // namespace midiMind
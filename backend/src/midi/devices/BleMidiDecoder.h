@@ -0,0 +1,131 @@
+// ============================================================================
+// File: backend/src/midi/devices/BleMidiDecoder.h
+// Version: 2.0.4
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Streaming decoder for BLE-MIDI packets (Bluetooth LE MIDI specification
+//   1.0), the counterpart of BleMidiPacketizer. Every message of a packet
+//   is decoded, with its sender timestamp.
+//
+// Features:
+//   - Any number of messages per packet, with or without running status
+//     and timestamp bytes
+//   - 13-bit timestamps rebuilt from the header and the low timestamp
+//     bytes, including low-byte wrap-around within a packet
+//   - SysEx spanning any number of packets; real-time messages inside it
+//   - Malformed input is skipped byte by byte, never aborting the packet
+//
+// ============================================================================
+
+#pragma once
+
+#include "../MidiMessage.h"
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace midiMind {
+
+/**
+ * @class BleMidiDecoder
+ * @brief Decodes BLE-MIDI packets into MIDI messages
+ *
+ * State carried between packets (SysEx in progress, running status) makes
+ * one decoder per characteristic necessary.
+ *
+ * Thread Safety: Not thread-safe (one receive thread), except
+ * getStatistics().
+ *
+ * Example:
+ * ```cpp
+ * BleMidiDecoder decoder;
+ * decoder.decode(packet, size, [&](MidiMessage* messages,
+ *                                  const uint16_t* timestamps, size_t count) {
+ *     // messages[i] was sent at timestamps[i] (sender ms, 13 bits)
+ * });
+ * ```
+ */
+class BleMidiDecoder {
+public:
+    /// Longest SysEx accepted; longer ones are dropped
+    static constexpr size_t MAX_SYSEX_SIZE = 65536;
+
+    /// BLE-MIDI timestamps count milliseconds modulo 8192
+    static constexpr uint16_t TIMESTAMP_MASK = 0x1FFF;
+
+    BleMidiDecoder();
+
+    /**
+     * @brief Decode one packet
+     * @param packet Characteristic value (header byte first)
+     * @param size Packet size
+     * @param deliver Called once with the messages completed by this
+     *        packet, if any: void(MidiMessage* messages,
+     *        const uint16_t* timestamps, size_t count)
+     * @return size_t Number of messages delivered
+     */
+    template<typename Deliver>
+    size_t decode(const uint8_t* packet, size_t size, Deliver&& deliver) {
+        count_ = 0;
+        parse(packet, size);
+
+        if (count_ > 0) {
+            deliver(messages_.data(), timestamps_.data(), count_);
+        }
+        return count_;
+    }
+
+    /**
+     * @brief Forget SysEx in progress and running status (new connection)
+     */
+    void reset();
+
+    /**
+     * @brief Statistics
+     * @return json {packets, messages, sysex, malformed_packets,
+     *         dropped_bytes, sysex_dropped}
+     */
+    json getStatistics() const;
+
+private:
+    void parse(const uint8_t* packet, size_t size);
+
+    /// Handle a status byte; `i` indexes the byte after it
+    void handleStatus(uint8_t status, const uint8_t* packet, size_t size,
+                      size_t& i, uint16_t timestamp);
+
+    /// Read the data bytes of `status` starting at `i`
+    void readMessage(uint8_t status, const uint8_t* packet, size_t size,
+                     size_t& i, uint16_t timestamp);
+
+    void abortSysEx();
+
+    void emit(const uint8_t* bytes, size_t size, uint16_t timestamp);
+
+    /// Data bytes following a status byte
+    static size_t dataLength(uint8_t status);
+
+    // Carried between packets
+    uint8_t runningStatus_;                 ///< 0 if none
+    bool inSysEx_;
+    std::vector<uint8_t> sysex_;
+    uint16_t lastTimestamp_;
+
+    // Output of the current packet (slots reused)
+    std::vector<MidiMessage> messages_;
+    std::vector<uint16_t> timestamps_;
+    size_t count_;
+
+    // Statistics
+    std::atomic<uint64_t> packets_;
+    std::atomic<uint64_t> messagesDecoded_;
+    std::atomic<uint64_t> sysexDecoded_;
+    std::atomic<uint64_t> malformedPackets_;
+    std::atomic<uint64_t> droppedBytes_;
+    std::atomic<uint64_t> sysexDropped_;
+};
+
+} // namespace midiMind
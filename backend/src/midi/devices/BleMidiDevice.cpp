@@ -1,17 +1,23 @@
 // ============================================================================
 // File: backend/src/midi/devices/BleMidiDevice.cpp
-// Version: 2.0.0
+// Version: 2.0.6
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 
 #include "BleMidiDevice.h"
 #include "../../core/Logger.h"
 #include <gio/gio.h>
+#include <gio/gunixfdlist.h>
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <poll.h>
+#include <unistd.h>
 
 namespace midiMind {
 
+std::atomic<bool> BleMidiDevice::useSessionBus_{false};
+
 // ============================================================================
 // CONSTRUCTOR / DESTRUCTOR
 // ============================================================================
@@ -26,7 +32,29 @@ BleMidiDevice::BleMidiDevice(const std::string& id,
     , dbusConnection_(nullptr)
     , connected_(false)
     , paired_(false)
+    , receiveRing_(RECEIVE_RING_SLOTS, OverflowPolicy::DROP_OLDEST)
     , readThreadRunning_(false)
+    , readLoop_(nullptr)
+    , releaseTimer_(nullptr)
+    , lastDue_(0)
+    , latencySum_(0)
+    , latencyCount_(0)
+    , latencyReportedAt_(0)
+    , jitterBufferMaxUs_(DEFAULT_JITTER_BUFFER.count())
+    , jitterBufferAdaptive_(true)
+    , jitterBufferDepthUs_(0)
+    , heldCount_(0)
+    , lateMessages_(0)
+    , charProxy_(nullptr)
+    , writeWithoutResponse_(false)
+    , writePath_(WritePath::NONE)
+    , writeFd_(-1)
+    , mtu_(DEFAULT_ATT_MTU)
+    , sendRing_(SEND_RING_SLOTS, OverflowPolicy::DROP_OLDEST)
+    , aggregationWindowUs_(DEFAULT_AGGREGATION_WINDOW.count())
+    , writerRunning_(false)
+    , packetsWritten_(0)
+    , writeErrors_(0)
     , rssi_(-100)
 {
     Logger::info("BleMidiDevice", "Created device: " + name + " (" + address + ")");
@@ -629,10 +657,29 @@ bool BleMidiDevice::connect() {
         return false;
     }
     
+    if (!openWriter()) {
+        Logger::error("BleMidiDevice", "Failed to open characteristic for writing");
+        disconnectCharacteristic();
+        status_ = DeviceStatus::ERROR;
+        return false;
+    }
+    
+    decoder_.reset();
+    clock_.reset();
+    lastDue_ = 0;
+    latencySum_ = 0;
+    latencyCount_ = 0;
+    latencyReportedAt_ = 0;
+    readLoop_ = g_main_loop_new(g_main_context_new(), FALSE);
+    g_main_context_unref(g_main_loop_get_context(readLoop_));     // Owned by the loop
+    
     connected_ = true;
     readThreadRunning_ = true;
     readThread_ = std::thread(&BleMidiDevice::readThread, this);
     
+    writerRunning_ = true;
+    writerThread_ = std::thread(&BleMidiDevice::writerThread, this);
+    
     status_ = DeviceStatus::CONNECTED;
     Logger::info("BleMidiDevice", "✓ Connected: " + name_);
     
@@ -647,10 +694,34 @@ bool BleMidiDevice::disconnect() {
     Logger::info("BleMidiDevice", "Disconnecting: " + name_);
     
     readThreadRunning_ = false;
+    if (readLoop_) {
+        // Quit from inside the loop: works even if it has not started yet
+        GSource* source = g_idle_source_new();
+        g_source_set_callback(source, [](gpointer loop) -> gboolean {
+            g_main_loop_quit(static_cast<GMainLoop*>(loop));
+            return G_SOURCE_REMOVE;
+        }, readLoop_, nullptr);
+        g_source_attach(source, g_main_loop_get_context(readLoop_));
+        g_source_unref(source);
+    }
     if (readThread_.joinable()) {
         readThread_.join();
     }
+    if (readLoop_) {
+        g_main_loop_unref(readLoop_);
+        readLoop_ = nullptr;
+    }
     
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        writerRunning_ = false;
+    }
+    writerCondition_.notify_one();
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+    
+    closeWriter();
     disconnectCharacteristic();
     
     if (dbusConnection_) {
@@ -704,87 +775,35 @@ bool BleMidiDevice::isConnected() const {
 // ============================================================================
 
 bool BleMidiDevice::sendMessage(const MidiMessage& message) {
-    if (!connected_.load()) {
+    if (!connected_.load() || !message.isValid()) {
         return false;
     }
     
-    if (!dbusConnection_ || characteristicPath_.empty()) {
-        return false;
+    // Written by writerThread(): the caller never waits on BlueZ
+    if (!sendRing_.push(message)) {
+        return false;       // Full: counted by the ring
     }
     
-    auto packet = encodeBlePacket(message);
-    
-    if (packet.empty()) {
-        return false;
-    }
-    
-    GError* error = nullptr;
-    GDBusProxy* charProxy = g_dbus_proxy_new_sync(
-        dbusConnection_,
-        G_DBUS_PROXY_FLAGS_NONE,
-        nullptr,
-        BLUEZ_SERVICE,
-        characteristicPath_.c_str(),
-        GATT_CHARACTERISTIC_INTERFACE,
-        nullptr,
-        &error
-    );
-    
-    if (error) {
-        g_error_free(error);
-        return false;
+    {
+        // Pairs with the writer's predicate check (no lost wake-up)
+        std::lock_guard<std::mutex> lock(writerMutex_);
     }
+    writerCondition_.notify_one();
     
-    GVariantBuilder builder;
-    g_variant_builder_init(&builder, G_VARIANT_TYPE("ay"));
-    for (uint8_t byte : packet) {
-        g_variant_builder_add(&builder, "y", byte);
-    }
-    GVariant* value = g_variant_builder_end(&builder);
-    
-    GVariant* result = g_dbus_proxy_call_sync(
-        charProxy,
-        "WriteValue",
-        g_variant_new("(@aya{sv})", value, nullptr),
-        G_DBUS_CALL_FLAGS_NONE,
-        -1,
-        nullptr,
-        &error
-    );
-    
-    g_object_unref(charProxy);
-    
-    if (error) {
-        Logger::error("BleMidiDevice", 
-            "Failed to write: " + std::string(error->message));
-        g_error_free(error);
-        return false;
-    }
-    
-    if (result) {
-        g_variant_unref(result);
-    }
-    
-    messagesSent_++;
     return true;
 }
 
 MidiMessage BleMidiDevice::receiveMessage() {
     std::lock_guard<std::mutex> lock(queueMutex_);
     
-    if (messageQueue_.empty()) {
-        return MidiMessage();
-    }
-    
-    MidiMessage msg = std::move(messageQueue_.front());
-    messageQueue_.pop();
+    MidiMessage msg;
+    receiveRing_.pop(msg);
     
     return msg;
 }
 
 bool BleMidiDevice::hasMessages() const {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    return !messageQueue_.empty();
+    return !receiveRing_.empty();
 }
 
 bool BleMidiDevice::requestIdentity() {
@@ -803,6 +822,26 @@ json BleMidiDevice::getCapabilities() const {
     };
 }
 
+bool BleMidiDevice::setOverflowPolicy(OverflowPolicy policy) {
+    // The receive ring is fed by the read thread: it never blocks
+    if (policy != OverflowPolicy::BLOCK) {
+        receiveRing_.setPolicy(policy);
+    }
+    sendRing_.setPolicy(policy);
+    return true;
+}
+
+bool BleMidiDevice::setJitterBuffer(std::chrono::microseconds maxDepth, bool adaptive) {
+    int64_t depth = std::clamp<int64_t>(maxDepth.count(), 0, MAX_JITTER_BUFFER.count());
+    
+    jitterBufferMaxUs_ = depth;
+    jitterBufferAdaptive_ = adaptive;
+    
+    Logger::info("BleMidiDevice", name_ + " jitter buffer: " + 
+        std::to_string(depth) + "µs" + (adaptive ? " (adaptive)" : ""));
+    return true;
+}
+
 std::string BleMidiDevice::getPort() const {
     return address_;
 }
@@ -818,7 +857,12 @@ json BleMidiDevice::getInfo() const {
         {"paired", paired_.load()},
         {"rssi", rssi_.load()},
         {"messages_sent", messagesSent_.load()},
-        {"messages_received", messagesReceived_.load()}
+        {"messages_received", messagesReceived_.load()},
+        {"receive_queue_size", receiveRing_.size()},
+        {"receive_queue", receiveRing_.getStatistics()},
+        {"decoder", decoder_.getStatistics()},
+        {"jitter_buffer", getJitterBufferStatistics()},
+        {"output", getOutputStatistics()}
     };
 }
 
@@ -828,7 +872,8 @@ json BleMidiDevice::getInfo() const {
 
 bool BleMidiDevice::connectToBluez() {
     GError* error = nullptr;
-    dbusConnection_ = g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error);
+    dbusConnection_ = g_bus_get_sync(
+        useSessionBus_.load() ? G_BUS_TYPE_SESSION : G_BUS_TYPE_SYSTEM, nullptr, &error);
     
     if (error) {
         Logger::error("BleMidiDevice", 
@@ -906,6 +951,31 @@ bool BleMidiDevice::connectCharacteristic() {
                         if (std::string(uuid) == BLE_MIDI_CHARACTERISTIC_UUID) {
                             characteristicPath_ = objectPath;
                             found = true;
+                            
+                            writeWithoutResponse_ = false;
+                            GVariant* flagsVar = g_variant_lookup_value(
+                                properties, "Flags", G_VARIANT_TYPE_STRING_ARRAY);
+                            if (flagsVar) {
+                                const gchar** flags = g_variant_get_strv(flagsVar, nullptr);
+                                for (const gchar** flag = flags; flag && *flag; ++flag) {
+                                    if (std::string(*flag) == "write-without-response") {
+                                        writeWithoutResponse_ = true;
+                                    }
+                                }
+                                g_free(flags);
+                                g_variant_unref(flagsVar);
+                            }
+                            
+                            // Exposed by BlueZ 5.62+; AcquireWrite reports it too
+                            mtu_ = DEFAULT_ATT_MTU;
+                            GVariant* mtuVar = g_variant_lookup_value(
+                                properties, "MTU", G_VARIANT_TYPE_UINT16);
+                            if (mtuVar) {
+                                mtu_ = std::max<uint16_t>(g_variant_get_uint16(mtuVar),
+                                                          DEFAULT_ATT_MTU);
+                                g_variant_unref(mtuVar);
+                            }
+                            
                             g_variant_unref(uuidVar);
                             break;
                         }
@@ -1001,9 +1071,284 @@ void BleMidiDevice::disconnectCharacteristic() {
     characteristicPath_.clear();
 }
 
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+const char* BleMidiDevice::writePathToString(WritePath path) {
+    switch (path) {
+        case WritePath::ACQUIRED_FD: return "acquired_fd";
+        case WritePath::WRITE_COMMAND: return "write_command";
+        case WritePath::WRITE_REQUEST: return "write_request";
+        default: return "none";
+    }
+}
+
+void BleMidiDevice::setUseSessionBus(bool enabled) {
+    useSessionBus_ = enabled;
+}
+
+bool BleMidiDevice::openWriter() {
+    GError* error = nullptr;
+    
+    // Kept for the whole connection: no proxy setup per packet
+    charProxy_ = g_dbus_proxy_new_sync(
+        dbusConnection_,
+        static_cast<GDBusProxyFlags>(G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                                     G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS),
+        nullptr,
+        BLUEZ_SERVICE,
+        characteristicPath_.c_str(),
+        GATT_CHARACTERISTIC_INTERFACE,
+        nullptr,
+        &error
+    );
+    
+    if (error) {
+        Logger::error("BleMidiDevice", 
+            "Failed to create characteristic proxy: " + std::string(error->message));
+        g_error_free(error);
+        charProxy_ = nullptr;
+        return false;
+    }
+    
+    writePath_ = writeWithoutResponse_ ? WritePath::WRITE_COMMAND
+                                       : WritePath::WRITE_REQUEST;
+    
+    if (writeWithoutResponse_) {
+        // BlueZ hands over a socket: each write() is one ATT write command,
+        // no D-Bus round-trip at all
+        GVariantBuilder options;
+        g_variant_builder_init(&options, G_VARIANT_TYPE("a{sv}"));
+        
+        GUnixFDList* fdList = nullptr;
+        GVariant* reply = g_dbus_proxy_call_with_unix_fd_list_sync(
+            charProxy_,
+            "AcquireWrite",
+            g_variant_new("(a{sv})", &options),
+            G_DBUS_CALL_FLAGS_NONE,
+            WRITE_TIMEOUT_MS,
+            nullptr,
+            &fdList,
+            nullptr,
+            &error
+        );
+        
+        if (error) {
+            Logger::warning("BleMidiDevice", 
+                "AcquireWrite unavailable, using WriteValue: " + std::string(error->message));
+            g_error_free(error);
+            error = nullptr;
+        } else {
+            gint32 handle = -1;
+            guint16 mtu = 0;
+            g_variant_get(reply, "(hq)", &handle, &mtu);
+            
+            int fd = fdList ? g_unix_fd_list_get(fdList, handle, nullptr) : -1;
+            if (fd >= 0) {
+                writeFd_ = fd;
+                if (mtu > 0) {
+                    mtu_ = std::max<uint16_t>(mtu, DEFAULT_ATT_MTU);
+                }
+                writePath_ = WritePath::ACQUIRED_FD;
+            }
+            
+            if (fdList) {
+                g_object_unref(fdList);
+            }
+            g_variant_unref(reply);
+        }
+    }
+    
+    packetizer_.reset();
+    packetizer_.setMaxPacketSize(mtu_.load() - 3);
+    
+    Logger::info("BleMidiDevice", "Output for " + name_ + ": " + 
+                writePathToString(writePath_.load()) + 
+                " (MTU " + std::to_string(mtu_.load()) + ")");
+    
+    return true;
+}
+
+void BleMidiDevice::closeWriter() {
+    writePath_ = WritePath::NONE;
+    
+    if (writeFd_ >= 0) {
+        ::close(writeFd_);      // BlueZ releases the write lock
+        writeFd_ = -1;
+    }
+    
+    if (charProxy_) {
+        g_object_unref(charProxy_);
+        charProxy_ = nullptr;
+    }
+    
+    sendRing_.clear();
+}
+
+void BleMidiDevice::setAggregationWindow(std::chrono::microseconds window) {
+    aggregationWindowUs_ = std::max<int64_t>(window.count(), 0);
+}
+
+void BleMidiDevice::writerThread() {
+    Logger::info("BleMidiDevice", "Writer thread started for: " + name_);
+    
+    using Clock = std::chrono::steady_clock;
+    
+    MidiMessage message;
+    Clock::time_point deadline;
+    
+    auto emit = [this](const uint8_t* packet, size_t size) {
+        writePacket(packet, size);
+    };
+    
+    auto ready = [this] {
+        return !sendRing_.empty() || !writerRunning_.load();
+    };
+    
+    while (writerRunning_.load()) {
+        {
+            std::unique_lock<std::mutex> lock(writerMutex_);
+            if (packetizer_.hasPending()) {
+                writerCondition_.wait_until(lock, deadline, ready);
+            } else {
+                writerCondition_.wait(lock, ready);
+            }
+        }
+        
+        while (sendRing_.pop(message)) {
+            Clock::time_point now = Clock::now();
+            
+            if (!packetizer_.hasPending()) {
+                deadline = now + std::chrono::microseconds(aggregationWindowUs_.load());
+            }
+            
+            // 13-bit millisecond timestamps: any epoch will do
+            uint32_t timeMs = static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now.time_since_epoch()).count());
+            
+            packetizer_.add(message, timeMs, emit);
+            messagesSent_++;
+        }
+        
+        if (packetizer_.hasPending() &&
+            (aggregationWindowUs_.load() == 0 || Clock::now() >= deadline)) {
+            packetizer_.flush(emit);
+        }
+    }
+    
+    packetizer_.flush(emit);
+    
+    Logger::info("BleMidiDevice", "Writer thread stopped for: " + name_);
+}
+
+bool BleMidiDevice::writePacket(const uint8_t* packet, size_t size) {
+    if (writePath_.load() == WritePath::ACQUIRED_FD) {
+        ssize_t written = ::write(writeFd_, packet, size);
+        
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Controller buffers full: wait for room once
+            struct pollfd pfd = {writeFd_, POLLOUT, 0};
+            if (::poll(&pfd, 1, WRITE_TIMEOUT_MS) > 0) {
+                written = ::write(writeFd_, packet, size);
+            }
+        }
+        
+        if (written == static_cast<ssize_t>(size)) {
+            packetsWritten_++;
+            return true;
+        }
+        
+        writeErrors_++;
+        
+        if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            // Socket released by BlueZ: continue through the proxy
+            Logger::warning("BleMidiDevice", 
+                "Write socket lost (" + std::string(strerror(errno)) + 
+                "), falling back to WriteValue");
+            ::close(writeFd_);
+            writeFd_ = -1;
+            writePath_ = WritePath::WRITE_COMMAND;
+            return writeValue(packet, size, false);
+        }
+        
+        return false;
+    }
+    
+    return writeValue(packet, size, writePath_.load() == WritePath::WRITE_REQUEST);
+}
+
+bool BleMidiDevice::writeValue(const uint8_t* packet, size_t size, bool withResponse) {
+    if (!charProxy_) {
+        return false;
+    }
+    
+    GVariant* value = g_variant_new_fixed_array(
+        G_VARIANT_TYPE_BYTE, packet, size, sizeof(uint8_t));
+    
+    GVariantBuilder options;
+    g_variant_builder_init(&options, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&options, "{sv}", "type", 
+                          g_variant_new_string(withResponse ? "request" : "command"));
+    
+    GVariant* args = g_variant_new("(@aya{sv})", value, &options);
+    
+    if (!withResponse) {
+        // No callback: sent as NO_REPLY_EXPECTED, messages stay in order on
+        // the connection
+        g_dbus_proxy_call(charProxy_, "WriteValue", args, G_DBUS_CALL_FLAGS_NONE,
+                          -1, nullptr, nullptr, nullptr);
+        packetsWritten_++;
+        return true;
+    }
+    
+    GError* error = nullptr;
+    GVariant* result = g_dbus_proxy_call_sync(
+        charProxy_,
+        "WriteValue",
+        args,
+        G_DBUS_CALL_FLAGS_NONE,
+        WRITE_TIMEOUT_MS,
+        nullptr,
+        &error
+    );
+    
+    if (error) {
+        Logger::error("BleMidiDevice", 
+            "Failed to write: " + std::string(error->message));
+        g_error_free(error);
+        writeErrors_++;
+        return false;
+    }
+    
+    if (result) {
+        g_variant_unref(result);
+    }
+    
+    packetsWritten_++;
+    return true;
+}
+
+json BleMidiDevice::getOutputStatistics() const {
+    return json{
+        {"path", writePathToString(writePath_.load())},
+        {"mtu", mtu_.load()},
+        {"packets_written", packetsWritten_.load()},
+        {"write_errors", writeErrors_.load()},
+        {"aggregation_window_us", aggregationWindowUs_.load()},
+        {"queue", sendRing_.getStatistics()},
+        {"packetizer", packetizer_.getStatistics()}
+    };
+}
+
 void BleMidiDevice::readThread() {
     Logger::info("BleMidiDevice", "Read thread started for: " + name_);
     
+    // Notifications are dispatched on this thread's context
+    GMainContext* context = g_main_loop_get_context(readLoop_);
+    g_main_context_push_thread_default(context);
+    
     guint subscriptionId = 0;
     
     if (!characteristicPath_.empty()) {
@@ -1036,12 +1381,7 @@ void BleMidiDevice::readThread() {
                     );
                     
                     if (len > 0) {
-                        MidiMessage msg = self->parseBlePacket(data, len);
-                        if (!msg.getRawData().empty() && msg.getRawData()[0] != 0x00) {
-                            std::lock_guard<std::mutex> lock(self->queueMutex_);
-                            self->messageQueue_.push(std::move(msg));
-                            self->messagesReceived_++;
-                        }
+                        self->receivePacket(data, len);
                     }
                     
                     g_variant_unref(value);
@@ -1055,120 +1395,176 @@ void BleMidiDevice::readThread() {
         );
     }
     
-    while (readThreadRunning_.load()) {
-        updateRssi();
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    // Releases held messages at their due time (µs ready time)
+    static GSourceFuncs releaseFuncs = {
+        nullptr,
+        nullptr,
+        [](GSource*, GSourceFunc callback, gpointer userData) -> gboolean {
+            return callback(userData);
+        },
+        nullptr,
+        nullptr,
+        nullptr
+    };
+    
+    releaseTimer_ = g_source_new(&releaseFuncs, sizeof(GSource));
+    g_source_set_callback(releaseTimer_, [](gpointer userData) -> gboolean {
+        static_cast<BleMidiDevice*>(userData)->releaseDue();
+        return G_SOURCE_CONTINUE;
+    }, this, nullptr);
+    g_source_set_ready_time(releaseTimer_, -1);
+    g_source_attach(releaseTimer_, context);
+    
+    GSource* rssiTimer = g_timeout_source_new_seconds(1);
+    g_source_set_callback(rssiTimer, [](gpointer userData) -> gboolean {
+        static_cast<BleMidiDevice*>(userData)->updateRssi();
+        return G_SOURCE_CONTINUE;
+    }, this, nullptr);
+    g_source_attach(rssiTimer, context);
+    
+    g_main_loop_run(readLoop_);
+    
+    g_source_destroy(rssiTimer);
+    g_source_unref(rssiTimer);
+    
+    g_source_destroy(releaseTimer_);
+    g_source_unref(releaseTimer_);
+    releaseTimer_ = nullptr;
+    
+    // Held messages still leave (a note-off must not be lost)
+    released_.clear();
+    for (HeldMessage& held : held_) {
+        released_.push_back(std::move(held.message));
     }
+    held_.clear();
+    heldCount_ = 0;
+    deliverReceived(released_.data(), released_.size());
     
     if (subscriptionId > 0) {
         g_dbus_connection_signal_unsubscribe(dbusConnection_, subscriptionId);
     }
     
+    g_main_context_pop_thread_default(context);
+    
     Logger::info("BleMidiDevice", "Read thread stopped for: " + name_);
 }
 
-MidiMessage BleMidiDevice::parseBlePacket(const uint8_t* data, size_t len) {
-    if (len < 2) {
-        return MidiMessage();  // Empty message
-    }
-    
-    // Skip BLE header
-    size_t offset = 1;
-    
-    uint8_t status = data[offset];
-    
-    if ((status & 0x80) == 0) {
-        return MidiMessage();  // Invalid status byte
-    }
+void BleMidiDevice::receivePacket(const uint8_t* data, size_t len) {
+    uint64_t arrival = TimestampManager::instance().now();
     
-    uint8_t statusType = status & 0xF0;
-    uint8_t channel = status & 0x0F;
-    
-    switch (statusType) {
-        case 0x80:  // Note Off
-            if (offset + 2 < len) {
-                return MidiMessage::noteOff(channel, data[offset + 1], data[offset + 2]);
-            }
-            break;
-            
-        case 0x90:  // Note On
-            if (offset + 2 < len) {
-                return MidiMessage::noteOn(channel, data[offset + 1], data[offset + 2]);
-            }
-            break;
-            
-        case 0xB0:  // Control Change
-            if (offset + 2 < len) {
-                return MidiMessage::controlChange(channel, data[offset + 1], data[offset + 2]);
-            }
-            break;
+    decoder_.decode(data, len, [this, arrival](MidiMessage* messages,
+                                               const uint16_t* timestamps,
+                                               size_t count) {
+        clock_.observe(timestamps[count - 1], arrival);
+        
+        // No re-timing before TimestampManager runs
+        int64_t depth = arrival > 0 ? jitterBufferMaxUs_.load() : 0;
+        if (jitterBufferAdaptive_.load()) {
+            depth = std::min(depth, clock_.getMaxJitter() + JITTER_BUFFER_MARGIN.count());
+        }
+        jitterBufferDepthUs_ = depth;
+        
+        // Stamped with the sending time; due at sending time + depth, never
+        // before a message received earlier
+        due_.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t sent = std::min(clock_.toHost(timestamps[i]), arrival);
+            messages[i].setTimestamp(sent);
             
-        case 0xC0:  // Program Change
-            if (offset + 1 < len) {
-                return MidiMessage::programChange(channel, data[offset + 1]);
+            uint64_t due = std::max(sent + depth, lastDue_);
+            if (due < arrival && depth > 0) {
+                lateMessages_++;        // Jitter beyond the depth
             }
-            break;
+            lastDue_ = due;
+            due_[i] = due;
             
-        case 0xF0:  // System
-            if (status == 0xF0) {
-                // System Exclusive
-                std::vector<uint8_t> sysex(data + offset, data + len);
-                return MidiMessage(sysex);
+            recordLatency(std::max(due, arrival) - sent, arrival);
+        }
+        
+        messagesReceived_ += count;
+        
+        // Messages already due leave now, unless earlier ones are held
+        size_t ready = 0;
+        if (held_.empty()) {
+            while (ready < count && due_[ready] <= arrival) {
+                ready++;
             }
-            break;
-            
-        default:
-            break;
+            deliverReceived(messages, ready);
+        }
+        
+        if (ready == count) {
+            return;
+        }
+        
+        for (size_t i = ready; i < count; ++i) {
+            held_.push_back(HeldMessage{std::move(messages[i]), due_[i]});
+        }
+        heldCount_ = held_.size();
+        
+        uint64_t wait = held_.front().due - std::min(held_.front().due, arrival);
+        g_source_set_ready_time(releaseTimer_,
+            g_get_monotonic_time() + static_cast<int64_t>(wait));
+    });
+}
+
+void BleMidiDevice::deliverReceived(MidiMessage* messages, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    // Thru path: the whole batch is routed in one call
+    if (dispatchReceived(messages, count)) {
+        return;
     }
     
-    return MidiMessage();  // Empty message for unrecognized types
+    for (size_t i = 0; i < count; ++i) {
+        receiveRing_.push(messages[i]);     // Full: counted by the ring
+    }
 }
 
-std::vector<uint8_t> BleMidiDevice::encodeBlePacket(const MidiMessage& msg) {
-    std::vector<uint8_t> packet;
-    packet.push_back(0x80);  // BLE MIDI header with timestamp
-    packet.push_back(0x80);  // Additional timestamp byte
+void BleMidiDevice::releaseDue() {
+    uint64_t now = TimestampManager::instance().now();
     
-    const auto& rawData = msg.getRawData();
-    
-    if (rawData.empty()) {
-        return packet;
+    released_.clear();
+    while (!held_.empty() && held_.front().due <= now) {
+        released_.push_back(std::move(held_.front().message));
+        held_.pop_front();
     }
+    heldCount_ = held_.size();
     
-    uint8_t status = rawData[0];
-    uint8_t statusType = status & 0xF0;
+    deliverReceived(released_.data(), released_.size());
     
-    switch (statusType) {
-        case 0x80:  // Note Off
-        case 0x90:  // Note On
-        case 0xB0:  // Control Change
-            if (rawData.size() >= 3) {
-                packet.push_back(rawData[0]);  // Status
-                packet.push_back(rawData[1]);  // Data1
-                packet.push_back(rawData[2]);  // Data2
-            }
-            break;
-            
-        case 0xC0:  // Program Change
-        case 0xD0:  // Channel Pressure
-            if (rawData.size() >= 2) {
-                packet.push_back(rawData[0]);  // Status
-                packet.push_back(rawData[1]);  // Data1
-            }
-            break;
-            
-        case 0xF0:  // System Exclusive
-            // Copy entire SysEx message
-            packet.insert(packet.end(), rawData.begin(), rawData.end());
-            break;
-            
-        default:
-            // Copy all bytes for other message types
-            packet.insert(packet.end(), rawData.begin(), rawData.end());
-            break;
+    if (held_.empty()) {
+        g_source_set_ready_time(releaseTimer_, -1);
+    } else {
+        g_source_set_ready_time(releaseTimer_,
+            g_get_monotonic_time() + static_cast<int64_t>(held_.front().due - now));
     }
-    
-    return packet;
+}
+
+void BleMidiDevice::recordLatency(uint64_t latencyUs, uint64_t now) {
+    latencySum_ += latencyUs;
+    latencyCount_++;
+    
+    if (latencyReportedAt_ == 0) {
+        latencyReportedAt_ = now;
+    } else if (now - latencyReportedAt_ >= LATENCY_REPORT_INTERVAL_US) {
+        reportLatency(latencySum_ / latencyCount_);
+        latencySum_ = 0;
+        latencyCount_ = 0;
+        latencyReportedAt_ = now;
+    }
+}
+
+json BleMidiDevice::getJitterBufferStatistics() const {
+    return json{
+        {"max_depth_us", jitterBufferMaxUs_.load()},
+        {"adaptive", jitterBufferAdaptive_.load()},
+        {"depth_us", jitterBufferDepthUs_.load()},
+        {"buffered", heldCount_.load()},
+        {"late", lateMessages_.load()},
+        {"clock", clock_.getStatistics()}
+    };
 }
 
 void BleMidiDevice::updateRssi() {
@@ -1227,7 +1623,8 @@ void BleMidiDevice::updateRssi() {
 
 GDBusConnection* BleMidiDevice::getDbusConnection() {
     GError* error = nullptr;
-    GDBusConnection* conn = g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error);
+    GDBusConnection* conn = g_bus_get_sync(
+        useSessionBus_.load() ? G_BUS_TYPE_SESSION : G_BUS_TYPE_SYSTEM, nullptr, &error);
     
     if (error) {
         Logger::error("BleMidiDevice", 
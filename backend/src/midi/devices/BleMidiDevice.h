@@ -1,22 +1,64 @@
 // ============================================================================
 // File: backend/src/midi/devices/BleMidiDevice.h
-// Version: 2.0.0
+// Version: 2.0.6
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v2.0.6:
+//   - setOverflowPolicy() also sets the send ring; BLOCK applies to the
+//     send ring only (the read thread never waits on the receive ring)
+//
+// Changes v2.0.5:
+//   - Sender clock tracked by BleClockSync (offset and drift against
+//     TimestampManager); messages are stamped with their sending time
+//   - Jitter buffer: messages leave at sending time + depth, the depth
+//     following the measured jitter up to a configurable maximum
+//   - Input latency (sending to delivery) reported once per second
+//
+// Changes v2.0.4:
+//   - Notifications decoded by BleMidiDecoder: every message of a packet,
+//     SysEx across packets, arrival times from the sender timestamps;
+//     a packet is handed to the batch callback in one call
+//   - Read thread runs a main loop on its own context, so notifications
+//     are dispatched on it
+//
+// Changes v2.0.3:
+//   - Output packed by BleMidiPacketizer: messages within the aggregation
+//     window share one MTU-sized packet (13-bit timestamps, running status)
+//
+// Changes v2.0.2:
+//   - Output goes through a send queue drained by a writer thread, on a
+//     BlueZ AcquireWrite socket when available, else through a cached
+//     characteristic proxy (write-without-response when supported)
+//   - D-Bus bus selectable (session bus for a mock BlueZ)
+//
+// Changes v2.0.1:
+//   - Receive queue is a lock-free ring (SpscMessageRing)
+//
+// ============================================================================
 
 #pragma once
 
 #include "MidiDevice.h"
+#include "BleMidiPacketizer.h"
+#include "BleMidiDecoder.h"
+#include "BleClockSync.h"
 #include <string>
-#include <queue>
 #include <mutex>
 #include <thread>
 #include <atomic>
 #include <vector>
+#include <deque>
+#include <condition_variable>
+#include <chrono>
 
 // Forward declarations pour BlueZ (via GIO)
 struct _GDBusConnection;
 typedef struct _GDBusConnection GDBusConnection;
+struct _GDBusProxy;
+typedef struct _GDBusProxy GDBusProxy;
+struct _GMainLoop;
+struct _GSource;
 
 namespace midiMind {
 
@@ -41,6 +83,34 @@ struct BleDeviceInfo {
  */
 class BleMidiDevice : public MidiDevice {
 public:
+    /// Receive ring slots (a channel message takes one)
+    static constexpr size_t RECEIVE_RING_SLOTS = 1024;
+    
+    /// Send ring slots
+    static constexpr size_t SEND_RING_SLOTS = 1024;
+    
+    /// ATT MTU assumed until BlueZ reports one
+    static constexpr uint16_t DEFAULT_ATT_MTU = 23;
+    
+    /// Longest wait for an acknowledged write or a full write socket
+    static constexpr int WRITE_TIMEOUT_MS = 1000;
+    
+    /// How long an output packet stays open for more messages
+    static constexpr std::chrono::microseconds DEFAULT_AGGREGATION_WINDOW{2000};
+    
+    /// Default longest hold of received messages (covers connection
+    /// intervals up to 11.25 ms)
+    static constexpr std::chrono::microseconds DEFAULT_JITTER_BUFFER{15000};
+    
+    /// Longest hold accepted by setJitterBuffer()
+    static constexpr std::chrono::microseconds MAX_JITTER_BUFFER{100000};
+    
+    /// Added to the measured jitter by the adaptive buffer
+    static constexpr std::chrono::microseconds JITTER_BUFFER_MARGIN{500};
+    
+    /// Interval between two input latency reports (µs)
+    static constexpr uint64_t LATENCY_REPORT_INTERVAL_US = 1000000;
+    
     // ========================================================================
     // CONSTRUCTOR / DESTRUCTOR
     // ========================================================================
@@ -64,6 +134,8 @@ public:
     bool hasMessages() const override;
     bool requestIdentity() override;
     json getCapabilities() const override;
+    bool setOverflowPolicy(OverflowPolicy policy) override;
+    bool setJitterBuffer(std::chrono::microseconds maxDepth, bool adaptive) override;
     std::string getPort() const override;
     json getInfo() const override;
     
@@ -86,6 +158,13 @@ public:
      */
     static std::vector<BleDeviceInfo> getPairedDevices();
     
+    /**
+     * @brief Talk to BlueZ on the session bus instead of the system bus
+     * @note For running against a mock org.bluez service; affects D-Bus
+     *       connections opened afterwards
+     */
+    static void setUseSessionBus(bool enabled);
+    
     // ========================================================================
     // BLE PAIRING (INSTANCE)
     // ========================================================================
@@ -131,6 +210,32 @@ public:
      * @brief Get detailed signal information
      */
     json getSignalStrength() const;
+    
+    /**
+     * @brief Hold output packets open for more messages
+     * @param window How long a packet waits after its first message (0:
+     *        sent as soon as the send queue is drained). A packet also goes
+     *        out as soon as it is full.
+     */
+    void setAggregationWindow(std::chrono::microseconds window);
+    
+    std::chrono::microseconds getAggregationWindow() const {
+        return std::chrono::microseconds(aggregationWindowUs_.load());
+    }
+    
+    /**
+     * @brief Output path statistics
+     * @return json {path, mtu, packets_written, write_errors,
+     *         aggregation_window_us, queue, packetizer}
+     */
+    json getOutputStatistics() const;
+    
+    /**
+     * @brief Input timing statistics
+     * @return json {max_depth_us, adaptive, depth_us, buffered, late,
+     *         clock}
+     */
+    json getJitterBufferStatistics() const;
 
 private:
     // ========================================================================
@@ -141,8 +246,41 @@ private:
     bool connectCharacteristic();
     void disconnectCharacteristic();
     void readThread();
-    MidiMessage parseBlePacket(const uint8_t* data, size_t len);
-    std::vector<uint8_t> encodeBlePacket(const MidiMessage& msg);
+    
+    /// Decode a notification and deliver its messages (read thread)
+    void receivePacket(const uint8_t* data, size_t len);
+    
+    /// Hand messages to the callbacks, else to receiveRing_ (read thread)
+    void deliverReceived(MidiMessage* messages, size_t count);
+    
+    /// Deliver the held messages that are due and re-arm releaseTimer_
+    /// (read thread)
+    void releaseDue();
+    
+    /// Add to the latency report, sent once per interval (read thread)
+    void recordLatency(uint64_t latencyUs, uint64_t now);
+    
+    /// How packets reach the characteristic
+    enum class WritePath {
+        NONE,
+        ACQUIRED_FD,        ///< Socket from AcquireWrite (write-without-response)
+        WRITE_COMMAND,      ///< WriteValue type "command" (no response)
+        WRITE_REQUEST       ///< WriteValue type "request" (acknowledged)
+    };
+    
+    static const char* writePathToString(WritePath path);
+    
+    /// Cache the characteristic proxy and pick the write path
+    bool openWriter();
+    void closeWriter();
+    
+    /// Drain sendRing_ (writer thread)
+    void writerThread();
+    
+    /// Deliver one packet to the characteristic (writer thread)
+    bool writePacket(const uint8_t* packet, size_t size);
+    
+    bool writeValue(const uint8_t* packet, size_t size, bool withResponse);
     void updateRssi();
     
     /**
@@ -184,11 +322,57 @@ private:
     std::atomic<bool> connected_;
     std::atomic<bool> paired_;
     
-    std::queue<MidiMessage> messageQueue_;
-    mutable std::mutex queueMutex_;
+    /// Filled from the GDBus signal handler; queueMutex_ only serializes
+    /// readers
+    SpscMessageRing receiveRing_;
+    std::mutex queueMutex_;
     
     std::thread readThread_;
     std::atomic<bool> readThreadRunning_;
+    struct _GMainLoop* readLoop_;           ///< Run by readThread_
+    BleMidiDecoder decoder_;                ///< Read thread only
+    
+    // Input timing (read thread only, except the atomics)
+    struct HeldMessage {
+        MidiMessage message;
+        uint64_t due;                       ///< TimestampManager µs
+    };
+    
+    BleClockSync clock_;
+    std::deque<HeldMessage> held_;
+    std::vector<uint64_t> due_;             ///< Per message of a packet
+    std::vector<MidiMessage> released_;
+    struct _GSource* releaseTimer_;         ///< On readLoop_'s context
+    uint64_t lastDue_;                      ///< Keeps release order
+    uint64_t latencySum_;
+    uint64_t latencyCount_;
+    uint64_t latencyReportedAt_;
+    
+    std::atomic<int64_t> jitterBufferMaxUs_;
+    std::atomic<bool> jitterBufferAdaptive_;
+    std::atomic<int64_t> jitterBufferDepthUs_;
+    std::atomic<size_t> heldCount_;
+    std::atomic<uint64_t> lateMessages_;
+    
+    // Output
+    GDBusProxy* charProxy_;                 ///< Cached for the connection
+    bool writeWithoutResponse_;             ///< Characteristic flag
+    std::atomic<WritePath> writePath_;
+    int writeFd_;                           ///< AcquireWrite socket, -1 if none
+    std::atomic<uint16_t> mtu_;
+    
+    MpscMessageRing sendRing_;
+    BleMidiPacketizer packetizer_;          ///< Writer thread only
+    std::atomic<int64_t> aggregationWindowUs_;
+    std::thread writerThread_;
+    std::atomic<bool> writerRunning_;
+    std::mutex writerMutex_;
+    std::condition_variable writerCondition_;
+    
+    std::atomic<uint64_t> packetsWritten_;
+    std::atomic<uint64_t> writeErrors_;
+    
+    static std::atomic<bool> useSessionBus_;
     
     std::atomic<int> rssi_;
 };
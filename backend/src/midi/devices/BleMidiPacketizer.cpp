@@ -0,0 +1,219 @@
+// ============================================================================
+// File: backend/src/midi/devices/BleMidiPacketizer.cpp
+// Version: 2.0.3
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "BleMidiPacketizer.h"
+#include <algorithm>
+
+namespace midiMind {
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+BleMidiPacketizer::BleMidiPacketizer(size_t maxPacketSize)
+    : maxPacketSize_(MIN_PACKET_SIZE)
+    , runningStatusEnabled_(true)
+    , packetStart_(0)
+    , lastTime_(0)
+    , runningStatus_(0)
+    , packets_(0)
+    , messages_(0)
+    , bytes_(0)
+    , statusBytesSaved_(0)
+    , timestampBytesSaved_(0)
+    , sysexContinuations_(0)
+    , dropped_(0)
+{
+    setMaxPacketSize(maxPacketSize);
+    packet_.reserve(MAX_PACKET_SIZE);
+    completed_.reserve(MAX_PACKET_SIZE * 2);
+}
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+void BleMidiPacketizer::setMaxPacketSize(size_t size) {
+    maxPacketSize_ = std::clamp(size, MIN_PACKET_SIZE, MAX_PACKET_SIZE);
+
+    if (packet_.size() > maxPacketSize_.load()) {
+        closePacket();
+    }
+}
+
+void BleMidiPacketizer::reset() {
+    packet_.clear();
+    completed_.clear();
+    completedEnds_.clear();
+    runningStatus_ = 0;
+}
+
+json BleMidiPacketizer::getStatistics() const {
+    return json{
+        {"max_packet_size", maxPacketSize_.load()},
+        {"packets", packets_.load()},
+        {"messages", messages_.load()},
+        {"bytes", bytes_.load()},
+        {"status_bytes_saved", statusBytesSaved_.load()},
+        {"timestamp_bytes_saved", timestampBytesSaved_.load()},
+        {"sysex_continuations", sysexContinuations_.load()},
+        {"dropped", dropped_.load()}
+    };
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+void BleMidiPacketizer::append(const uint8_t* data, size_t size, uint32_t timeMs) {
+    if (size == 0 || (data[0] & 0x80) == 0) {
+        dropped_++;
+        return;
+    }
+
+    if (hasPending()) {
+        // Timestamps never go backwards within a packet, and a packet
+        // spans less than one low-byte wrap
+        timeMs = std::max(timeMs, lastTime_);
+        if (timeMs - packetStart_ >= TIMESTAMP_WRAP_MS) {
+            closePacket();
+        }
+    }
+
+    messages_++;
+
+    uint8_t status = data[0];
+
+    if (status == 0xF0) {
+        appendSysEx(data, size, timeMs);
+        return;
+    }
+
+    if (status >= 0xF8) {
+        // Real-time: running status survives it
+        reserve(2, timeMs);
+        packet_.push_back(timestampByte(timeMs));
+        packet_.push_back(status);
+        lastTime_ = timeMs;
+        return;
+    }
+
+    if (status > 0xF0) {
+        // System common: cancels running status
+        reserve(1 + size, timeMs);
+        packet_.push_back(timestampByte(timeMs));
+        packet_.insert(packet_.end(), data, data + size);
+        runningStatus_ = 0;
+        lastTime_ = timeMs;
+        return;
+    }
+
+    // Channel message. A timestamp byte may only be left out together with
+    // the status byte (the receiver reads data bytes straight after data)
+    bool running = runningStatusEnabled_ && hasPending() && status == runningStatus_;
+    bool sameTime = running && timeMs == lastTime_;
+
+    size_t needed = (size - 1) + (running ? 0 : 1) + (sameTime ? 0 : 1);
+
+    if (hasPending() && packet_.size() + needed > maxPacketSize_.load()) {
+        closePacket();
+        running = false;
+        sameTime = false;
+        needed = size + 1;
+    }
+
+    reserve(needed, timeMs);
+
+    if (sameTime) {
+        timestampBytesSaved_++;
+    } else {
+        packet_.push_back(timestampByte(timeMs));
+    }
+
+    if (running) {
+        statusBytesSaved_++;
+    } else {
+        packet_.push_back(status);
+    }
+
+    packet_.insert(packet_.end(), data + 1, data + size);
+
+    runningStatus_ = status;
+    lastTime_ = timeMs;
+}
+
+void BleMidiPacketizer::appendSysEx(const uint8_t* data, size_t size, uint32_t timeMs) {
+    // Body: the bytes between F0 and F7
+    size_t end = (size > 1 && data[size - 1] == 0xF7) ? size - 1 : size;
+
+    reserve(2, timeMs);
+    packet_.push_back(timestampByte(timeMs));
+    packet_.push_back(0xF0);
+
+    for (size_t i = 1; i < end; ++i) {
+        if (data[i] & 0x80) {
+            dropped_++;             // Not a SysEx data byte
+            continue;
+        }
+
+        if (packet_.size() >= maxPacketSize_.load()) {
+            // Continuation packet: header, then data bytes (no timestamp)
+            closePacket();
+            openPacket(timeMs);
+            sysexContinuations_++;
+        }
+
+        packet_.push_back(data[i]);
+    }
+
+    // F7 is always preceded by a timestamp byte
+    if (packet_.size() + 2 > maxPacketSize_.load()) {
+        closePacket();
+        openPacket(timeMs);
+        sysexContinuations_++;
+    }
+
+    packet_.push_back(timestampByte(timeMs));
+    packet_.push_back(0xF7);
+
+    runningStatus_ = 0;
+    lastTime_ = timeMs;
+}
+
+void BleMidiPacketizer::reserve(size_t bytes, uint32_t timeMs) {
+    if (hasPending() && packet_.size() + bytes > maxPacketSize_.load()) {
+        closePacket();
+    }
+
+    if (!hasPending()) {
+        openPacket(timeMs);
+    }
+}
+
+void BleMidiPacketizer::openPacket(uint32_t timeMs) {
+    packet_.clear();
+    packet_.push_back(headerByte(timeMs));
+    packetStart_ = timeMs;
+    lastTime_ = timeMs;
+    runningStatus_ = 0;
+}
+
+void BleMidiPacketizer::closePacket() {
+    if (packet_.empty()) {
+        return;
+    }
+
+    completed_.insert(completed_.end(), packet_.begin(), packet_.end());
+    completedEnds_.push_back(completed_.size());
+
+    packets_++;
+    bytes_ += packet_.size();
+
+    packet_.clear();
+    runningStatus_ = 0;
+}
+
+} // namespace midiMind
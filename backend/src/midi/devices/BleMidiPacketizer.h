@@ -0,0 +1,185 @@
+// ============================================================================
+// File: backend/src/midi/devices/BleMidiPacketizer.h
+// Version: 2.0.3
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Packs outgoing MIDI messages into BLE-MIDI packets (Bluetooth LE MIDI
+//   specification 1.0). Several messages share one packet, so a chord
+//   costs one GATT write instead of one per note.
+//
+// Packet layout:
+//   header    1 0 t12..t7          (timestamp high 6 bits)
+//   message   1 t6..t0  status  data...
+//   message   1 t6..t0  data...            running status
+//   message   data...                      running status, same timestamp
+//
+// Features:
+//   - 13-bit millisecond timestamps; one packet never spans 128 ms, so the
+//     receiver can always recover low-byte wrap-around
+//   - Running status and timestamp byte elision within a packet
+//   - SysEx of any length: split into continuation packets when it does
+//     not fit, with the timestamp before F7 the spec requires
+//   - Real-time messages do not cancel running status
+//
+// ============================================================================
+
+#pragma once
+
+#include "../MidiMessage.h"
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace midiMind {
+
+/**
+ * @class BleMidiPacketizer
+ * @brief Aggregates messages into MTU-sized BLE-MIDI packets
+ *
+ * The caller add()s messages and flush()es the open packet when its
+ * deadline passes; packets are handed to the emit callback, in order.
+ *
+ * Thread Safety: Not thread-safe (owned by one writer thread), except
+ * getStatistics().
+ *
+ * Example:
+ * ```cpp
+ * BleMidiPacketizer packetizer(mtu - 3);
+ * auto emit = [&](const uint8_t* packet, size_t size) { write(fd, packet, size); };
+ * packetizer.add(noteOn, nowMs, emit);
+ * packetizer.add(noteOn2, nowMs, emit);
+ * packetizer.flush(emit);        // one packet, both notes
+ * ```
+ */
+class BleMidiPacketizer {
+public:
+    /// Smallest packet: the default ATT MTU (23) minus the write header
+    static constexpr size_t MIN_PACKET_SIZE = 20;
+
+    /// Largest BLE-MIDI packet (ATT MTU 515 - 3)
+    static constexpr size_t MAX_PACKET_SIZE = 512;
+
+    /// Span of the low timestamp byte; a packet stays below it
+    static constexpr uint32_t TIMESTAMP_WRAP_MS = 128;
+
+    /**
+     * @param maxPacketSize Largest packet to produce (ATT MTU - 3)
+     */
+    explicit BleMidiPacketizer(size_t maxPacketSize = MIN_PACKET_SIZE);
+
+    /**
+     * @brief Change the packet size limit (the open packet is kept)
+     */
+    void setMaxPacketSize(size_t size);
+
+    size_t getMaxPacketSize() const { return maxPacketSize_.load(); }
+
+    /**
+     * @brief Disable running status and timestamp elision (default on)
+     */
+    void setRunningStatus(bool enabled) { runningStatusEnabled_ = enabled; }
+
+    /**
+     * @brief Append a message to the open packet
+     * @param message Complete MIDI message
+     * @param timeMs Send time in milliseconds (any epoch; 13 bits are used)
+     * @param emit Called for each packet completed by this message:
+     *        void(const uint8_t* packet, size_t size)
+     */
+    template<typename Emit>
+    void add(const MidiMessage& message, uint32_t timeMs, Emit&& emit) {
+        const auto& data = message.getRawData();
+        append(data.data(), data.size(), timeMs);
+        emitCompleted(emit);
+    }
+
+    /**
+     * @brief Emit the open packet, if any
+     * @return true if a packet was emitted
+     */
+    template<typename Emit>
+    bool flush(Emit&& emit) {
+        closePacket();
+        bool emitted = !completedEnds_.empty();
+        emitCompleted(emit);
+        return emitted;
+    }
+
+    /**
+     * @brief Drop the open packet and any state carried between messages
+     */
+    void reset();
+
+    /**
+     * @brief Whether a packet is open (waiting for more messages or flush)
+     */
+    bool hasPending() const { return !packet_.empty(); }
+
+    /**
+     * @brief Statistics
+     * @return json {max_packet_size, packets, messages, bytes,
+     *         status_bytes_saved, timestamp_bytes_saved,
+     *         sysex_continuations, dropped}
+     */
+    json getStatistics() const;
+
+private:
+    /// Encode one message, closing packets as they fill
+    void append(const uint8_t* data, size_t size, uint32_t timeMs);
+
+    void appendSysEx(const uint8_t* data, size_t size, uint32_t timeMs);
+
+    /// Make room for `bytes` more bytes, starting a new packet if needed
+    void reserve(size_t bytes, uint32_t timeMs);
+
+    void openPacket(uint32_t timeMs);
+
+    /// Move the open packet to the completed list
+    void closePacket();
+
+    template<typename Emit>
+    void emitCompleted(Emit& emit) {
+        size_t begin = 0;
+        for (size_t end : completedEnds_) {
+            emit(completed_.data() + begin, end - begin);
+            begin = end;
+        }
+        completed_.clear();
+        completedEnds_.clear();
+    }
+
+    static uint8_t headerByte(uint32_t timeMs) {
+        return static_cast<uint8_t>(0x80 | ((timeMs >> 7) & 0x3F));
+    }
+
+    static uint8_t timestampByte(uint32_t timeMs) {
+        return static_cast<uint8_t>(0x80 | (timeMs & 0x7F));
+    }
+
+    std::atomic<size_t> maxPacketSize_;
+    bool runningStatusEnabled_;
+
+    // Open packet
+    std::vector<uint8_t> packet_;
+    uint32_t packetStart_;              ///< Time of the header
+    uint32_t lastTime_;                 ///< Time of the last timestamp byte
+    uint8_t runningStatus_;             ///< 0 if none (reset per packet)
+
+    // Packets completed by the current call (flat, reused)
+    std::vector<uint8_t> completed_;
+    std::vector<size_t> completedEnds_;
+
+    // Statistics
+    std::atomic<uint64_t> packets_;
+    std::atomic<uint64_t> messages_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> statusBytesSaved_;
+    std::atomic<uint64_t> timestampBytesSaved_;
+    std::atomic<uint64_t> sysexContinuations_;
+    std::atomic<uint64_t> dropped_;
+};
+
+} // namespace midiMind
@@ -0,0 +1,472 @@
+// ============================================================================
+// File: backend/src/midi/devices/MessageRing.h
+// Version: 4.2.1
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Changes v4.2.1:
+//   - FIXED: take() read a slot while a DROP_OLDEST producer refilled it;
+//     slot fields are atomics, so the discarded copy is merely stale
+//   - BLOCK producers poll with short sleeps instead of yielding, and a
+//     real-time thread (SCHED_FIFO/RR) never waits: it drops at once
+//
+// Description:
+//   Fixed-capacity, preallocated message queues for device traffic.
+//   Messages are copied inline into 32-byte slots (a channel message takes
+//   one slot, a SysEx as many consecutive slots as it needs), so enqueuing
+//   neither allocates nor locks. Receive threads push while API threads
+//   read sizes and statistics without ever waiting on each other.
+//
+// Variants:
+//   - SpscMessageRing: one producer thread (a device's receive thread)
+//   - MpscMessageRing: any number of producers (a shared output buffer)
+//   Both have a single consumer; callers with several reader threads
+//   serialize pop() among themselves.
+//
+// Full-queue policies:
+//   - DROP_NEWEST: the message being pushed is dropped
+//   - DROP_OLDEST: the oldest queued messages are discarded to make room
+//   - BLOCK: the producer waits for room, at most BLOCK_TIMEOUT, then drops
+//     the new message. Meant for send rings fed by API threads; a producer
+//     running under a real-time policy drops instead of waiting
+//
+// ============================================================================
+
+#pragma once
+
+#include "../MidiMessage.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace midiMind {
+
+enum class OverflowPolicy {
+    DROP_OLDEST,
+    DROP_NEWEST,
+    BLOCK
+};
+
+inline std::string overflowPolicyToString(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::DROP_OLDEST: return "DROP_OLDEST";
+        case OverflowPolicy::DROP_NEWEST: return "DROP_NEWEST";
+        case OverflowPolicy::BLOCK: return "BLOCK";
+        default: return "UNKNOWN";
+    }
+}
+
+/**
+ * @class MessageRing
+ * @brief Bounded lock-free queue of MIDI messages with inline storage
+ * @tparam MultiProducer true if several threads push concurrently
+ *
+ * Slots are claimed by advancing the tail, filled, then published by
+ * stamping the first slot's sequence with its position. The consumer
+ * takes a message once its first slot is published, in push order.
+ *
+ * Thread Safety: push() from one thread (any number if MultiProducer),
+ * pop()/clear() from one thread at a time, size() and getStatistics()
+ * from anywhere.
+ *
+ * Example:
+ * ```cpp
+ * SpscMessageRing ring(1024, OverflowPolicy::DROP_OLDEST);
+ * ring.push(message);             // Receive thread
+ * MidiMessage next;
+ * while (ring.pop(next)) { ... }  // Reader
+ * ```
+ */
+template <bool MultiProducer>
+class MessageRing {
+public:
+    /// Message bytes carried per slot
+    static constexpr size_t SLOT_BYTES = 12;
+
+    /// Longest wait of a BLOCK producer before it drops the message
+    static constexpr std::chrono::milliseconds BLOCK_TIMEOUT{100};
+
+    /// Sleep between two looks at a full ring of a BLOCK producer
+    static constexpr std::chrono::microseconds BLOCK_POLL_INTERVAL{200};
+
+    /**
+     * @param capacity Slots (rounded up to a power of two); the largest
+     *        message that fits is capacity * SLOT_BYTES bytes
+     * @param policy Behavior when the ring is full
+     */
+    explicit MessageRing(size_t capacity, OverflowPolicy policy = OverflowPolicy::DROP_NEWEST)
+        : capacity_(roundUp(capacity))
+        , mask_(capacity_ - 1)
+        , slots_(new Slot[capacity_])
+        , head_(0)
+        , tail_(0)
+        , policy_(policy)
+        , limit_(0)
+        , pushed_(0)
+        , popped_(0)
+        , droppedNewest_(0)
+        , droppedOldest_(0)
+        , blocked_(0)
+        , highWater_(0)
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    MessageRing(const MessageRing&) = delete;
+    MessageRing& operator=(const MessageRing&) = delete;
+
+    // ========================================================================
+    // PRODUCER
+    // ========================================================================
+
+    /**
+     * @brief Queue a message (bytes and timestamp)
+     * @return bool false if it was dropped
+     */
+    bool push(const MidiMessage& message) {
+        const auto& data = message.getRawData();
+        return push(data.data(), data.size(), message.getTimestamp());
+    }
+
+    bool push(const uint8_t* data, size_t size, uint64_t timestamp) {
+        size_t slots = slotsFor(size);
+        if (size == 0 || slots > capacity_) {
+            droppedNewest_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        bool waited = false;
+        std::chrono::steady_clock::time_point deadline;
+
+        for (;;) {
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            uint64_t head = head_.load(std::memory_order_acquire);
+
+            size_t limit = limit_.load(std::memory_order_relaxed);
+            bool limited = limit > 0 && size_t(queued()) >= limit;
+
+            if (!limited && tail + slots - head <= capacity_) {
+                if (MultiProducer) {
+                    if (!tail_.compare_exchange_weak(tail, tail + slots,
+                                                     std::memory_order_relaxed)) {
+                        continue;   // Another producer claimed these slots
+                    }
+                } else {
+                    tail_.store(tail + slots, std::memory_order_relaxed);
+                }
+
+                write(tail, data, size, timestamp);
+
+                pushed_.fetch_add(1, std::memory_order_relaxed);
+                updateHighWater();
+                return true;
+            }
+
+            switch (policy_.load(std::memory_order_relaxed)) {
+                case OverflowPolicy::DROP_OLDEST:
+                    if (discardOldest()) {
+                        continue;
+                    }
+                    break;      // Oldest not published yet: drop this one
+
+                case OverflowPolicy::BLOCK: {
+                    auto now = std::chrono::steady_clock::now();
+                    if (!waited) {
+                        if (realtimeThread()) {
+                            break;      // Never stall a real-time thread
+                        }
+                        waited = true;
+                        deadline = now + BLOCK_TIMEOUT;
+                        blocked_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (now < deadline) {
+                        std::this_thread::sleep_for(BLOCK_POLL_INTERVAL);
+                        continue;
+                    }
+                    break;
+                }
+
+                case OverflowPolicy::DROP_NEWEST:
+                default:
+                    break;
+            }
+
+            droppedNewest_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    // ========================================================================
+    // CONSUMER
+    // ========================================================================
+
+    /**
+     * @brief Take the oldest message
+     * @param message Receives it (timestamp included)
+     * @return bool false if the ring is empty
+     */
+    bool pop(MidiMessage& message) {
+        std::vector<uint8_t> bytes;
+        uint64_t timestamp = 0;
+
+        if (!take(&bytes, &timestamp)) {
+            return false;
+        }
+
+        message = MidiMessage(std::move(bytes));
+        message.setTimestamp(timestamp);
+        return true;
+    }
+
+    /**
+     * @brief Discard every published message
+     */
+    void clear() {
+        while (take(nullptr, nullptr)) {
+        }
+    }
+
+    // ========================================================================
+    // STATE
+    // ========================================================================
+
+    /**
+     * @brief Messages queued (exact when no push or pop is in progress)
+     */
+    size_t size() const {
+        return static_cast<size_t>(queued());
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    void setPolicy(OverflowPolicy policy) {
+        policy_.store(policy, std::memory_order_relaxed);
+    }
+
+    OverflowPolicy getPolicy() const {
+        return policy_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Limit the number of queued messages below what the slots
+     *        hold (0 = no limit); the full-queue policy applies beyond it
+     */
+    void setLimit(size_t messages) {
+        limit_.store(messages, std::memory_order_relaxed);
+    }
+
+    uint64_t getDropped() const {
+        return droppedNewest_.load(std::memory_order_relaxed) +
+               droppedOldest_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Statistics
+     * @return json {capacity, limit, size, policy, pushed, popped,
+     *         dropped_newest, dropped_oldest, blocked, high_water}
+     */
+    json getStatistics() const {
+        return json{
+            {"capacity", capacity_},
+            {"limit", limit_.load(std::memory_order_relaxed)},
+            {"size", size()},
+            {"policy", overflowPolicyToString(getPolicy())},
+            {"pushed", pushed_.load(std::memory_order_relaxed)},
+            {"popped", popped_.load(std::memory_order_relaxed)},
+            {"dropped_newest", droppedNewest_.load(std::memory_order_relaxed)},
+            {"dropped_oldest", droppedOldest_.load(std::memory_order_relaxed)},
+            {"blocked", blocked_.load(std::memory_order_relaxed)},
+            {"high_water", highWater_.load(std::memory_order_relaxed)}
+        };
+    }
+
+private:
+    static constexpr size_t SLOT_WORDS = SLOT_BYTES / sizeof(uint32_t);
+
+    /// Fields other than sequence are relaxed atomics: a discarding
+    /// producer may rewrite a slot the consumer is still copying
+    struct alignas(32) Slot {
+        /// First slot of a message: its position + 1 once published
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> timestamp;
+        std::atomic<uint32_t> size;
+        std::atomic<uint32_t> words[SLOT_WORDS];
+    };
+
+    static size_t roundUp(size_t capacity) {
+        size_t result = 2;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static size_t slotsFor(size_t size) {
+        return size <= SLOT_BYTES ? 1 : (size + SLOT_BYTES - 1) / SLOT_BYTES;
+    }
+
+    static void storeChunk(Slot& slot, const uint8_t* data, size_t chunk) {
+        for (size_t w = 0; w < SLOT_WORDS; ++w) {
+            uint32_t word = 0;
+            size_t offset = w * sizeof(uint32_t);
+            if (offset < chunk) {
+                std::memcpy(&word, data + offset,
+                            std::min(sizeof(uint32_t), chunk - offset));
+            }
+            slot.words[w].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    static void loadChunk(const Slot& slot, uint8_t* data, size_t chunk) {
+        for (size_t w = 0, offset = 0; offset < chunk; ++w, offset += sizeof(uint32_t)) {
+            uint32_t word = slot.words[w].load(std::memory_order_relaxed);
+            std::memcpy(data + offset, &word, std::min(sizeof(uint32_t), chunk - offset));
+        }
+    }
+
+    /// True on a thread scheduled SCHED_FIFO or SCHED_RR
+    static bool realtimeThread() {
+#ifdef __linux__
+        int policy = SCHED_OTHER;
+        sched_param param{};
+        if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+            return policy == SCHED_FIFO || policy == SCHED_RR;
+        }
+#endif
+        return false;
+    }
+
+    int64_t queued() const {
+        int64_t count = static_cast<int64_t>(pushed_.load(std::memory_order_relaxed)) -
+                        static_cast<int64_t>(popped_.load(std::memory_order_relaxed)) -
+                        static_cast<int64_t>(droppedOldest_.load(std::memory_order_relaxed));
+        return count > 0 ? count : 0;
+    }
+
+    void write(uint64_t position, const uint8_t* data, size_t size, uint64_t timestamp) {
+        Slot& first = slots_[position & mask_];
+        first.timestamp.store(timestamp, std::memory_order_relaxed);
+        first.size.store(static_cast<uint32_t>(size), std::memory_order_relaxed);
+
+        for (size_t offset = 0, i = 0; offset < size; offset += SLOT_BYTES, ++i) {
+            size_t chunk = size - offset < SLOT_BYTES ? size - offset : SLOT_BYTES;
+            storeChunk(slots_[(position + i) & mask_], data + offset, chunk);
+        }
+
+        first.sequence.store(position + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Take the message at the head (consumer or discarding producer)
+     * @param bytes Receives its bytes (nullptr = discard)
+     * @return bool false if no published message is at the head
+     */
+    bool take(std::vector<uint8_t>* bytes, uint64_t* timestamp) {
+        for (;;) {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            const Slot& first = slots_[head & mask_];
+
+            if (first.sequence.load(std::memory_order_acquire) != head + 1) {
+                return false;
+            }
+
+            // A discarding producer may free and refill these slots while we
+            // read them; the head then moves and the stale copy is thrown away
+            size_t size = first.size.load(std::memory_order_relaxed);
+            if (size > capacity_ * SLOT_BYTES) {
+                size = capacity_ * SLOT_BYTES;
+            }
+
+            if (bytes) {
+                bytes->resize(size);
+                for (size_t offset = 0, i = 0; offset < size; offset += SLOT_BYTES, ++i) {
+                    size_t chunk = size - offset < SLOT_BYTES ? size - offset : SLOT_BYTES;
+                    loadChunk(slots_[(head + i) & mask_], bytes->data() + offset, chunk);
+                }
+                *timestamp = first.timestamp.load(std::memory_order_relaxed);
+            }
+
+            if (head_.compare_exchange_strong(head, head + slotsFor(size),
+                                              std::memory_order_acq_rel)) {
+                popped_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    /// Make room by discarding the oldest message (producer)
+    bool discardOldest() {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        const Slot& first = slots_[head & mask_];
+
+        if (first.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+
+        size_t size = first.size.load(std::memory_order_relaxed);
+        if (size > capacity_ * SLOT_BYTES) {
+            return false;
+        }
+
+        if (head_.compare_exchange_strong(head, head + slotsFor(size),
+                                          std::memory_order_acq_rel)) {
+            droppedOldest_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;    // Freed by us or by the consumer
+    }
+
+    void updateHighWater() {
+        size_t current = size();
+        size_t high = highWater_.load(std::memory_order_relaxed);
+        while (current > high &&
+               !highWater_.compare_exchange_weak(high, current, std::memory_order_relaxed)) {
+        }
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<uint64_t> head_;      ///< Consumer position
+    alignas(64) std::atomic<uint64_t> tail_;      ///< Producer position
+
+    std::atomic<OverflowPolicy> policy_;
+    std::atomic<size_t> limit_;
+
+    // Statistics
+    std::atomic<uint64_t> pushed_;
+    std::atomic<uint64_t> popped_;
+    std::atomic<uint64_t> droppedNewest_;
+    std::atomic<uint64_t> droppedOldest_;
+    std::atomic<uint64_t> blocked_;
+    std::atomic<size_t> highWater_;
+};
+
+/// Ring fed by one thread (a device's receive thread)
+using SpscMessageRing = MessageRing<false>;
+
+/// Ring fed by several threads (an output shared by routes)
+using MpscMessageRing = MessageRing<true>;
+
+} // namespace midiMind
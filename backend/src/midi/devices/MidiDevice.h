@@ -1,15 +1,46 @@
 // ============================================================================
 // File: backend/src/midi/devices/MidiDevice.h
-// Version: 4.2.0
+// Version: 4.2.6
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v4.2.6:
+//   - setJitterBuffer(): re-timing of received messages for devices whose
+//     messages carry the sender's time (BLE)
+//   - setLatencyCallback(): devices report the delay they add on input
+//
+// Changes v4.2.5:
+//   - setBatchCallback(): messages received together (one BLE packet) are
+//     handed over in one call
+//
+// Changes v4.2.4:
+//   - setOverflowPolicy(): full-queue behavior of the device's message
+//     rings (MessageRing)
+//
+// Changes v4.2.3:
+//   - Timed output: OutputMode (DIRECT / QUEUED), sendMessagesAt() for
+//     devices whose driver can deliver at a given time
+//
+// Changes v4.2.2:
+//   - Received-message callback moved here from the ALSA devices:
+//     setMessageCallback(); devices call dispatchReceived(), which stamps
+//     the arrival time and hands the message over on the receive thread
+//
+// Changes v4.2.1:
+//   - ADDED: sendMessages() (burst of messages, one output flush)
+//
+// ============================================================================
 
 #pragma once
 
 #include "../MidiMessage.h"
+#include "MessageRing.h"
+#include "../../timing/TimestampManager.h"
 #include <string>
 #include <atomic>
 #include <memory>
+#include <functional>
+#include <chrono>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -41,6 +72,11 @@ enum class DeviceStatus {
     ERROR
 };
 
+enum class OutputMode {
+    DIRECT,     ///< Sent when handed over; timing is up to our threads
+    QUEUED      ///< Handed over ahead, delivered by the driver at its time
+};
+
 // ============================================================================
 // CLASS: MidiDevice (Abstract Base)
 // ============================================================================
@@ -56,6 +92,10 @@ enum class DeviceStatus {
  */
 class MidiDevice {
 public:
+    using MessageCallback = std::function<void(const MidiMessage&)>;
+    using BatchCallback = std::function<void(const MidiMessage*, size_t)>;
+    using LatencyCallback = std::function<void(uint64_t latencyUs)>;
+    
     // ========================================================================
     // CONSTRUCTOR / DESTRUCTOR
     // ========================================================================
@@ -141,6 +181,80 @@ public:
     // VIRTUAL METHODS WITH DEFAULT IMPLEMENTATION
     // ========================================================================
     
+    /**
+     * @brief Send several MIDI messages as one burst
+     * @param messages First message
+     * @param count Number of messages
+     * @return size_t Number of messages sent
+     * @note Sends them one by one; devices override this to flush their
+     *       output once per burst instead of once per message
+     */
+    virtual size_t sendMessages(const MidiMessage* messages, size_t count) {
+        size_t sent = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (sendMessage(messages[i])) {
+                sent++;
+            }
+        }
+        return sent;
+    }
+    
+    /**
+     * @brief Send messages to be delivered at a given time
+     * @param messages First message
+     * @param count Number of messages
+     * @param due Delivery time (steady clock)
+     * @return size_t Number of messages accepted
+     * @note Only called when supportsTimedOutput(); the default sends now
+     */
+    virtual size_t sendMessagesAt(const MidiMessage* messages, size_t count,
+                                  std::chrono::steady_clock::time_point due) {
+        return sendMessages(messages, count);
+    }
+    
+    /**
+     * @brief Whether sendMessagesAt() currently delivers at the given time
+     *        (QUEUED mode on a device that supports it)
+     */
+    virtual bool supportsTimedOutput() const {
+        return false;
+    }
+    
+    /**
+     * @brief Choose how messages are sent
+     * @return bool false if the device has no such mode
+     */
+    virtual bool setOutputMode(OutputMode mode) {
+        return mode == OutputMode::DIRECT;
+    }
+    
+    virtual OutputMode getOutputMode() const {
+        return OutputMode::DIRECT;
+    }
+    
+    /**
+     * @brief What the device's queues do when full
+     *
+     * BLOCK only ever applies to send queues: receive queues are fed by
+     * the sequencer reactor or a reader thread, which must not wait.
+     *
+     * @return bool false if the device has no queue the policy applies to
+     */
+    virtual bool setOverflowPolicy(OverflowPolicy policy) {
+        return false;
+    }
+    
+    /**
+     * @brief Hold received messages so that they leave evenly spaced, as
+     *        the sender played them
+     * @param maxDepth Longest hold (0: messages leave on arrival)
+     * @param adaptive Hold only as long as the measured jitter requires
+     * @return bool false if the device cannot re-time its input
+     */
+    virtual bool setJitterBuffer(std::chrono::microseconds maxDepth, bool adaptive) {
+        return false;
+    }
+    
     /**
      * @brief Get device port identifier
      * @return std::string Port identifier (empty if not applicable)
@@ -163,10 +277,51 @@ public:
             {"connected", isConnected()},
             {"messages_received", messagesReceived_.load()},
             {"messages_sent", messagesSent_.load()},
-            {"port", getPort()}
+            {"port", getPort()},
+            {"output_mode", outputModeToString(getOutputMode())}
         };
     }
     
+    // ========================================================================
+    // RECEIVE CALLBACK
+    // ========================================================================
+    
+    /**
+     * @brief Set the callback for received messages
+     * @param callback Called on the device's receive thread as soon as a
+     *        message arrives (nullptr = none). While a callback is set,
+     *        received messages go to it instead of the receive queue.
+     */
+    void setMessageCallback(MessageCallback callback) {
+        std::atomic_store(&messageCallback_, callback ?
+            std::make_shared<const MessageCallback>(std::move(callback)) :
+            std::shared_ptr<const MessageCallback>());
+    }
+    
+    /**
+     * @brief Set the callback for messages received together
+     * @param callback Called on the receive thread with all the messages of
+     *        one reception, in order (nullptr = none). Without it, such
+     *        messages go to the message callback one by one.
+     */
+    void setBatchCallback(BatchCallback callback) {
+        std::atomic_store(&batchCallback_, callback ?
+            std::make_shared<const BatchCallback>(std::move(callback)) :
+            std::shared_ptr<const BatchCallback>());
+    }
+    
+    /**
+     * @brief Set the callback for the input latency the device measures
+     * @param callback Called from the device's receive thread, about once
+     *        per second, with the mean delay between a message's sending
+     *        and its delivery (nullptr = none)
+     */
+    void setLatencyCallback(LatencyCallback callback) {
+        std::atomic_store(&latencyCallback_, callback ?
+            std::make_shared<const LatencyCallback>(std::move(callback)) :
+            std::shared_ptr<const LatencyCallback>());
+    }
+    
     // ========================================================================
     // GETTERS
     // ========================================================================
@@ -228,7 +383,67 @@ public:
         }
     }
 
+    static std::string outputModeToString(OutputMode mode) {
+        switch (mode) {
+            case OutputMode::DIRECT: return "DIRECT";
+            case OutputMode::QUEUED: return "QUEUED";
+            default: return "UNKNOWN";
+        }
+    }
+
 protected:
+    /**
+     * @brief Stamp a received message with its arrival time and hand it
+     *        to the callback
+     * @return bool true if a callback took it (do not queue it)
+     */
+    bool dispatchReceived(MidiMessage& message) {
+        message.setTimestamp(TimestampManager::instance().now());
+        
+        auto callback = std::atomic_load(&messageCallback_);
+        if (!callback) {
+            return false;
+        }
+        
+        (*callback)(message);
+        return true;
+    }
+    
+    /**
+     * @brief Hand messages received together to the callbacks
+     * @param messages Messages in order, already stamped by the device
+     *        (TimestampManager time)
+     * @param count Number of messages
+     * @return bool true if a callback took them (do not queue them)
+     */
+    bool dispatchReceived(const MidiMessage* messages, size_t count) {
+        auto batch = std::atomic_load(&batchCallback_);
+        if (batch) {
+            (*batch)(messages, count);
+            return true;
+        }
+        
+        auto callback = std::atomic_load(&messageCallback_);
+        if (!callback) {
+            return false;
+        }
+        
+        for (size_t i = 0; i < count; ++i) {
+            (*callback)(messages[i]);
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Hand a latency measurement to the latency callback
+     */
+    void reportLatency(uint64_t latencyUs) {
+        auto callback = std::atomic_load(&latencyCallback_);
+        if (callback) {
+            (*callback)(latencyUs);
+        }
+    }
+    
     // Immutable after construction (thread-safe reads)
     const std::string id_;
     const std::string name_;
@@ -239,6 +454,12 @@ protected:
     std::atomic<DeviceStatus> status_;
     std::atomic<uint64_t> messagesReceived_;
     std::atomic<uint64_t> messagesSent_;
+    
+private:
+    /// Accessed with std::atomic_load/atomic_store (set from any thread)
+    std::shared_ptr<const MessageCallback> messageCallback_;
+    std::shared_ptr<const BatchCallback> batchCallback_;
+    std::shared_ptr<const LatencyCallback> latencyCallback_;
 };
 
 } // namespace midiMind
\ No newline at end of file
@@ -1,13 +1,34 @@
 // ============================================================================
 // File: backend/src/midi/devices/MidiDeviceManager.cpp
-// Version: 4.2.0 - EventBus Integration + BLE MIDI Support
+// Version: 4.2.5
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v4.2.5:
+//   - discoverUsbClient() queries the announced client through the shared
+//     AlsaSequencer (getClientInfo/getClientPorts) instead of opening a
+//     sequencer client for every announcement
+//
+// Changes v4.2.4:
+//   - FIXED: disconnectAll() did not call the disconnect callback nor
+//     publish DeviceDisconnectedEvent (devices stayed registered with the
+//     router)
+//
+// Changes v4.2.3:
+//   - Hot-plug driven by ALSA announcements and BlueZ signals; the device
+//     list is updated per client / per object instead of rescanned
+//
+// Changes v4.2.2:
+//   - USB devices can be opened as RawMidiDevice (setDeviceBackend)
+//
+// ============================================================================
 
 #include "MidiDeviceManager.h"
 #include "UsbMidiDevice.h"
+#include "RawMidiDevice.h"
 #include "VirtualMidiDevice.h"
 #include "BleMidiDevice.h"
+#include "AlsaSequencer.h"
 #include "../../core/Logger.h"
 #include "../../core/EventBus.h"
 #include "../../core/TimeUtils.h"
@@ -19,6 +40,7 @@
 #include <chrono>
 #include <thread>
 #include <set>
+#include <cstring>
 
 #ifdef __linux__
 #include <alsa/asoundlib.h>
@@ -217,6 +239,10 @@ bool MidiDeviceManager::connect(const std::string& deviceId) {
 }
 
 void MidiDeviceManager::disconnect(const std::string& deviceId) {
+    disconnectDevice(deviceId, "User disconnected");
+}
+
+void MidiDeviceManager::disconnectDevice(const std::string& deviceId, const std::string& reason) {
     bool found = false;
     std::string deviceName;
     
@@ -256,7 +282,7 @@ void MidiDeviceManager::disconnect(const std::string& deviceId) {
                 eventBus_->publish(events::DeviceDisconnectedEvent(
                     deviceId,
                     deviceName,
-                    "User disconnected",
+                    reason,
                     TimeUtils::systemNow()
                 ));
                 Logger::debug("MidiDeviceManager", "Published DeviceDisconnectedEvent: " + deviceName);
@@ -269,17 +295,49 @@ void MidiDeviceManager::disconnect(const std::string& deviceId) {
 }
 
 void MidiDeviceManager::disconnectAll() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    Logger::info("MidiDeviceManager", "Disconnecting all devices...");
+    std::vector<std::shared_ptr<MidiDevice>> disconnected;
     
-    for (auto& device : devices_) {
-        device->disconnect();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        Logger::info("MidiDeviceManager", "Disconnecting all devices...");
+        
+        for (auto& device : devices_) {
+            device->disconnect();
+        }
+        
+        disconnected.swap(devices_);
+        
+        Logger::info("MidiDeviceManager", "✅ All devices disconnected");
     }
     
-    devices_.clear();
+    // Same notifications as disconnectDevice(), so listeners (router
+    // registrations) drop every device
+    std::function<void(const std::string&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
+        callback = onDeviceDisconnect_;
+    }
     
-    Logger::info("MidiDeviceManager", "✅ All devices disconnected");
+    for (const auto& device : disconnected) {
+        if (callback) {
+            callback(device->getId());
+        }
+        
+        if (eventBus_) {
+            try {
+                eventBus_->publish(events::DeviceDisconnectedEvent(
+                    device->getId(),
+                    device->getName(),
+                    "All devices disconnected",
+                    TimeUtils::systemNow()
+                ));
+            } catch (const std::exception& e) {
+                Logger::error("MidiDeviceManager", 
+                    "Failed to publish DeviceDisconnectedEvent: " + std::string(e.what()));
+            }
+        }
+    }
 }
 
 bool MidiDeviceManager::isConnected(const std::string& deviceId) const {
@@ -291,6 +349,43 @@ bool MidiDeviceManager::isConnected(const std::string& deviceId) const {
                       });
 }
 
+bool MidiDeviceManager::setDeviceBackend(const std::string& deviceId, DeviceBackend backend) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (backend == DeviceBackend::RAWMIDI) {
+        auto it = std::find_if(availableDevices_.begin(), availableDevices_.end(),
+                              [&deviceId](const MidiDeviceInfo& info) {
+                                  return info.id == deviceId;
+                              });
+        
+        if (it == availableDevices_.end() || it->rawmidi.empty()) {
+            Logger::error("MidiDeviceManager", "No raw MIDI port for device: " + deviceId);
+            return false;
+        }
+    }
+    
+    deviceBackends_[deviceId] = backend;
+    
+    Logger::info("MidiDeviceManager", "Backend of " + deviceId + ": " +
+                deviceBackendToString(backend));
+    return true;
+}
+
+DeviceBackend MidiDeviceManager::getDeviceBackend(const std::string& deviceId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = deviceBackends_.find(deviceId);
+    return it != deviceBackends_.end() ? it->second : DeviceBackend::SEQUENCER;
+}
+
+std::string MidiDeviceManager::deviceBackendToString(DeviceBackend backend) {
+    switch (backend) {
+        case DeviceBackend::SEQUENCER: return "SEQUENCER";
+        case DeviceBackend::RAWMIDI: return "RAWMIDI";
+        default: return "UNKNOWN";
+    }
+}
+
 std::shared_ptr<MidiDevice> MidiDeviceManager::getDevice(const std::string& deviceId) {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -313,13 +408,20 @@ void MidiDeviceManager::startHotPlugMonitoring(int intervalMs) {
         return;
     }
     
-    Logger::info("MidiDeviceManager", "Starting hot-plug monitoring (interval=" + 
-                std::to_string(intervalMs) + "ms)");
+    Logger::info("MidiDeviceManager", "Starting hot-plug monitoring");
     
     scanIntervalMs_ = intervalMs;
     hotPlugRunning_ = true;
     hotPlugThread_ = std::thread(&MidiDeviceManager::hotPlugThread, this);
     
+#ifdef __linux__
+    if (bluetoothEnabled_.load()) {
+        bleLoop_ = g_main_loop_new(g_main_context_new(), FALSE);
+        g_main_context_unref(g_main_loop_get_context(bleLoop_));     // Owned by the loop
+        bleMonitorThread_ = std::thread(&MidiDeviceManager::bleMonitorThread, this);
+    }
+#endif
+    
     Logger::info("MidiDeviceManager", "✅ Hot-plug monitoring started");
 }
 
@@ -330,12 +432,36 @@ void MidiDeviceManager::stopHotPlugMonitoring() {
     
     Logger::info("MidiDeviceManager", "Stopping hot-plug monitoring...");
     
-    hotPlugRunning_ = false;
+    {
+        std::lock_guard<std::mutex> lock(hotPlugMutex_);
+        hotPlugRunning_ = false;
+    }
+    hotPlugCondition_.notify_all();
     
     if (hotPlugThread_.joinable()) {
         hotPlugThread_.join();
     }
     
+#ifdef __linux__
+    if (bleLoop_) {
+        // Quit from inside the loop: also works if it has not started yet
+        GSource* source = g_idle_source_new();
+        g_source_set_callback(source, [](gpointer loop) -> gboolean {
+            g_main_loop_quit(static_cast<GMainLoop*>(loop));
+            return G_SOURCE_REMOVE;
+        }, bleLoop_, nullptr);
+        g_source_attach(source, g_main_loop_get_context(bleLoop_));
+        g_source_unref(source);
+        
+        if (bleMonitorThread_.joinable()) {
+            bleMonitorThread_.join();
+        }
+        
+        g_main_loop_unref(bleLoop_);
+        bleLoop_ = nullptr;
+    }
+#endif
+    
     Logger::info("MidiDeviceManager", "✅ Hot-plug monitoring stopped");
 }
 
@@ -343,6 +469,10 @@ bool MidiDeviceManager::isHotPlugMonitoringActive() const {
     return hotPlugRunning_;
 }
 
+bool MidiDeviceManager::isHotPlugEventDriven() const {
+    return hotPlugEventDriven_.load();
+}
+
 void MidiDeviceManager::setHotPlugCallbacks(
     std::function<void(const std::string&)> onConnect,
     std::function<void(const std::string&)> onDisconnect) 
@@ -360,18 +490,331 @@ void MidiDeviceManager::setEventBus(std::shared_ptr<EventBus> eventBus) {
 void MidiDeviceManager::hotPlugThread() {
     Logger::debug("MidiDeviceManager", "Hot-plug monitor thread started");
     
+#ifdef __linux__
+    // Client and port start/exit events of the whole system, delivered by
+    // the sequencer's reactor
+    auto sequencer = AlsaSequencer::acquire();
+    int announcePort = -1;
+    
+    if (sequencer) {
+        int ownClient = sequencer->getClientId();
+        announcePort = sequencer->createPort("Hot-plug",
+                                             SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_NO_EXPORT,
+                                             SND_SEQ_PORT_TYPE_APPLICATION,
+                                             [this, ownClient](const snd_seq_event_t* ev) {
+                                                 onAnnounce(ev, ownClient);
+                                             });
+        
+        if (announcePort >= 0 &&
+            sequencer->connectFrom(announcePort, SND_SEQ_CLIENT_SYSTEM,
+                                   SND_SEQ_PORT_SYSTEM_ANNOUNCE) < 0) {
+            sequencer->deletePort(announcePort);
+            announcePort = -1;
+        }
+    }
+    
+    hotPlugEventDriven_ = announcePort >= 0;
+    
+    if (announcePort >= 0) {
+        while (hotPlugRunning_) {
+            std::map<int, bool> changes;
+            {
+                std::unique_lock<std::mutex> lock(hotPlugMutex_);
+                hotPlugCondition_.wait(lock, [this] {
+                    return !hotPlugRunning_ || !pendingClients_.empty();
+                });
+                
+                if (!hotPlugRunning_) break;
+                
+                hotPlugCondition_.wait_for(lock, std::chrono::milliseconds(HOTPLUG_SETTLE_MS),
+                                           [this] { return !hotPlugRunning_; });
+                changes.swap(pendingClients_);
+            }
+            
+            for (const auto& change : changes) {
+                refreshUsbClient(*sequencer, change.first, change.second);
+            }
+        }
+        
+        sequencer->deletePort(announcePort);
+        hotPlugEventDriven_ = false;
+        
+        Logger::debug("MidiDeviceManager", "Hot-plug monitor thread stopped");
+        return;
+    }
+    
+    sequencer.reset();
+#endif
+    
+    Logger::warning("MidiDeviceManager", "ALSA announcements unavailable: rescanning USB every " +
+                   std::to_string(scanIntervalMs_.load()) + "ms");
+    
     while (hotPlugRunning_) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(scanIntervalMs_.load()));
+        {
+            std::unique_lock<std::mutex> lock(hotPlugMutex_);
+            hotPlugCondition_.wait_for(lock, std::chrono::milliseconds(scanIntervalMs_.load()),
+                                       [this] { return !hotPlugRunning_; });
+        }
         
         if (!hotPlugRunning_) break;
         
-        Logger::debug("MidiDeviceManager", "Hot-plug: Rescanning devices...");
-        discoverDevices(false);
+        updateAvailableDevices([](const MidiDeviceInfo& info) {
+                                   return info.type == DeviceType::USB;
+                               },
+                               discoverUsbDevices(), "Device unplugged");
     }
     
     Logger::debug("MidiDeviceManager", "Hot-plug monitor thread stopped");
 }
 
+void MidiDeviceManager::updateAvailableDevices(
+    const std::function<bool(const MidiDeviceInfo&)>& inScope,
+    const std::vector<MidiDeviceInfo>& found,
+    const std::string& reason)
+{
+    std::vector<std::string> vanished;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        for (auto it = availableDevices_.begin(); it != availableDevices_.end();) {
+            bool present = std::any_of(found.begin(), found.end(),
+                                       [&it](const MidiDeviceInfo& info) {
+                                           return info.id == it->id;
+                                       });
+            
+            if (inScope(*it) && !present) {
+                Logger::info("MidiDeviceManager", "Device gone: " + it->name);
+                vanished.push_back(it->id);
+                it = availableDevices_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        
+        for (const auto& info : found) {
+            bool known = std::any_of(availableDevices_.begin(), availableDevices_.end(),
+                                     [&info](const MidiDeviceInfo& existing) {
+                                         return existing.id == info.id;
+                                     });
+            
+            // Known entries keep what identification added to them
+            if (!known) {
+                Logger::info("MidiDeviceManager", "Device available: " + info.name);
+                availableDevices_.push_back(info);
+            }
+        }
+    }
+    
+    for (const auto& deviceId : vanished) {
+        if (isConnected(deviceId)) {
+            disconnectDevice(deviceId, reason);
+        }
+    }
+}
+
+#ifdef __linux__
+void MidiDeviceManager::refreshUsbClient(AlsaSequencer& sequencer, int client, bool exited) {
+    std::vector<MidiDeviceInfo> found;
+    if (!exited) {
+        found = discoverUsbClient(sequencer, client);
+    }
+    
+    std::string prefix = std::to_string(client) + ":";
+    updateAvailableDevices([&prefix](const MidiDeviceInfo& info) {
+                               return info.type == DeviceType::USB &&
+                                      info.port.compare(0, prefix.size(), prefix) == 0;
+                           },
+                           found, "Device unplugged");
+}
+
+void MidiDeviceManager::onAnnounce(const snd_seq_event_t* ev, int ownClient) {
+    bool exited;
+    
+    switch (ev->type) {
+        case SND_SEQ_EVENT_CLIENT_START:
+        case SND_SEQ_EVENT_CLIENT_CHANGE:
+        case SND_SEQ_EVENT_PORT_START:
+        case SND_SEQ_EVENT_PORT_EXIT:
+        case SND_SEQ_EVENT_PORT_CHANGE:
+            exited = false;
+            break;
+        case SND_SEQ_EVENT_CLIENT_EXIT:
+            exited = true;
+            break;
+        default:
+            return;
+    }
+    
+    int client = ev->data.addr.client;
+    if (client == ownClient) {
+        return;     // Our own device ports
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(hotPlugMutex_);
+        pendingClients_[client] = exited;       // Latest state wins
+    }
+    hotPlugCondition_.notify_one();
+}
+
+std::vector<MidiDeviceInfo> MidiDeviceManager::discoverUsbClient(AlsaSequencer& sequencer,
+                                                                 int client) {
+    std::vector<MidiDeviceInfo> devices;
+    
+    AlsaSequencer::ClientInfo clientInfo;
+    if (!sequencer.getClientInfo(client, clientInfo)) {
+        return devices;     // Gone again
+    }
+    
+    MidiDeviceInfo info;
+    if (describeUsbClient(clientInfo, sequencer.getClientPorts(client), info)) {
+        devices.push_back(info);
+    }
+    
+    return devices;
+}
+
+void MidiDeviceManager::bleMonitorThread() {
+    Logger::debug("MidiDeviceManager", "BLE monitor thread started");
+    
+    // Signal callbacks are dispatched on the context current at subscription
+    GMainContext* context = g_main_loop_get_context(bleLoop_);
+    g_main_context_push_thread_default(context);
+    
+    GError* error = nullptr;
+    GDBusConnection* connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error);
+    
+    if (error) {
+        Logger::warning("MidiDeviceManager", 
+            "BLE hot-plug unavailable (D-Bus): " + std::string(error->message));
+        g_error_free(error);
+        g_main_context_pop_thread_default(context);
+        return;
+    }
+    
+    GDBusSignalCallback callback = [](GDBusConnection* conn, const gchar* sender,
+                                      const gchar* objectPath, const gchar* interfaceName,
+                                      const gchar* signalName, GVariant* parameters,
+                                      gpointer userData) {
+        static_cast<MidiDeviceManager*>(userData)->handleBleSignal(
+            conn, objectPath, signalName, parameters);
+    };
+    
+    // InterfacesAdded / InterfacesRemoved
+    guint objectsSubscription = g_dbus_connection_signal_subscribe(
+        connection, "org.bluez", "org.freedesktop.DBus.ObjectManager", nullptr,
+        "/", nullptr, G_DBUS_SIGNAL_FLAGS_NONE, callback, this, nullptr);
+    
+    // A device's services may resolve after it appeared
+    guint propertiesSubscription = g_dbus_connection_signal_subscribe(
+        connection, "org.bluez", "org.freedesktop.DBus.Properties", "PropertiesChanged",
+        nullptr, "org.bluez.Device1", G_DBUS_SIGNAL_FLAGS_NONE, callback, this, nullptr);
+    
+    g_main_loop_run(bleLoop_);
+    
+    g_dbus_connection_signal_unsubscribe(connection, objectsSubscription);
+    g_dbus_connection_signal_unsubscribe(connection, propertiesSubscription);
+    g_object_unref(connection);
+    
+    g_main_context_pop_thread_default(context);
+    
+    Logger::debug("MidiDeviceManager", "BLE monitor thread stopped");
+}
+
+void MidiDeviceManager::handleBleSignal(GDBusConnection* connection, const char* objectPath,
+                                        const char* signalName, GVariant* parameters) {
+    if (std::strcmp(signalName, "InterfacesAdded") == 0) {
+        const gchar* path = nullptr;
+        GVariant* interfaces = nullptr;
+        g_variant_get(parameters, "(&o@a{sa{sv}})", &path, &interfaces);
+        
+        MidiDeviceInfo info;
+        if (parseBleDevice(path, interfaces, info)) {
+            std::string deviceId = info.id;
+            updateAvailableDevices([&deviceId](const MidiDeviceInfo& existing) {
+                                       return existing.id == deviceId;
+                                   },
+                                   {info}, "");
+        }
+        
+        g_variant_unref(interfaces);
+        
+    } else if (std::strcmp(signalName, "InterfacesRemoved") == 0) {
+        const gchar* path = nullptr;
+        GVariantIter* removed = nullptr;
+        g_variant_get(parameters, "(&oas)", &path, &removed);
+        
+        bool isDevice = false;
+        const gchar* interfaceName;
+        while (g_variant_iter_next(removed, "&s", &interfaceName)) {
+            if (std::strcmp(interfaceName, "org.bluez.Device1") == 0) {
+                isDevice = true;
+            }
+        }
+        g_variant_iter_free(removed);
+        
+        if (isDevice) {
+            std::string pathStr(path);
+            updateAvailableDevices([&pathStr](const MidiDeviceInfo& info) {
+                                       return info.type == DeviceType::BLUETOOTH &&
+                                              info.objectPath == pathStr;
+                                   },
+                                   {}, "Bluetooth device removed");
+        }
+        
+    } else if (std::strcmp(signalName, "PropertiesChanged") == 0) {
+        GVariant* changed = nullptr;
+        g_variant_get(parameters, "(&s@a{sv}as)", nullptr, &changed, nullptr);
+        
+        GVariant* uuids = g_variant_lookup_value(changed, "UUIDs", nullptr);
+        g_variant_unref(changed);
+        
+        if (!uuids) {
+            return;
+        }
+        g_variant_unref(uuids);
+        
+        GVariant* result = g_dbus_connection_call_sync(
+            connection, "org.bluez", objectPath, "org.freedesktop.DBus.Properties",
+            "GetAll", g_variant_new("(s)", "org.bluez.Device1"), G_VARIANT_TYPE("(a{sv})"),
+            G_DBUS_CALL_FLAGS_NONE, -1, nullptr, nullptr);
+        
+        if (!result) {
+            return;
+        }
+        
+        // Same shape as InterfacesAdded: {"org.bluez.Device1": properties}
+        GVariant* properties = g_variant_get_child_value(result, 0);
+        GVariantBuilder builder;
+        g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sa{sv}}"));
+        g_variant_builder_add(&builder, "{s@a{sv}}", "org.bluez.Device1", properties);
+        GVariant* interfaces = g_variant_ref_sink(g_variant_builder_end(&builder));
+        g_variant_unref(properties);
+        
+        MidiDeviceInfo info;
+        if (parseBleDevice(objectPath, interfaces, info)) {
+            std::string deviceId = info.id;
+            updateAvailableDevices([&deviceId](const MidiDeviceInfo& existing) {
+                                       return existing.id == deviceId;
+                                   },
+                                   {info}, "");
+        }
+        
+        g_variant_unref(interfaces);
+        g_variant_unref(result);
+    }
+}
+#else
+void MidiDeviceManager::bleMonitorThread() {
+}
+
+void MidiDeviceManager::handleBleSignal(struct _GDBusConnection* connection,
+                                        const char* objectPath, const char* signalName,
+                                        struct _GVariant* parameters) {
+}
+#endif
+
 std::vector<MidiDeviceInfo> MidiDeviceManager::discoverUsbDevices() {
     std::vector<MidiDeviceInfo> devices;
 
@@ -411,10 +854,7 @@ std::vector<MidiDeviceInfo> MidiDeviceManager::discoverUsbDevices() {
     }
 
     snd_seq_client_info_t* cinfo;
-    snd_seq_port_info_t* pinfo;
-
     snd_seq_client_info_alloca(&cinfo);
-    snd_seq_port_info_alloca(&pinfo);
 
     snd_seq_client_info_set_client(cinfo, -1);
 
@@ -422,106 +862,31 @@ std::vector<MidiDeviceInfo> MidiDeviceManager::discoverUsbDevices() {
     std::set<int> processedCards;
 
     while (snd_seq_query_next_client(seq, cinfo) >= 0) {
-        int client = snd_seq_client_info_get_client(cinfo);
-
-        // Skip system clients (0, 14, etc.)
-        if (client == 0 || client == SND_SEQ_CLIENT_SYSTEM) {
-            continue;
-        }
-
-        const char* clientName = snd_seq_client_info_get_name(cinfo);
-        std::string clientNameStr(clientName ? clientName : "");
-
-        // Get card number for this client
         int cardNum = snd_seq_client_info_get_card(cinfo);
 
-        Logger::debug("MidiDeviceManager",
-            std::string("Client ") + std::to_string(client) + ": \"" + clientNameStr +
-            "\" (card=" + std::to_string(cardNum) + ")");
-
-        // Skip clients without a hardware card association
-        if (cardNum < 0) {
-            Logger::debug("MidiDeviceManager", "  -> Skipped: no card association");
-            continue;
-        }
-
         // Skip if this card was already processed
-        if (processedCards.find(cardNum) != processedCards.end()) {
+        if (cardNum >= 0 && processedCards.find(cardNum) != processedCards.end()) {
             Logger::debug("MidiDeviceManager", "  -> Skipped: card already processed");
             continue;
         }
 
         // Verify this card actually exists in hardware
-        if (hardwareCards.find(cardNum) == hardwareCards.end()) {
+        if (cardNum >= 0 && hardwareCards.find(cardNum) == hardwareCards.end()) {
             Logger::debug("MidiDeviceManager", "  -> Skipped: card not in hardware list");
             continue;
         }
 
-        // Additional name-based filtering for known virtual ports
-        if (clientNameStr.find("Midi Through") != std::string::npos ||
-            clientNameStr.find("MIDI Through") != std::string::npos ||
-            clientNameStr == "System" ||
-            clientNameStr == "Timer" ||
-            clientNameStr == "Announce") {
-            Logger::debug("MidiDeviceManager", "  -> Skipped: blacklisted name");
-            continue;
-        }
+        const char* clientName = snd_seq_client_info_get_name(cinfo);
 
-        snd_seq_port_info_set_client(pinfo, client);
-        snd_seq_port_info_set_port(pinfo, -1);
+        AlsaSequencer::ClientInfo client;
+        client.client = snd_seq_client_info_get_client(cinfo);
+        client.name = clientName ? clientName : "";
+        client.card = cardNum;
 
-        // Find the first suitable port for this card
-        bool foundValidPort = false;
         MidiDeviceInfo info;
-        unsigned int combinedCaps = 0;
-
-        while (snd_seq_query_next_port(seq, pinfo) >= 0) {
-            unsigned int caps = snd_seq_port_info_get_capability(pinfo);
-
-            // Skip ports without READ or WRITE capability
-            if (!((caps & SND_SEQ_PORT_CAP_READ) || (caps & SND_SEQ_PORT_CAP_WRITE))) {
-                continue;
-            }
-
-            // Skip ports that are only for subscription
-            if ((caps & SND_SEQ_PORT_CAP_NO_EXPORT)) {
-                continue;
-            }
-
-            if (!foundValidPort) {
-                int port = snd_seq_port_info_get_port(pinfo);
-                info.id = "usb_" + std::to_string(client) + "_" + std::to_string(port);
-                info.name = snd_seq_port_info_get_name(pinfo);
-                info.type = DeviceType::USB;
-                info.port = std::to_string(client) + ":" + std::to_string(port);
-                info.manufacturer = clientNameStr;
-                info.available = true;
-                info.status = DeviceStatus::DISCONNECTED;
-                info.messagesReceived = 0;
-                info.messagesSent = 0;
-                foundValidPort = true;
-            }
-
-            // Combine capabilities from all ports
-            combinedCaps |= caps;
-        }
-
-        if (foundValidPort) {
-            // Set direction based on combined capabilities
-            if ((combinedCaps & SND_SEQ_PORT_CAP_READ) && (combinedCaps & SND_SEQ_PORT_CAP_WRITE)) {
-                info.direction = DeviceDirection::BIDIRECTIONAL;
-            } else if (combinedCaps & SND_SEQ_PORT_CAP_READ) {
-                info.direction = DeviceDirection::INPUT;
-            } else {
-                info.direction = DeviceDirection::OUTPUT;
-            }
-
+        if (describeUsbClient(client, AlsaSequencer::queryClientPorts(seq, client.client), info)) {
             devices.push_back(info);
             processedCards.insert(cardNum);
-
-            Logger::info("MidiDeviceManager", "✓ ACCEPTED: " + info.name +
-                        " (card " + std::to_string(cardNum) +
-                        ", client " + std::to_string(client) + ")");
         }
     }
 
@@ -536,6 +901,98 @@ std::vector<MidiDeviceInfo> MidiDeviceManager::discoverUsbDevices() {
     return devices;
 }
 
+#ifdef __linux__
+bool MidiDeviceManager::describeUsbClient(const AlsaSequencer::ClientInfo& clientInfo,
+                                          const std::vector<AlsaSequencer::PortInfo>& ports,
+                                          MidiDeviceInfo& info) {
+    int client = clientInfo.client;
+
+    // Skip system clients (0, 14, etc.)
+    if (client == 0 || client == SND_SEQ_CLIENT_SYSTEM) {
+        return false;
+    }
+
+    const std::string& clientNameStr = clientInfo.name;
+
+    // Get card number for this client
+    int cardNum = clientInfo.card;
+
+    Logger::debug("MidiDeviceManager",
+        std::string("Client ") + std::to_string(client) + ": \"" + clientNameStr +
+        "\" (card=" + std::to_string(cardNum) + ")");
+
+    // Skip clients without a hardware card association
+    if (cardNum < 0) {
+        Logger::debug("MidiDeviceManager", "  -> Skipped: no card association");
+        return false;
+    }
+
+    // Additional name-based filtering for known virtual ports
+    if (clientNameStr.find("Midi Through") != std::string::npos ||
+        clientNameStr.find("MIDI Through") != std::string::npos ||
+        clientNameStr == "System" ||
+        clientNameStr == "Timer" ||
+        clientNameStr == "Announce") {
+        Logger::debug("MidiDeviceManager", "  -> Skipped: blacklisted name");
+        return false;
+    }
+
+    // Find the first suitable port for this card
+    bool foundValidPort = false;
+    unsigned int combinedCaps = 0;
+
+    for (const auto& portInfo : ports) {
+        unsigned int caps = portInfo.caps;
+
+        // Skip ports without READ or WRITE capability
+        if (!((caps & SND_SEQ_PORT_CAP_READ) || (caps & SND_SEQ_PORT_CAP_WRITE))) {
+            continue;
+        }
+
+        // Skip ports that are only for subscription
+        if ((caps & SND_SEQ_PORT_CAP_NO_EXPORT)) {
+            continue;
+        }
+
+        if (!foundValidPort) {
+            int port = portInfo.port;
+            info.id = "usb_" + std::to_string(client) + "_" + std::to_string(port);
+            info.name = portInfo.name;
+            info.type = DeviceType::USB;
+            info.port = std::to_string(client) + ":" + std::to_string(port);
+            info.rawmidi = RawMidiDevice::portName(cardNum, port);
+            info.manufacturer = clientNameStr;
+            info.available = true;
+            info.status = DeviceStatus::DISCONNECTED;
+            info.messagesReceived = 0;
+            info.messagesSent = 0;
+            foundValidPort = true;
+        }
+
+        // Combine capabilities from all ports
+        combinedCaps |= caps;
+    }
+
+    if (!foundValidPort) {
+        return false;
+    }
+
+    // Set direction based on combined capabilities
+    if ((combinedCaps & SND_SEQ_PORT_CAP_READ) && (combinedCaps & SND_SEQ_PORT_CAP_WRITE)) {
+        info.direction = DeviceDirection::BIDIRECTIONAL;
+    } else if (combinedCaps & SND_SEQ_PORT_CAP_READ) {
+        info.direction = DeviceDirection::INPUT;
+    } else {
+        info.direction = DeviceDirection::OUTPUT;
+    }
+
+    Logger::info("MidiDeviceManager", "✓ ACCEPTED: " + info.name +
+                " (card " + std::to_string(cardNum) +
+                ", client " + std::to_string(client) + ")");
+    return true;
+}
+#endif
+
 std::vector<MidiDeviceInfo> MidiDeviceManager::discoverBluetoothDevices() {
     std::vector<MidiDeviceInfo> devices;
     
@@ -665,62 +1122,10 @@ std::vector<MidiDeviceInfo> MidiDeviceManager::discoverBluetoothDevices() {
         g_variant_get(result, "(a{oa{sa{sv}}})", &iter);
         
         while (g_variant_iter_next(iter, "{&o@a{sa{sv}}}", &objectPath, &ifacesAndProperties)) {
-            GVariant* deviceProps = nullptr;
-            if (g_variant_lookup(ifacesAndProperties, "org.bluez.Device1", "@a{sv}", &deviceProps)) {
-                
-                GVariant* uuids = nullptr;
-                if (g_variant_lookup(deviceProps, "UUIDs", "@as", &uuids)) {
-                    GVariantIter uuidIter;
-                    const gchar* uuid;
-                    bool hasBleMidi = false;
-                    
-                    g_variant_iter_init(&uuidIter, uuids);
-                    while (g_variant_iter_next(&uuidIter, "&s", &uuid)) {
-                        std::string uuidStr(uuid);
-                        std::transform(uuidStr.begin(), uuidStr.end(), 
-                                     uuidStr.begin(), ::tolower);
-                        
-                        if (uuidStr == "03b80e5a-ede8-4b33-a751-6ce34ec4c700") {
-                            hasBleMidi = true;
-                            break;
-                        }
-                    }
-                    
-                    if (hasBleMidi) {
-                        const gchar* name = nullptr;
-                        const gchar* address = nullptr;
-                        
-                        g_variant_lookup(deviceProps, "Name", "&s", &name);
-                        g_variant_lookup(deviceProps, "Address", "&s", &address);
-                        
-                        if (address) {
-                            MidiDeviceInfo info;
-                            
-                            std::string addressStr(address);
-                            std::string deviceId = "ble_" + addressStr;
-                            std::replace(deviceId.begin(), deviceId.end(), ':', '_');
-                            
-                            info.id = deviceId;
-                            info.name = name ? name : "BLE MIDI Device";
-                            info.type = DeviceType::BLUETOOTH;
-                            info.direction = DeviceDirection::BIDIRECTIONAL;
-                            info.status = DeviceStatus::DISCONNECTED;
-                            info.bluetoothAddress = addressStr;
-                            info.objectPath = objectPath;
-                            info.available = true;
-                            info.messagesReceived = 0;
-                            info.messagesSent = 0;
-                            
-                            devices.push_back(info);
-                            
-                            Logger::info("MidiDeviceManager", "  Found: " + info.name);
-                        }
-                    }
-                    
-                    g_variant_unref(uuids);
-                }
-                
-                g_variant_unref(deviceProps);
+            MidiDeviceInfo info;
+            if (parseBleDevice(objectPath, ifacesAndProperties, info)) {
+                devices.push_back(info);
+                Logger::info("MidiDeviceManager", "  Found: " + info.name);
             }
             
             g_variant_unref(ifacesAndProperties);
@@ -741,6 +1146,66 @@ std::vector<MidiDeviceInfo> MidiDeviceManager::discoverBluetoothDevices() {
     
     return devices;
 }
+
+#ifdef __linux__
+bool MidiDeviceManager::parseBleDevice(const char* objectPath, GVariant* interfaces,
+                                       MidiDeviceInfo& info) {
+    GVariant* deviceProps = nullptr;
+    if (!g_variant_lookup(interfaces, "org.bluez.Device1", "@a{sv}", &deviceProps)) {
+        return false;
+    }
+    
+    bool found = false;
+    GVariant* uuids = nullptr;
+    if (g_variant_lookup(deviceProps, "UUIDs", "@as", &uuids)) {
+        GVariantIter uuidIter;
+        const gchar* uuid;
+        bool hasBleMidi = false;
+        
+        g_variant_iter_init(&uuidIter, uuids);
+        while (g_variant_iter_next(&uuidIter, "&s", &uuid)) {
+            std::string uuidStr(uuid);
+            std::transform(uuidStr.begin(), uuidStr.end(), 
+                         uuidStr.begin(), ::tolower);
+            
+            if (uuidStr == "03b80e5a-ede8-4b33-a751-6ce34ec4c700") {
+                hasBleMidi = true;
+                break;
+            }
+        }
+        
+        const gchar* name = nullptr;
+        const gchar* address = nullptr;
+        
+        g_variant_lookup(deviceProps, "Name", "&s", &name);
+        g_variant_lookup(deviceProps, "Address", "&s", &address);
+        
+        if (hasBleMidi && address) {
+            std::string addressStr(address);
+            std::string deviceId = "ble_" + addressStr;
+            std::replace(deviceId.begin(), deviceId.end(), ':', '_');
+            
+            info.id = deviceId;
+            info.name = name ? name : "BLE MIDI Device";
+            info.type = DeviceType::BLUETOOTH;
+            info.direction = DeviceDirection::BIDIRECTIONAL;
+            info.status = DeviceStatus::DISCONNECTED;
+            info.bluetoothAddress = addressStr;
+            info.objectPath = objectPath;
+            info.available = true;
+            info.messagesReceived = 0;
+            info.messagesSent = 0;
+            found = true;
+        }
+        
+        g_variant_unref(uuids);
+    }
+    
+    g_variant_unref(deviceProps);
+    return found;
+}
+#endif
+
 std::vector<MidiDeviceInfo> MidiDeviceManager::scanBleDevices(int duration, 
                                                 const std::string& nameFilter) {
     if (duration < 1) duration = 1;
@@ -1114,6 +1579,16 @@ std::shared_ptr<MidiDevice> MidiDeviceManager::createDevice(const MidiDeviceInfo
         switch (info.type) {
             case DeviceType::USB: {
 #ifdef __linux__
+                auto backend = deviceBackends_.find(info.id);
+                if (backend != deviceBackends_.end() &&
+                    backend->second == DeviceBackend::RAWMIDI && !info.rawmidi.empty()) {
+                    auto device = std::make_shared<RawMidiDevice>(info.id, info.name, info.rawmidi);
+                    device->setSysExHandler(sysexHandler_);
+                    
+                    Logger::info("MidiDeviceManager", "✅ Created raw MIDI device: " + info.name);
+                    return device;
+                }
+                
                 size_t colonPos = info.port.find(':');
                 if (colonPos == std::string::npos) {
                     Logger::error("MidiDeviceManager", "Invalid port format: " + info.port);
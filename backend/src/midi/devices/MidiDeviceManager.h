@@ -1,9 +1,23 @@
 // ============================================================================
 // File: backend/src/midi/devices/MidiDeviceManager.h
-// Version: 4.2.1 - BLE MIDI SUPPORT + Pairing Management
+// Version: 4.2.4
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.2.4:
+//   - An announced client is read through the shared AlsaSequencer
+//     instead of a sequencer client opened per announcement
+//
+// Changes v4.2.3:
+//   - Event-driven hot-plug: ALSA System:Announce port and BlueZ
+//     InterfacesAdded/Removed signals update the device list per device
+//     instead of a full rescan every interval (polling is only a fallback
+//     when the announce port is unavailable)
+//
+// Changes v4.2.2:
+//   - Per-device backend choice for USB devices: ALSA sequencer (default)
+//     or raw MIDI (RawMidiDevice), setDeviceBackend()
+//
 // Changes v4.2.1:
 //   - Added BLE pairing/unpairing methods
 //   - Added scanBleDevices() with filter support
@@ -22,12 +36,37 @@
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <unordered_map>
+#include <map>
+#include <condition_variable>
+
+#ifdef __linux__
+#include <alsa/asoundlib.h>
+#include "AlsaSequencer.h"
+#endif
+
+struct _GVariant;
+struct _GMainLoop;
+struct _GDBusConnection;
 
 namespace midiMind {
 
 // Forward declarations
 class EventBus;
 
+// ============================================================================
+// ENUMERATIONS
+// ============================================================================
+
+/**
+ * @enum DeviceBackend
+ * @brief Driver layer a USB device is opened through
+ */
+enum class DeviceBackend {
+    SEQUENCER,  ///< Port on the shared ALSA sequencer client (UsbMidiDevice)
+    RAWMIDI     ///< Exclusive raw MIDI byte stream (RawMidiDevice)
+};
+
 // ============================================================================
 // STRUCTURES
 // ============================================================================
@@ -43,6 +82,7 @@ struct MidiDeviceInfo {
     DeviceDirection direction;
     DeviceStatus status;
     std::string port;
+    std::string rawmidi;        ///< Raw MIDI name ("hw:c,d,s"), empty if none
     bool available;
     
     // Metadata
@@ -215,6 +255,26 @@ public:
      */
     bool isConnected(const std::string& deviceId) const;
     
+    // ========================================================================
+    // BACKEND SELECTION
+    // ========================================================================
+    
+    /**
+     * @brief Choose the driver layer of a USB device
+     * @param deviceId Device ID
+     * @param backend Backend used from the next connect()
+     * @return bool false if the device has no raw MIDI port (RAWMIDI)
+     * @note A connected device keeps its backend until reconnected
+     */
+    bool setDeviceBackend(const std::string& deviceId, DeviceBackend backend);
+    
+    /**
+     * @brief Backend a device is (or will be) opened with
+     */
+    DeviceBackend getDeviceBackend(const std::string& deviceId) const;
+    
+    static std::string deviceBackendToString(DeviceBackend backend);
+    
     // ========================================================================
     // DEVICE ACCESS
     // ========================================================================
@@ -238,7 +298,10 @@ public:
     
     /**
      * @brief Start hot-plug monitoring
-     * @param intervalMs Scan interval in milliseconds (default 2000)
+     * @param intervalMs USB rescan interval in milliseconds, used only if
+     *        ALSA announcements are unavailable (default 2000)
+     * @note Changes are applied as the ALSA announce port and BlueZ report
+     *       them; nothing runs while no device comes or goes
      */
     void startHotPlugMonitoring(int intervalMs = 2000);
     
@@ -253,6 +316,12 @@ public:
      */
     bool isHotPlugMonitoringActive() const;
     
+    /**
+     * @brief Whether USB hot-plug follows ALSA announcements (false:
+     *        periodic rescan fallback)
+     */
+    bool isHotPlugEventDriven() const;
+    
     /**
      * @brief Set hot-plug callback
      * @param onConnect Called when device connected
@@ -279,10 +348,74 @@ private:
     // ========================================================================
     
     /**
-     * @brief Hot-plug monitoring thread
+     * @brief Hot-plug monitoring thread: applies announced ALSA client
+     *        changes (or rescans USB periodically as a fallback)
      */
     void hotPlugThread();
     
+    /**
+     * @brief BlueZ signal thread (runs bleLoop_)
+     */
+    void bleMonitorThread();
+    
+    /**
+     * @brief Disconnect a device and notify
+     * @param reason Reason published with DeviceDisconnectedEvent
+     */
+    void disconnectDevice(const std::string& deviceId, const std::string& reason);
+    
+    /**
+     * @brief Replace the available devices within a scope with those found
+     *        there; connected devices that vanished are disconnected
+     * @param inScope Selects the entries the change covers
+     * @param found Devices now present in the scope
+     * @param reason Disconnection reason for vanished connected devices
+     */
+    void updateAvailableDevices(const std::function<bool(const MidiDeviceInfo&)>& inScope,
+                                const std::vector<MidiDeviceInfo>& found,
+                                const std::string& reason);
+    
+    
+    /**
+     * @brief Apply a BlueZ ObjectManager / Properties signal
+     */
+    void handleBleSignal(struct _GDBusConnection* connection, const char* objectPath,
+                         const char* signalName, struct _GVariant* parameters);
+    
+#ifdef __linux__
+    /// Queue an ALSA announcement for the hot-plug thread (reactor thread)
+    void onAnnounce(const snd_seq_event_t* ev, int ownClient);
+    
+    /**
+     * @brief Re-read one ALSA client after an announcement
+     * @param sequencer Shared client the announcements arrive on
+     * @param exited true if the client is gone
+     */
+    void refreshUsbClient(AlsaSequencer& sequencer, int client, bool exited);
+    
+    /**
+     * @brief Device of one sequencer client, if it is a USB MIDI device
+     * @param ports The client's ports, in port order
+     * @return bool false if the client is skipped
+     */
+    bool describeUsbClient(const AlsaSequencer::ClientInfo& client,
+                           const std::vector<AlsaSequencer::PortInfo>& ports,
+                           MidiDeviceInfo& info);
+    
+    /**
+     * @brief Discover the device of a single ALSA client
+     */
+    std::vector<MidiDeviceInfo> discoverUsbClient(AlsaSequencer& sequencer, int client);
+#endif
+    
+    /**
+     * @brief BLE MIDI device from a BlueZ object's interfaces
+     * @param interfaces a{sa{sv}} (interface -> properties)
+     * @return bool false if not a Device1 with the BLE MIDI service
+     */
+    static bool parseBleDevice(const char* objectPath, struct _GVariant* interfaces,
+                               MidiDeviceInfo& info);
+    
     /**
      * @brief Discover USB MIDI devices (ALSA)
      */
@@ -308,6 +441,9 @@ private:
     /// Available devices (last scan)
     std::vector<MidiDeviceInfo> availableDevices_;
     
+    /// Backend by device ID (SEQUENCER if absent)
+    std::unordered_map<std::string, DeviceBackend> deviceBackends_;
+    
     /// Thread safety for devices and discovery
     mutable std::mutex mutex_;
     
@@ -315,6 +451,20 @@ private:
     std::thread hotPlugThread_;
     std::atomic<bool> hotPlugRunning_{false};
     std::atomic<int> scanIntervalMs_{2000};
+    std::atomic<bool> hotPlugEventDriven_{false};
+    
+    /// ALSA clients announced since last handled (client -> exited)
+    std::map<int, bool> pendingClients_;
+    std::mutex hotPlugMutex_;
+    std::condition_variable hotPlugCondition_;
+    
+    /// A card announces its client and ports one by one: changes within
+    /// this window are applied together
+    static constexpr int HOTPLUG_SETTLE_MS = 100;
+    
+    /// BlueZ signal monitoring
+    std::thread bleMonitorThread_;
+    struct _GMainLoop* bleLoop_ = nullptr;
     
     /// Callbacks (protected by separate mutex to avoid deadlock)
     std::mutex callbackMutex_;
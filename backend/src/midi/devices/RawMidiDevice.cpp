@@ -0,0 +1,705 @@
+// ============================================================================
+// File: backend/src/midi/devices/RawMidiDevice.cpp
+// Version: 4.2.8
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "RawMidiDevice.h"
+#include "../../core/Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace midiMind {
+
+// ============================================================================
+// CONSTRUCTOR / DESTRUCTOR
+// ============================================================================
+
+RawMidiDevice::RawMidiDevice(const std::string& id,
+                             const std::string& name,
+                             const std::string& hwName)
+    : MidiDevice(id, name, DeviceType::USB, DeviceDirection::BIDIRECTIONAL)
+    , hwName_(hwName)
+#ifdef __linux__
+    , input_(nullptr)
+    , output_(nullptr)
+#endif
+    , stopFd_(-1)
+    , running_(false)
+    , outputStatus_(0)
+    , runningStatusEnabled_(true)
+    , inputStatus_(0)
+    , inSysEx_(false)
+    , receiveRing_(RECEIVE_RING_SLOTS, OverflowPolicy::DROP_OLDEST)
+    , sysexHandler_(nullptr)
+    , bytesReceived_(0)
+    , bytesSent_(0)
+    , writes_(0)
+    , statusBytesSaved_(0)
+    , sysexReceived_(0)
+    , droppedBytes_(0)
+    , outputDropped_(0)
+    , backlogSize_(0)
+    , backlogPeak_(0)
+    , errors_(0)
+{
+    Logger::info("RawMidiDevice", "Created: " + name + " (" + hwName + ")");
+}
+
+RawMidiDevice::~RawMidiDevice() {
+    disconnect();
+}
+
+std::string RawMidiDevice::portName(int card, int seqPort) {
+    return "hw:" + std::to_string(card) + "," + std::to_string(seqPort / 32) +
+           "," + std::to_string(seqPort % 32);
+}
+
+// ============================================================================
+// CONNECTION
+// ============================================================================
+
+bool RawMidiDevice::connect() {
+    if (isConnected()) {
+        Logger::warning("RawMidiDevice", "Already connected: " + name_);
+        return true;
+    }
+
+#ifdef __linux__
+    Logger::info("RawMidiDevice", "Connecting to " + name_ + " (" + hwName_ + ")...");
+
+    status_ = DeviceStatus::CONNECTING;
+
+    // Neither direction blocks: the reader waits in poll() for input, the
+    // writer for room in the output buffer
+    int result = snd_rawmidi_open(nullptr, &output_, hwName_.c_str(), SND_RAWMIDI_NONBLOCK);
+    if (result < 0) {
+        Logger::error("RawMidiDevice",
+            "Failed to open output " + hwName_ + ": " + std::string(snd_strerror(result)));
+        output_ = nullptr;
+        errors_++;
+        status_ = DeviceStatus::ERROR;
+        return false;
+    }
+
+    snd_rawmidi_params_t* params;
+    snd_rawmidi_params_alloca(&params);
+    if (snd_rawmidi_params_current(output_, params) >= 0) {
+        snd_rawmidi_params_set_buffer_size(output_, params, OUTPUT_BUFFER_SIZE);
+        snd_rawmidi_params(output_, params);
+    }
+
+    result = snd_rawmidi_open(&input_, nullptr, hwName_.c_str(), SND_RAWMIDI_NONBLOCK);
+    if (result < 0) {
+        Logger::warning("RawMidiDevice",
+            "No input on " + hwName_ + " (output only): " + std::string(snd_strerror(result)));
+        input_ = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(outputMutex_);
+        outputStatus_ = 0;
+        backlog_.clear();
+        backlogSize_ = 0;
+    }
+
+    pending_.clear();
+    inputStatus_ = 0;
+    inSysEx_ = false;
+
+    stopFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    running_ = true;
+    writerThread_ = std::thread(&RawMidiDevice::writerLoop, this);
+
+    if (input_) {
+        readerThread_ = std::thread(&RawMidiDevice::readerLoop, this);
+
+        // Input is on the thru path: keep it ahead of API and file work
+        sched_param param{};
+        param.sched_priority = THREAD_PRIORITY;
+        result = pthread_setschedparam(readerThread_.native_handle(), SCHED_FIFO, &param);
+        if (result != 0) {
+            Logger::debug("RawMidiDevice",
+                "Real-time priority not available (error " + std::to_string(result) + ")");
+        }
+    }
+
+    status_ = DeviceStatus::CONNECTED;
+    Logger::info("RawMidiDevice", "✓ Connected: " + name_);
+
+    return true;
+#else
+    Logger::error("RawMidiDevice", "ALSA not available on this platform");
+    status_ = DeviceStatus::ERROR;
+    return false;
+#endif
+}
+
+bool RawMidiDevice::disconnect() {
+    if (status_ == DeviceStatus::DISCONNECTED) {
+        return true;
+    }
+
+    Logger::info("RawMidiDevice", "Disconnecting " + name_ + "...");
+
+    status_ = DeviceStatus::DISCONNECTED;
+    closePorts();
+
+    Logger::info("RawMidiDevice", "✓ Disconnected: " + name_);
+    return true;
+}
+
+bool RawMidiDevice::isConnected() const {
+    return status_.load() == DeviceStatus::CONNECTED;
+}
+
+void RawMidiDevice::closePorts() {
+    {
+        std::lock_guard<std::mutex> lock(outputMutex_);
+        running_ = false;
+    }
+    backlogReady_.notify_all();
+
+    if (stopFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(stopFd_, &one, sizeof(one));
+        (void)written;
+    }
+
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+
+    if (readerThread_.joinable()) {
+        // Disconnected from our own message callback
+        if (readerThread_.get_id() == std::this_thread::get_id()) {
+            readerThread_.detach();
+        } else {
+            readerThread_.join();
+        }
+    }
+
+    if (stopFd_ >= 0) {
+        close(stopFd_);
+        stopFd_ = -1;
+    }
+
+#ifdef __linux__
+    if (input_) {
+        snd_rawmidi_close(input_);
+        input_ = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    if (output_) {
+        // Disconnecting (not a sender's thread): the rest may block
+        snd_rawmidi_nonblock(output_, 0);
+        flushBacklog();
+        backlog_.clear();
+        backlogSize_ = 0;
+
+        snd_rawmidi_drain(output_);
+        snd_rawmidi_close(output_);
+        output_ = nullptr;
+    }
+#endif
+}
+
+// ============================================================================
+// MESSAGING
+// ============================================================================
+
+bool RawMidiDevice::sendMessage(const MidiMessage& message) {
+    return sendMessages(&message, 1) == 1;
+}
+
+size_t RawMidiDevice::sendMessages(const MidiMessage* messages, size_t count) {
+    if (!isConnected()) {
+        return 0;
+    }
+
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(outputMutex_);
+
+    if (!output_) {
+        return 0;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastWrite_ > RUNNING_STATUS_REFRESH) {
+        outputStatus_ = 0;
+    }
+
+    outputBuffer_.clear();
+    size_t encoded = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (messages[i].getSize() == 0) {
+            continue;
+        }
+        encode(messages[i], outputBuffer_);
+        encoded++;
+    }
+
+    if (outputBuffer_.empty()) {
+        return 0;
+    }
+
+    if (!queueOutput(outputBuffer_)) {
+        // The receiver may have lost sync: restate the status next time
+        outputStatus_ = 0;
+        return 0;
+    }
+
+    lastWrite_ = now;
+    messagesSent_ += encoded;
+    return encoded;
+#else
+    return 0;
+#endif
+}
+
+MidiMessage RawMidiDevice::receiveMessage() {
+    std::lock_guard<std::mutex> lock(receiveMutex_);
+
+    MidiMessage msg;
+    receiveRing_.pop(msg);
+
+    return msg;
+}
+
+bool RawMidiDevice::hasMessages() const {
+    return !receiveRing_.empty();
+}
+
+// ============================================================================
+// INFORMATION
+// ============================================================================
+
+bool RawMidiDevice::requestIdentity() {
+    if (!sysexHandler_) {
+        Logger::warning("RawMidiDevice", "No SysExHandler configured");
+        return false;
+    }
+
+    return sysexHandler_->requestIdentity(id_);
+}
+
+json RawMidiDevice::getCapabilities() const {
+    return json{
+        {"channels", 16},
+        {"polyphony", 128},
+        {"supports_sysex", true},
+        {"supports_mpe", false},
+        {"rawmidi", hwName_}
+    };
+}
+
+bool RawMidiDevice::setOverflowPolicy(OverflowPolicy policy) {
+    // Only a receive ring, fed by the reader thread: it never blocks
+    if (policy == OverflowPolicy::BLOCK) {
+        return false;
+    }
+    receiveRing_.setPolicy(policy);
+    return true;
+}
+
+std::string RawMidiDevice::getPort() const {
+    return hwName_;
+}
+
+json RawMidiDevice::getInfo() const {
+    json info = MidiDevice::getInfo();
+
+    info["backend"] = "rawmidi";
+    info["running_status"] = runningStatusEnabled_.load();
+    info["receive_queue_size"] = receiveRing_.size();
+    info["receive_queue"] = receiveRing_.getStatistics();
+
+    return info;
+}
+
+json RawMidiDevice::getRawStatistics() const {
+    return json{
+        {"hw_name", hwName_},
+        {"bytes_received", bytesReceived_.load()},
+        {"bytes_sent", bytesSent_.load()},
+        {"writes", writes_.load()},
+        {"status_bytes_saved", statusBytesSaved_.load()},
+        {"sysex_received", sysexReceived_.load()},
+        {"dropped_bytes", droppedBytes_.load()},
+        {"output_backlog", backlogSize_.load()},
+        {"output_backlog_peak", backlogPeak_.load()},
+        {"output_dropped_bytes", outputDropped_.load()},
+        {"errors", errors_.load()}
+    };
+}
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+void RawMidiDevice::setSysExHandler(std::shared_ptr<SysExHandler> handler) {
+    sysexHandler_ = handler;
+}
+
+void RawMidiDevice::setRunningStatus(bool enabled) {
+    runningStatusEnabled_ = enabled;
+
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    outputStatus_ = 0;
+}
+
+// ============================================================================
+// PRIVATE METHODS - OUTPUT
+// ============================================================================
+
+void RawMidiDevice::encode(const MidiMessage& message, std::vector<uint8_t>& out) {
+    const auto& data = message.getRawData();
+    uint8_t status = data[0];
+
+    if (status >= 0xF8) {
+        // Real-time: may go anywhere, running status unaffected
+        out.push_back(status);
+        return;
+    }
+
+    if (status >= 0xF0) {
+        // SysEx and system common cancel running status
+        outputStatus_ = 0;
+        out.insert(out.end(), data.begin(), data.end());
+        return;
+    }
+
+    if (runningStatusEnabled_.load(std::memory_order_relaxed) && status == outputStatus_) {
+        out.insert(out.end(), data.begin() + 1, data.end());
+        statusBytesSaved_++;
+        return;
+    }
+
+    outputStatus_ = status;
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+bool RawMidiDevice::queueOutput(const std::vector<uint8_t>& bytes) {
+#ifdef __linux__
+    size_t offset = 0;
+
+    // Behind earlier bytes still waiting: keep the stream in order
+    if (backlog_.empty()) {
+        ssize_t written = writeSome(bytes.data(), bytes.size());
+        if (written < 0) {
+            return false;
+        }
+        offset = static_cast<size_t>(written);
+    }
+
+    if (offset == bytes.size()) {
+        return true;
+    }
+
+    // A message cut by the kernel buffer must be completed; a whole burst
+    // that does not fit is dropped rather than making the sender wait
+    if (offset == 0 && backlog_.size() + bytes.size() > OUTPUT_BACKLOG_LIMIT) {
+        outputDropped_ += bytes.size();
+        return false;
+    }
+
+    backlog_.insert(backlog_.end(), bytes.begin() + static_cast<std::ptrdiff_t>(offset),
+                    bytes.end());
+    backlogSize_ = backlog_.size();
+    if (backlog_.size() > backlogPeak_.load(std::memory_order_relaxed)) {
+        backlogPeak_ = backlog_.size();
+    }
+
+    backlogReady_.notify_one();
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RawMidiDevice::flushBacklog() {
+#ifdef __linux__
+    size_t offset = 0;
+
+    while (offset < backlog_.size()) {
+        ssize_t written = writeSome(backlog_.data() + offset, backlog_.size() - offset);
+        if (written < 0) {
+            // Stream broken: start over with a status byte
+            backlog_.clear();
+            backlogSize_ = 0;
+            outputStatus_ = 0;
+            return false;
+        }
+        if (written == 0) {
+            break;          // Buffer full
+        }
+        offset += static_cast<size_t>(written);
+    }
+
+    backlog_.erase(backlog_.begin(), backlog_.begin() + static_cast<std::ptrdiff_t>(offset));
+    backlogSize_ = backlog_.size();
+    return true;
+#else
+    return false;
+#endif
+}
+
+ssize_t RawMidiDevice::writeSome(const uint8_t* data, size_t size) {
+#ifdef __linux__
+    ssize_t written;
+    do {
+        written = snd_rawmidi_write(output_, data, size);
+    } while (written == -EINTR);
+
+    if (written == -EAGAIN) {
+        return 0;
+    }
+
+    if (written < 0) {
+        Logger::error("RawMidiDevice", "Write failed on " + hwName_ + ": " +
+                     std::string(snd_strerror(static_cast<int>(written))));
+        errors_++;
+        return written;
+    }
+
+    writes_++;
+    bytesSent_ += static_cast<uint64_t>(written);
+    return written;
+#else
+    return -1;
+#endif
+}
+
+void RawMidiDevice::writerLoop() {
+#ifdef __linux__
+    int count = snd_rawmidi_poll_descriptors_count(output_);
+    std::vector<struct pollfd> fds(static_cast<size_t>(count > 0 ? count : 0) + 1);
+
+    fds[0].fd = stopFd_;
+    fds[0].events = POLLIN;
+    snd_rawmidi_poll_descriptors(output_, fds.data() + 1,
+                                 static_cast<unsigned int>(fds.size() - 1));
+
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(outputMutex_);
+            backlogReady_.wait(lock, [this] { return !running_ || !backlog_.empty(); });
+
+            if (!running_) {
+                break;      // closePorts() writes what is left
+            }
+
+            flushBacklog();
+            if (backlog_.empty()) {
+                continue;
+            }
+        }
+
+        // Kernel buffer full: sleep until the device has taken some of it
+        int result = poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+
+        if (result < 0 && errno != EINTR) {
+            Logger::error("RawMidiDevice", "poll() failed: " + std::to_string(errno));
+            errors_++;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            break;      // Shutdown
+        }
+    }
+#endif
+}
+
+// ============================================================================
+// PRIVATE METHODS - INPUT
+// ============================================================================
+
+void RawMidiDevice::readerLoop() {
+#ifdef __linux__
+    Logger::debug("RawMidiDevice", "Reader thread started: " + hwName_);
+
+    int count = snd_rawmidi_poll_descriptors_count(input_);
+    std::vector<struct pollfd> fds(static_cast<size_t>(count > 0 ? count : 0) + 1);
+
+    fds[0].fd = stopFd_;
+    fds[0].events = POLLIN;
+    snd_rawmidi_poll_descriptors(input_, fds.data() + 1,
+                                 static_cast<unsigned int>(fds.size() - 1));
+
+    uint8_t buffer[256];
+
+    while (running_) {
+        int result = poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::error("RawMidiDevice", "poll() failed: " + std::to_string(errno));
+            errors_++;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            break;      // Shutdown
+        }
+
+        // Drain everything pending before sleeping again
+        while (running_) {
+            ssize_t received = snd_rawmidi_read(input_, buffer, sizeof(buffer));
+
+            if (received == -EAGAIN || received == 0) {
+                break;
+            }
+
+            if (received < 0) {
+                Logger::error("RawMidiDevice", "Read failed on " + hwName_ + ": " +
+                             std::string(snd_strerror(static_cast<int>(received))));
+                errors_++;
+
+                if (received == -ENODEV) {
+                    // Unplugged: the hot-plug monitor removes the device
+                    status_ = DeviceStatus::ERROR;
+                    running_ = false;
+                }
+                break;
+            }
+
+            bytesReceived_ += static_cast<uint64_t>(received);
+            parseInput(buffer, static_cast<size_t>(received));
+        }
+    }
+
+    Logger::debug("RawMidiDevice", "Reader thread stopped: " + hwName_);
+#endif
+}
+
+void RawMidiDevice::parseInput(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t byte = data[i];
+
+        if (byte >= 0xF8) {
+            // Real-time, possibly in the middle of another message
+            if (byte == 0xFE || byte == 0xF9 || byte == 0xFD) {
+                continue;       // Active sensing, undefined
+            }
+            deliver(std::vector<uint8_t>{byte});
+            continue;
+        }
+
+        if (byte == 0xF0) {
+            if (inSysEx_) {
+                droppedBytes_ += pending_.size();   // Unterminated
+            }
+            pending_.assign(1, byte);
+            inSysEx_ = true;
+            inputStatus_ = 0;
+            continue;
+        }
+
+        if (byte == 0xF7) {
+            if (inSysEx_) {
+                pending_.push_back(byte);
+                inSysEx_ = false;
+                sysexReceived_++;
+                deliver(std::move(pending_));
+                pending_.clear();
+            } else {
+                droppedBytes_++;
+            }
+            continue;
+        }
+
+        if (byte & 0x80) {
+            // Any other status ends an unterminated SysEx
+            if (inSysEx_) {
+                droppedBytes_ += pending_.size();
+                inSysEx_ = false;
+            }
+
+            pending_.assign(1, byte);
+
+            if (byte >= 0xF0) {
+                // System common
+                inputStatus_ = 0;
+                if (byte == 0xF4 || byte == 0xF5) {
+                    droppedBytes_++;
+                    pending_.clear();
+                } else if (dataLength(byte) == 0) {
+                    deliver(std::move(pending_));
+                    pending_.clear();
+                }
+            } else {
+                inputStatus_ = byte;
+            }
+            continue;
+        }
+
+        // Data byte
+        if (inSysEx_) {
+            pending_.push_back(byte);
+            continue;
+        }
+
+        if (pending_.empty()) {
+            if (inputStatus_ == 0) {
+                droppedBytes_++;        // No status to attach it to
+                continue;
+            }
+            pending_.push_back(inputStatus_);
+        }
+
+        pending_.push_back(byte);
+
+        if (pending_.size() == 1 + dataLength(pending_[0])) {
+            deliver(std::move(pending_));
+            pending_.clear();
+        }
+    }
+}
+
+void RawMidiDevice::deliver(std::vector<uint8_t>&& bytes) {
+    MidiMessage msg(std::move(bytes));
+
+    if (!msg.isValid()) {
+        return;
+    }
+
+    messagesReceived_++;
+
+    // Thru path: routed right here, on the reader thread
+    if (dispatchReceived(msg)) {
+        return;
+    }
+
+    receiveRing_.push(msg);     // Full: counted by the ring
+}
+
+size_t RawMidiDevice::dataLength(uint8_t status) {
+    switch (status & 0xF0) {
+        case 0xC0:
+        case 0xD0:
+            return 1;
+        case 0xF0:
+            switch (status) {
+                case 0xF1:
+                case 0xF3:
+                    return 1;
+                case 0xF2:
+                    return 2;
+                default:
+                    return 0;
+            }
+        default:
+            return 2;
+    }
+}
+
+} // namespace midiMind
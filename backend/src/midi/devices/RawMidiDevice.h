@@ -0,0 +1,244 @@
+// ============================================================================
+// File: backend/src/midi/devices/RawMidiDevice.h
+// Version: 4.2.8
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   MIDI device on an ALSA raw MIDI port (snd_rawmidi), for class-compliant
+//   USB interfaces we drive exclusively. Bytes go straight to and from the
+//   driver: no sequencer event conversion, no per-event drain.
+//
+// Features:
+//   - Output: a burst is encoded into one byte stream (running status
+//     applied) and written with one non-blocking snd_rawmidi_write(); what
+//     the kernel buffer cannot take is left to a writer thread
+//   - Input: a reader thread sleeps in poll() and parses the byte stream
+//     (running status, interleaved real-time bytes, SysEx of any length)
+//   - SysEx is passed through as raw bytes in both directions
+//
+// Changes v4.2.8:
+//   - setOverflowPolicy() rejects BLOCK: the only ring is the receive
+//     ring, and the reader thread must not wait on it
+//
+// Changes v4.2.7:
+//   - Output opened with SND_RAWMIDI_NONBLOCK: a full kernel buffer no
+//     longer blocks the sender (router / scheduler thread); the rest of
+//     the stream waits in a bounded backlog drained by a writer thread
+//
+// Changes v4.2.6:
+//   - Receive queue is a lock-free ring (SpscMessageRing)
+//
+// Limitations:
+//   - Exclusive: the port cannot be used through the sequencer meanwhile
+//   - No driver-timed output (OutputMode::DIRECT only)
+//
+// ============================================================================
+
+#pragma once
+
+#include "MidiDevice.h"
+#include "../sysex/SysExHandler.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+#ifdef __linux__
+#include <alsa/asoundlib.h>
+#endif
+
+namespace midiMind {
+
+/**
+ * @class RawMidiDevice
+ * @brief MidiDevice writing and reading the raw MIDI byte stream
+ *
+ * Thread Safety: Methods are thread-safe and sending never waits for the
+ * device. Received messages are handed to the message callback on the
+ * reader thread.
+ *
+ * Example:
+ * ```cpp
+ * auto device = std::make_shared<RawMidiDevice>("usb_24_0", "Keystation",
+ *     RawMidiDevice::portName(1, 0));
+ * device->connect();
+ * device->sendMessage(MidiMessage::noteOn(0, 60, 100));
+ * ```
+ */
+class RawMidiDevice : public MidiDevice {
+public:
+    /// SCHED_FIFO priority requested for the reader thread
+    static constexpr int THREAD_PRIORITY = 80;
+
+    /// Running status is restated after this much output silence, so a
+    /// receiver plugged in mid-stream picks it up again
+    static constexpr std::chrono::milliseconds RUNNING_STATUS_REFRESH{500};
+
+    /// Kernel output buffer requested (bytes)
+    static constexpr size_t OUTPUT_BUFFER_SIZE = 4096;
+
+    /// Bytes waiting for the kernel buffer beyond which bursts are dropped
+    /// (about 5 s of DIN MIDI)
+    static constexpr size_t OUTPUT_BACKLOG_LIMIT = 16384;
+
+    /// Receive ring slots (a channel message takes one)
+    static constexpr size_t RECEIVE_RING_SLOTS = 1024;
+
+    // ========================================================================
+    // CONSTRUCTOR / DESTRUCTOR
+    // ========================================================================
+
+    /**
+     * @param hwName ALSA raw MIDI name ("hw:card,device,subdevice")
+     */
+    RawMidiDevice(const std::string& id,
+                  const std::string& name,
+                  const std::string& hwName);
+
+    ~RawMidiDevice() override;
+
+    /**
+     * @brief Raw MIDI name of a sequencer port of a card's MIDI client
+     * @param card Card number
+     * @param seqPort Port number on the card's sequencer client
+     * @return std::string "hw:card,device,subdevice" (snd-seq-midi numbers
+     *         ports device * 32 + subdevice)
+     */
+    static std::string portName(int card, int seqPort);
+
+    // ========================================================================
+    // MIDIDEVICE INTERFACE IMPLEMENTATION
+    // ========================================================================
+
+    bool connect() override;
+    bool disconnect() override;
+    bool sendMessage(const MidiMessage& message) override;
+    size_t sendMessages(const MidiMessage* messages, size_t count) override;
+    MidiMessage receiveMessage() override;
+    bool isConnected() const override;
+    bool hasMessages() const override;
+
+    bool requestIdentity() override;
+    json getCapabilities() const override;
+    bool setOverflowPolicy(OverflowPolicy policy) override;
+
+    std::string getPort() const override;
+    json getInfo() const override;
+
+    // ========================================================================
+    // CONFIGURATION
+    // ========================================================================
+
+    void setSysExHandler(std::shared_ptr<SysExHandler> handler);
+
+    /**
+     * @brief Omit repeated channel status bytes on output (default on)
+     */
+    void setRunningStatus(bool enabled);
+
+    // ========================================================================
+    // STATISTICS
+    // ========================================================================
+
+    /**
+     * @brief Statistics
+     * @return json {hw_name, bytes_received, bytes_sent, writes,
+     *         status_bytes_saved, sysex_received, dropped_bytes,
+     *         output_backlog, output_backlog_peak, output_dropped_bytes,
+     *         errors}
+     */
+    json getRawStatistics() const;
+
+private:
+    // ========================================================================
+    // PRIVATE METHODS
+    // ========================================================================
+
+    void closePorts();
+
+    void readerLoop();
+
+    /// Drain the backlog as the kernel buffer empties (writer thread)
+    void writerLoop();
+
+    /// Parse received bytes, dispatching each complete message (reader thread)
+    void parseInput(const uint8_t* data, size_t size);
+
+    void deliver(std::vector<uint8_t>&& bytes);
+
+    /// Append a message to the output stream (outputMutex_ held)
+    void encode(const MidiMessage& message, std::vector<uint8_t>& out);
+
+    /**
+     * @brief Write what the kernel buffer takes now, queue the rest
+     *        (outputMutex_ held)
+     * @return bool false if the stream was dropped (write error, backlog full)
+     */
+    bool queueOutput(const std::vector<uint8_t>& bytes);
+
+    /// Write the backlog as far as possible (outputMutex_ held)
+    bool flushBacklog();
+
+    /**
+     * @brief One non-blocking write (outputMutex_ held)
+     * @return Bytes written (0: buffer full), negative ALSA error code
+     */
+    ssize_t writeSome(const uint8_t* data, size_t size);
+
+    /// Data bytes following a status byte (0 for SysEx and real-time)
+    static size_t dataLength(uint8_t status);
+
+    // ========================================================================
+    // MEMBER VARIABLES
+    // ========================================================================
+
+    const std::string hwName_;
+
+#ifdef __linux__
+    snd_rawmidi_t* input_;
+    snd_rawmidi_t* output_;
+#endif
+
+    /// Wakes the reader and writer for shutdown
+    int stopFd_;
+    std::thread readerThread_;
+    std::thread writerThread_;
+    std::atomic<bool> running_;
+
+    // Output (outputMutex_)
+    std::mutex outputMutex_;
+    std::condition_variable backlogReady_;
+    std::vector<uint8_t> outputBuffer_;
+    std::vector<uint8_t> backlog_;          ///< Written by the writer thread, in order
+    uint8_t outputStatus_;                  ///< Running status, 0 if none
+    std::chrono::steady_clock::time_point lastWrite_;
+    std::atomic<bool> runningStatusEnabled_;
+
+    // Input parser (reader thread only)
+    std::vector<uint8_t> pending_;          ///< Message being assembled
+    uint8_t inputStatus_;                   ///< Running status, 0 if none
+    bool inSysEx_;
+
+    /// Filled on the reader thread; receiveMutex_ only serializes readers
+    SpscMessageRing receiveRing_;
+    std::mutex receiveMutex_;
+
+    std::shared_ptr<SysExHandler> sysexHandler_;
+
+    // Statistics
+    std::atomic<uint64_t> bytesReceived_;
+    std::atomic<uint64_t> bytesSent_;
+    std::atomic<uint64_t> writes_;
+    std::atomic<uint64_t> statusBytesSaved_;
+    std::atomic<uint64_t> sysexReceived_;
+    std::atomic<uint64_t> droppedBytes_;
+    std::atomic<uint64_t> outputDropped_;
+    std::atomic<size_t> backlogSize_;
+    std::atomic<size_t> backlogPeak_;
+    std::atomic<uint64_t> errors_;
+};
+
+} // namespace midiMind
@@ -1,13 +1,45 @@
 // ============================================================================
 // File: backend/src/midi/devices/UsbMidiDevice.cpp
-// Version: 4.2.0
+// Version: 4.2.7
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v4.2.7:
+//   - FIXED: setOverflowPolicy(BLOCK) made the reactor wait on a full
+//     receive ring; BLOCK now applies to the send buffer only
+//
+// Changes v4.2.6:
+//   - FIXED: closeSequencer() reset sequencer_ while senders dereferenced
+//     it; every access works on an atomic_load copy
+//
+// Changes v4.2.5:
+//   - Queues are preallocated lock-free rings: the reactor thread never
+//     waits on a reader, and enqueuing does not allocate
+//
+// Changes v4.2.4:
+//   - QUEUED output mode: sendMessagesAt() schedules the burst on the
+//     sequencer's queue, delivered by the kernel at its time
+//
+// Changes v4.2.3:
+//   - One port on the shared AlsaSequencer client; the per-device client
+//     and receive thread are gone
+//
+// Changes v4.2.2:
+//   - Received messages go to the MidiDevice callback (stamped on
+//     arrival) and are queued only when no callback is set
+//   - Receive thread waits in poll() for input (no 1 ms sleep loop)
+//
+// Changes v4.2.1:
+//   - sendMessages(): a burst is queued with snd_seq_event_output() and
+//     drained once
+//
+// ============================================================================
 
 #include "UsbMidiDevice.h"
 #include "../../core/Logger.h"
 #include <chrono>
 #include <thread>
+#include <vector>
 
 namespace midiMind {
 
@@ -20,11 +52,13 @@ UsbMidiDevice::UsbMidiDevice(const std::string& id,
                              int alsaClient,
                              int alsaPort)
     : MidiDevice(id, name, DeviceType::USB, DeviceDirection::BIDIRECTIONAL)
-    , alsaSeq_(nullptr)
+    , sequencer_(nullptr)
     , alsaClient_(alsaClient)
     , alsaPort_(alsaPort)
     , myPort_(-1)
-    , shouldStop_(false)
+    , outputMode_(OutputMode::DIRECT)
+    , receiveRing_(RECEIVE_RING_SLOTS, OverflowPolicy::DROP_OLDEST)
+    , sendBuffer_(SEND_RING_SLOTS, OverflowPolicy::DROP_OLDEST)
     , maxBufferSize_(1000)
     , autoReconnect_(false)
     , retryCount_(0)
@@ -36,6 +70,7 @@ UsbMidiDevice::UsbMidiDevice(const std::string& id,
     , sysexHandler_(nullptr)
 {
     reconnecting_.clear();
+    sendBuffer_.setLimit(maxBufferSize_.load());
     
     Logger::info("UsbMidiDevice", "Created: " + name + 
                 " (ALSA " + std::to_string(alsaClient) + ":" + 
@@ -85,9 +120,6 @@ bool UsbMidiDevice::connect() {
         return false;
     }
     
-    shouldStop_ = false;
-    receiveThread_ = std::thread(&UsbMidiDevice::receiveThreadFunc, this);
-    
     status_ = DeviceStatus::CONNECTED;
     retryCount_ = 0;
     
@@ -105,12 +137,7 @@ bool UsbMidiDevice::disconnect() {
     
     Logger::info("UsbMidiDevice", "Disconnecting " + name_ + "...");
     
-    shouldStop_ = true;
-    if (receiveThread_.joinable()) {
-        receiveCv_.notify_all();
-        receiveThread_.join();
-    }
-    
+    // No input is dispatched to us once our port is deleted
     disconnectFromPorts();
     closeSequencer();
     
@@ -129,16 +156,9 @@ bool UsbMidiDevice::isConnected() const {
 // ============================================================================
 
 bool UsbMidiDevice::sendMessage(const MidiMessage& message) {
-    if (!isConnected() || !alsaSeq_) {
-        {
-            std::lock_guard<std::mutex> lock(sendMutex_);
-            sendBuffer_.push(message);
-            
-            if (sendBuffer_.size() > maxBufferSize_.load()) {
-                Logger::warning("UsbMidiDevice", "Send buffer overflow, dropping oldest message");
-                sendBuffer_.pop();
-            }
-        }
+    auto sequencer = std::atomic_load(&sequencer_);
+    if (!isConnected() || !sequencer) {
+        sendBuffer_.push(message);      // Overflow counted by the ring
         
         // FIX: Spawn reconnection thread only if not already reconnecting
         // and store thread to join later to avoid dangling pointer
@@ -166,16 +186,11 @@ bool UsbMidiDevice::sendMessage(const MidiMessage& message) {
     snd_seq_ev_set_subs(&ev);
     snd_seq_ev_set_direct(&ev);
     
-    int result = snd_seq_event_output(alsaSeq_, &ev);
-    if (result < 0) {
-        Logger::error("UsbMidiDevice", "Failed to send event: " + 
-                     std::string(snd_strerror(result)));
+    if (sequencer->output(&ev, 1) == 0) {
         alsaErrors_++;
         return false;
     }
     
-    snd_seq_drain_output(alsaSeq_);
-    
     alsaEventsSent_++;
     messagesSent_++;
     
@@ -186,22 +201,99 @@ bool UsbMidiDevice::sendMessage(const MidiMessage& message) {
 #endif
 }
 
-MidiMessage UsbMidiDevice::receiveMessage() {
-    std::lock_guard<std::mutex> lock(receiveMutex_);
+size_t UsbMidiDevice::sendMessages(const MidiMessage* messages, size_t count) {
+    auto sequencer = std::atomic_load(&sequencer_);
+    if (!isConnected() || !sequencer) {
+        return MidiDevice::sendMessages(messages, count);     // Buffered
+    }
     
-    if (receiveQueue_.empty()) {
-        return MidiMessage();
+    return outputBurst(*sequencer, messages, count, false,
+                       std::chrono::steady_clock::time_point());
+}
+
+size_t UsbMidiDevice::sendMessagesAt(const MidiMessage* messages, size_t count,
+                                     std::chrono::steady_clock::time_point due) {
+    auto sequencer = std::atomic_load(&sequencer_);
+    if (!isConnected() || !sequencer) {
+        return MidiDevice::sendMessages(messages, count);     // Buffered
     }
     
-    MidiMessage msg = std::move(receiveQueue_.front());
-    receiveQueue_.pop();
+    return outputBurst(*sequencer, messages, count,
+                       outputMode_.load() == OutputMode::QUEUED, due);
+}
+
+bool UsbMidiDevice::supportsTimedOutput() const {
+    if (outputMode_.load() != OutputMode::QUEUED) {
+        return false;
+    }
+    
+    auto sequencer = std::atomic_load(&sequencer_);
+    return sequencer && sequencer->hasQueue();
+}
+
+bool UsbMidiDevice::setOutputMode(OutputMode mode) {
+    outputMode_ = mode;
+    Logger::info("UsbMidiDevice", name_ + ": output mode " + outputModeToString(mode));
+    return true;
+}
+
+OutputMode UsbMidiDevice::getOutputMode() const {
+    return outputMode_.load();
+}
+
+bool UsbMidiDevice::setOverflowPolicy(OverflowPolicy policy) {
+    // The receive ring is fed by the sequencer reactor: it never blocks
+    if (policy != OverflowPolicy::BLOCK) {
+        receiveRing_.setPolicy(policy);
+    }
+    sendBuffer_.setPolicy(policy);
+    return true;
+}
+
+size_t UsbMidiDevice::outputBurst(AlsaSequencer& sequencer, const MidiMessage* messages,
+                                  size_t count, bool queued,
+                                  std::chrono::steady_clock::time_point due) {
+#ifdef __linux__
+    thread_local std::vector<snd_seq_event_t> events;
+    events.resize(count);
+    
+    int port = myPort_.load();
+    for (size_t i = 0; i < count; ++i) {
+        snd_seq_event_t* ev = &events[i];
+        snd_seq_ev_clear(ev);
+        midiMessageToAlsaEvent(messages[i], ev);
+        
+        snd_seq_ev_set_source(ev, port);
+        snd_seq_ev_set_subs(ev);
+        snd_seq_ev_set_direct(ev);
+    }
+    
+    // Drained to the kernel once for the whole burst
+    size_t sent = queued ? sequencer.outputAt(events.data(), count, due) :
+                           sequencer.output(events.data(), count);
+    
+    alsaErrors_ += count - sent;
+    alsaEventsSent_ += sent;
+    messagesSent_ += sent;
+    
+    return sent;
+#else
+    Logger::error("UsbMidiDevice", "ALSA not available on this platform");
+    return 0;
+#endif
+}
+
+MidiMessage UsbMidiDevice::receiveMessage() {
+    std::lock_guard<std::mutex> lock(receiveMutex_);
+    
+    MidiMessage msg;
+    receiveRing_.pop(msg);
     
     return msg;
 }
 
 bool UsbMidiDevice::hasMessages() const {
-    std::lock_guard<std::mutex> lock(receiveMutex_);
-    return !receiveQueue_.empty();
+    return !receiveRing_.empty();
 }
 
 // ============================================================================
@@ -246,26 +338,25 @@ json UsbMidiDevice::getInfo() const {
     info["retry_count"] = retryCount_.load();
     info["max_buffer_size"] = maxBufferSize_.load();
     
-    // FIX: Access queues with mutex
-    {
-        std::lock_guard<std::mutex> lock(receiveMutex_);
-        info["receive_queue_size"] = receiveQueue_.size();
-    }
-    {
-        std::lock_guard<std::mutex> lock(sendMutex_);
-        info["send_buffer_size"] = sendBuffer_.size();
-    }
+    info["receive_queue_size"] = receiveRing_.size();
+    info["send_buffer_size"] = sendBuffer_.size();
+    info["receive_queue"] = receiveRing_.getStatistics();
+    info["send_buffer"] = sendBuffer_.getStatistics();
     
     return info;
 }
 
 json UsbMidiDevice::getAlsaStatistics() const {
+    auto sequencer = std::atomic_load(&sequencer_);
+    
     return {
         {"events_received", alsaEventsReceived_.load()},
         {"events_sent", alsaEventsSent_.load()},
         {"errors", alsaErrors_.load()},
         {"client", alsaClient_},
-        {"port", alsaPort_}
+        {"port", alsaPort_},
+        {"output_mode", outputModeToString(outputMode_.load())},
+        {"sequencer", sequencer ? sequencer->getStatistics() : json()}
     };
 }
 
@@ -273,11 +364,6 @@ json UsbMidiDevice::getAlsaStatistics() const {
 // CALLBACK
 // ============================================================================
 
-void UsbMidiDevice::setMessageCallback(std::function<void(const MidiMessage&)> callback) {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
-    messageCallback_ = callback;
-}
-
 // ============================================================================
 // CONFIGURATION
 // ============================================================================
@@ -302,6 +388,7 @@ void UsbMidiDevice::setSysExHandler(std::shared_ptr<SysExHandler> handler) {
 
 void UsbMidiDevice::setMaxBufferSize(size_t size) {
     maxBufferSize_ = size;
+    sendBuffer_.setLimit(size);
 }
 
 // ============================================================================
@@ -310,24 +397,12 @@ void UsbMidiDevice::setMaxBufferSize(size_t size) {
 
 bool UsbMidiDevice::openSequencer() {
 #ifdef __linux__
-    int result = snd_seq_open(&alsaSeq_, "default", SND_SEQ_OPEN_DUPLEX, 0);
-    if (result < 0) {
-        Logger::error("UsbMidiDevice", 
-            "Failed to open ALSA sequencer: " + std::string(snd_strerror(result)));
+    auto sequencer = AlsaSequencer::acquire();
+    if (!sequencer) {
         alsaErrors_++;
         return false;
     }
-    
-    // FIX: Set non-blocking mode to avoid blocking in receiveThreadFunc
-    result = snd_seq_nonblock(alsaSeq_, 1);
-    if (result < 0) {
-        Logger::warning("UsbMidiDevice", 
-            "Failed to set non-blocking mode: " + std::string(snd_strerror(result)));
-    }
-    
-    snd_seq_set_client_name(alsaSeq_, "MidiMind");
-    
-    Logger::debug("UsbMidiDevice", "ALSA sequencer opened");
+    std::atomic_store(&sequencer_, std::move(sequencer));
     return true;
 #else
     Logger::error("UsbMidiDevice", "ALSA not available on this platform");
@@ -336,27 +411,24 @@ bool UsbMidiDevice::openSequencer() {
 }
 
 void UsbMidiDevice::closeSequencer() {
-#ifdef __linux__
-    if (alsaSeq_) {
-        snd_seq_close(alsaSeq_);
-        alsaSeq_ = nullptr;
-        Logger::debug("UsbMidiDevice", "ALSA sequencer closed");
-    }
-#endif
+    // The client stays open while other devices use it; a sender still
+    // holding its copy keeps it alive until its call returns
+    std::atomic_store(&sequencer_, std::shared_ptr<AlsaSequencer>());
 }
 
 bool UsbMidiDevice::createPorts() {
 #ifdef __linux__
-    if (!alsaSeq_) {
+    auto sequencer = std::atomic_load(&sequencer_);
+    if (!sequencer) {
         return false;
     }
     
-    int port = snd_seq_create_simple_port(alsaSeq_, 
-                                          name_.c_str(),
-                                          SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_WRITE | 
-                                          SND_SEQ_PORT_CAP_SUBS_READ | SND_SEQ_PORT_CAP_SUBS_WRITE,
-                                          SND_SEQ_PORT_TYPE_MIDI_GENERIC | 
-                                          SND_SEQ_PORT_TYPE_APPLICATION);
+    int port = sequencer->createPort(name_,
+                                     SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_WRITE | 
+                                     SND_SEQ_PORT_CAP_SUBS_READ | SND_SEQ_PORT_CAP_SUBS_WRITE,
+                                     SND_SEQ_PORT_TYPE_MIDI_GENERIC | 
+                                     SND_SEQ_PORT_TYPE_APPLICATION,
+                                     [this](const snd_seq_event_t* ev) { processAlsaEvent(ev); });
     
     if (port < 0) {
         Logger::error("UsbMidiDevice", 
@@ -377,11 +449,12 @@ bool UsbMidiDevice::createPorts() {
 bool UsbMidiDevice::connectToPorts() {
 #ifdef __linux__
     int port = myPort_.load();
-    if (!alsaSeq_ || port < 0) {
+    auto sequencer = std::atomic_load(&sequencer_);
+    if (!sequencer || port < 0) {
         return false;
     }
     
-    int result = snd_seq_connect_to(alsaSeq_, port, alsaClient_, alsaPort_);
+    int result = sequencer->connectTo(port, alsaClient_, alsaPort_);
     if (result < 0) {
         Logger::error("UsbMidiDevice", 
             "Failed to connect to device: " + std::string(snd_strerror(result)));
@@ -389,7 +462,7 @@ bool UsbMidiDevice::connectToPorts() {
         return false;
     }
     
-    result = snd_seq_connect_from(alsaSeq_, port, alsaClient_, alsaPort_);
+    result = sequencer->connectFrom(port, alsaClient_, alsaPort_);
     if (result < 0) {
         Logger::warning("UsbMidiDevice", 
             "Failed to connect from device (input may not be supported): " + 
@@ -406,10 +479,11 @@ bool UsbMidiDevice::connectToPorts() {
 void UsbMidiDevice::disconnectFromPorts() {
 #ifdef __linux__
     int port = myPort_.load();
-    if (alsaSeq_ && port >= 0) {
-        snd_seq_disconnect_to(alsaSeq_, port, alsaClient_, alsaPort_);
-        snd_seq_disconnect_from(alsaSeq_, port, alsaClient_, alsaPort_);
-        snd_seq_delete_simple_port(alsaSeq_, port);
+    auto sequencer = std::atomic_load(&sequencer_);
+    if (sequencer && port >= 0) {
+        sequencer->disconnectTo(port, alsaClient_, alsaPort_);
+        sequencer->disconnectFrom(port, alsaClient_, alsaPort_);
+        sequencer->deletePort(port);
         myPort_ = -1;
         
         Logger::debug("UsbMidiDevice", "Disconnected from ports");
@@ -420,21 +494,18 @@ void UsbMidiDevice::disconnectFromPorts() {
 bool UsbMidiDevice::validateConnection() {
 #ifdef __linux__
     int port = myPort_.load();
-    if (!alsaSeq_ || port < 0) {
+    auto sequencer = std::atomic_load(&sequencer_);
+    if (!sequencer || port < 0) {
         return false;
     }
     
-    snd_seq_port_info_t* pinfo;
-    snd_seq_port_info_alloca(&pinfo);
-    
-    int result = snd_seq_get_port_info(alsaSeq_, port, pinfo);
-    if (result < 0) {
+    unsigned int caps = 0;
+    if (!sequencer->getPortCapability(port, caps)) {
         Logger::error("UsbMidiDevice", "Port validation failed");
         return false;
     }
     
     // FIX: Actually validate port info
-    unsigned int caps = snd_seq_port_info_get_capability(pinfo);
     if (!(caps & (SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_WRITE))) {
         Logger::error("UsbMidiDevice", "Port does not have required capabilities");
         return false;
@@ -448,47 +519,9 @@ bool UsbMidiDevice::validateConnection() {
 }
 
 // ============================================================================
-// PRIVATE METHODS - THREADING
+// PRIVATE METHODS - INPUT
 // ============================================================================
 
-void UsbMidiDevice::receiveThreadFunc() {
-    Logger::debug("UsbMidiDevice", "Receive thread started");
-    
-#ifdef __linux__
-    while (!shouldStop_) {
-        if (!alsaSeq_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
-        }
-        
-        snd_seq_event_t* ev = nullptr;
-        int result = snd_seq_event_input(alsaSeq_, &ev);
-        
-        if (result < 0) {
-            if (result == -EAGAIN) {
-                // Non-blocking mode: no event available
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                continue;
-            }
-            
-            Logger::error("UsbMidiDevice", 
-                "Error receiving event: " + std::string(snd_strerror(result)));
-            alsaErrors_++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
-        }
-        
-        // FIX: No memory leak - ev points to ALSA internal buffer
-        // It will be reused on next snd_seq_event_input call
-        if (ev) {
-            processAlsaEvent(ev);
-        }
-    }
-#endif
-    
-    Logger::debug("UsbMidiDevice", "Receive thread stopped");
-}
-
 void UsbMidiDevice::processAlsaEvent(const snd_seq_event_t* ev) {
 #ifdef __linux__
     if (!ev) return;
@@ -498,25 +531,14 @@ void UsbMidiDevice::processAlsaEvent(const snd_seq_event_t* ev) {
     MidiMessage msg = alsaEventToMidiMessage(ev);
     
     if (msg.isValid()) {
-        // FIX: Copy callback and call without holding lock to avoid deadlock
-        std::function<void(const MidiMessage&)> callback;
-        {
-            std::lock_guard<std::mutex> lock(callbackMutex_);
-            callback = messageCallback_;
-        }
-        
-        // Call callback with message before moving it to queue
-        if (callback) {
-            callback(msg);
-        }
+        messagesReceived_++;
         
-        {
-            std::lock_guard<std::mutex> lock(receiveMutex_);
-            receiveQueue_.push(std::move(msg));
+        // Thru path: routed right here, on the sequencer's reactor thread
+        if (dispatchReceived(msg)) {
+            return;
         }
-        receiveCv_.notify_one();
         
-        messagesReceived_++;
+        receiveRing_.push(msg);
     }
 #endif
 }
@@ -650,9 +672,9 @@ void UsbMidiDevice::flushMessageBuffer() {
         Logger::info("UsbMidiDevice", "Flushing " + 
                     std::to_string(sendBuffer_.size()) + " buffered messages");
         
-        while (!sendBuffer_.empty()) {
-            messagesToSend.push_back(std::move(sendBuffer_.front()));
-            sendBuffer_.pop();
+        MidiMessage msg;
+        while (sendBuffer_.pop(msg)) {
+            messagesToSend.push_back(std::move(msg));
         }
     }
     
@@ -1,16 +1,46 @@
 // ============================================================================
 // File: backend/src/midi/devices/UsbMidiDevice.h
-// Version: 4.2.0
+// Version: 4.2.7
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v4.2.7:
+//   - setOverflowPolicy(): BLOCK applies to the send buffer only
+//
+// Changes v4.2.6:
+//   - sequencer_ is read with std::atomic_load and replaced with
+//     std::atomic_store (senders race with disconnect())
+//
+// Changes v4.2.5:
+//   - Receive queue and disconnected send buffer are lock-free rings
+//     (SpscMessageRing / MpscMessageRing); getInfo() reads their sizes
+//     without locking
+//
+// Changes v4.2.4:
+//   - OutputMode::QUEUED: timed bursts scheduled on the ALSA queue
+//
+// Changes v4.2.3:
+//   - Port on the shared AlsaSequencer client instead of a client and
+//     receive thread per device; input arrives on the reactor thread
+//
+// Changes v4.2.2:
+//   - Message callback inherited from MidiDevice (stamped on arrival,
+//     not queued when a callback takes it)
+//   - Receive thread sleeps in poll() on the sequencer instead of
+//     polling every millisecond
+//
+// Changes v4.2.1:
+//   - sendMessages(): one snd_seq_drain_output() per burst
+//
+// ============================================================================
 
 #pragma once
 
 #include "MidiDevice.h"
+#include "AlsaSequencer.h"
 #include "../sysex/SysExHandler.h"
 #include <thread>
-#include <queue>
-#include <condition_variable>
+#include <mutex>
 #include <atomic>
 
 #ifdef __linux__
@@ -21,6 +51,12 @@ namespace midiMind {
 
 class UsbMidiDevice : public MidiDevice {
 public:
+    /// Receive ring slots (a channel message takes one)
+    static constexpr size_t RECEIVE_RING_SLOTS = 1024;
+    
+    /// Send buffer slots (holds up to the max buffer size of messages)
+    static constexpr size_t SEND_RING_SLOTS = 2048;
+    
     // ========================================================================
     // CONSTRUCTOR / DESTRUCTOR
     // ========================================================================
@@ -39,12 +75,20 @@ public:
     bool connect() override;
     bool disconnect() override;
     bool sendMessage(const MidiMessage& message) override;
+    size_t sendMessages(const MidiMessage* messages, size_t count) override;
+    size_t sendMessagesAt(const MidiMessage* messages, size_t count,
+                          std::chrono::steady_clock::time_point due) override;
     MidiMessage receiveMessage() override;
     bool isConnected() const override;
     
     bool requestIdentity() override;
     json getCapabilities() const override;
     
+    bool supportsTimedOutput() const override;
+    bool setOutputMode(OutputMode mode) override;
+    OutputMode getOutputMode() const override;
+    bool setOverflowPolicy(OverflowPolicy policy) override;
+    
     // ========================================================================
     // ADDITIONAL METHODS
     // ========================================================================
@@ -53,12 +97,6 @@ public:
     std::string getPort() const override;
     json getInfo() const override;
     
-    // ========================================================================
-    // CALLBACK
-    // ========================================================================
-    
-    void setMessageCallback(std::function<void(const MidiMessage&)> callback);
-    
     // ========================================================================
     // CONFIGURATION
     // ========================================================================
@@ -87,11 +125,20 @@ private:
     void disconnectFromPorts();
     bool validateConnection();
     
+    /**
+     * @brief Convert and send a burst (connected only)
+     * @param sequencer Client loaded by the caller (kept alive for the call)
+     * @param queued true: delivered by the queue at due, false: now
+     */
+    size_t outputBurst(AlsaSequencer& sequencer, const MidiMessage* messages,
+                       size_t count, bool queued,
+                       std::chrono::steady_clock::time_point due);
+    
     // ========================================================================
-    // PRIVATE METHODS - THREADING
+    // PRIVATE METHODS - INPUT
     // ========================================================================
     
-    void receiveThreadFunc();
+    /// Handler of our port's events (sequencer reactor thread)
     void processAlsaEvent(const snd_seq_event_t* ev);
     
     // ========================================================================
@@ -112,30 +159,24 @@ private:
     // MEMBER VARIABLES
     // ========================================================================
     
-#ifdef __linux__
-    snd_seq_t* alsaSeq_;
-#else
-    void* alsaSeq_;
-#endif
+    /// Shared client (std::atomic_load/atomic_store only: senders run
+    /// concurrently with disconnect())
+    std::shared_ptr<AlsaSequencer> sequencer_;
     
     int alsaClient_;
     int alsaPort_;
     std::atomic<int> myPort_;
+    std::atomic<OutputMode> outputMode_;
     
-    std::thread receiveThread_;
-    std::atomic<bool> shouldStop_;
-    
-    std::queue<MidiMessage> receiveQueue_;
-    mutable std::mutex receiveMutex_;
-    std::condition_variable receiveCv_;
+    /// Filled on the reactor thread; receiveMutex_ only serializes readers
+    SpscMessageRing receiveRing_;
+    std::mutex receiveMutex_;
     
-    std::queue<MidiMessage> sendBuffer_;
-    mutable std::mutex sendMutex_;
+    /// Messages sent while disconnected; sendMutex_ serializes the flush
+    MpscMessageRing sendBuffer_;
+    std::mutex sendMutex_;
     std::atomic<size_t> maxBufferSize_;
     
-    std::function<void(const MidiMessage&)> messageCallback_;
-    std::mutex callbackMutex_;
-    
     std::atomic<bool> autoReconnect_;
     std::atomic<int> retryCount_;
     std::atomic<int> maxRetries_;
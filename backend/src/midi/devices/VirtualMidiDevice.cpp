@@ -1,13 +1,30 @@
 // ============================================================================
 // File: backend/src/midi/devices/VirtualMidiDevice.cpp
-// Version: 4.2.0
+// Version: 4.2.4
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v4.2.4:
+//   - FIXED: setOverflowPolicy(BLOCK) made the reactor wait on a full
+//     receive ring; BLOCK now applies to the send ring only
+//
+// Changes v4.2.3:
+//   - Queues are preallocated lock-free rings; the queue size limit is the
+//     rings' message limit
+//
+// Changes v4.2.2:
+//   - One port on the shared AlsaSequencer client; the per-device client
+//     and receive thread are gone
+//
+// Changes v4.2.1:
+//   - Received messages go to the MidiDevice callback (stamped on
+//     arrival) and are queued only when no callback is set
+//   - Receive thread waits in poll() for input (no 1 ms sleep loop)
+//
+// ============================================================================
 
 #include "VirtualMidiDevice.h"
 #include "../../core/Logger.h"
-#include <chrono>
-#include <thread>
 
 namespace midiMind {
 
@@ -17,13 +34,17 @@ namespace midiMind {
 
 VirtualMidiDevice::VirtualMidiDevice(const std::string& id, const std::string& name)
     : MidiDevice(id, name, DeviceType::VIRTUAL, DeviceDirection::BIDIRECTIONAL)
-    , alsaSeq_(nullptr)
+    , sequencer_(nullptr)
     , virtualPort_(-1)
     , isInput_(true)
     , isOutput_(true)
-    , shouldStop_(false)
+    , receiveRing_(RING_SLOTS, OverflowPolicy::DROP_NEWEST)
+    , sendRing_(RING_SLOTS, OverflowPolicy::DROP_NEWEST)
     , maxQueueSize_(1000)
 {
+    receiveRing_.setLimit(maxQueueSize_.load());
+    sendRing_.setLimit(maxQueueSize_.load());
+    
     Logger::info("VirtualMidiDevice", "Created: " + name);
 }
 
@@ -57,9 +78,6 @@ bool VirtualMidiDevice::connect() {
         return false;
     }
     
-    shouldStop_ = false;
-    receiveThread_ = std::thread(&VirtualMidiDevice::receiveThreadFunc, this);
-    
     status_ = DeviceStatus::CONNECTED;
     
     Logger::info("VirtualMidiDevice", "✓ Virtual port created: " + name_);
@@ -84,11 +102,7 @@ bool VirtualMidiDevice::disconnect() {
     Logger::info("VirtualMidiDevice", "Disconnecting virtual port: " + name_);
     
 #ifdef __linux__
-    shouldStop_ = true;
-    if (receiveThread_.joinable()) {
-        receiveThread_.join();
-    }
-    
+    // No input is dispatched to us once our port is deleted
     deleteVirtualPort();
     closeSequencer();
 #endif
@@ -122,7 +136,7 @@ bool VirtualMidiDevice::sendMessage(const MidiMessage& message) {
     
 #ifdef __linux__
     int port = virtualPort_.load();
-    if (alsaSeq_ && port >= 0) {
+    if (sequencer_ && port >= 0) {
         snd_seq_event_t ev;
         snd_seq_ev_clear(&ev);
         midiMessageToAlsaEvent(message, &ev);
@@ -131,28 +145,19 @@ bool VirtualMidiDevice::sendMessage(const MidiMessage& message) {
         snd_seq_ev_set_subs(&ev);
         snd_seq_ev_set_direct(&ev);
         
-        int result = snd_seq_event_output(alsaSeq_, &ev);
-        if (result < 0) {
-            Logger::error("VirtualMidiDevice", "Failed to send event: " + 
-                         std::string(snd_strerror(result)));
+        if (sequencer_->output(&ev, 1) == 0) {
             return false;
         }
         
-        snd_seq_drain_output(alsaSeq_);
-        
         messagesSent_++;
         return true;
     }
 #endif
     
-    std::lock_guard<std::mutex> lock(sendMutex_);
-    
-    if (sendQueue_.size() >= maxQueueSize_.load()) {
-        Logger::warning("VirtualMidiDevice", "Send queue full, dropping message");
-        return false;
+    if (!sendRing_.push(message)) {
+        return false;       // Full: counted by the ring
     }
     
-    sendQueue_.push(message);
     messagesSent_++;
     
     return true;
@@ -161,19 +166,14 @@ bool VirtualMidiDevice::sendMessage(const MidiMessage& message) {
 MidiMessage VirtualMidiDevice::receiveMessage() {
     std::lock_guard<std::mutex> lock(receiveMutex_);
     
-    if (receiveQueue_.empty()) {
-        return MidiMessage();
-    }
-    
-    MidiMessage msg = std::move(receiveQueue_.front());
-    receiveQueue_.pop();
+    MidiMessage msg;
+    receiveRing_.pop(msg);
     
     return msg;
 }
 
 bool VirtualMidiDevice::hasMessages() const {
-    std::lock_guard<std::mutex> lock(receiveMutex_);
-    return !receiveQueue_.empty();
+    return !receiveRing_.empty();
 }
 
 // ============================================================================
@@ -185,6 +185,15 @@ bool VirtualMidiDevice::requestIdentity() {
     return false;
 }
 
+bool VirtualMidiDevice::setOverflowPolicy(OverflowPolicy policy) {
+    // The receive ring is fed by the sequencer reactor: it never blocks
+    if (policy != OverflowPolicy::BLOCK) {
+        receiveRing_.setPolicy(policy);
+    }
+    sendRing_.setPolicy(policy);
+    return true;
+}
+
 json VirtualMidiDevice::getCapabilities() const {
     return json{
         {"channels", 16},
@@ -216,15 +225,10 @@ json VirtualMidiDevice::getInfo() const {
     info["is_output"] = isOutput_.load();
     info["max_queue_size"] = maxQueueSize_.load();
     
-    // FIX: Access queues with mutex
-    {
-        std::lock_guard<std::mutex> lock(receiveMutex_);
-        info["receive_queue_size"] = receiveQueue_.size();
-    }
-    {
-        std::lock_guard<std::mutex> lock(sendMutex_);
-        info["send_queue_size"] = sendQueue_.size();
-    }
+    info["receive_queue_size"] = receiveRing_.size();
+    info["send_queue_size"] = sendRing_.size();
+    info["receive_queue"] = receiveRing_.getStatistics();
+    info["send_queue"] = sendRing_.getStatistics();
     
     return info;
 }
@@ -249,79 +253,49 @@ void VirtualMidiDevice::setPortDirection(bool input, bool output) {
 
 void VirtualMidiDevice::setMaxQueueSize(size_t size) {
     maxQueueSize_ = size;
+    receiveRing_.setLimit(size);
+    sendRing_.setLimit(size);
 }
 
 size_t VirtualMidiDevice::getMessageCount() const {
-    std::lock_guard<std::mutex> lock(receiveMutex_);
-    return receiveQueue_.size();
+    return receiveRing_.size();
 }
 
 void VirtualMidiDevice::clearMessages() {
     {
         std::lock_guard<std::mutex> lock(receiveMutex_);
-        while (!receiveQueue_.empty()) {
-            receiveQueue_.pop();
-        }
+        receiveRing_.clear();
     }
     
     {
         std::lock_guard<std::mutex> lock(sendMutex_);
-        while (!sendQueue_.empty()) {
-            sendQueue_.pop();
-        }
+        sendRing_.clear();
     }
     
     Logger::debug("VirtualMidiDevice", "Message queues cleared");
 }
 
-void VirtualMidiDevice::setMessageCallback(std::function<void(const MidiMessage&)> callback) {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
-    messageCallback_ = callback;
-}
-
 // ============================================================================
 // PRIVATE METHODS - ALSA
 // ============================================================================
 
 bool VirtualMidiDevice::openSequencer() {
 #ifdef __linux__
-    int result = snd_seq_open(&alsaSeq_, "default", SND_SEQ_OPEN_DUPLEX, 0);
-    
-    if (result < 0) {
-        Logger::error("VirtualMidiDevice", 
-            "Failed to open ALSA sequencer: " + std::string(snd_strerror(result)));
-        return false;
-    }
-    
-    // FIX: Set non-blocking mode to avoid blocking in receiveThreadFunc
-    result = snd_seq_nonblock(alsaSeq_, 1);
-    if (result < 0) {
-        Logger::warning("VirtualMidiDevice", 
-            "Failed to set non-blocking mode: " + std::string(snd_strerror(result)));
-    }
-    
-    snd_seq_set_client_name(alsaSeq_, ("MidiMind_" + name_).c_str());
-    
-    Logger::debug("VirtualMidiDevice", "ALSA sequencer opened");
-    return true;
+    sequencer_ = AlsaSequencer::acquire();
+    return sequencer_ != nullptr;
 #else
     return false;
 #endif
 }
 
 void VirtualMidiDevice::closeSequencer() {
-#ifdef __linux__
-    if (alsaSeq_) {
-        snd_seq_close(alsaSeq_);
-        alsaSeq_ = nullptr;
-        Logger::debug("VirtualMidiDevice", "ALSA sequencer closed");
-    }
-#endif
+    // The client stays open while other devices use it
+    sequencer_.reset();
 }
 
 bool VirtualMidiDevice::createVirtualPort() {
 #ifdef __linux__
-    if (!alsaSeq_) {
+    if (!sequencer_) {
         return false;
     }
     
@@ -333,11 +307,11 @@ bool VirtualMidiDevice::createVirtualPort() {
         caps |= SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ;
     }
     
-    int port = snd_seq_create_simple_port(
-        alsaSeq_,
-        name_.c_str(),
+    int port = sequencer_->createPort(
+        name_,
         caps,
-        SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION
+        SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION,
+        [this](const snd_seq_event_t* ev) { processAlsaEvent(ev); }
     );
     
     if (port < 0) {
@@ -358,8 +332,8 @@ bool VirtualMidiDevice::createVirtualPort() {
 void VirtualMidiDevice::deleteVirtualPort() {
 #ifdef __linux__
     int port = virtualPort_.load();
-    if (alsaSeq_ && port >= 0) {
-        snd_seq_delete_simple_port(alsaSeq_, port);
+    if (sequencer_ && port >= 0) {
+        sequencer_->deletePort(port);
         virtualPort_ = -1;
         Logger::debug("VirtualMidiDevice", "Deleted virtual port");
     }
@@ -367,45 +341,9 @@ void VirtualMidiDevice::deleteVirtualPort() {
 }
 
 // ============================================================================
-// PRIVATE METHODS - THREADING
+// PRIVATE METHODS - INPUT
 // ============================================================================
 
-void VirtualMidiDevice::receiveThreadFunc() {
-    Logger::debug("VirtualMidiDevice", "Receive thread started");
-    
-#ifdef __linux__
-    while (!shouldStop_) {
-        if (!alsaSeq_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
-        }
-        
-        snd_seq_event_t* ev = nullptr;
-        int result = snd_seq_event_input(alsaSeq_, &ev);
-        
-        if (result < 0) {
-            if (result == -EAGAIN) {
-                // Non-blocking mode: no event available
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                continue;
-            }
-            
-            Logger::error("VirtualMidiDevice", 
-                "Error receiving event: " + std::string(snd_strerror(result)));
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
-        }
-        
-        // FIX: No memory leak - ev points to ALSA internal buffer
-        if (ev) {
-            processAlsaEvent(ev);
-        }
-    }
-#endif
-    
-    Logger::debug("VirtualMidiDevice", "Receive thread stopped");
-}
-
 void VirtualMidiDevice::processAlsaEvent(const snd_seq_event_t* ev) {
 #ifdef __linux__
     if (!ev) return;
@@ -413,30 +351,14 @@ void VirtualMidiDevice::processAlsaEvent(const snd_seq_event_t* ev) {
     MidiMessage msg = alsaEventToMidiMessage(ev);
     
     if (msg.isValid()) {
-        // FIX: Copy callback and call without holding lock to avoid deadlock
-        std::function<void(const MidiMessage&)> callback;
-        {
-            std::lock_guard<std::mutex> lock(callbackMutex_);
-            callback = messageCallback_;
-        }
+        messagesReceived_++;
         
-        // Call callback with message before moving it to queue
-        if (callback) {
-            callback(msg);
+        // Thru path: routed right here, on the sequencer's reactor thread
+        if (dispatchReceived(msg)) {
+            return;
         }
         
-        {
-            std::lock_guard<std::mutex> lock(receiveMutex_);
-            
-            if (receiveQueue_.size() >= maxQueueSize_.load()) {
-                Logger::warning("VirtualMidiDevice", "Receive queue full, dropping message");
-                return;
-            }
-            
-            receiveQueue_.push(std::move(msg));
-        }
-        
-        messagesReceived_++;
+        receiveRing_.push(msg);     // Full: counted by the ring
     }
 #endif
 }
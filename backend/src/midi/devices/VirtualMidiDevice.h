@@ -1,15 +1,33 @@
 // ============================================================================
 // File: backend/src/midi/devices/VirtualMidiDevice.h
-// Version: 4.2.0
+// Version: 4.2.4
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
+//
+// Changes v4.2.4:
+//   - setOverflowPolicy(): BLOCK applies to the send ring only
+//
+// Changes v4.2.3:
+//   - Receive and send queues are lock-free rings (SpscMessageRing /
+//     MpscMessageRing)
+//
+// Changes v4.2.2:
+//   - Port on the shared AlsaSequencer client ("MidiMind:<name>")
+//     instead of a client and receive thread per device
+//
+// Changes v4.2.1:
+//   - Message callback inherited from MidiDevice (stamped on arrival,
+//     not queued when a callback takes it)
+//   - Receive thread sleeps in poll() on the sequencer instead of
+//     polling every millisecond
+//
+// ============================================================================
 
 #pragma once
 
 #include "MidiDevice.h"
-#include <queue>
+#include "AlsaSequencer.h"
 #include <mutex>
-#include <thread>
 #include <atomic>
 
 #ifdef __linux__
@@ -20,6 +38,9 @@ namespace midiMind {
 
 class VirtualMidiDevice : public MidiDevice {
 public:
+    /// Slots per queue (a channel message takes one)
+    static constexpr size_t RING_SLOTS = 1024;
+    
     // ========================================================================
     // CONSTRUCTOR / DESTRUCTOR
     // ========================================================================
@@ -39,6 +60,7 @@ public:
     
     bool requestIdentity() override;
     json getCapabilities() const override;
+    bool setOverflowPolicy(OverflowPolicy policy) override;
     
     // ========================================================================
     // ADDITIONAL METHODS
@@ -56,12 +78,6 @@ public:
     void setMaxQueueSize(size_t size);
     size_t getMessageCount() const;
     void clearMessages();
-    
-    // ========================================================================
-    // CALLBACK
-    // ========================================================================
-    
-    void setMessageCallback(std::function<void(const MidiMessage&)> callback);
 
 private:
     // ========================================================================
@@ -74,10 +90,10 @@ private:
     void deleteVirtualPort();
     
     // ========================================================================
-    // PRIVATE METHODS - THREADING
+    // PRIVATE METHODS - INPUT
     // ========================================================================
     
-    void receiveThreadFunc();
+    /// Handler of our port's events (sequencer reactor thread)
     void processAlsaEvent(const snd_seq_event_t* ev);
     
     // ========================================================================
@@ -91,30 +107,22 @@ private:
     // MEMBER VARIABLES
     // ========================================================================
     
-#ifdef __linux__
-    snd_seq_t* alsaSeq_;
-#else
-    void* alsaSeq_;
-#endif
+    std::shared_ptr<AlsaSequencer> sequencer_;
     
     std::atomic<int> virtualPort_;
     
     std::atomic<bool> isInput_;
     std::atomic<bool> isOutput_;
     
-    std::thread receiveThread_;
-    std::atomic<bool> shouldStop_;
+    /// Filled on the reactor thread; receiveMutex_ only serializes readers
+    SpscMessageRing receiveRing_;
+    std::mutex receiveMutex_;
     
-    std::queue<MidiMessage> receiveQueue_;
-    mutable std::mutex receiveMutex_;
-    
-    std::queue<MidiMessage> sendQueue_;
-    mutable std::mutex sendMutex_;
+    /// Queue-only mode output (no ALSA)
+    MpscMessageRing sendRing_;
+    std::mutex sendMutex_;
     
     std::atomic<size_t> maxQueueSize_;
-    
-    std::function<void(const MidiMessage&)> messageCallback_;
-    std::mutex callbackMutex_;
 };
 
 } // namespace midiMind
\ No newline at end of file
@@ -1,9 +1,16 @@
 // ============================================================================
 // File: backend/src/midi/file/MidiFileReader.cpp
-// Version: 4.3.0 - CHANNEL STANDARDIZATION
+// Version: 4.3.3
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.3.3:
+//   - Parsed events and tracks are moved into place instead of copied
+//
+// Changes v4.3.2:
+//   - calculateDuration() builds MidiFile::tempoMap from all Set Tempo
+//     events and derives durationMs from it (was: last tempo seen)
+//
 // Changes v4.3.0:
 //   - FIX: Channels standardisés sur 1-16 (convention MIDI standard)
 //   - parseMidiChannelEvent(): channel = (status & 0x0F) + 1
@@ -16,6 +23,7 @@
 #include <fstream>
 #include <sstream>
 #include <cstring>
+#include <utility>
 #include <algorithm>
 #include <limits>
 
@@ -154,8 +162,7 @@ MidiFile MidiFileReader::readFromBuffer(const uint8_t* data, size_t size) {
                            "Track length exceeds buffer size");
             }
             
-            MidiTrack track = parseTrackFromBuffer(data, offset, trackLength);
-            midiFile.tracks.push_back(track);
+            midiFile.tracks.push_back(parseTrackFromBuffer(data, offset, trackLength));
             
             offset += trackLength;
             
@@ -287,7 +294,7 @@ std::vector<MidiEvent> MidiFileReader::parseTrackEvents(
                        "Unknown status byte: " + std::to_string(statusByte));
         }
         
-        events.push_back(event);
+        events.push_back(std::move(event));
     }
     
     return events;
@@ -632,7 +639,7 @@ void MidiFileReader::calculateDuration(MidiFile& file) {
     }
     
     uint32_t maxTicks = 0;
-    uint32_t currentTempo = 500000;
+    std::vector<std::pair<uint64_t, uint32_t>> tempoChanges;
     
     for (const auto& track : file.tracks) {
         for (const auto& event : track.events) {
@@ -641,26 +648,23 @@ void MidiFileReader::calculateDuration(MidiFile& file) {
             }
             
             if (event.type == MidiEventType::META && event.metaType == 0x51) {
-                currentTempo = event.tempo;
+                tempoChanges.emplace_back(event.absoluteTime, event.tempo);
             }
         }
     }
     
     file.durationTicks = maxTicks;
+    file.tempoMap.build(file.header.division, std::move(tempoChanges));
     
-    if (file.header.division > 0) {
-        double microseconds = (static_cast<double>(maxTicks) * currentTempo) / 
-                             file.header.division;
-        double durationMsDouble = microseconds / 1000.0;
-        
-        if (durationMsDouble > std::numeric_limits<uint32_t>::max()) {
-            file.durationMs = std::numeric_limits<uint32_t>::max();
-        } else {
-            file.durationMs = static_cast<uint32_t>(durationMsDouble);
-        }
+    uint64_t durationMs = file.tempoMap.ticksToMs(maxTicks);
+    
+    if (durationMs > std::numeric_limits<uint32_t>::max()) {
+        file.durationMs = std::numeric_limits<uint32_t>::max();
+    } else {
+        file.durationMs = static_cast<uint32_t>(durationMs);
     }
     
-    file.tempo = static_cast<uint16_t>(60000000.0 / currentTempo);
+    file.tempo = static_cast<uint16_t>(file.tempoMap.getInitialBpm() + 0.5);
 }
 
 void MidiFileReader::extractMetadata(MidiFile& file) {
@@ -669,12 +673,8 @@ void MidiFileReader::extractMetadata(MidiFile& file) {
     }
     
     for (const auto& event : file.tracks[0].events) {
-        if (event.type == MidiEventType::META) {
-            if (event.metaType == 0x51) {
-                file.tempo = static_cast<uint16_t>(60000000.0 / event.tempo);
-            } else if (event.metaType == 0x58) {
-                file.timeSignature = event.timeSignature;
-            }
+        if (event.type == MidiEventType::META && event.metaType == 0x58) {
+            file.timeSignature = event.timeSignature;
         }
     }
     
@@ -711,6 +711,7 @@ nlohmann::json MidiFile::toJson() const {
     j["duration_ticks"] = durationTicks;
     j["duration_ms"] = durationMs;
     j["tempo"] = tempo;
+    j["tempo_map"] = tempoMap.toJson();
     j["time_signature"] = {
         {"numerator", timeSignature.numerator},
         {"denominator", timeSignature.denominator}
@@ -1,6 +1,6 @@
 // ============================================================================
 // File: backend/src/midi/file/MidiFileReader.h
-// Version: 4.3.1 - JSON SUPPORT FIX
+// Version: 4.3.2 - TEMPO MAP
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
@@ -21,6 +21,10 @@
 // Author: MidiMind Team
 // Date: 2025-11-12
 //
+// Changes v4.3.2:
+//   - ADDED: MidiFile::tempoMap (all tempo changes, built at load time)
+//   - FIXED: durationMs honors tempo changes
+//
 // Changes v4.3.1:
 //   - FIXED: Added <nlohmann/json.hpp> include for MidiFile::toJson()
 //
@@ -30,6 +34,7 @@
 
 #include "../MidiMessage.h"
 #include "../../core/Error.h"
+#include "TempoMap.h"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -153,8 +158,9 @@ struct MidiFile {
     // Computed values
     uint32_t durationTicks = 0;
     uint32_t durationMs = 0;
-    uint16_t tempo = 120;            ///< BPM
+    uint16_t tempo = 120;            ///< Initial BPM
     TimeSignature timeSignature;
+    TempoMap tempoMap;               ///< Tick ↔ time conversion (all tempo changes)
     
     /**
      * @brief Convert to JSON
@@ -346,7 +352,7 @@ private:
     int getDataBytesCount(uint8_t statusByte);
     
     /**
-     * @brief Calculate file duration with overflow protection
+     * @brief Build tempo map and calculate file duration with overflow protection
      */
     void calculateDuration(MidiFile& file);
     
@@ -0,0 +1,125 @@
+// ============================================================================
+// File: backend/src/midi/file/TempoMap.cpp
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "TempoMap.h"
+#include <algorithm>
+
+namespace midiMind {
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+TempoMap::TempoMap(uint16_t division)
+    : division_(division > 0 ? division : 480)
+{
+    segments_.push_back(TempoSegment{});
+}
+
+// ============================================================================
+// BUILD
+// ============================================================================
+
+void TempoMap::build(uint16_t division,
+                     std::vector<std::pair<uint64_t, uint32_t>> changes) {
+    division_ = division > 0 ? division : 480;
+    segments_.clear();
+
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    // Implicit 120 BPM until the first tempo event
+    segments_.push_back(TempoSegment{0, 0, DEFAULT_US_PER_QUARTER});
+
+    for (const auto& [tick, usPerQuarter] : changes) {
+        if (usPerQuarter == 0) {
+            continue;
+        }
+
+        TempoSegment& last = segments_.back();
+
+        if (tick == last.startTick) {
+            last.usPerQuarter = usPerQuarter;
+            continue;
+        }
+
+        if (usPerQuarter == last.usPerQuarter) {
+            continue;
+        }
+
+        TempoSegment segment;
+        segment.startTick = tick;
+        segment.startMicros = last.startMicros +
+            (tick - last.startTick) * last.usPerQuarter / division_;
+        segment.usPerQuarter = usPerQuarter;
+
+        segments_.push_back(segment);
+    }
+}
+
+// ============================================================================
+// CONVERSIONS
+// ============================================================================
+
+uint64_t TempoMap::ticksToMicros(uint64_t ticks) const {
+    const TempoSegment& segment = segments_[segmentForTick(ticks)];
+
+    return segment.startMicros +
+           (ticks - segment.startTick) * segment.usPerQuarter / division_;
+}
+
+uint64_t TempoMap::microsToTicks(uint64_t micros) const {
+    const TempoSegment& segment = segments_[segmentForMicros(micros)];
+
+    return segment.startTick +
+           (micros - segment.startMicros) * division_ / segment.usPerQuarter;
+}
+
+uint32_t TempoMap::getTempoAt(uint64_t tick) const {
+    return segments_[segmentForTick(tick)].usPerQuarter;
+}
+
+double TempoMap::getBpmAt(uint64_t tick) const {
+    return 60000000.0 / getTempoAt(tick);
+}
+
+nlohmann::json TempoMap::toJson() const {
+    nlohmann::json changes = nlohmann::json::array();
+
+    for (const auto& segment : segments_) {
+        changes.push_back({
+            {"tick", segment.startTick},
+            {"time_ms", segment.startMicros / 1000},
+            {"bpm", 60000000.0 / segment.usPerQuarter}
+        });
+    }
+
+    return changes;
+}
+
+// ============================================================================
+// PRIVATE METHODS
+// ============================================================================
+
+size_t TempoMap::segmentForTick(uint64_t tick) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), tick,
+                               [](uint64_t t, const TempoSegment& segment) {
+                                   return t < segment.startTick;
+                               });
+
+    return static_cast<size_t>(it - segments_.begin()) - 1;
+}
+
+size_t TempoMap::segmentForMicros(uint64_t micros) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), micros,
+                               [](uint64_t us, const TempoSegment& segment) {
+                                   return us < segment.startMicros;
+                               });
+
+    return static_cast<size_t>(it - segments_.begin()) - 1;
+}
+
+} // namespace midiMind
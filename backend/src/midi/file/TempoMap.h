@@ -0,0 +1,129 @@
+// ============================================================================
+// File: backend/src/midi/file/TempoMap.h
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Tempo map for Standard MIDI Files.
+//   Converts between ticks and microseconds across tempo changes.
+//
+// Features:
+//   - Piecewise-constant tempo segments with cumulative time offsets
+//   - O(log n) lookups in both directions (tick → µs, µs → tick)
+//   - Built once at load time from Set Tempo (0x51) meta-events
+//
+// ============================================================================
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+namespace midiMind {
+
+/**
+ * @struct TempoSegment
+ * @brief Span of the file played at a constant tempo
+ */
+struct TempoSegment {
+    uint64_t startTick = 0;          ///< First tick of the segment
+    uint64_t startMicros = 0;        ///< Absolute time of startTick (µs)
+    uint32_t usPerQuarter = 500000;  ///< Tempo (microseconds per quarter note)
+};
+
+/**
+ * @class TempoMap
+ * @brief Tick ↔ time conversion honoring every tempo change
+ *
+ * Thread Safety: Immutable after build(); const methods are thread-safe.
+ *
+ * Example:
+ * ```cpp
+ * TempoMap map;
+ * map.build(480, {{0, 500000}, {1920, 250000}});  // 120 BPM, then 240 BPM
+ *
+ * uint64_t us = map.ticksToMicros(2400);   // 2000000 + 250000 = 2250000
+ * uint64_t tick = map.microsToTicks(us);   // 2400
+ * ```
+ */
+class TempoMap {
+public:
+    /// Default SMF tempo (120 BPM)
+    static constexpr uint32_t DEFAULT_US_PER_QUARTER = 500000;
+
+    /**
+     * @brief Constructor (single 120 BPM segment)
+     * @param division Ticks per quarter note
+     */
+    explicit TempoMap(uint16_t division = 480);
+
+    /**
+     * @brief Build map from tempo changes
+     * @param division Ticks per quarter note
+     * @param changes (tick, µs per quarter note) pairs, in any order
+     * @note Later changes at the same tick override earlier ones
+     */
+    void build(uint16_t division, std::vector<std::pair<uint64_t, uint32_t>> changes);
+
+    /**
+     * @brief Convert absolute tick to absolute time
+     * @return uint64_t Microseconds from the start of the file
+     */
+    uint64_t ticksToMicros(uint64_t ticks) const;
+
+    /**
+     * @brief Convert absolute time to absolute tick
+     * @param micros Microseconds from the start of the file
+     * @return uint64_t Last tick reached at that time
+     */
+    uint64_t microsToTicks(uint64_t micros) const;
+
+    uint64_t ticksToMs(uint64_t ticks) const { return ticksToMicros(ticks) / 1000; }
+    uint64_t msToTicks(uint64_t ms) const { return microsToTicks(ms * 1000); }
+
+    /**
+     * @brief Get tempo in effect at a tick
+     * @return uint32_t Microseconds per quarter note
+     */
+    uint32_t getTempoAt(uint64_t tick) const;
+
+    /**
+     * @brief Get tempo in effect at a tick
+     * @return double Beats per minute
+     */
+    double getBpmAt(uint64_t tick) const;
+
+    double getInitialBpm() const { return getBpmAt(0); }
+
+    uint16_t getDivision() const { return division_; }
+    size_t getSegmentCount() const { return segments_.size(); }
+    const std::vector<TempoSegment>& getSegments() const { return segments_; }
+
+    /**
+     * @brief Convert to JSON (list of tempo changes)
+     */
+    nlohmann::json toJson() const;
+
+private:
+    /**
+     * @brief Index of the segment containing a tick
+     */
+    size_t segmentForTick(uint64_t tick) const;
+
+    /**
+     * @brief Index of the segment containing a time
+     */
+    size_t segmentForMicros(uint64_t micros) const;
+
+    /// Segments sorted by startTick (never empty, first starts at tick 0)
+    std::vector<TempoSegment> segments_;
+
+    /// Ticks per quarter note
+    uint16_t division_;
+};
+
+} // namespace midiMind
@@ -0,0 +1,201 @@
+// ============================================================================
+// File: backend/src/midi/player/ChaseIndex.cpp
+// Version: 4.3.1
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "ChaseIndex.h"
+#include <algorithm>
+
+namespace midiMind {
+
+// Upper bound on checkpoints (~6 KB each); the interval grows for very long files
+static constexpr uint64_t MAX_CHECKPOINTS = 1024;
+
+// ============================================================================
+// BUILD
+// ============================================================================
+
+void ChaseIndex::build(const PackedEventStore& events, uint64_t interval) {
+    clear();
+
+    uint64_t lastTick = events.empty() ? 0 : events[events.size() - 1].tick;
+    interval_ = std::max<uint64_t>({interval, 1, lastTick / MAX_CHECKPOINTS + 1});
+
+    size_t count = static_cast<size_t>(lastTick / interval_) + 1;
+    checkpoints_.reserve(count);
+
+    std::array<ChaseChannelState, 16> state;
+    size_t index = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t checkpointTick = i * interval_;
+
+        while (index < events.size() && events[index].tick < checkpointTick) {
+            applyEvent(state, events[index]);
+            applyEvent(used_, events[index]);
+            index++;
+        }
+
+        ChaseCheckpoint checkpoint;
+        checkpoint.tick = checkpointTick;
+        checkpoint.eventIndex = index;
+        checkpoint.channels = state;
+        checkpoints_.push_back(checkpoint);
+    }
+
+    // Parameters first set in the last interval still need a reset entry
+    for (; index < events.size(); ++index) {
+        applyEvent(used_, events[index]);
+    }
+}
+
+void ChaseIndex::clear() {
+    std::vector<ChaseCheckpoint>().swap(checkpoints_);
+    used_ = {};
+    interval_ = 1;
+}
+
+// ============================================================================
+// CHASE
+// ============================================================================
+
+std::vector<ChaseMessage> ChaseIndex::getChaseMessages(const PackedEventStore& events,
+                                                       uint64_t tick) const {
+    std::vector<ChaseMessage> messages;
+
+    if (checkpoints_.empty()) {
+        return messages;
+    }
+
+    size_t cp = static_cast<size_t>(std::min<uint64_t>(tick / interval_,
+                                                       checkpoints_.size() - 1));
+    const ChaseCheckpoint& checkpoint = checkpoints_[cp];
+
+    // Replay only the state events between the checkpoint and the target
+    std::array<ChaseChannelState, 16> channels = checkpoint.channels;
+    for (size_t i = checkpoint.eventIndex; i < events.size() && events[i].tick < tick; ++i) {
+        applyEvent(channels, events[i]);
+    }
+
+    const uint8_t UNSET = ChaseChannelState::UNSET;
+
+    for (uint8_t ch = 0; ch < 16; ++ch) {
+        const ChaseChannelState& used = used_[ch];
+        const ChaseChannelState& state = channels[ch];
+
+        // Unset so far: reset to the default, on behalf of the track that
+        // sets it later
+        auto add = [&](bool set, uint16_t track, uint16_t laterTrack, MidiMessage message) {
+            messages.push_back(ChaseMessage{std::move(message), set ? track : laterTrack});
+        };
+
+        auto controller = [&](uint8_t cc) {
+            if (used.controllers[cc] == UNSET) return;
+            bool set = state.controllers[cc] != UNSET;
+            uint8_t value = set ? state.controllers[cc] : getDefaultControllerValue(cc);
+            add(set, state.controllerTracks[cc], used.controllerTracks[cc],
+                MidiMessage(static_cast<uint8_t>(0xB0 | ch), cc, value));
+        };
+
+        // Bank select must precede the program change it applies to
+        controller(0);
+        controller(32);
+
+        if (used.program != UNSET) {
+            bool set = state.program != UNSET;
+            add(set, state.programTrack, used.programTrack,
+                MidiMessage(static_cast<uint8_t>(0xC0 | ch), static_cast<uint8_t>(set ? state.program : 0)));
+        }
+
+        for (uint8_t cc = 1; cc < 120; ++cc) {
+            if (cc != 32 && isChasedController(cc)) {
+                controller(cc);
+            }
+        }
+
+        if (used.pitchBend != 0xFFFF) {
+            bool set = state.pitchBend != 0xFFFF;
+            uint16_t bend = set ? state.pitchBend : 8192;
+            add(set, state.pitchBendTrack, used.pitchBendTrack,
+                MidiMessage(static_cast<uint8_t>(0xE0 | ch),
+                            static_cast<uint8_t>(bend & 0x7F),
+                            static_cast<uint8_t>((bend >> 7) & 0x7F)));
+        }
+
+        if (used.pressure != UNSET) {
+            bool set = state.pressure != UNSET;
+            add(set, state.pressureTrack, used.pressureTrack,
+                MidiMessage(static_cast<uint8_t>(0xD0 | ch), static_cast<uint8_t>(set ? state.pressure : 0)));
+        }
+    }
+
+    return messages;
+}
+
+// ============================================================================
+// PRIVATE METHODS
+// ============================================================================
+
+void ChaseIndex::applyEvent(std::array<ChaseChannelState, 16>& channels,
+                            const PackedEvent& event) {
+    if (event.isSysEx() || event.size < 2) {
+        return;
+    }
+
+    ChaseChannelState& state = channels[event.getStatus() & 0x0F];
+
+    switch (event.getStatus() & 0xF0) {
+        case 0xB0:
+            if (event.size == 3 && isChasedController(event.data[1])) {
+                state.controllers[event.data[1]] = event.data[2] & 0x7F;
+                state.controllerTracks[event.data[1]] = event.trackNumber;
+            }
+            break;
+        case 0xC0:
+            state.program = event.data[1] & 0x7F;
+            state.programTrack = event.trackNumber;
+            break;
+        case 0xD0:
+            state.pressure = event.data[1] & 0x7F;
+            state.pressureTrack = event.trackNumber;
+            break;
+        case 0xE0:
+            if (event.size == 3) {
+                state.pitchBend = static_cast<uint16_t>(
+                    (event.data[1] & 0x7F) | ((event.data[2] & 0x7F) << 7));
+                state.pitchBendTrack = event.trackNumber;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool ChaseIndex::isChasedController(uint8_t controller) {
+    if (controller >= 120) {
+        return false;   // Channel mode messages
+    }
+
+    switch (controller) {
+        case 6: case 38:                    // Data entry
+        case 96: case 97:                   // Data increment/decrement
+        case 98: case 99: case 100: case 101:  // NRPN/RPN select
+            return false;
+        default:
+            return true;
+    }
+}
+
+uint8_t ChaseIndex::getDefaultControllerValue(uint8_t controller) {
+    switch (controller) {
+        case 7:  return 100;    // Volume
+        case 8:  return 64;     // Balance
+        case 10: return 64;     // Pan
+        case 11: return 127;    // Expression
+        default:
+            return (controller >= 71 && controller <= 79) ? 64 : 0;  // Sound controllers
+    }
+}
+
+} // namespace midiMind
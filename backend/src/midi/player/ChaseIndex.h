@@ -0,0 +1,151 @@
+// ============================================================================
+// File: backend/src/midi/player/ChaseIndex.h
+// Version: 4.3.1
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Changes v4.3.1:
+//   - Each chased value keeps the track that set it, so that the player
+//     can leave out muted and non-soloed tracks
+//
+// Description:
+//   Seek index for controller chasing.
+//   Stores per-channel controller/program/pitch bend/pressure state at
+//   regular tick intervals so that a seek can restore the channel state
+//   without replaying the file from tick 0.
+//
+// Features:
+//   - Checkpoint lookup in O(1), partial replay of at most one interval
+//   - One chase message per parameter the channel actually uses
+//   - Parameters set later in the file are reset to their GM defaults
+//   - Every chase message carries the track of the event it restores
+//
+// ============================================================================
+
+#pragma once
+
+#include "PackedEventStore.h"
+#include "../MidiMessage.h"
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace midiMind {
+
+/**
+ * @struct ChaseChannelState
+ * @brief Chased state of one MIDI channel (UNSET = never set so far)
+ */
+struct ChaseChannelState {
+    static constexpr uint8_t UNSET = 0xFF;
+
+    std::array<uint8_t, 128> controllers;
+    uint8_t program = UNSET;
+    uint8_t pressure = UNSET;
+    uint16_t pitchBend = 0xFFFF;
+
+    // Track of the event that set each value
+    std::array<uint16_t, 128> controllerTracks;
+    uint16_t programTrack = 0;
+    uint16_t pressureTrack = 0;
+    uint16_t pitchBendTrack = 0;
+
+    ChaseChannelState() {
+        controllers.fill(UNSET);
+        controllerTracks.fill(0);
+    }
+};
+
+/**
+ * @struct ChaseMessage
+ * @brief One chase message and the track whose event it restores
+ */
+struct ChaseMessage {
+    MidiMessage message;
+    uint16_t trackNumber;
+};
+
+/**
+ * @struct ChaseCheckpoint
+ * @brief State of all channels before a given tick
+ */
+struct ChaseCheckpoint {
+    uint64_t tick = 0;                              ///< Checkpoint tick
+    size_t eventIndex = 0;                          ///< First event at or after tick
+    std::array<ChaseChannelState, 16> channels;     ///< State from events before tick
+};
+
+/**
+ * @class ChaseIndex
+ * @brief Checkpointed channel state for fast seeking
+ *
+ * Thread Safety: None. Owned and locked by MidiPlayer.
+ *
+ * Example:
+ * ```cpp
+ * ChaseIndex chase;
+ * chase.build(events, division * 16);
+ *
+ * for (const auto& chased : chase.getChaseMessages(events, targetTick)) {
+ *     if (mask->isTrackEnabled(chased.trackNumber)) {
+ *         router->route(chased.message);
+ *     }
+ * }
+ * ```
+ */
+class ChaseIndex {
+public:
+    /**
+     * @brief Build checkpoints from a tick-sorted event store
+     * @param events Packed events (sorted by tick)
+     * @param interval Ticks between checkpoints
+     */
+    void build(const PackedEventStore& events, uint64_t interval);
+
+    /**
+     * @brief Release all checkpoints
+     */
+    void clear();
+
+    /**
+     * @brief Messages restoring the channel state just before a tick
+     * @param events Same store the index was built from
+     * @param tick Seek target (events at this tick are not included)
+     * @return std::vector<ChaseMessage> Bank/program first, then controllers,
+     *         pitch bend and channel pressure. A reset to the default value
+     *         carries the track that sets the parameter later.
+     */
+    std::vector<ChaseMessage> getChaseMessages(const PackedEventStore& events,
+                                               uint64_t tick) const;
+
+    size_t getCheckpointCount() const { return checkpoints_.size(); }
+    uint64_t getInterval() const { return interval_; }
+
+private:
+    /**
+     * @brief Apply one event to the channel states
+     */
+    static void applyEvent(std::array<ChaseChannelState, 16>& channels,
+                           const PackedEvent& event);
+
+    /**
+     * @brief Controllers that are chased (excludes RPN/NRPN, data entry and mode messages)
+     */
+    static bool isChasedController(uint8_t controller);
+
+    /**
+     * @brief GM value of a controller after reset
+     */
+    static uint8_t getDefaultControllerValue(uint8_t controller);
+
+    /// Checkpoints at tick 0, interval, 2 * interval, ...
+    std::vector<ChaseCheckpoint> checkpoints_;
+
+    /// Every parameter set anywhere in the file (values are irrelevant)
+    std::array<ChaseChannelState, 16> used_;
+
+    uint64_t interval_ = 1;
+};
+
+} // namespace midiMind
@@ -1,9 +1,92 @@
 // ============================================================================
 // File: backend/src/midi/player/MidiPlayer.cpp
-// Version: 4.2.0
+// Version: 4.3.9
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.3.9:
+//   - FIXED: once the last event had left ahead of time, process() asked to
+//     be called a lookahead before the end of file, i.e. at once, until the
+//     end was reached (scheduler spin); the end is not sent early
+//
+// Changes v4.3.8:
+//   - FIXED: getCurrentPosition() read the tempo map without mutex_ while
+//     load() could replace it; it now locks like getDuration()
+//
+// Changes v4.3.7:
+//   - seek() converts ms to ticks under mutex_ (tempo map vs. load())
+//   - Loop wrap rebases the clock at the wrap's scheduled time, not at
+//     now(): the overshoot is kept and looped players stay aligned
+//
+// Changes v4.3.6:
+//   - Mute/solo/transpose/volume setters take trackMutex_ only: a mask
+//     change never waits for a dispatch in progress
+//   - process() routes its burst after releasing mutex_; routeMutex_
+//     keeps its output in order with seek/pause/stop output
+//
+// Changes v4.3.5:
+//   - Chase leaves out muted and non-soloed tracks (ChaseIndex keeps the
+//     track of each chased value) and goes through the dispatch mask
+//
+// Changes v4.3.4:
+//   - Lookahead (setLookahead, default 0): process() routes events up to
+//     the lookahead early, one burst per due time, with their due time
+//
+// Changes v4.3.3:
+//   - Events due in one process() call (chords, drum hits) are collected
+//     and routed as one burst; chase and all-notes-off too
+//
+// Changes v4.3.2:
+//   - Progress rate configurable (setProgressRate, default 30 Hz); no event
+//     while the position is unchanged, immediate event after a jump
+//
+// Changes v4.3.1:
+//   - process() delivers to the output callback when one is set
+//
+// Changes v4.3.0:
+//   - playbackLoop() thread replaced by process(), called from the shared
+//     PlayerEngine scheduler thread; transport changes call the wake
+//     callback instead of notifying a per-player condition variable
+//   - playAt() starts/resumes at a given steady_clock instant so several
+//     players can share one start time
+//   - Reaching the end without loop now stops the player (the old thread
+//     exited but left the state at PLAYING)
+//
+// Changes v4.2.6:
+//   - Mute/solo/transpose/volume compiled into a DispatchMask snapshot
+//     (track bitmask + note/velocity tables) swapped on every change;
+//     replaces shouldPlayEvent()'s per-event solo scan and the two
+//     MidiMessage copies of applyModifications()/applyMasterVolume()
+//   - Dispatched events reuse one MidiMessage buffer
+//
+// Changes v4.2.5:
+//   - Seek and loop restore program/controller/bend/pressure state from
+//     a ChaseIndex built at load time (no replay from tick 0)
+//
+// Changes v4.2.4:
+//   - Events stored in a PackedEventStore (32-byte records, SysEx arena);
+//     MidiMessage objects are only built at dispatch
+//   - Channel events keep the file's status byte (was OR-ed with the
+//     1-based channel number); SysEx is played, meta-events are skipped
+//   - Track analysis reads the packed events in a single pass
+//   - Parsed MidiFile tracks are released once the store is built
+//
+// Changes v4.2.3:
+//   - Playback, seek and duration use MidiFile::tempoMap instead of a
+//     single tempo; due events are found by precomputed file time
+//   - Time signature read from the file for musical positions
+//
+// Changes v4.2.2:
+//   - playbackLoop() sleeps until the next event deadline instead of
+//     polling every 100µs (and every 10ms while paused)
+//   - Transport changes wake the thread through wakeCv_
+//   - Dispatch lateness recorded in latenessHistogram_
+//
+// Changes v4.2.1:
+//   - playbackLoop() advances a cursor instead of scanning all events
+//   - Seek/loop/resume reposition the cursor with std::lower_bound
+//   - Seek and tempo changes rebase the playback clock
+//
 // Changes v4.2.0:
 //   - Added EventBus integration
 //   - Published playback events
@@ -21,6 +104,9 @@
 
 namespace midiMind {
 
+// Chase checkpoints every 16 quarter notes (4 bars of 4/4)
+static constexpr uint64_t CHASE_INTERVAL_QUARTERS = 16;
+
 // ============================================================================
 // GM INSTRUMENT NAMES
 // ============================================================================
@@ -63,15 +149,24 @@ static const char* GM_INSTRUMENTS[128] = {
 // ============================================================================
 
 MidiPlayer::MidiPlayer(std::shared_ptr<MidiRouter> router,
-                       std::shared_ptr<EventBus> eventBus)
+                       std::shared_ptr<EventBus> eventBus,
+                       const std::string& playerId)
     : router_(router)
     , eventBus_(eventBus)
+    , playerId_(playerId)
     , state_(PlayerState::STOPPED)
-    , running_(false)
     , currentTick_(0)
     , totalTicks_(0)
+    , totalFileTimeUs_(0)
     , ticksPerQuarterNote_(480)
     , tempo_(120.0)
+    , baseTempo_(120.0)
+    , startTick_(0)
+    , startFileTimeUs_(0)
+    , nextEventIndex_(0)
+    , progressInterval_(0)
+    , lookahead_(0)
+    , lastProgressTick_(0)
     , timeSignatureNum_(4)
     , timeSignatureDen_(4)
     , ticksPerBeat_(480)
@@ -79,7 +174,9 @@ MidiPlayer::MidiPlayer(std::shared_ptr<MidiRouter> router,
     , transpose_(0)
     , masterVolume_(1.0f)
 {
-    Logger::info("MidiPlayer", "MidiPlayer initialized");
+    setProgressRate(DEFAULT_PROGRESS_RATE);
+    rebuildDispatchMask();
+    Logger::info("MidiPlayer", "MidiPlayer initialized (" + playerId_ + ")");
 }
 
 MidiPlayer::~MidiPlayer() {
@@ -96,6 +193,47 @@ void MidiPlayer::setEventBus(std::shared_ptr<EventBus> eventBus) {
     Logger::info("MidiPlayer", "EventBus configured");
 }
 
+void MidiPlayer::setProgressRate(double hz) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    progressInterval_ = hz > 0.0 ?
+        std::chrono::microseconds(static_cast<int64_t>(1e6 / std::min(hz, 1000.0))) :
+        std::chrono::microseconds(0);
+    
+    Logger::debug("MidiPlayer", "Progress rate: " + std::to_string(hz) + " Hz");
+}
+
+double MidiPlayer::getProgressRate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progressInterval_.count() > 0 ? 1e6 / progressInterval_.count() : 0.0;
+}
+
+void MidiPlayer::setLookahead(std::chrono::microseconds lookahead) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lookahead_ = std::max(std::chrono::microseconds(0),
+                              std::min(lookahead, MAX_LOOKAHEAD));
+    }
+    
+    Logger::debug("MidiPlayer", "Lookahead: " + std::to_string(lookahead.count()) + " us");
+    wakeScheduler();
+}
+
+std::chrono::microseconds MidiPlayer::getLookahead() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lookahead_;
+}
+
+void MidiPlayer::setWakeCallback(WakeCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wakeCallback_ = std::move(callback);
+}
+
+void MidiPlayer::setOutputCallback(OutputCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    outputCallback_ = std::move(callback);
+}
+
 void MidiPlayer::publishStateChange(PlayerState newState) {
     if (!eventBus_) return;
     
@@ -117,8 +255,9 @@ void MidiPlayer::publishStateChange(PlayerState newState) {
         eventBus_->publish(events::PlaybackStateChangedEvent(
             eventState,
             currentFile_,
-            getCurrentPosition(),
-            TimeUtils::systemNow()
+            ticksToMs(currentTick_.load()),     // Caller holds mutex_
+            TimeUtils::systemNow(),
+            playerId_
         ));
         
         Logger::debug("MidiPlayer", "Published PlaybackStateChangedEvent");
@@ -134,6 +273,8 @@ void MidiPlayer::publishStateChange(PlayerState newState) {
 
 bool MidiPlayer::load(const std::string& filepath) {
     std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> routeLock(routeMutex_);
+    std::lock_guard<std::mutex> trackLock(trackMutex_);
     
     Logger::info("MidiPlayer", "Loading file: " + filepath);
     
@@ -144,9 +285,15 @@ bool MidiPlayer::load(const std::string& filepath) {
         
         currentFile_ = "";
         currentTick_ = 0;
+        startTick_ = 0;
+        startFileTimeUs_ = 0;
+        nextEventIndex_ = 0;
         totalTicks_ = 0;
+        totalFileTimeUs_ = 0;
+        latenessHistogram_.reset();
         tracks_.clear();
-        allEvents_.clear();
+        events_.clear();
+        chaseIndex_.clear();
         
         MidiFileReader reader;
         midiFile_ = reader.readFromFile(filepath);
@@ -159,9 +306,25 @@ bool MidiPlayer::load(const std::string& filepath) {
         currentFile_ = filepath;
         ticksPerQuarterNote_ = midiFile_.header.division;
         
+        // Playback tempo starts at the file's own tempo (speed ratio 1.0)
+        baseTempo_ = midiFile_.tempoMap.getInitialBpm();
+        tempo_ = baseTempo_;
+        
+        if (midiFile_.timeSignature.isValid()) {
+            timeSignatureNum_ = midiFile_.timeSignature.numerator;
+            timeSignatureDen_ = midiFile_.timeSignature.denominator;
+        }
+        ticksPerBeat_ = ticksPerQuarterNote_ * 4 / timeSignatureDen_;
+        if (ticksPerBeat_ == 0) ticksPerBeat_ = 1;
+        
         parseAllTracks();
         extractMetadata();
         calculateDuration();
+        rebuildDispatchMask();
+        chaseIndex_.build(events_, ticksPerQuarterNote_ * CHASE_INTERVAL_QUARTERS);
+        
+        // Playback only needs the packed events from here on
+        std::vector<MidiTrack>().swap(midiFile_.tracks);
         
         Logger::info("MidiPlayer", 
                     "✓ File loaded: " + std::to_string(tracks_.size()) + 
@@ -182,7 +345,7 @@ std::string MidiPlayer::getCurrentFile() const {
 
 bool MidiPlayer::hasFile() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return !currentFile_.empty() && !allEvents_.empty();
+    return !currentFile_.empty() && !events_.empty();
 }
 
 // ============================================================================
@@ -190,9 +353,13 @@ bool MidiPlayer::hasFile() const {
 // ============================================================================
 
 bool MidiPlayer::play() {
+    return playAt(std::chrono::steady_clock::now());
+}
+
+bool MidiPlayer::playAt(std::chrono::steady_clock::time_point startTime) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    if (allEvents_.empty()) {
+    if (events_.empty()) {
         Logger::warning("MidiPlayer", "No file loaded");
         return false;
     }
@@ -202,16 +369,19 @@ bool MidiPlayer::play() {
         return true;
     }
     
-    Logger::info("MidiPlayer", "Starting playback");
-    
-    state_ = PlayerState::PLAYING;
-    running_ = true;
-    
-    if (playbackThread_.joinable()) {
-        playbackThread_.join();
+    if (state_ == PlayerState::PAUSED) {
+        // Resume from the exact paused position
+        Logger::info("MidiPlayer", "Resuming playback (" + playerId_ + ")");
+        anchorClock();
+    } else {
+        Logger::info("MidiPlayer", "Starting playback (" + playerId_ + ")");
+        rebaseClock(currentTick_.load());
     }
     
-    playbackThread_ = std::thread(&MidiPlayer::playbackLoop, this);
+    startTime_ = startTime;
+    lastProgress_ = std::chrono::steady_clock::time_point{};
+    state_ = PlayerState::PLAYING;
+    wakeScheduler();
     
     publishStateChange(state_);
     
@@ -224,6 +394,7 @@ bool MidiPlayer::play() {
 
 bool MidiPlayer::pause() {
     std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> routeLock(routeMutex_);
     
     if (state_ != PlayerState::PLAYING) {
         return false;
@@ -231,6 +402,7 @@ bool MidiPlayer::pause() {
     
     Logger::info("MidiPlayer", "Pausing playback");
     
+    anchorClock();
     state_ = PlayerState::PAUSED;
     sendAllNotesOff();
     
@@ -245,6 +417,7 @@ bool MidiPlayer::pause() {
 
 void MidiPlayer::stop() {
     std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> routeLock(routeMutex_);
     stopPlayback();
 }
 
@@ -253,23 +426,12 @@ void MidiPlayer::stopPlayback() {
         return;
     }
     
-    Logger::info("MidiPlayer", "Stopping playback");
+    Logger::info("MidiPlayer", "Stopping playback (" + playerId_ + ")");
     
-    running_ = false;
     state_ = PlayerState::STOPPED;
     
-    if (playbackThread_.joinable()) {
-        mutex_.unlock();
-        playbackThread_.join();
-        mutex_.lock();
-    }
-    
     sendAllNotesOff();
-    currentTick_ = 0;
-    
-    for (auto& event : allEvents_) {
-        event.processed = false;
-    }
+    rebaseClock(0);
     
     publishStateChange(state_);
     
@@ -287,13 +449,19 @@ PlayerState MidiPlayer::getState() const {
 // ============================================================================
 
 void MidiPlayer::seek(uint64_t timeMs) {
-    uint64_t ticks = msToTicks(timeMs);
-    seekToTick(ticks);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> routeLock(routeMutex_);
+    seekLocked(msToTicks(timeMs));
 }
 
 void MidiPlayer::seekToTick(uint64_t tick) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+    std::lock_guard<std::mutex> routeLock(routeMutex_);
+    seekLocked(tick);
+}
+
+void MidiPlayer::seekLocked(uint64_t tick) {
+    // Caller must hold mutex_ and routeMutex_
     if (tick > totalTicks_) {
         tick = totalTicks_;
     }
@@ -301,15 +469,13 @@ void MidiPlayer::seekToTick(uint64_t tick) {
     Logger::debug("MidiPlayer", "Seeking to tick: " + std::to_string(tick));
     
     sendAllNotesOff();
-    currentTick_ = tick;
-    
-    for (auto& event : allEvents_) {
-        event.processed = (event.tick < tick);
-    }
+    chaseToTick(tick);
+    rebaseClock(tick);
 }
 
 bool MidiPlayer::seekToBar(uint32_t bar, uint8_t beat, uint16_t tick) {
     std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> routeLock(routeMutex_);
     
     if (bar < 1 || beat < 1 || beat > timeSignatureNum_) {
         Logger::warning("MidiPlayer", "Invalid bar/beat position");
@@ -323,11 +489,8 @@ bool MidiPlayer::seekToBar(uint32_t bar, uint8_t beat, uint16_t tick) {
     }
     
     sendAllNotesOff();
-    currentTick_ = targetTick;
-    
-    for (auto& event : allEvents_) {
-        event.processed = (event.tick < targetTick);
-    }
+    chaseToTick(targetTick);
+    rebaseClock(targetTick);
     
     Logger::info("MidiPlayer", 
                 "Seeked to " + std::to_string(bar) + ":" + 
@@ -337,6 +500,7 @@ bool MidiPlayer::seekToBar(uint32_t bar, uint8_t beat, uint16_t tick) {
 }
 
 uint64_t MidiPlayer::getCurrentPosition() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return ticksToMs(currentTick_.load());
 }
 
@@ -362,6 +526,10 @@ void MidiPlayer::setTempo(double bpm) {
     if (bpm < 50.0) bpm = 50.0;
     if (bpm > 300.0) bpm = 300.0;
     
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Keep the current position when the tick rate changes
+    anchorClock();
     tempo_ = bpm;
     Logger::debug("MidiPlayer", "Tempo set to: " + std::to_string(bpm) + " BPM");
 }
@@ -384,7 +552,9 @@ void MidiPlayer::setVolume(float volume) {
     if (volume < 0.0f) volume = 0.0f;
     if (volume > 1.0f) volume = 1.0f;
     
+    std::lock_guard<std::mutex> lock(trackMutex_);
     masterVolume_ = volume;
+    rebuildDispatchMask();
     Logger::debug("MidiPlayer", "Volume set to: " + std::to_string(volume));
 }
 
@@ -396,7 +566,9 @@ void MidiPlayer::setTranspose(int semitones) {
     if (semitones < -12) semitones = -12;
     if (semitones > 12) semitones = 12;
     
+    std::lock_guard<std::mutex> lock(trackMutex_);
     transpose_ = semitones;
+    rebuildDispatchMask();
     Logger::debug("MidiPlayer", 
                  "Transpose set to: " + std::to_string(semitones) + " semitones");
 }
@@ -410,13 +582,14 @@ int MidiPlayer::getTranspose() const {
 // ============================================================================
 
 void MidiPlayer::setTrackMute(uint16_t trackIndex, bool muted) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(trackMutex_);
     
     if (trackIndex >= tracks_.size()) {
         return;
     }
     
     tracks_[trackIndex].isMuted = muted;
+    rebuildDispatchMask();
     
     Logger::debug("MidiPlayer", 
                  "Track " + std::to_string(trackIndex) + " " + 
@@ -424,13 +597,14 @@ void MidiPlayer::setTrackMute(uint16_t trackIndex, bool muted) {
 }
 
 void MidiPlayer::setTrackSolo(uint16_t trackIndex, bool solo) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(trackMutex_);
     
     if (trackIndex >= tracks_.size()) {
         return;
     }
     
     tracks_[trackIndex].isSolo = solo;
+    rebuildDispatchMask();
     
     Logger::debug("MidiPlayer", 
                  "Track " + std::to_string(trackIndex) + " " + 
@@ -438,7 +612,7 @@ void MidiPlayer::setTrackSolo(uint16_t trackIndex, bool solo) {
 }
 
 const TrackInfo* MidiPlayer::getTrackInfo(uint16_t trackIndex) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(trackMutex_);
     
     if (trackIndex >= tracks_.size()) {
         return nullptr;
@@ -448,7 +622,7 @@ const TrackInfo* MidiPlayer::getTrackInfo(uint16_t trackIndex) const {
 }
 
 std::vector<TrackInfo> MidiPlayer::getTracksInfo() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(trackMutex_);
     return tracks_;
 }
 
@@ -458,6 +632,7 @@ std::vector<TrackInfo> MidiPlayer::getTracksInfo() const {
 
 json MidiPlayer::getMetadata() const {
     std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> trackLock(trackMutex_);
     
     json meta = json::object();
     
@@ -466,6 +641,7 @@ json MidiPlayer::getMetadata() const {
     meta["division"] = ticksPerQuarterNote_;
     meta["duration_ms"] = ticksToMs(totalTicks_);
     meta["tempo_bpm"] = tempo_.load();
+    meta["tempo_map"] = midiFile_.tempoMap.toJson();
     meta["time_signature"] = std::to_string(timeSignatureNum_) + "/" + 
                              std::to_string(timeSignatureDen_);
     
@@ -492,6 +668,22 @@ json MidiPlayer::getMetadata() const {
     return meta;
 }
 
+TempoMap MidiPlayer::getTempoMap() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return midiFile_.tempoMap;
+}
+
+std::pair<uint8_t, uint8_t> MidiPlayer::getTimeSignature() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {timeSignatureNum_, timeSignatureDen_};
+}
+
+json MidiPlayer::getTimingStatistics() const {
+    json stats = json::object();
+    stats["dispatch_lateness"] = latenessHistogram_.toJson();
+    return stats;
+}
+
 void MidiPlayer::setStateCallback(StateCallback callback) {
     std::lock_guard<std::mutex> lock(mutex_);
     stateCallback_ = callback;
@@ -502,250 +694,430 @@ void MidiPlayer::setStateCallback(StateCallback callback) {
 // ============================================================================
 
 void MidiPlayer::parseAllTracks() {
-    allEvents_.clear();
     tracks_.resize(midiFile_.tracks.size());
     
+    // Size the store up front so building it never reallocates
+    size_t eventCount = 0;
+    size_t sysexBytes = 0;
+    for (const auto& track : midiFile_.tracks) {
+        for (const auto& event : track.events) {
+            if (event.type == MidiEventType::MIDI_CHANNEL) {
+                eventCount++;
+            } else if (event.type == MidiEventType::SYSEX) {
+                eventCount++;
+                sysexBytes += event.data.size() + 1;
+            }
+        }
+    }
+    
+    events_.clear();
+    events_.reserve(eventCount, sysexBytes);
+    
+    std::vector<uint8_t> sysex;
+    
     for (size_t trackIdx = 0; trackIdx < midiFile_.tracks.size(); ++trackIdx) {
-        auto& track = midiFile_.tracks[trackIdx];
-        auto& trackInfo = tracks_[trackIdx];
-        trackInfo.index = trackIdx;
+        const auto& track = midiFile_.tracks[trackIdx];
+        tracks_[trackIdx].index = trackIdx;
         
         uint64_t currentTick = 0;
         
         for (const auto& event : track.events) {
             currentTick += event.deltaTime;
+            uint64_t fileTimeUs = midiFile_.tempoMap.ticksToMicros(currentTick);
             
-            ScheduledEvent sched;
-            sched.tick = currentTick;
-			// Construire le message MIDI à partir des données de l'événement
-			if (event.type == MidiEventType::MIDI_CHANNEL) {
-				std::vector<uint8_t> midiData;
-				midiData.push_back(event.status | event.channel);
-				midiData.insert(midiData.end(), event.data.begin(), event.data.end());
-				sched.message = MidiMessage(midiData);
-			} else {
-				// Pour les meta-events et sysex, créer un message vide ou approprié
-				sched.message = MidiMessage();
-			}
-            sched.trackNumber = trackIdx;
-            sched.processed = false;
-            
-            allEvents_.push_back(sched);
+            if (event.type == MidiEventType::MIDI_CHANNEL) {
+                // event.status is the full status byte; data holds the data bytes
+                uint8_t bytes[3] = {event.status, 0, 0};
+                uint8_t size = 1;
+                for (size_t i = 0; i < event.data.size() && size < 3; ++i) {
+                    bytes[size++] = event.data[i];
+                }
+                events_.addMessage(currentTick, fileTimeUs, trackIdx, bytes, size);
+            }
+            else if (event.type == MidiEventType::SYSEX) {
+                // F0 events omit the leading F0 in the file; F7 escapes are raw bytes
+                sysex.clear();
+                if (event.status == 0xF0) {
+                    sysex.push_back(0xF0);
+                }
+                sysex.insert(sysex.end(), event.data.begin(), event.data.end());
+                if (!sysex.empty()) {
+                    events_.addSysEx(currentTick, fileTimeUs, trackIdx,
+                                     sysex.data(), sysex.size());
+                }
+            }
+            // Meta-events are not sent: tempo changes live in midiFile_.tempoMap
         }
     }
     
-    std::sort(allEvents_.begin(), allEvents_.end(),
-              [](const ScheduledEvent& a, const ScheduledEvent& b) {
-                  return a.tick < b.tick;
-              });
+    // Stable: events sharing a tick keep their file order (e.g. note off before note on)
+    events_.sortByTick();
+    
+    Logger::debug("MidiPlayer", "Packed " + std::to_string(events_.size()) +
+                 " events (" + std::to_string(events_.getMemoryUsage() / 1024) + " KB)");
 }
 
 void MidiPlayer::extractMetadata() {
+    std::vector<uint32_t> totalVelocity(tracks_.size(), 0);
+    
     for (auto& track : tracks_) {
-        analyzeTrack(track.index);
+        track.name = "Track " + std::to_string(track.index + 1);
+        track.channel = 0;
+        track.programChange = 0;
+        track.noteCount = 0;
+        track.minNote = 127;
+        track.maxNote = 0;
+        track.avgVelocity = 64;
     }
-}
-
-void MidiPlayer::analyzeTrack(uint16_t trackIndex) {
-    if (trackIndex >= tracks_.size()) return;
-    
-    auto& track = tracks_[trackIndex];
-    auto& midiTrack = midiFile_.tracks[trackIndex];
-    
-    track.name = "Track " + std::to_string(trackIndex + 1);
-    track.channel = 0;
-    track.programChange = 0;
-    track.noteCount = 0;
-    track.minNote = 127;
-    track.maxNote = 0;
-    track.avgVelocity = 64;
     
-    uint32_t totalVelocity = 0;
-    
-    for (const auto& event : midiTrack.events) {
-        MidiMessage msg(event.data);
-        uint8_t status = msg.getStatus();
-        uint8_t type = status & 0xF0;
-        uint8_t channel = status & 0x0F;
+    for (const auto& event : events_) {
+        if (event.isSysEx() || event.trackNumber >= tracks_.size()) {
+            continue;
+        }
+        
+        auto& track = tracks_[event.trackNumber];
+        uint8_t type = event.getStatus() & 0xF0;
+        uint8_t channel = event.getStatus() & 0x0F;
         
         if (type == 0x90) {
             track.channel = channel;
-            uint8_t note = msg.getData1();
-            uint8_t velocity = msg.getData2();
+            uint8_t note = event.data[1];
+            uint8_t velocity = event.data[2];
             
             if (velocity > 0) {
                 track.noteCount++;
                 if (note < track.minNote) track.minNote = note;
                 if (note > track.maxNote) track.maxNote = note;
-                totalVelocity += velocity;
+                totalVelocity[event.trackNumber] += velocity;
             }
         }
         else if (type == 0xC0) {
-            track.programChange = msg.getData1();
+            track.programChange = event.data[1] & 0x7F;
             track.instrumentName = GM_INSTRUMENTS[track.programChange];
         }
     }
     
-    if (track.noteCount > 0) {
-        track.avgVelocity = totalVelocity / track.noteCount;
+    for (auto& track : tracks_) {
+        if (track.noteCount > 0) {
+            track.avgVelocity = totalVelocity[track.index] / track.noteCount;
+        }
     }
 }
 
 void MidiPlayer::calculateDuration() {
     totalTicks_ = 0;
     
-    for (const auto& event : allEvents_) {
-        if (event.tick > totalTicks_) {
-            totalTicks_ = event.tick;
+    // Track ends include meta-events (End of Track), which are not packed
+    for (const auto& track : midiFile_.tracks) {
+        if (!track.events.empty() && track.events.back().absoluteTime > totalTicks_) {
+            totalTicks_ = track.events.back().absoluteTime;
         }
     }
+    
+    totalFileTimeUs_ = midiFile_.tempoMap.ticksToMicros(totalTicks_);
 }
 
 // ============================================================================
 // PRIVATE METHODS - PLAYBACK
 // ============================================================================
 
-void MidiPlayer::playbackLoop() {
-    Logger::info("MidiPlayer", "Playback thread started");
+std::chrono::steady_clock::time_point MidiPlayer::process(
+    std::chrono::steady_clock::time_point now)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
     
-    uint64_t tickCounter = 0;
-    startTime_ = std::chrono::high_resolution_clock::now();
+    if (state_ != PlayerState::PLAYING) {
+        return std::chrono::steady_clock::time_point::max();
+    }
     
-    while (running_) {
-        if (state_ != PlayerState::PLAYING) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (now < startTime_) {
+        return startTime_;      // Synchronized start not reached yet
+    }
+    
+    // Held until the burst is routed; mutex_ is released before that
+    std::unique_lock<std::mutex> routeLock(routeMutex_);
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        now - startTime_).count();
+    
+    double speed = getSpeedRatio();
+    uint64_t fileTimeUs = startFileTimeUs_ + static_cast<uint64_t>(elapsed * speed);
+    uint64_t targetTick = std::max(startTick_, midiFile_.tempoMap.microsToTicks(fileTimeUs));
+    
+    currentTick_ = targetTick;
+    
+    // Dispatch the events that became due since the last call, plus those
+    // due within the lookahead
+    uint64_t dispatchUntilUs = fileTimeUs +
+        static_cast<uint64_t>(static_cast<double>(lookahead_.count()) * speed);
+    auto mask = std::atomic_load(&dispatchMask_);
+    size_t burstSize = 0;
+    dispatchGroups_.clear();
+    
+    while (nextEventIndex_ < events_.size() &&
+           events_[nextEventIndex_].fileTimeUs <= dispatchUntilUs) {
+        const auto& event = events_[nextEventIndex_++];
+        
+        if (!mask->isTrackEnabled(event.trackNumber)) {
             continue;
         }
         
-        auto now = std::chrono::high_resolution_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
-            now - startTime_).count();
-        
-        double currentTempo = tempo_.load();
-        double microsecondsPerTick = (60.0 / currentTempo) * 1000000.0 / ticksPerQuarterNote_;
-        uint64_t targetTick = static_cast<uint64_t>(elapsed / microsecondsPerTick);
+        if (burstSize == dispatchBurst_.size()) {
+            dispatchBurst_.emplace_back();
+        }
+        MidiMessage& message = dispatchBurst_[burstSize];
         
-        currentTick_ = targetTick;
+        if (event.isSysEx()) {
+            message.setRawData(events_.getSysExData(event), event.sysexLength);
+        } else {
+            uint8_t bytes[3] = {event.data[0], event.data[1], event.data[2]};
+            mask->apply(bytes, event.size);
+            message.setRawData(bytes, event.size);
+        }
         
-        for (auto& event : allEvents_) {
-            if (!running_ || state_ != PlayerState::PLAYING) break;
-            
-            if (event.tick <= targetTick && !event.processed) {
-                if (shouldPlayEvent(event)) {
-                    auto modifiedMsg = applyModifications(event.message, event.trackNumber);
-                    modifiedMsg = applyMasterVolume(modifiedMsg);
-                    
-                    if (router_) {
-                        router_->route(modifiedMsg);
-                    }
-                }
-                event.processed = true;
-            }
+        if (outputCallback_) {
+            // Virtual clock (offline render): lateness is meaningless
+            outputCallback_(message, event.trackNumber, event.tick);
+            continue;
         }
         
-        // Publish progress every 10 iterations
-        if (eventBus_ && (tickCounter % 10 == 0)) {
-            try {
-                double position = getCurrentPosition();
-                double duration = getDuration();
-                double percentage = (duration > 0) ? (position / duration * 100.0) : 0.0;
-                
-                eventBus_->publish(events::PlaybackProgressEvent(
-                    position,
-                    duration,
-                    percentage,
-                    TimeUtils::systemNow()
-                ));
-            } catch (const std::exception&) {
-                // Silent for progress events
-            }
+        auto scheduled = fileTimeToTimePoint(event.fileTimeUs, speed);
+        auto lateness = std::chrono::steady_clock::now() - scheduled;
+        latenessHistogram_.record(lateness.count() > 0 ?
+            std::chrono::duration_cast<std::chrono::microseconds>(lateness).count() : 0);
+        
+        // Due now (default time point) or, ahead of time, when scheduled
+        auto due = scheduled > now ? scheduled : std::chrono::steady_clock::time_point();
+        if (dispatchGroups_.empty() || dispatchGroups_.back().second != due) {
+            dispatchGroups_.emplace_back(burstSize, due);
         }
-        tickCounter++;
         
-        if (currentTick_ >= totalTicks_) {
-            if (loopEnabled_) {
-                currentTick_ = 0;
-                for (auto& event : allEvents_) {
-                    event.processed = false;
-                }
-                startTime_ = std::chrono::high_resolution_clock::now();
-            } else {
-                break;
+        burstSize++;
+        dispatchGroups_.back().first = burstSize;
+    }
+    
+    if (fileTimeUs >= totalFileTimeUs_) {
+        // End of file: the burst, then notes off and chase, in that order
+        routeDispatchGroups();
+        
+        if (!loopEnabled_) {
+            stopPlayback();
+            return std::chrono::steady_clock::time_point::max();
+        }
+        // Restart at the time the end was due, not now: the overshoot
+        // carries into the next pass
+        sendAllNotesOff();
+        chaseToTick(0);
+        rebaseClock(0, fileTimeToTimePoint(totalFileTimeUs_, speed));
+        return startTime_;
+    }
+    
+    // Next call: when the next event (or end of file) is due; transport
+    // changes (pause, stop, seek, tempo) wake the scheduler earlier.
+    // Events leave a lookahead early; the end of file is handled on time
+    std::chrono::steady_clock::time_point next;
+    if (nextEventIndex_ < events_.size()) {
+        next = fileTimeToTimePoint(events_[nextEventIndex_].fileTimeUs, speed) - lookahead_;
+    } else {
+        next = fileTimeToTimePoint(totalFileTimeUs_, speed);
+    }
+    
+    bool publishProgress = false;
+    double position = 0.0;
+    double duration = 0.0;
+    
+    if (eventBus_ && progressInterval_.count() > 0) {
+        if (now - lastProgress_ < progressInterval_) {
+            next = std::min(next, lastProgress_ + progressInterval_);
+        } else {
+            lastProgress_ = now;
+            next = std::min(next, now + progressInterval_);
+            
+            if (targetTick != lastProgressTick_) {
+                lastProgressTick_ = targetTick;
+                position = ticksToMs(targetTick);
+                duration = ticksToMs(totalTicks_);
+                publishProgress = true;
             }
         }
-        
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
     
-    Logger::info("MidiPlayer", "Playback thread stopped");
+    // Route without mutex_: transport calls wait on routeMutex_ only if
+    // they have output of their own, mask changes never wait
+    lock.unlock();
+    routeDispatchGroups();
+    routeLock.unlock();
+    
+    if (publishProgress) {
+        // Subscribers may call back into the player: no lock held
+        double percentage = (duration > 0) ? (position / duration * 100.0) : 0.0;
+        try {
+            eventBus_->publish(events::PlaybackProgressEvent(
+                position,
+                duration,
+                percentage,
+                TimeUtils::systemNow(),
+                playerId_
+            ));
+        } catch (const std::exception&) {
+            // Silent for progress events
+        }
+    }
+    
+    return next;
 }
 
-bool MidiPlayer::shouldPlayEvent(const ScheduledEvent& event) const {
-    if (event.trackNumber >= tracks_.size()) {
-        return true;
+void MidiPlayer::routeDispatchGroups() {
+    // Caller must hold routeMutex_ (owns dispatchBurst_/dispatchGroups_)
+    if (!router_) {
+        return;
     }
     
-    const auto& track = tracks_[event.trackNumber];
-    
-    if (track.isMuted) {
-        return false;
+    // Events due together leave together
+    size_t begin = 0;
+    for (const auto& group : dispatchGroups_) {
+        if (group.second == std::chrono::steady_clock::time_point()) {
+            router_->route(dispatchBurst_.data() + begin, group.first - begin);
+        } else {
+            router_->route(dispatchBurst_.data() + begin, group.first - begin, group.second);
+        }
+        begin = group.first;
     }
+    dispatchGroups_.clear();
+}
+
+void MidiPlayer::rebuildDispatchMask() {
+    // Caller must hold trackMutex_ (reads tracks_)
+    auto mask = std::make_shared<DispatchMask>();
     
     bool anySolo = std::any_of(tracks_.begin(), tracks_.end(),
                                 [](const TrackInfo& t) { return t.isSolo; });
     
-    if (anySolo && !track.isSolo) {
-        return false;
+    mask->trackBits.assign((tracks_.size() + 63) / 64, 0);
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        const auto& track = tracks_[i];
+        if (!track.isMuted && (!anySolo || track.isSolo)) {
+            mask->trackBits[i >> 6] |= uint64_t(1) << (i & 63);
+        }
     }
     
-    return true;
+    int trans = transpose_.load();
+    float volume = masterVolume_.load();
+    
+    for (int value = 0; value < 128; ++value) {
+        mask->noteMap[value] = static_cast<uint8_t>(std::clamp(value + trans, 0, 127));
+        mask->velocityMap[value] = static_cast<uint8_t>(value * volume);
+    }
+    
+    std::atomic_store(&dispatchMask_, std::shared_ptr<const DispatchMask>(std::move(mask)));
+}
+
+void MidiPlayer::wakeScheduler() {
+    // Caller must hold mutex_
+    if (wakeCallback_) {
+        wakeCallback_();
+    }
 }
 
-MidiMessage MidiPlayer::applyModifications(const MidiMessage& message, 
-                                           uint16_t trackNumber) const {
-    uint8_t status = message.getStatus();
-    uint8_t type = status & 0xF0;
+void MidiPlayer::sendAllNotesOff() {
+    // Caller must hold routeMutex_
+    if (!router_) return;
     
-    if (type != 0x90 && type != 0x80) {
-        return message;
+    std::vector<MidiMessage> messages;
+    messages.reserve(16);
+    for (uint8_t channel = 0; channel < 16; ++channel) {
+        uint8_t status = 0xB0 | channel;
+        messages.emplace_back(status, 123, 0);
     }
+    router_->route(messages.data(), messages.size());
+}
+
+void MidiPlayer::chaseToTick(uint64_t tick) {
+    // Caller must hold mutex_ and routeMutex_
+    if (!router_) return;
     
-    uint8_t note = message.getData1();
-    uint8_t velocity = message.getData2();
+    // Muted and non-soloed tracks keep their state to themselves
+    auto mask = std::atomic_load(&dispatchMask_);
+    std::vector<MidiMessage> messages;
     
-    int trans = transpose_.load();
-    int newNote = static_cast<int>(note) + trans;
+    for (auto& chased : chaseIndex_.getChaseMessages(events_, tick)) {
+        if (!mask->isTrackEnabled(chased.trackNumber)) {
+            continue;
+        }
+        
+        const auto& raw = chased.message.getRawData();
+        uint8_t bytes[3] = {0, 0, 0};
+        uint8_t size = static_cast<uint8_t>(std::min<size_t>(raw.size(), 3));
+        std::copy(raw.begin(), raw.begin() + size, bytes);
+        mask->apply(bytes, size);
+        chased.message.setRawData(bytes, size);
+        
+        messages.push_back(std::move(chased.message));
+    }
     
-    if (newNote < 0) newNote = 0;
-    if (newNote > 127) newNote = 127;
+    router_->route(messages.data(), messages.size());
     
-    return MidiMessage(status, static_cast<uint8_t>(newNote), velocity);
+    Logger::debug("MidiPlayer", "Chased " + std::to_string(messages.size()) +
+                 " messages to tick " + std::to_string(tick));
 }
 
-MidiMessage MidiPlayer::applyMasterVolume(const MidiMessage& message) const {
-    uint8_t status = message.getStatus();
-    uint8_t type = status & 0xF0;
+// ============================================================================
+// PRIVATE METHODS - SCHEDULING
+// ============================================================================
+
+size_t MidiPlayer::findEventIndex(uint64_t tick) const {
+    return events_.lowerBound(tick);
+}
+
+void MidiPlayer::rebaseClock(uint64_t tick) {
+    rebaseClock(tick, std::chrono::steady_clock::now());
+}
+
+void MidiPlayer::rebaseClock(uint64_t tick, std::chrono::steady_clock::time_point at) {
+    // Caller must hold mutex_. Playback is at `tick` at instant `at`.
+    startTick_ = tick;
+    startFileTimeUs_ = midiFile_.tempoMap.ticksToMicros(tick);
+    startTime_ = at;
+    currentTick_ = tick;
+    nextEventIndex_ = findEventIndex(tick);
     
-    if (type != 0x90) {
-        return message;
-    }
+    // Position jumped: report it at the next process() call
+    lastProgress_ = std::chrono::steady_clock::time_point{};
+    lastProgressTick_ = UINT64_MAX;
     
-    uint8_t note = message.getData1();
-    uint8_t velocity = message.getData2();
+    // The scheduler may be sleeping towards a stale deadline
+    wakeScheduler();
+}
+
+void MidiPlayer::anchorClock() {
+    // Caller must hold mutex_. Re-anchors at the exact current position
+    // without moving the cursor (nothing is replayed or skipped).
+    auto now = std::chrono::steady_clock::now();
     
-    float volume = masterVolume_.load();
-    uint8_t newVelocity = static_cast<uint8_t>(velocity * volume);
+    if (state_ == PlayerState::PLAYING) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            now - startTime_).count();
+        
+        startFileTimeUs_ += static_cast<uint64_t>(elapsed * getSpeedRatio());
+        startTick_ = std::max(startTick_, midiFile_.tempoMap.microsToTicks(startFileTimeUs_));
+        currentTick_ = startTick_;
+    }
     
-    return MidiMessage(status, note, newVelocity);
+    startTime_ = now;
+    wakeScheduler();
 }
 
-void MidiPlayer::sendAllNotesOff() {
-    if (!router_) return;
+std::chrono::steady_clock::time_point MidiPlayer::fileTimeToTimePoint(
+    uint64_t fileTimeUs, double speed) const
+{
+    double offsetUs = (static_cast<double>(fileTimeUs) - static_cast<double>(startFileTimeUs_)) /
+                      speed;
     
-    for (uint8_t channel = 0; channel < 16; ++channel) {
-        uint8_t status = 0xB0 | channel;
-        router_->route(MidiMessage(status, 123, 0));
-    }
+    return startTime_ + std::chrono::microseconds(static_cast<int64_t>(std::ceil(offsetUs)));
+}
+
+double MidiPlayer::getSpeedRatio() const {
+    return tempo_.load() / baseTempo_;
 }
 
 // ============================================================================
@@ -753,15 +1125,13 @@ void MidiPlayer::sendAllNotesOff() {
 // ============================================================================
 
 uint64_t MidiPlayer::msToTicks(uint64_t ms) const {
-    double currentTempo = tempo_.load();
-    double ticksPerMs = (currentTempo * ticksPerQuarterNote_) / 60000.0;
-    return static_cast<uint64_t>(ms * ticksPerMs);
+    double fileTimeUs = static_cast<double>(ms) * 1000.0 * getSpeedRatio();
+    return midiFile_.tempoMap.microsToTicks(static_cast<uint64_t>(fileTimeUs));
 }
 
 uint64_t MidiPlayer::ticksToMs(uint64_t ticks) const {
-    double currentTempo = tempo_.load();
-    double msPerTick = 60000.0 / (currentTempo * ticksPerQuarterNote_);
-    return static_cast<uint64_t>(ticks * msPerTick);
+    double fileTimeUs = static_cast<double>(midiFile_.tempoMap.ticksToMicros(ticks));
+    return static_cast<uint64_t>(fileTimeUs / getSpeedRatio() / 1000.0);
 }
 
 uint64_t MidiPlayer::musicalPositionToTicks(uint32_t bar, uint8_t beat, 
@@ -1,9 +1,64 @@
 // ============================================================================
 // File: backend/src/midi/player/MidiPlayer.h
-// Version: 4.2.0
+// Version: 4.3.9
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
+// Changes v4.3.9:
+//   - process() no longer spins through the last lookahead before the end
+//
+// Changes v4.3.8:
+//   - getCurrentPosition() takes mutex_ (tempo map conversion)
+//
+// Changes v4.3.7:
+//   - Loop wrap keeps the overshoot (rebaseClock at the scheduled time)
+//
+// Changes v4.3.6:
+//   - trackMutex_ (track metadata, mask rebuilds) and routeMutex_
+//     (output order) split from mutex_
+//
+// Changes v4.3.5:
+//   - Chase filtered by the dispatch mask (mute/solo)
+//
+// Changes v4.3.4:
+//   - Optional lookahead: events are routed up to N ms before their time,
+//     stamped with it, for destinations that deliver on time themselves
+//
+// Changes v4.3.3:
+//   - Events due in one process() call are routed as one burst
+//
+// Changes v4.3.2:
+//   - Progress events at a configurable rate, only when the position moved
+//
+// Changes v4.3.1:
+//   - Output callback (replaces router delivery, used by OfflineRenderer)
+//   - getTempoMap(), getTimeSignature()
+//
+// Changes v4.3.0:
+//   - No playback thread of its own: driven by PlayerEngine via process()
+//   - Player ID, playAt() for synchronized starts, wake callback
+//
+// Changes v4.2.6:
+//   - Mute/solo/transpose/volume compiled into an immutable DispatchMask
+//
+// Changes v4.2.5:
+//   - Controller chase on seek/loop through ChaseIndex
+//
+// Changes v4.2.4:
+//   - Playback events held in a PackedEventStore (replaces ScheduledEvent)
+//
+// Changes v4.2.3:
+//   - Tempo map support: event times precomputed from MidiFile::tempoMap
+//   - setTempo() scales playback relative to the file's initial tempo
+//
+// Changes v4.2.2:
+//   - Deadline-driven playback thread (condition variable, steady_clock)
+//   - Dispatch lateness histogram (getTimingStatistics)
+//
+// Changes v4.2.1:
+//   - Cursor-based scheduling (no per-wakeup scan of all events)
+//   - Seek/loop/resume rebase the clock and cursor by binary search
+//
 // Changes v4.2.0:
 //   - Added EventBus integration
 //   - Added publishStateChange() method
@@ -16,13 +71,16 @@
 #include "../MidiMessage.h"
 #include "../MidiRouter.h"
 #include "../file/MidiFileReader.h"
+#include "PackedEventStore.h"
+#include "ChaseIndex.h"
+#include "../../timing/LatencyHistogram.h"
 #include <string>
 #include <vector>
-#include <thread>
 #include <mutex>
 #include <atomic>
 #include <functional>
 #include <chrono>
+#include <array>
 #include <nlohmann/json.hpp>
 #include <memory>
 
@@ -68,25 +126,62 @@ struct MusicalPosition {
     std::string formatted;
 };
 
-struct ScheduledEvent {
-    uint64_t tick = 0;
-    uint64_t absoluteTime = 0;
-    MidiMessage message;
-    uint16_t trackNumber = 0;
-    bool processed = false;
+/**
+ * @struct DispatchMask
+ * @brief Immutable per-event dispatch state, rebuilt on mute/solo/transpose/volume changes
+ */
+struct DispatchMask {
+    std::vector<uint64_t> trackBits;        // Bit set = track audible (mute and solo applied)
+    std::array<uint8_t, 128> noteMap;       // Note number after transpose
+    std::array<uint8_t, 128> velocityMap;   // Note-on velocity after master volume
+    
+    bool isTrackEnabled(uint16_t track) const {
+        size_t word = track >> 6;
+        return word >= trackBits.size() || ((trackBits[word] >> (track & 63)) & 1);
+    }
+    
+    /**
+     * @brief Transform a short message in place (note on/off only)
+     */
+    void apply(uint8_t* bytes, uint8_t size) const {
+        uint8_t type = bytes[0] & 0xF0;
+        if (size < 3 || (type != 0x90 && type != 0x80)) return;
+        
+        bytes[1] = noteMap[bytes[1] & 0x7F];
+        if (type == 0x90) {
+            bytes[2] = velocityMap[bytes[2] & 0x7F];
+        }
+    }
 };
 
 // ============================================================================
 // CLASS: MidiPlayer
 // ============================================================================
 
+/**
+ * @class MidiPlayer
+ * @brief One playback instance (file, tempo, loop, transport)
+ *
+ * The player has no thread of its own: a PlayerEngine calls process()
+ * whenever the deadline it returned is reached or the wake callback fires.
+ */
 class MidiPlayer {
 public:
     using StateCallback = std::function<void(const std::string& newState)>;
+    using WakeCallback = std::function<void()>;
+    using OutputCallback = std::function<void(const MidiMessage& message,
+                                              uint16_t trackNumber, uint64_t tick)>;
+    
+    /// Default PlaybackProgressEvent rate while playing (Hz)
+    static constexpr double DEFAULT_PROGRESS_RATE = 30.0;
+    
+    /// Longest lookahead: a stop still lets this much already-routed music play
+    static constexpr std::chrono::microseconds MAX_LOOKAHEAD{100000};
     
     // Constructor with EventBus
     MidiPlayer(std::shared_ptr<MidiRouter> router,
-               std::shared_ptr<EventBus> eventBus = nullptr);
+               std::shared_ptr<EventBus> eventBus = nullptr,
+               const std::string& playerId = "main");
     
     ~MidiPlayer();
     
@@ -98,8 +193,11 @@ public:
     std::string getCurrentFile() const;
     bool hasFile() const;
     
+    const std::string& getId() const { return playerId_; }
+    
     // Playback control
     bool play();
+    bool playAt(std::chrono::steady_clock::time_point startTime);
     bool pause();
     void stop();
     PlayerState getState() const;
@@ -132,52 +230,92 @@ public:
     
     // Metadata
     json getMetadata() const;
+    
+    // Timing statistics (dispatch lateness vs. scheduled time)
+    json getTimingStatistics() const;
     void setStateCallback(StateCallback callback);
     
     // EventBus configuration
     void setEventBus(std::shared_ptr<EventBus> eventBus);
+    void setProgressRate(double hz);   // 0 = no progress events
+    double getProgressRate() const;
+    
+    // Dispatch ahead of time (0 = each event when due)
+    void setLookahead(std::chrono::microseconds lookahead);
+    std::chrono::microseconds getLookahead() const;
+    
+    // File timing
+    TempoMap getTempoMap() const;
+    std::pair<uint8_t, uint8_t> getTimeSignature() const;
+    
+    // Scheduler interface (PlayerEngine)
+    void setWakeCallback(WakeCallback callback);
+    void setOutputCallback(OutputCallback callback);   // Dispatch here instead of the router
+    std::chrono::steady_clock::time_point process(std::chrono::steady_clock::time_point now);
 
 private:
     void parseAllTracks();
     void extractMetadata();
-    void analyzeTrack(uint16_t trackIndex);
     void calculateDuration();
     
-    void playbackLoop();
-    bool shouldPlayEvent(const ScheduledEvent& event) const;
-    MidiMessage applyModifications(const MidiMessage& message, uint16_t trackNumber) const;
-    MidiMessage applyMasterVolume(const MidiMessage& message) const;
+    void rebuildDispatchMask();
+    void routeDispatchGroups();
+    void wakeScheduler();
     void sendAllNotesOff();
+    void chaseToTick(uint64_t tick);
+    void seekLocked(uint64_t tick);
     void stopPlayback();
     
+    // Scheduling cursor
+    size_t findEventIndex(uint64_t tick) const;
+    void rebaseClock(uint64_t tick);
+    void rebaseClock(uint64_t tick, std::chrono::steady_clock::time_point at);
+    void anchorClock();
+    std::chrono::steady_clock::time_point fileTimeToTimePoint(uint64_t fileTimeUs,
+                                                              double speed) const;
+    double getSpeedRatio() const;
+    
     uint64_t msToTicks(uint64_t ms) const;
     uint64_t ticksToMs(uint64_t ticks) const;
     uint64_t musicalPositionToTicks(uint32_t bar, uint8_t beat, uint16_t tick) const;
     MusicalPosition ticksToMusicalPosition(uint64_t ticks) const;
     
-    // EventBus helper
+    // EventBus helper (caller holds mutex_)
     void publishStateChange(PlayerState newState);
     
     // Core members
     std::shared_ptr<MidiRouter> router_;
     std::shared_ptr<EventBus> eventBus_;
-    mutable std::mutex mutex_;
-    std::thread playbackThread_;
+    std::string playerId_;
+    mutable std::mutex mutex_;         // Transport, file and clock state
+    mutable std::mutex trackMutex_;    // tracks_ and mask rebuilds (after mutex_)
+    std::mutex routeMutex_;            // Output order and dispatch buffers (after mutex_, before trackMutex_)
+    WakeCallback wakeCallback_;        // Wakes the scheduler on transport changes
+    OutputCallback outputCallback_;    // Replaces router_ delivery when set
     std::atomic<PlayerState> state_;
-    std::atomic<bool> running_;
     
     // File data
     std::string currentFile_;
-    MidiFile midiFile_;
-    std::vector<ScheduledEvent> allEvents_;
+    MidiFile midiFile_;           // Header, tempo map and time signature (tracks released after load)
+    PackedEventStore events_;
+    ChaseIndex chaseIndex_;       // Controller state checkpoints for seeking
     std::vector<TrackInfo> tracks_;
     
     // Timing
     std::atomic<uint64_t> currentTick_;
     uint64_t totalTicks_;
+    uint64_t totalFileTimeUs_;    // File time of totalTicks_ (µs)
     uint16_t ticksPerQuarterNote_;
-    std::atomic<double> tempo_;
-    std::chrono::high_resolution_clock::time_point startTime_;
+    std::atomic<double> tempo_;   // Playback tempo (BPM)
+    double baseTempo_;            // Initial tempo of the file (BPM)
+    std::chrono::steady_clock::time_point startTime_;
+    uint64_t startTick_;          // Tick reached at startTime_
+    uint64_t startFileTimeUs_;    // File time of startTick_ (µs)
+    size_t nextEventIndex_;       // Play cursor: first event not yet dispatched
+    std::chrono::steady_clock::time_point lastProgress_;
+    std::chrono::microseconds progressInterval_;   // 0 = progress disabled
+    std::chrono::microseconds lookahead_;          // Events routed this early
+    uint64_t lastProgressTick_;   // Position of the last progress event
     
     // Time signature
     uint8_t timeSignatureNum_;
@@ -188,7 +326,14 @@ private:
     std::atomic<bool> loopEnabled_;
     std::atomic<int> transpose_;
     std::atomic<float> masterVolume_;
+    std::shared_ptr<const DispatchMask> dispatchMask_;   // Swapped with std::atomic_store
+    std::vector<MidiMessage> dispatchBurst_;              // Slots reused for every dispatched event
+    std::vector<std::pair<size_t, std::chrono::steady_clock::time_point>>
+        dispatchGroups_;                                  // (end, due) of each burst in dispatchBurst_
     StateCallback stateCallback_;
+    
+    // Timing statistics
+    LatencyHistogram latenessHistogram_;
 };
 
 } // namespace midiMind
\ No newline at end of file
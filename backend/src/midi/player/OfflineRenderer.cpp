@@ -0,0 +1,209 @@
+// ============================================================================
+// File: backend/src/midi/player/OfflineRenderer.cpp
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "OfflineRenderer.h"
+#include "../MidiRouter.h"
+#include "../file/MidiFileWriter.h"
+#include "../../core/Logger.h"
+#include "../../core/Error.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+namespace midiMind {
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+OfflineRenderer::OfflineRenderer(std::shared_ptr<MidiRouter> router)
+    : router_(router)
+{
+}
+
+// ============================================================================
+// RENDER
+// ============================================================================
+
+json OfflineRenderer::render(const MidiPlayer& source, const std::string& outputPath,
+                             bool applyRouting) {
+    using Clock = std::chrono::steady_clock;
+
+    if (!source.hasFile()) {
+        THROW_ERROR(ErrorCode::MIDI_FILE_ERROR, "No file loaded in player " + source.getId());
+    }
+
+    auto renderStart = Clock::now();
+
+    // Private player: same file, same settings, no router, no event bus
+    MidiPlayer player(nullptr, nullptr, source.getId() + ":render");
+    if (!player.load(source.getCurrentFile())) {
+        THROW_ERROR(ErrorCode::MIDI_FILE_ERROR, "Cannot load " + source.getCurrentFile());
+    }
+
+    for (const auto& info : source.getTracksInfo()) {
+        player.setTrackMute(info.index, info.isMuted);
+        player.setTrackSolo(info.index, info.isSolo);
+    }
+    player.setTranspose(source.getTranspose());
+    player.setVolume(source.getVolume());
+    player.setTempo(source.getTempo());
+    player.setLoop(false);
+
+    double fileBpm = source.getTempoMap().getInitialBpm();
+    double speed = fileBpm > 0.0 ? source.getTempo() / fileBpm : 1.0;
+
+    // Output tracks keyed by destination device or source track number
+    std::map<std::string, MidiTrack> tracks;
+    bool routing = applyRouting && router_;
+    size_t eventCount = 0;
+
+    player.setOutputCallback([&](const MidiMessage& message, uint16_t trackNumber,
+                                 uint64_t tick) {
+        if (routing) {
+            for (const auto& [deviceId, routed] : router_->resolveRoutes(message)) {
+                appendMessage(tracks[deviceId], routed, tick);
+                eventCount++;
+            }
+        } else {
+            char key[8];
+            snprintf(key, sizeof(key), "%05u", static_cast<unsigned>(trackNumber));
+            appendMessage(tracks[key], message, tick);
+            eventCount++;
+        }
+    });
+
+    // Virtual clock: jump straight to each deadline process() returns
+    Clock::time_point now{};
+    player.playAt(now);
+
+    while (true) {
+        auto next = player.process(now);
+        if (next == Clock::time_point::max()) {
+            break;
+        }
+        now = next > now ? next : now + std::chrono::microseconds(1);
+    }
+
+    // Assemble the file
+    MidiFile file;
+    file.header.format = 1;
+    file.header.division = source.getTempoMap().getDivision();
+    file.tracks.reserve(tracks.size() + 1);
+    file.tracks.push_back(buildConductorTrack(source, speed));
+
+    uint64_t lastTick = 0;
+
+    for (auto& [key, track] : tracks) {
+        std::string name = routing ? key : "Track " + std::to_string(std::stoul(key) + 1);
+
+        MidiEvent nameEvent;
+        nameEvent.type = MidiEventType::META;
+        nameEvent.metaType = 0x03;
+        nameEvent.data.assign(name.begin(), name.end());
+        track.events.insert(track.events.begin(), std::move(nameEvent));
+        track.name = name;
+
+        // Ticks were collected absolute; the writer expects deltas
+        uint64_t previous = 0;
+        for (auto& event : track.events) {
+            event.deltaTime = static_cast<uint32_t>(event.absoluteTime - previous);
+            previous = event.absoluteTime;
+        }
+        lastTick = std::max(lastTick, previous);
+
+        file.tracks.push_back(std::move(track));
+    }
+
+    file.header.numTracks = static_cast<uint16_t>(file.tracks.size());
+
+    MidiFileWriter writer;
+    writer.writeToFile(outputPath, file);
+
+    double renderMs = std::chrono::duration<double, std::milli>(Clock::now() - renderStart).count();
+    uint64_t durationMs = static_cast<uint64_t>(
+        source.getTempoMap().ticksToMs(lastTick) / speed);
+
+    Logger::info("OfflineRenderer",
+        "Rendered " + std::to_string(eventCount) + " events to " + outputPath +
+        " in " + std::to_string(static_cast<uint64_t>(renderMs)) + " ms");
+
+    return json{
+        {"output", outputPath},
+        {"events", eventCount},
+        {"tracks", file.tracks.size()},
+        {"duration_ms", durationMs},
+        {"render_ms", renderMs},
+        {"realtime_factor", renderMs > 0.0 ? durationMs / renderMs : 0.0}
+    };
+}
+
+// ============================================================================
+// PRIVATE METHODS
+// ============================================================================
+
+MidiTrack OfflineRenderer::buildConductorTrack(const MidiPlayer& source, double speed) {
+    MidiTrack track;
+    track.name = "Conductor";
+
+    auto [numerator, denominator] = source.getTimeSignature();
+
+    MidiEvent timeSignature;
+    timeSignature.type = MidiEventType::META;
+    timeSignature.metaType = 0x58;
+    timeSignature.data = {
+        numerator,
+        static_cast<uint8_t>(std::log2(std::max<uint8_t>(denominator, 1))),
+        24,
+        8
+    };
+    track.events.push_back(std::move(timeSignature));
+
+    TempoMap tempoMap = source.getTempoMap();
+    uint64_t previous = 0;
+
+    for (const auto& segment : tempoMap.getSegments()) {
+        uint32_t usPerQuarter = static_cast<uint32_t>(
+            std::clamp(std::lround(segment.usPerQuarter / speed), 1L, 0xFFFFFFL));
+
+        MidiEvent tempo;
+        tempo.type = MidiEventType::META;
+        tempo.metaType = 0x51;
+        tempo.deltaTime = static_cast<uint32_t>(segment.startTick - previous);
+        tempo.absoluteTime = segment.startTick;
+        tempo.data = {
+            static_cast<uint8_t>((usPerQuarter >> 16) & 0xFF),
+            static_cast<uint8_t>((usPerQuarter >> 8) & 0xFF),
+            static_cast<uint8_t>(usPerQuarter & 0xFF)
+        };
+        track.events.push_back(std::move(tempo));
+        previous = segment.startTick;
+    }
+
+    return track;
+}
+
+void OfflineRenderer::appendMessage(MidiTrack& track, const MidiMessage& message,
+                                    uint64_t tick) {
+    const auto& bytes = message.getRawData();
+    if (bytes.empty()) {
+        return;
+    }
+
+    MidiEvent event;
+    event.absoluteTime = tick;
+    event.status = bytes[0];
+    event.data.assign(bytes.begin() + 1, bytes.end());
+
+    // SMF SysEx: F0 <length> <bytes after F0>
+    event.type = (bytes[0] == 0xF0 || bytes[0] == 0xF7) ?
+        MidiEventType::SYSEX : MidiEventType::MIDI_CHANNEL;
+
+    track.events.push_back(std::move(event));
+}
+
+} // namespace midiMind
@@ -0,0 +1,82 @@
+// ============================================================================
+// File: backend/src/midi/player/OfflineRenderer.h
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Renders a player's current setup to a Standard MIDI File.
+//   The file is played by a private MidiPlayer against a virtual clock, so
+//   the output goes through exactly the same dispatch path as live playback
+//   (mute/solo, transpose, master volume, tempo) and optionally through the
+//   MidiRouter transformations, as fast as the CPU allows.
+//
+// Output layout:
+//   - Track 0: conductor (time signature + tempo map scaled to the tempo)
+//   - One track per destination device (routing applied) or per source
+//     track (routing bypassed)
+//
+// ============================================================================
+
+#pragma once
+
+#include "MidiPlayer.h"
+#include "../file/MidiFileReader.h"
+#include <string>
+#include <memory>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace midiMind {
+
+class MidiRouter;
+
+/**
+ * @class OfflineRenderer
+ * @brief Faster-than-realtime rendering of the playback pipeline
+ *
+ * Thread Safety: render() is reentrant; the source player is only read.
+ *
+ * Example:
+ * ```cpp
+ * OfflineRenderer renderer(router);
+ * json result = renderer.render(*player, "/home/pi/midi/render.mid");
+ * ```
+ */
+class OfflineRenderer {
+public:
+    /**
+     * @brief Constructor
+     * @param router Router whose routes/transformations are applied (may be null)
+     */
+    explicit OfflineRenderer(std::shared_ptr<MidiRouter> router);
+
+    /**
+     * @brief Render a player's file with its current settings
+     * @param source Player providing the file, mute/solo, transpose, volume, tempo
+     * @param outputPath Destination .mid file
+     * @param applyRouting true = route through MidiRouter (one track per device)
+     * @return json {output, events, tracks, duration_ms, render_ms, realtime_factor}
+     * @throws MidiMindException if no file is loaded or the output cannot be written
+     */
+    json render(const MidiPlayer& source, const std::string& outputPath,
+                bool applyRouting = true);
+
+private:
+    /**
+     * @brief Conductor track: time signature and tempo changes
+     * @param speed Playback tempo / file tempo
+     */
+    static MidiTrack buildConductorTrack(const MidiPlayer& source, double speed);
+
+    /**
+     * @brief Append a rendered message to a track (ticks are absolute)
+     */
+    static void appendMessage(MidiTrack& track, const MidiMessage& message,
+                              uint64_t tick);
+
+    std::shared_ptr<MidiRouter> router_;
+};
+
+} // namespace midiMind
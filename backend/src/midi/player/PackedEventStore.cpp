@@ -0,0 +1,88 @@
+// ============================================================================
+// File: backend/src/midi/player/PackedEventStore.cpp
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+
+#include "PackedEventStore.h"
+#include <algorithm>
+
+namespace midiMind {
+
+// ============================================================================
+// BUILDING
+// ============================================================================
+
+void PackedEventStore::clear() {
+    std::vector<PackedEvent>().swap(events_);
+    std::vector<uint8_t>().swap(sysexArena_);
+}
+
+void PackedEventStore::reserve(size_t events, size_t sysexBytes) {
+    events_.reserve(events);
+    sysexArena_.reserve(sysexBytes);
+}
+
+void PackedEventStore::addMessage(uint64_t tick, uint64_t fileTimeUs, uint16_t trackNumber,
+                                  const uint8_t* bytes, uint8_t size) {
+    PackedEvent event;
+    event.tick = tick;
+    event.fileTimeUs = fileTimeUs;
+    event.trackNumber = trackNumber;
+    event.size = std::min<uint8_t>(size, 3);
+    std::copy(bytes, bytes + event.size, event.data);
+
+    events_.push_back(event);
+}
+
+void PackedEventStore::addSysEx(uint64_t tick, uint64_t fileTimeUs, uint16_t trackNumber,
+                                const uint8_t* bytes, size_t length) {
+    PackedEvent event;
+    event.tick = tick;
+    event.fileTimeUs = fileTimeUs;
+    event.trackNumber = trackNumber;
+    event.sysexOffset = static_cast<uint32_t>(sysexArena_.size());
+    event.sysexLength = static_cast<uint32_t>(length);
+    event.data[0] = length > 0 ? bytes[0] : 0;
+
+    sysexArena_.insert(sysexArena_.end(), bytes, bytes + length);
+    events_.push_back(event);
+}
+
+void PackedEventStore::sortByTick() {
+    std::stable_sort(events_.begin(), events_.end(),
+                     [](const PackedEvent& a, const PackedEvent& b) {
+                         return a.tick < b.tick;
+                     });
+}
+
+// ============================================================================
+// ACCESS
+// ============================================================================
+
+size_t PackedEventStore::lowerBound(uint64_t tick) const {
+    auto it = std::lower_bound(events_.begin(), events_.end(), tick,
+                               [](const PackedEvent& event, uint64_t t) {
+                                   return event.tick < t;
+                               });
+    return static_cast<size_t>(it - events_.begin());
+}
+
+MidiMessage PackedEventStore::toMessage(const PackedEvent& event) const {
+    if (event.isSysEx()) {
+        auto first = sysexArena_.begin() + event.sysexOffset;
+        return MidiMessage(std::vector<uint8_t>(first, first + event.sysexLength));
+    }
+
+    switch (event.size) {
+        case 1:  return MidiMessage(event.data[0]);
+        case 2:  return MidiMessage(event.data[0], event.data[1]);
+        default: return MidiMessage(event.data[0], event.data[1], event.data[2]);
+    }
+}
+
+size_t PackedEventStore::getMemoryUsage() const {
+    return events_.capacity() * sizeof(PackedEvent) + sysexArena_.capacity();
+}
+
+} // namespace midiMind
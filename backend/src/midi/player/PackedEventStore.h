@@ -0,0 +1,127 @@
+// ============================================================================
+// File: backend/src/midi/player/PackedEventStore.h
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Compact playback representation of a MIDI file.
+//   Every event is a fixed-size 32-byte record stored contiguously; short
+//   messages are kept inline and SysEx payloads live in a single side arena.
+//   Loading a file therefore performs no heap allocation per event.
+//
+// ============================================================================
+
+#pragma once
+
+#include "../MidiMessage.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace midiMind {
+
+/**
+ * @struct PackedEvent
+ * @brief Fixed-size playback event (32 bytes)
+ *
+ * Channel messages use data[0..size-1] (status, data1, data2).
+ * SysEx events have size == 0 and reference sysexLength bytes at
+ * sysexOffset in the store's arena.
+ */
+struct PackedEvent {
+    uint64_t tick = 0;               ///< Absolute tick
+    uint64_t fileTimeUs = 0;         ///< Absolute file time (µs), from the tempo map
+    uint32_t sysexOffset = 0;        ///< Arena offset (SysEx only)
+    uint32_t sysexLength = 0;        ///< Arena byte count (SysEx only)
+    uint16_t trackNumber = 0;
+    uint8_t size = 0;                ///< Inline byte count (0 for SysEx)
+    uint8_t data[3] = {0, 0, 0};     ///< Inline message bytes
+
+    bool isSysEx() const { return size == 0; }
+    uint8_t getStatus() const { return data[0]; }
+};
+
+static_assert(sizeof(PackedEvent) == 32, "PackedEvent must stay 32 bytes");
+
+/**
+ * @class PackedEventStore
+ * @brief Tick-ordered array of PackedEvent plus SysEx arena
+ *
+ * Thread Safety: None. Owned and locked by MidiPlayer.
+ *
+ * Example:
+ * ```cpp
+ * PackedEventStore store;
+ * store.reserve(count, sysexBytes);
+ * store.addMessage(0, 0, 0, noteOn, 3);
+ * store.sortByTick();
+ * MidiMessage msg = store.toMessage(store[0]);
+ * ```
+ */
+class PackedEventStore {
+public:
+    /**
+     * @brief Release all events and SysEx bytes
+     */
+    void clear();
+
+    /**
+     * @brief Pre-allocate storage
+     * @param events Number of events
+     * @param sysexBytes Total SysEx payload size
+     */
+    void reserve(size_t events, size_t sysexBytes = 0);
+
+    /**
+     * @brief Append a short (1-3 byte) message
+     */
+    void addMessage(uint64_t tick, uint64_t fileTimeUs, uint16_t trackNumber,
+                    const uint8_t* bytes, uint8_t size);
+
+    /**
+     * @brief Append a SysEx message (bytes copied into the arena)
+     */
+    void addSysEx(uint64_t tick, uint64_t fileTimeUs, uint16_t trackNumber,
+                  const uint8_t* bytes, size_t length);
+
+    /**
+     * @brief Order events by tick (stable: same-tick events keep insertion order)
+     */
+    void sortByTick();
+
+    /**
+     * @brief Index of the first event at or after a tick (O(log n))
+     */
+    size_t lowerBound(uint64_t tick) const;
+
+    /**
+     * @brief Build the MidiMessage for an event (at dispatch time only)
+     */
+    MidiMessage toMessage(const PackedEvent& event) const;
+
+    /**
+     * @brief SysEx bytes of an event (nullptr for short messages)
+     */
+    const uint8_t* getSysExData(const PackedEvent& event) const {
+        return event.isSysEx() ? sysexArena_.data() + event.sysexOffset : nullptr;
+    }
+
+    size_t size() const { return events_.size(); }
+    bool empty() const { return events_.empty(); }
+    const PackedEvent& operator[](size_t index) const { return events_[index]; }
+
+    std::vector<PackedEvent>::const_iterator begin() const { return events_.begin(); }
+    std::vector<PackedEvent>::const_iterator end() const { return events_.end(); }
+
+    /**
+     * @brief Bytes held by the store (events + arena)
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    std::vector<PackedEvent> events_;
+    std::vector<uint8_t> sysexArena_;
+};
+
+} // namespace midiMind
@@ -0,0 +1,285 @@
+// ============================================================================
+// File: backend/src/midi/player/PlayerEngine.cpp
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Lock order: a player's mutex may be held while taking the engine mutex
+// (wake callback), never the reverse. Player methods are therefore only
+// called with the engine mutex released.
+//
+// ============================================================================
+
+#include "PlayerEngine.h"
+#include "../../core/Logger.h"
+#include <algorithm>
+
+namespace midiMind {
+
+// ============================================================================
+// CONSTRUCTOR / DESTRUCTOR
+// ============================================================================
+
+PlayerEngine::PlayerEngine(std::shared_ptr<MidiRouter> router,
+                           std::shared_ptr<EventBus> eventBus)
+    : router_(router)
+    , eventBus_(eventBus)
+    , playersChanged_(true)
+    , nextPlayerNumber_(1)
+    , wakePending_(false)
+    , running_(true)
+{
+    createPlayer(DEFAULT_PLAYER_ID);
+
+    schedulerThread_ = std::thread(&PlayerEngine::schedulerLoop, this);
+
+    Logger::info("PlayerEngine", "PlayerEngine initialized");
+}
+
+PlayerEngine::~PlayerEngine() {
+    stopAll();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wakeCv_.notify_all();
+
+    if (schedulerThread_.joinable()) {
+        schedulerThread_.join();
+    }
+
+    // Players may outlive the engine (shared with the API layer)
+    for (const auto& id : getPlayerIds()) {
+        if (auto player = getPlayer(id)) {
+            player->setWakeCallback(nullptr);
+        }
+    }
+
+    Logger::info("PlayerEngine", "PlayerEngine destroyed");
+}
+
+// ============================================================================
+// PLAYER MANAGEMENT
+// ============================================================================
+
+std::shared_ptr<MidiPlayer> PlayerEngine::createPlayer(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (players_.size() >= MAX_PLAYERS) {
+        Logger::warning("PlayerEngine", "Player limit reached");
+        return nullptr;
+    }
+
+    std::string playerId = id;
+    while (playerId.empty() || players_.count(playerId)) {
+        if (!id.empty()) {
+            Logger::warning("PlayerEngine", "Player already exists: " + id);
+            return nullptr;
+        }
+        playerId = "player-" + std::to_string(nextPlayerNumber_++);
+    }
+
+    return addPlayer(playerId);
+}
+
+std::shared_ptr<MidiPlayer> PlayerEngine::addPlayer(const std::string& id) {
+    // The player is not visible to anyone yet: taking its mutex here is safe
+    auto player = std::make_shared<MidiPlayer>(router_, eventBus_, id);
+    player->setWakeCallback([this]() { wake(); });
+
+    players_[id] = player;
+    playersChanged_ = true;
+    wakePending_ = true;
+    wakeCv_.notify_one();
+
+    Logger::info("PlayerEngine", "Player created: " + id);
+
+    return player;
+}
+
+bool PlayerEngine::removePlayer(const std::string& id) {
+    std::shared_ptr<MidiPlayer> player;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (id == DEFAULT_PLAYER_ID) {
+            Logger::warning("PlayerEngine", "Default player cannot be removed");
+            return false;
+        }
+
+        auto it = players_.find(id);
+        if (it == players_.end()) {
+            return false;
+        }
+
+        player = it->second;
+        players_.erase(it);
+        playersChanged_ = true;
+    }
+
+    player->stop();
+    player->setWakeCallback(nullptr);
+    wake();
+
+    Logger::info("PlayerEngine", "Player removed: " + id);
+
+    return true;
+}
+
+std::shared_ptr<MidiPlayer> PlayerEngine::getPlayer(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = players_.find(id);
+    return it != players_.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<MidiPlayer> PlayerEngine::getDefaultPlayer() const {
+    return getPlayer(DEFAULT_PLAYER_ID);
+}
+
+std::vector<std::string> PlayerEngine::getPlayerIds() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::string> ids;
+    ids.reserve(players_.size());
+    for (const auto& [id, player] : players_) {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+size_t PlayerEngine::getPlayerCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return players_.size();
+}
+
+// ============================================================================
+// TRANSPORT
+// ============================================================================
+
+size_t PlayerEngine::playTogether(const std::vector<std::string>& ids) {
+    std::vector<std::shared_ptr<MidiPlayer>> players;
+
+    for (const auto& id : ids) {
+        if (auto player = getPlayer(id)) {
+            players.push_back(player);
+        } else {
+            Logger::warning("PlayerEngine", "Unknown player: " + id);
+        }
+    }
+
+    // One anchor for every player keeps the layers phase-aligned
+    auto startTime = std::chrono::steady_clock::now();
+    size_t started = 0;
+
+    for (const auto& player : players) {
+        if (player->playAt(startTime)) {
+            started++;
+        }
+    }
+
+    return started;
+}
+
+void PlayerEngine::stopAll() {
+    for (const auto& id : getPlayerIds()) {
+        if (auto player = getPlayer(id)) {
+            player->stop();
+        }
+    }
+}
+
+void PlayerEngine::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakePending_ = true;
+    }
+    wakeCv_.notify_one();
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+json PlayerEngine::getStatus() const {
+    json players = json::array();
+
+    for (const auto& id : getPlayerIds()) {
+        auto player = getPlayer(id);
+        if (!player) continue;
+
+        players.push_back({
+            {"player_id", id},
+            {"state", static_cast<int>(player->getState())},
+            {"filename", player->getCurrentFile()},
+            {"position", player->getCurrentPosition()},
+            {"duration", player->getDuration()},
+            {"tempo", player->getTempo()},
+            {"loop", player->isLooping()}
+        });
+    }
+
+    return players;
+}
+
+// ============================================================================
+// PRIVATE METHODS
+// ============================================================================
+
+void PlayerEngine::schedulerLoop() {
+    Logger::info("PlayerEngine", "Scheduler thread started");
+
+    using Clock = std::chrono::steady_clock;
+
+    // (deadline returned by the last process() call, player)
+    std::vector<std::pair<Clock::time_point, std::shared_ptr<MidiPlayer>>> schedule;
+
+    while (running_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (playersChanged_) {
+                schedule.clear();
+                for (const auto& [id, player] : players_) {
+                    schedule.emplace_back(Clock::time_point::min(), player);
+                }
+                playersChanged_ = false;
+            }
+
+            wakePending_ = false;
+        }
+
+        // Earliest deadline first, so due events of all layers go out in time order
+        std::sort(schedule.begin(), schedule.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        auto now = Clock::now();
+        auto next = Clock::time_point::max();
+
+        for (auto& entry : schedule) {
+            try {
+                entry.first = entry.second->process(now);
+            } catch (const std::exception& e) {
+                Logger::error("PlayerEngine",
+                    "Player " + entry.second->getId() + " failed: " + e.what());
+                entry.first = Clock::time_point::max();
+            }
+            next = std::min(next, entry.first);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto woken = [this] { return wakePending_ || !running_; };
+
+        if (next == Clock::time_point::max()) {
+            wakeCv_.wait(lock, woken);     // Nothing playing: no polling
+        } else {
+            wakeCv_.wait_until(lock, next, woken);
+        }
+    }
+
+    Logger::info("PlayerEngine", "Scheduler thread stopped");
+}
+
+} // namespace midiMind
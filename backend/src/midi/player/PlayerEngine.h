@@ -0,0 +1,168 @@
+// ============================================================================
+// File: backend/src/midi/player/PlayerEngine.h
+// Version: 4.3.0
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Description:
+//   Hosts several independent MidiPlayer instances (backing track, click,
+//   one-shot clips...) on a single scheduler thread.
+//
+// Features:
+//   - Players addressed by ID; "main" always exists
+//   - One timing thread: sleeps until the earliest deadline of all players
+//     and services due players in deadline order
+//   - Synchronized start of several players on the same clock instant
+//
+// ============================================================================
+
+#pragma once
+
+#include "MidiPlayer.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace midiMind {
+
+class MidiRouter;
+class EventBus;
+
+/**
+ * @class PlayerEngine
+ * @brief Multi-player host driven by one shared scheduler thread
+ *
+ * Thread Safety: All public methods are thread-safe.
+ *
+ * Example:
+ * ```cpp
+ * PlayerEngine engine(router, eventBus);
+ * auto click = engine.createPlayer("click");
+ * engine.getPlayer("main")->load("backing.mid");
+ * click->load("click.mid");
+ * engine.playTogether({"main", "click"});
+ * ```
+ */
+class PlayerEngine {
+public:
+    /// ID of the player that always exists
+    static constexpr const char* DEFAULT_PLAYER_ID = "main";
+
+    /// Upper bound on hosted players
+    static constexpr size_t MAX_PLAYERS = 32;
+
+    /**
+     * @brief Constructor (creates the default player and starts the scheduler)
+     */
+    PlayerEngine(std::shared_ptr<MidiRouter> router,
+                 std::shared_ptr<EventBus> eventBus = nullptr);
+
+    /**
+     * @brief Destructor (stops all players and the scheduler)
+     */
+    ~PlayerEngine();
+
+    PlayerEngine(const PlayerEngine&) = delete;
+    PlayerEngine& operator=(const PlayerEngine&) = delete;
+
+    // ========================================================================
+    // PLAYER MANAGEMENT
+    // ========================================================================
+
+    /**
+     * @brief Create a player
+     * @param id Player ID (empty = generated "player-N")
+     * @return std::shared_ptr<MidiPlayer> New player, nullptr if the ID is
+     *         taken or MAX_PLAYERS is reached
+     */
+    std::shared_ptr<MidiPlayer> createPlayer(const std::string& id = "");
+
+    /**
+     * @brief Stop and remove a player (the default player cannot be removed)
+     * @return bool true if removed
+     */
+    bool removePlayer(const std::string& id);
+
+    /**
+     * @brief Get a player by ID
+     * @return std::shared_ptr<MidiPlayer> Player or nullptr
+     */
+    std::shared_ptr<MidiPlayer> getPlayer(const std::string& id) const;
+
+    std::shared_ptr<MidiPlayer> getDefaultPlayer() const;
+    std::vector<std::string> getPlayerIds() const;
+    size_t getPlayerCount() const;
+
+    // ========================================================================
+    // TRANSPORT
+    // ========================================================================
+
+    /**
+     * @brief Start (or resume) several players on the same clock instant
+     * @param ids Player IDs
+     * @return size_t Number of players started
+     */
+    size_t playTogether(const std::vector<std::string>& ids);
+
+    /**
+     * @brief Stop every player
+     */
+    void stopAll();
+
+    /**
+     * @brief Wake the scheduler (called by players on transport changes)
+     */
+    void wake();
+
+    // ========================================================================
+    // STATUS
+    // ========================================================================
+
+    /**
+     * @brief Get state of all players
+     * @return json Array of {player_id, state, filename, position, duration, tempo}
+     */
+    json getStatus() const;
+
+private:
+    /**
+     * @brief Scheduler thread: services due players, sleeps until the next deadline
+     */
+    void schedulerLoop();
+
+    /**
+     * @brief Create and register a player (caller holds mutex_)
+     */
+    std::shared_ptr<MidiPlayer> addPlayer(const std::string& id);
+
+    std::shared_ptr<MidiRouter> router_;
+    std::shared_ptr<EventBus> eventBus_;
+
+    /// Hosted players by ID
+    std::map<std::string, std::shared_ptr<MidiPlayer>> players_;
+
+    /// players_ changed since the scheduler last copied it
+    bool playersChanged_;
+
+    /// Counter for generated IDs
+    uint32_t nextPlayerNumber_;
+
+    /// Scheduler wake-up
+    mutable std::mutex mutex_;
+    std::condition_variable wakeCv_;
+    bool wakePending_;
+
+    std::thread schedulerThread_;
+    std::atomic<bool> running_;
+};
+
+} // namespace midiMind
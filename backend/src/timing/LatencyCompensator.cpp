@@ -1,6 +1,6 @@
 // ============================================================================
 // File: backend/src/timing/LatencyCompensator.cpp
-// Version: 4.1.0
+// Version: 4.2.4
 // Project: MidiMind - MIDI Orchestration System for Raspberry Pi
 // ============================================================================
 //
@@ -10,6 +10,25 @@
 // Author: MidiMind Team
 // Date: 2025-10-16
 //
+// Changes v4.2.4:
+//   - Added recordDeviceInputLatency() / getDeviceInputProfile(): input
+//     latency is kept apart from the output-path profile used by
+//     getAlignmentDelays(); statistics report it under "input"
+//
+// Changes v4.2.3:
+//   - Added getAlignmentDelays(): device compensation (recorded input
+//     latency) counts toward a destination's alignment
+//   - Device changes call the change callback: manual offset, removal of a
+//     compensated device, measured offset drifting DEVICE_ALIGNMENT_STEP_US
+//
+// Changes v4.2.2:
+//   - Changes that can move an alignment delay (instrument registration,
+//     measurement, manual offset, enable/disable, reload) call the change
+//     callback once the locks are released
+//
+// Changes v4.2.1:
+//   - Added getAlignmentDelay()
+//
 // Changes v4.1.0:
 //   - Added instrument-level compensation
 //   - Database integration
@@ -137,12 +156,19 @@ bool LatencyCompensator::registerDevice(const std::string& deviceId) {
 }
 
 void LatencyCompensator::unregisterDevice(const std::string& deviceId) {
-    std::lock_guard<std::mutex> lock(deviceMutex_);
+    std::unique_lock<std::mutex> lock(deviceMutex_);
     
     auto it = devices_.find(deviceId);
     if (it != devices_.end()) {
+        bool aligned = it->second.alignmentOffset != 0;
         devices_.erase(it);
+        deviceInputs_.erase(deviceId);
         Logger::info("LatencyCompensator", "Device unregistered: " + deviceId);
+        
+        lock.unlock();
+        if (aligned) {
+            notifyChanged();
+        }
     }
 }
 
@@ -156,7 +182,7 @@ bool LatencyCompensator::isDeviceRegistered(const std::string& deviceId) const {
 // ============================================================================
 
 bool LatencyCompensator::registerInstrument(const InstrumentLatencyProfile& profile) {
-    std::lock_guard<std::mutex> lock(instrumentMutex_);
+    std::unique_lock<std::mutex> lock(instrumentMutex_);
     
     if (instruments_.find(profile.instrumentId) != instruments_.end()) {
         Logger::warning("LatencyCompensator", 
@@ -167,16 +193,22 @@ bool LatencyCompensator::registerInstrument(const InstrumentLatencyProfile& prof
     instruments_[profile.instrumentId] = profile;
     
     Logger::info("LatencyCompensator", "Instrument registered: " + profile.instrumentId);
+    
+    lock.unlock();
+    notifyChanged();
     return true;
 }
 
 void LatencyCompensator::unregisterInstrument(const std::string& instrumentId) {
-    std::lock_guard<std::mutex> lock(instrumentMutex_);
+    std::unique_lock<std::mutex> lock(instrumentMutex_);
     
     auto it = instruments_.find(instrumentId);
     if (it != instruments_.end()) {
         instruments_.erase(it);
         Logger::info("LatencyCompensator", "Instrument unregistered: " + instrumentId);
+        
+        lock.unlock();
+        notifyChanged();
     }
 }
 
@@ -190,7 +222,7 @@ bool LatencyCompensator::isInstrumentRegistered(const std::string& instrumentId)
 // ============================================================================
 
 void LatencyCompensator::recordDeviceLatency(const std::string& deviceId, uint64_t latencyUs) {
-    std::lock_guard<std::mutex> lock(deviceMutex_);
+    std::unique_lock<std::mutex> lock(deviceMutex_);
     
     auto it = devices_.find(deviceId);
     if (it == devices_.end()) {
@@ -199,14 +231,46 @@ void LatencyCompensator::recordDeviceLatency(const std::string& deviceId, uint64
     }
     
     DeviceLatencyProfile& profile = it->second;
+    if (!addDeviceMeasurement(profile, latencyUs)) {
+        return;
+    }
+    
+    // May be measured per packet: alignment follows only a real drift
+    int64_t drift = profile.compensationOffset - profile.alignmentOffset;
+    if (drift >= DEVICE_ALIGNMENT_STEP_US || drift <= -DEVICE_ALIGNMENT_STEP_US) {
+        profile.alignmentOffset = profile.compensationOffset;
+        
+        lock.unlock();
+        notifyChanged();
+    }
+}
+
+void LatencyCompensator::recordDeviceInputLatency(const std::string& deviceId,
+                                                  uint64_t latencyUs) {
+    std::lock_guard<std::mutex> lock(deviceMutex_);
+    
+    if (devices_.find(deviceId) == devices_.end()) {
+        Logger::warning("LatencyCompensator", "Device not registered: " + deviceId);
+        return;
+    }
+    
+    // Statistics only: no alignment delay depends on it
+    DeviceLatencyProfile& profile = deviceInputs_[deviceId];
+    profile.deviceId = deviceId;
+    addDeviceMeasurement(profile, latencyUs);
+}
+
+bool LatencyCompensator::addDeviceMeasurement(DeviceLatencyProfile& profile,
+                                              uint64_t latencyUs) {
+    // Caller holds deviceMutex_
     
     // Detect outliers (load atomic value)
     bool outlierDetection = outlierDetectionEnabled_.load();
     if (outlierDetection && isOutlier(profile, latencyUs)) {
         Logger::debug("LatencyCompensator", 
-                     "Outlier detected for " + deviceId + ": " + 
+                     "Outlier detected for " + profile.deviceId + ": " + 
                      std::to_string(latencyUs) + "Âµs");
-        return;
+        return false;
     }
     
     // Add measurement
@@ -218,8 +282,9 @@ void LatencyCompensator::recordDeviceLatency(const std::string& deviceId, uint64
     }
     
     Logger::debug("LatencyCompensator", 
-                 deviceId + " latency: " + std::to_string(latencyUs) + "Âµs, " +
+                 profile.deviceId + " latency: " + std::to_string(latencyUs) + "Âµs, " +
                  "avg: " + std::to_string(profile.averageLatency) + "Âµs");
+    return true;
 }
 
 int64_t LatencyCompensator::getDeviceCompensation(const std::string& deviceId) const {
@@ -234,16 +299,20 @@ int64_t LatencyCompensator::getDeviceCompensation(const std::string& deviceId) c
 }
 
 void LatencyCompensator::setDeviceCompensation(const std::string& deviceId, int64_t offsetUs) {
-    std::lock_guard<std::mutex> lock(deviceMutex_);
+    std::unique_lock<std::mutex> lock(deviceMutex_);
     
     auto it = devices_.find(deviceId);
     if (it != devices_.end()) {
         it->second.compensationOffset = offsetUs;
+        it->second.alignmentOffset = offsetUs;
         it->second.autoCompensation = false;
         
         Logger::info("LatencyCompensator", 
                     deviceId + " manual compensation set to " + 
                     std::to_string(offsetUs) + "Âµs");
+        
+        lock.unlock();
+        notifyChanged();
     }
 }
 
@@ -253,7 +322,7 @@ void LatencyCompensator::setDeviceCompensation(const std::string& deviceId, int6
 
 void LatencyCompensator::recordInstrumentLatency(const std::string& instrumentId, 
                                                  uint64_t latencyUs) {
-    std::lock_guard<std::mutex> lock(instrumentMutex_);
+    std::unique_lock<std::mutex> lock(instrumentMutex_);
     
     auto it = instruments_.find(instrumentId);
     if (it == instruments_.end()) {
@@ -327,6 +396,9 @@ void LatencyCompensator::recordInstrumentLatency(const std::string& instrumentId
     Logger::debug("LatencyCompensator", 
                  instrumentId + " latency: " + std::to_string(latencyUs) + "Âµs, " +
                  "avg: " + std::to_string(profile.avgLatency) + "Âµs");
+    
+    lock.unlock();
+    notifyChanged();
 }
 
 int64_t LatencyCompensator::getInstrumentCompensation(const std::string& instrumentId) const {
@@ -346,9 +418,61 @@ int64_t LatencyCompensator::getInstrumentCompensation(const std::string& instrum
     return profile.totalCompensation;
 }
 
+int64_t LatencyCompensator::getAlignmentDelay(const std::string& instrumentId) const {
+    return getAlignmentDelays({instrumentId})[instrumentId];
+}
+
+std::unordered_map<std::string, int64_t> LatencyCompensator::getAlignmentDelays(
+    const std::vector<std::string>& destinations) const {
+    std::unordered_map<std::string, int64_t> compensation;
+    
+    if (!isEnabled()) {
+        for (const auto& id : destinations) {
+            compensation[id] = 0;
+        }
+        return compensation;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex_);
+        for (const auto& id : destinations) {
+            auto it = devices_.find(id);
+            compensation[id] = it != devices_.end() ? it->second.alignmentOffset : 0;
+        }
+    }
+    
+    // Compensations are negative latencies: the slowest destination or
+    // instrument has the lowest one and is the reference the others wait for
+    int64_t slowest = 0;
+    
+    {
+        std::lock_guard<std::mutex> lock(instrumentMutex_);
+        for (const auto& [id, profile] : instruments_) {
+            if (!profile.enabled) {
+                continue;
+            }
+            auto it = compensation.find(id);
+            if (it != compensation.end()) {
+                it->second += profile.totalCompensation;
+            } else {
+                slowest = std::min(slowest, profile.totalCompensation);
+            }
+        }
+    }
+    
+    for (const auto& [id, value] : compensation) {
+        slowest = std::min(slowest, value);
+    }
+    for (auto& [id, value] : compensation) {
+        value -= slowest;
+    }
+    
+    return compensation;
+}
+
 void LatencyCompensator::setInstrumentCompensation(const std::string& instrumentId, 
                                                    int64_t offsetUs) {
-    std::lock_guard<std::mutex> lock(instrumentMutex_);
+    std::unique_lock<std::mutex> lock(instrumentMutex_);
     
     auto it = instruments_.find(instrumentId);
     if (it != instruments_.end()) {
@@ -358,9 +482,17 @@ void LatencyCompensator::setInstrumentCompensation(const std::string& instrument
         Logger::info("LatencyCompensator", 
                     instrumentId + " manual compensation set to " + 
                     std::to_string(offsetUs) + "Âµs");
+        
+        lock.unlock();
+        notifyChanged();
     }
 }
 
+void LatencyCompensator::setChangeCallback(ChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    changeCallback_ = std::move(callback);
+}
+
 // ============================================================================
 // PROFILES
 // ============================================================================
@@ -376,6 +508,17 @@ DeviceLatencyProfile LatencyCompensator::getDeviceProfile(const std::string& dev
     return DeviceLatencyProfile();
 }
 
+DeviceLatencyProfile LatencyCompensator::getDeviceInputProfile(const std::string& deviceId) const {
+    std::lock_guard<std::mutex> lock(deviceMutex_);
+    
+    auto it = deviceInputs_.find(deviceId);
+    if (it != deviceInputs_.end()) {
+        return it->second;
+    }
+    
+    return DeviceLatencyProfile();
+}
+
 InstrumentLatencyProfile LatencyCompensator::getInstrumentProfile(
     const std::string& instrumentId) const {
     
@@ -474,7 +617,7 @@ bool LatencyCompensator::saveInstrumentProfiles() {
 }
 
 bool LatencyCompensator::loadInstrumentProfiles() {
-    std::lock_guard<std::mutex> lock(instrumentMutex_);
+    std::unique_lock<std::mutex> lock(instrumentMutex_);
     
     Logger::info("LatencyCompensator", "Loading instrument profiles from database...");
     
@@ -535,6 +678,8 @@ bool LatencyCompensator::loadInstrumentProfiles() {
     Logger::info("LatencyCompensator", 
                 "âœ“ Loaded " + std::to_string(instruments_.size()) + " instrument profiles");
     
+    lock.unlock();
+    notifyChanged();
     return true;
 }
 
@@ -547,7 +692,13 @@ json LatencyCompensator::getDeviceStatistics(const std::string& deviceId) const
     
     auto it = devices_.find(deviceId);
     if (it != devices_.end()) {
-        return it->second.toJson();
+        json stats = it->second.toJson();
+        
+        auto input = deviceInputs_.find(deviceId);
+        if (input != deviceInputs_.end()) {
+            stats["input"] = input->second.toJson();
+        }
+        return stats;
     }
     
     return json::object();
@@ -574,7 +725,13 @@ json LatencyCompensator::getAllStatistics() const {
         stats["devices"] = json::array();
         
         for (const auto& [id, profile] : devices_) {
-            stats["devices"].push_back(profile.toJson());
+            json device = profile.toJson();
+            
+            auto input = deviceInputs_.find(id);
+            if (input != deviceInputs_.end()) {
+                device["input"] = input->second.toJson();
+            }
+            stats["devices"].push_back(device);
         }
     }
     
@@ -670,6 +827,14 @@ void LatencyCompensator::updateDeviceStatistics(DeviceLatencyProfile& profile) {
     // Statistics are updated in addMeasurement()
 }
 
+void LatencyCompensator::notifyChanged() {
+    // Held while the callback runs, so setChangeCallback(nullptr) waits for it
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    if (changeCallback_) {
+        changeCallback_();
+    }
+}
+
 } // namespace midiMind
 
 // ============================================================================
@@ -1,8 +1,26 @@
 // ============================================================================
 // File: backend/src/timing/LatencyCompensator.h
-// Version: 4.2.0 - PHASE 1 COMPLETE
+// Version: 4.2.4
 // ============================================================================
 //
+// Changes v4.2.4:
+//   - FIXED: input latency (BLE jitter buffer) went into the device profile
+//     that feeds output alignment; it now has its own input profile
+//     (recordDeviceInputLatency(), statistics only)
+//
+// Changes v4.2.3:
+//   - FIXED: alignment ignored device profiles, where input latency (BLE
+//     jitter buffer) is recorded; a destination's device compensation now
+//     adds to its instrument's (getAlignmentDelays())
+//
+// Changes v4.2.2:
+//   - ADDED: setChangeCallback(), told whenever an alignment delay may have
+//     changed (MidiRouter compiles the delays into its routing table)
+//
+// Changes v4.2.1:
+//   - ADDED: getAlignmentDelay() (delay that lines an instrument up with
+//     the slowest one, for timed delivery)
+//
 // Changes v4.2.0:
 //   ✅ ADDED: enable() / disable() / isEnabled()
 //   ✅ ADDED: getGlobalOffset() / setGlobalOffset()
@@ -20,6 +38,7 @@
 #include <mutex>
 #include <atomic>
 #include <memory>
+#include <functional>
 #include <nlohmann/json.hpp>
 #include "InstrumentLatencyProfile.h"
 #include "../storage/InstrumentDatabase.h"
@@ -37,6 +56,7 @@ struct DeviceLatencyProfile {
     double jitter;
     uint64_t measurementCount;
     int64_t compensationOffset;
+    int64_t alignmentOffset;    ///< compensationOffset as last used for alignment
     bool autoCompensation;
     std::deque<uint64_t> latencyHistory;
     
@@ -48,6 +68,7 @@ struct DeviceLatencyProfile {
         , jitter(0.0)
         , measurementCount(0)
         , compensationOffset(0)
+        , alignmentOffset(0)
         , autoCompensation(true)
     {}
     
@@ -58,6 +79,11 @@ struct DeviceLatencyProfile {
 
 class LatencyCompensator {
 public:
+    using ChangeCallback = std::function<void()>;
+    
+    /// Drift of a device's measured compensation before alignment follows
+    static constexpr int64_t DEVICE_ALIGNMENT_STEP_US = 500;
+    
     explicit LatencyCompensator(InstrumentDatabase& instrumentDb);
     ~LatencyCompensator();
     
@@ -74,18 +100,58 @@ public:
     void unregisterInstrument(const std::string& instrumentId);
     bool isInstrumentRegistered(const std::string& instrumentId) const;
     
-    // Device latency measurement
+    // Device latency measurement (output path: counts toward alignment)
     void recordDeviceLatency(const std::string& deviceId, uint64_t latencyUs);
     int64_t getDeviceCompensation(const std::string& deviceId) const;
     void setDeviceCompensation(const std::string& deviceId, int64_t offsetUs);
     
+    /**
+     * @brief Record latency a device adds to what it receives (BLE jitter
+     *        buffer)
+     *
+     * Kept in the device's input profile, for statistics only: it delays
+     * messages before they are routed, so it never moves an output's
+     * alignment delay.
+     */
+    void recordDeviceInputLatency(const std::string& deviceId, uint64_t latencyUs);
+    
     // Instrument latency measurement
     void recordInstrumentLatency(const std::string& instrumentId, uint64_t latencyUs);
     int64_t getInstrumentCompensation(const std::string& instrumentId) const;
     void setInstrumentCompensation(const std::string& instrumentId, int64_t offsetUs);
     
+    /**
+     * @brief Delay to hold messages for an instrument so that they sound
+     *        together with those of the slowest enabled instrument
+     * @return Delay in µs (>= 0); 0 for the slowest instrument, an unknown
+     *         instrument with no slower peer, or when compensation is disabled
+     */
+    int64_t getAlignmentDelay(const std::string& instrumentId) const;
+    
+    /**
+     * @brief Alignment delays of a set of destinations, in one pass
+     *
+     * A destination's compensation is its enabled instrument's plus its
+     * device's output-path compensation (recordDeviceLatency(),
+     * setDeviceCompensation()). Device profiles count for the given
+     * destinations alone; input profiles never count.
+     *
+     * @return Delay in µs (>= 0) per destination
+     */
+    std::unordered_map<std::string, int64_t> getAlignmentDelays(
+        const std::vector<std::string>& destinations) const;
+    
+    /**
+     * @brief Set the callback told that alignment delays may have changed
+     * @param callback Called after the change, without the compensator's
+     *        locks held (may call back into it); nullptr to remove.
+     *        Returns only once no call of the previous callback is running.
+     */
+    void setChangeCallback(ChangeCallback callback);
+    
     // Profiles
     DeviceLatencyProfile getDeviceProfile(const std::string& deviceId) const;
+    DeviceLatencyProfile getDeviceInputProfile(const std::string& deviceId) const;
     InstrumentLatencyProfile getInstrumentProfile(const std::string& instrumentId) const;
     std::vector<InstrumentLatencyProfile> getAllInstrumentProfiles() const;
     
@@ -126,15 +192,21 @@ public:
     
     // ✅ NEW: Global control methods for CommandHandler
     void enable() { 
-        std::lock_guard<std::mutex> lock(deviceMutex_);
-        enabled_ = true; 
+        {
+            std::lock_guard<std::mutex> lock(deviceMutex_);
+            enabled_ = true; 
+        }
         Logger::info("LatencyCompensator", "Compensation enabled");
+        notifyChanged();
     }
     
     void disable() { 
-        std::lock_guard<std::mutex> lock(deviceMutex_);
-        enabled_ = false; 
+        {
+            std::lock_guard<std::mutex> lock(deviceMutex_);
+            enabled_ = false; 
+        }
         Logger::info("LatencyCompensator", "Compensation disabled");
+        notifyChanged();
     }
     
     bool isEnabled() const { 
@@ -156,15 +228,22 @@ public:
 
 private:
     bool isOutlier(const DeviceLatencyProfile& profile, uint64_t latency) const;
+    bool addDeviceMeasurement(DeviceLatencyProfile& profile, uint64_t latencyUs);
     void updateDeviceStatistics(DeviceLatencyProfile& profile);
+    void notifyChanged();
     
     std::unordered_map<std::string, DeviceLatencyProfile> devices_;
+    std::unordered_map<std::string, DeviceLatencyProfile> deviceInputs_;
     std::unordered_map<std::string, InstrumentLatencyProfile> instruments_;
     InstrumentDatabase& instrumentDb_;
     
     mutable std::mutex deviceMutex_;
     mutable std::mutex instrumentMutex_;
     
+    // Change listener (held while it runs: removal waits for it)
+    std::mutex callbackMutex_;
+    ChangeCallback changeCallback_;
+    
     // Atomic configuration parameters
     std::atomic<size_t> historySize_;
     std::atomic<bool> outlierDetectionEnabled_;
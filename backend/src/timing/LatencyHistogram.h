@@ -0,0 +1,207 @@
+// ============================================================================
+// File: backend/src/timing/LatencyHistogram.h
+// Version: 4.2.1
+// Project: MidiMind - MIDI Orchestration System for Raspberry Pi
+// ============================================================================
+//
+// Changes v4.2.1:
+//   - record(value, count) for values shared by a burst
+//   - Copyable (the copy is a snapshot)
+//
+// Description:
+//   Lock-free, log-bucketed latency histogram (HDR-style).
+//   Records microsecond values with relaxed atomics so it can be fed from
+//   real-time threads and read concurrently from API threads.
+//
+// ============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace midiMind {
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size log2 histogram with 8 linear sub-buckets per octave
+ *
+ * Values below 16µs are exact; above that the relative bucket error is
+ * at most 12.5%. Values beyond ~2^32µs are clamped into the last bucket.
+ *
+ * Thread Safety: record() is wait-free and may run concurrently with
+ * readers. Readers see an approximately consistent snapshot.
+ *
+ * Example:
+ * ```cpp
+ * LatencyHistogram lateness;
+ * lateness.record(actualUs - scheduledUs);
+ * json j = lateness.toJson();   // count, min, max, mean, p50, p95, p99
+ * ```
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = 256;
+
+    LatencyHistogram() { reset(); }
+
+    /**
+     * @brief Snapshot of another histogram (it may be recording meanwhile)
+     */
+    LatencyHistogram(const LatencyHistogram& other) { *this = other; }
+
+    LatencyHistogram& operator=(const LatencyHistogram& other) {
+        if (this != &other) {
+            for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                buckets_[i].store(other.buckets_[i].load(std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+            }
+            count_.store(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            sum_.store(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            max_.store(other.max_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            min_.store(other.min_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Record one value (microseconds)
+     */
+    void record(uint64_t valueUs) {
+        record(valueUs, 1);
+    }
+
+    /**
+     * @brief Record the same value several times (microseconds)
+     */
+    void record(uint64_t valueUs, uint64_t count) {
+        buckets_[bucketIndex(valueUs)].fetch_add(count, std::memory_order_relaxed);
+        count_.fetch_add(count, std::memory_order_relaxed);
+        sum_.fetch_add(valueUs * count, std::memory_order_relaxed);
+
+        uint64_t prev = max_.load(std::memory_order_relaxed);
+        while (valueUs > prev &&
+               !max_.compare_exchange_weak(prev, valueUs, std::memory_order_relaxed)) {}
+
+        prev = min_.load(std::memory_order_relaxed);
+        while (valueUs < prev &&
+               !min_.compare_exchange_weak(prev, valueUs, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * @brief Clear all recorded values
+     */
+    void reset() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+
+    uint64_t getCount() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return max_.load(std::memory_order_relaxed); }
+
+    uint64_t getMin() const {
+        uint64_t min = min_.load(std::memory_order_relaxed);
+        return min == UINT64_MAX ? 0 : min;
+    }
+
+    double getMean() const {
+        uint64_t count = getCount();
+        return count ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / count : 0.0;
+    }
+
+    /**
+     * @brief Get value at percentile
+     * @param percentile 0.0 - 100.0
+     * @return uint64_t Upper bound of the bucket holding the percentile (µs)
+     */
+    uint64_t getPercentile(double percentile) const {
+        uint64_t total = 0;
+        std::array<uint64_t, BUCKET_COUNT> snapshot;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            snapshot[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += snapshot[i];
+        }
+
+        if (total == 0) {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * total + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += snapshot[i];
+            if (seen >= rank) {
+                uint64_t upper = bucketUpperBound(i);
+                uint64_t max = getMax();
+                return upper < max ? upper : max;
+            }
+        }
+
+        return getMax();
+    }
+
+    json toJson() const {
+        return {
+            {"count", getCount()},
+            {"min_us", getMin()},
+            {"max_us", getMax()},
+            {"mean_us", getMean()},
+            {"p50_us", getPercentile(50.0)},
+            {"p95_us", getPercentile(95.0)},
+            {"p99_us", getPercentile(99.0)}
+        };
+    }
+
+    // ========================================================================
+    // BUCKET MAPPING
+    // ========================================================================
+
+    static size_t bucketIndex(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        unsigned shift = msb - SUB_BUCKET_BITS;
+        size_t sub = static_cast<size_t>(value >> shift) & (SUB_BUCKETS - 1);
+        size_t index = (shift + 1) * SUB_BUCKETS + sub;
+
+        return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+    }
+
+    static uint64_t bucketUpperBound(size_t index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+
+        unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS) - 1;
+        uint64_t sub = index % SUB_BUCKETS;
+        uint64_t lower = (SUB_BUCKETS + sub) << shift;
+
+        return lower + (uint64_t(1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+    std::atomic<uint64_t> min_;
+};
+
+} // namespace midiMind